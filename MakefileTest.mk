@@ -4,7 +4,7 @@ CC = gcc
 CFLAGS = -g -Wall -Iinclude -Iinclude/common -Iexternal -MMD -MP
 
 # --- Configuration for Executables ---
-TARGETS = test_linked_list test_preprocessing test_job_receiver test_simulation_stats test_timed_queue
+TARGETS = test_linked_list test_preprocessing test_job_receiver test_simulation_stats test_timed_queue test_queueing_model test_checkpoint test_event_ring test_binary_log test_log_filter test_text_buffer test_log_router test_latency_histogram test_metrics_ring test_stats_snapshot test_streaming_moments test_trace_writer test_lock_profile test_host_usage test_steady_state test_stats_export test_ws_bridge test_websocket_handler test_session_manager
 
 # --- Rules ---
 all: $(TARGETS)
@@ -13,18 +13,76 @@ all: $(TARGETS)
 test_linked_list: tests/test_linked_list.c src/linked_list.c tests/test_utils.c include/linked_list.h include/test_utils.h include/common/common.h
 	$(CC) $(CFLAGS) -o $@ tests/test_linked_list.c src/linked_list.c tests/test_utils.c
 
-test_preprocessing: tests/test_preprocessing.c src/preprocessing.c tests/test_utils.c include/preprocessing.h include/test_utils.h include/common/common.h
-	$(CC) $(CFLAGS) -o $@ tests/test_preprocessing.c src/preprocessing.c tests/test_utils.c
+test_preprocessing: tests/test_preprocessing.c src/preprocessing.c external/mongoose.c src/steady_state.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/common/timeutils.c tests/test_utils.c include/preprocessing.h include/log_filter.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_preprocessing.c src/preprocessing.c external/mongoose.c src/steady_state.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/common/timeutils.c tests/test_utils.c -lm
 
-test_job_receiver: tests/test_job_receiver.c src/job_receiver.c tests/test_utils.c src/preprocessing.c src/timed_queue.c src/linked_list.c src/common/timeutils.c src/simulation_stats.c src/console_handler.c include/job_receiver.h include/preprocessing.h include/linked_list.h include/timed_queue.h include/common/timeutils.h include/simulation_stats.h include/console_handler.h include/test_utils.h include/common/common.h
-	$(CC) $(CFLAGS) -o $@ tests/test_job_receiver.c src/job_receiver.c tests/test_utils.c src/preprocessing.c src/timed_queue.c src/linked_list.c src/common/timeutils.c src/simulation_stats.c src/console_handler.c -lm -lpthread
+test_job_receiver: tests/test_job_receiver.c src/job_receiver.c src/lock_profile.c src/host_usage.c tests/test_utils.c src/preprocessing.c external/mongoose.c src/timed_queue.c src/linked_list.c src/common/timeutils.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/console_handler.c src/log_event.c src/common/text_buffer.c src/event_ring.c src/log_filter.c src/log_router.c include/job_receiver.h include/preprocessing.h include/linked_list.h include/timed_queue.h include/common/timeutils.h include/simulation_stats.h include/console_handler.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_job_receiver.c src/job_receiver.c src/lock_profile.c src/host_usage.c tests/test_utils.c src/preprocessing.c external/mongoose.c src/timed_queue.c src/linked_list.c src/common/timeutils.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/console_handler.c src/log_event.c src/common/text_buffer.c src/event_ring.c src/log_filter.c src/log_router.c -lm -lpthread
 
-test_simulation_stats: tests/test_simulation_stats.c src/simulation_stats.c tests/test_utils.c include/simulation_stats.h include/test_utils.h
-	$(CC) $(CFLAGS) -o $@ tests/test_simulation_stats.c src/simulation_stats.c tests/test_utils.c -lm
+test_simulation_stats: tests/test_simulation_stats.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c tests/test_utils.c include/simulation_stats.h include/test_utils.h
+	$(CC) $(CFLAGS) -o $@ tests/test_simulation_stats.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c tests/test_utils.c -lm
 
 test_timed_queue: tests/test_timed_queue.c src/timed_queue.c src/linked_list.c tests/test_utils.c src/common/timeutils.c include/timed_queue.h include/linked_list.h include/common/timeutils.h include/test_utils.h include/common/common.h
 	$(CC) $(CFLAGS) -o $@ tests/test_timed_queue.c src/timed_queue.c src/linked_list.c tests/test_utils.c src/common/timeutils.c -lm
 
+test_queueing_model: tests/test_queueing_model.c src/queueing_model.c tests/test_utils.c include/queueing_model.h include/preprocessing.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_queueing_model.c src/queueing_model.c tests/test_utils.c -lm
+
+CHECKPOINT_SRCS = src/checkpoint.c src/simulation_context.c src/lock_profile.c src/host_usage.c src/metrics_ring.c src/stats_snapshot.c src/job_receiver.c src/printer.c src/paper_refiller.c src/signalcatcher.c src/log_router.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/queueing_model.c src/timed_queue.c src/linked_list.c src/common/timeutils.c src/preprocessing.c external/mongoose.c
+test_checkpoint: tests/test_checkpoint.c $(CHECKPOINT_SRCS) tests/test_utils.c include/checkpoint.h include/simulation_context.h include/job_receiver.h include/timed_queue.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_checkpoint.c $(CHECKPOINT_SRCS) tests/test_utils.c -lm -lpthread
+
+test_event_ring: tests/test_event_ring.c src/event_ring.c tests/test_utils.c include/event_ring.h include/log_event.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_event_ring.c src/event_ring.c tests/test_utils.c -lpthread
+
+test_binary_log: tests/test_binary_log.c src/binary_log.c src/log_event.c src/common/text_buffer.c src/common/timeutils.c tests/test_utils.c include/binary_log.h include/log_event.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_binary_log.c src/binary_log.c src/log_event.c src/common/text_buffer.c src/common/timeutils.c tests/test_utils.c -lm -lpthread
+
+test_log_filter: tests/test_log_filter.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/preprocessing.c external/mongoose.c src/steady_state.c src/common/timeutils.c tests/test_utils.c include/log_filter.h include/log_event.h include/preprocessing.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_log_filter.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/preprocessing.c external/mongoose.c src/steady_state.c src/common/timeutils.c tests/test_utils.c -lm
+
+test_text_buffer: tests/test_text_buffer.c src/common/text_buffer.c tests/test_utils.c include/common/text_buffer.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_text_buffer.c src/common/text_buffer.c tests/test_utils.c
+
+test_log_router: tests/test_log_router.c src/log_router.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/queueing_model.c src/timed_queue.c src/linked_list.c src/common/timeutils.c tests/test_utils.c include/log_router.h include/log_filter.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_log_router.c src/log_router.c src/log_filter.c src/log_event.c src/common/text_buffer.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/queueing_model.c src/timed_queue.c src/linked_list.c src/common/timeutils.c tests/test_utils.c -lm -lpthread
+
+test_latency_histogram: tests/test_latency_histogram.c src/latency_histogram.c tests/test_utils.c include/latency_histogram.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_latency_histogram.c src/latency_histogram.c tests/test_utils.c -lm
+
+test_metrics_ring: tests/test_metrics_ring.c src/metrics_ring.c src/common/text_buffer.c tests/test_utils.c include/metrics_ring.h include/common/text_buffer.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_metrics_ring.c src/metrics_ring.c src/common/text_buffer.c tests/test_utils.c -lpthread
+
+test_stats_snapshot: tests/test_stats_snapshot.c src/stats_snapshot.c src/latency_histogram.c tests/test_utils.c include/stats_snapshot.h include/latency_histogram.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_stats_snapshot.c src/stats_snapshot.c src/latency_histogram.c tests/test_utils.c -lm
+
+test_streaming_moments: tests/test_streaming_moments.c src/streaming_moments.c tests/test_utils.c include/streaming_moments.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_streaming_moments.c src/streaming_moments.c tests/test_utils.c -lm
+
+test_trace_writer: tests/test_trace_writer.c src/trace_writer.c tests/test_utils.c include/trace_writer.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_trace_writer.c src/trace_writer.c tests/test_utils.c -lpthread
+
+test_lock_profile: tests/test_lock_profile.c src/lock_profile.c src/latency_histogram.c tests/test_utils.c include/lock_profile.h include/latency_histogram.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_lock_profile.c src/lock_profile.c src/latency_histogram.c tests/test_utils.c -lm -lpthread
+
+test_host_usage: tests/test_host_usage.c src/host_usage.c tests/test_utils.c include/host_usage.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_host_usage.c src/host_usage.c tests/test_utils.c -lpthread
+
+test_steady_state: tests/test_steady_state.c src/steady_state.c tests/test_utils.c include/steady_state.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_steady_state.c src/steady_state.c tests/test_utils.c
+
+test_stats_export: tests/test_stats_export.c src/stats_export.c src/json_writer.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c tests/test_utils.c include/stats_export.h include/json_writer.h include/simulation_stats.h include/preprocessing.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_stats_export.c src/stats_export.c src/json_writer.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c tests/test_utils.c -lm
+
+test_ws_bridge: tests/test_ws_bridge.c src/ws_bridge.c src/log_filter.c src/log_event.c src/common/text_buffer.c external/mongoose.c tests/test_utils.c include/ws_bridge.h include/log_filter.h include/log_event.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_ws_bridge.c src/ws_bridge.c src/log_filter.c src/log_event.c src/common/text_buffer.c external/mongoose.c tests/test_utils.c -lm -lpthread
+
+test_websocket_handler: tests/test_websocket_handler.c src/websocket_handler.c src/ws_bridge.c src/log_router.c src/log_filter.c src/log_event.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/queueing_model.c src/metrics_ring.c src/host_usage.c src/lock_profile.c src/timed_queue.c src/linked_list.c src/common/text_buffer.c src/common/timeutils.c external/mongoose.c tests/test_utils.c include/websocket_handler.h include/ws_bridge.h include/log_router.h include/log_event.h include/timed_queue.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_websocket_handler.c src/websocket_handler.c src/ws_bridge.c src/log_router.c src/log_filter.c src/log_event.c src/simulation_stats.c src/steady_state.c src/latency_histogram.c src/streaming_moments.c src/queueing_model.c src/metrics_ring.c src/host_usage.c src/lock_profile.c src/timed_queue.c src/linked_list.c src/common/text_buffer.c src/common/timeutils.c external/mongoose.c tests/test_utils.c -lm -lpthread
+
+test_session_manager: tests/test_session_manager.c src/session_manager.c src/stats_export.c src/json_writer.c src/ws_bridge.c $(CHECKPOINT_SRCS) tests/test_utils.c include/session_manager.h include/simulation_context.h include/ws_bridge.h include/test_utils.h include/common/common.h
+	$(CC) $(CFLAGS) -o $@ tests/test_session_manager.c src/session_manager.c src/stats_export.c src/json_writer.c src/ws_bridge.c $(CHECKPOINT_SRCS) tests/test_utils.c -lm -lpthread
+
 clean:
 	rm -rf $(TARGETS) *.o *.d *.dSYM
 
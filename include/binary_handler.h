@@ -0,0 +1,42 @@
+#ifndef BINARY_HANDLER_H
+#define BINARY_HANDLER_H
+
+/**
+ * @file binary_handler.h
+ * @brief log_ops backend for LOG_MODE_BINARY: every event is appended as a
+ *        fixed-width record to a binary log (see binary_log.h), decoded
+ *        offline with bin/evdecode. The parameters and final statistics are
+ *        still printed to stdout.
+ *
+ * Simulation threads push records into a lock-free ring; a writer thread
+ * appends them to the log, so growing the file never stalls a thread that
+ * holds the pipeline's locks.
+ *
+ * In the server, -binlog attaches this sink next to the websocket one and
+ * logs every event, unfiltered by the sessions' log options. Its records
+ * carry no session, so the server requires -sessions 1 with -binlog.
+ */
+
+/**
+ * @brief Opens the log file and starts the writer thread. Call before the run starts.
+ *
+ * @param path The file to write.
+ * @param overflow_policy EVENT_RING_OVERFLOW_BLOCK or EVENT_RING_OVERFLOW_DROP
+ *        when the writer falls behind.
+ * @return TRUE on success, FALSE on failure.
+ */
+int binary_handler_open(const char* path, int overflow_policy);
+
+/**
+ * @brief Drains the ring, stops the writer thread, finalizes the log file and
+ *        reports how many records were written. Call after the simulation
+ *        threads have stopped logging.
+ */
+void binary_handler_close(void);
+
+/**
+ * @brief Registers the binary handler with the log router
+ */
+void binary_handler_register(void);
+
+#endif // BINARY_HANDLER_H
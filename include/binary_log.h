@@ -0,0 +1,93 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log_event.h"
+
+/**
+ * @file binary_log.h
+ * @brief Append-only file of fixed-width log_event_t records, written through
+ *        a growable memory mapping and read back by bin/evdecode.
+ *
+ * Layout: a binary_log_header_t followed by record_count log_event_t records
+ * in host byte order. The writer maps the file, copies each record into the
+ * mapping and doubles the file when it runs out of room; closing it truncates
+ * the file to the records written and stores the count in the header. A file
+ * left by a crashed run still decodes: its count is 0 and the records end at
+ * the first zeroed slot.
+ */
+
+#define BINARY_LOG_MAGIC   0x56455150u // "PQEV"
+#define BINARY_LOG_VERSION 1
+
+typedef struct binary_log_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;   // sizeof(log_event_t) of the writer
+    uint32_t reserved;
+    uint64_t record_count;  // 0 until the writer is closed
+} binary_log_header_t;
+
+typedef struct binary_log_writer {
+    int fd;
+    char* map;              // mapping of the whole file, header included
+    size_t map_size;
+    size_t record_count;
+    size_t record_capacity; // records that fit in the current mapping
+    pthread_mutex_t mutex;  // appends come from every simulation thread
+} binary_log_writer_t;
+
+typedef struct binary_log_reader {
+    const char* map;
+    size_t map_size;
+    const log_event_t* records;
+    size_t record_count;
+} binary_log_reader_t;
+
+/**
+ * @brief Creates (or truncates) a log file and maps it for appending.
+ *
+ * @param writer The writer to initialize.
+ * @param path The file to write.
+ * @return TRUE on success, FALSE on failure.
+ */
+int binary_log_open(binary_log_writer_t* writer, const char* path);
+
+/**
+ * @brief Appends a record, growing the file when the mapping is full.
+ *        Safe to call from any thread.
+ *
+ * @param writer An open writer.
+ * @param event The record to append.
+ * @return TRUE on success, FALSE if the file could not grow.
+ */
+int binary_log_append(binary_log_writer_t* writer, const log_event_t* event);
+
+/**
+ * @brief Stores the record count, trims the file to the records written and
+ *        unmaps it.
+ *
+ * @param writer An open writer.
+ */
+void binary_log_close(binary_log_writer_t* writer);
+
+/**
+ * @brief Maps a log file read-only and validates its header.
+ *
+ * @param reader The reader to initialize.
+ * @param path The file to read.
+ * @return TRUE on success, FALSE if the file is missing or not a compatible log.
+ */
+int binary_log_read(binary_log_reader_t* reader, const char* path);
+
+/**
+ * @brief Unmaps a file opened with binary_log_read.
+ *
+ * @param reader The reader to release.
+ */
+void binary_log_release(binary_log_reader_t* reader);
+
+#endif // BINARY_LOG_H
@@ -0,0 +1,95 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "preprocessing.h"
+#include "simulation_context.h"
+
+/**
+ * @file checkpoint.h
+ * @brief Saves a quiesced simulation to a compact binary file and restores it.
+ *
+ * A checkpoint holds the model parameters, statistics accumulators, random
+ * state, job receiver progress, printer paper state and every job still
+ * queued. Run options (paths, logging, session cap) are not saved.
+ * Absolute timestamps are shifted on restore so the run's clock continues
+ * from the instant the checkpoint was requested: the time spent draining,
+ * saved and paused is left out, and the job that was due next arrives as
+ * far after that instant as it would have without the checkpoint. The
+ * restored statistics are identical to the saved ones.
+ *
+ * Jobs in service when the checkpoint is requested finish before the save,
+ * so their whole service is counted, and a refill in progress is abandoned
+ * and requested again after resuming. A resumed run therefore matches an
+ * uninterrupted one in its counts and arrival timing. Its printers, however,
+ * are free again at the quiesce instant rather than when those jobs would
+ * have finished.
+ *
+ * Layout: a checkpoint_header_t, the simulation_model_parameters_t, the
+ * statistics, a checkpoint_state_t, then queue_length job_t records, all in
+ * host byte order. The statistics are stored as (zero run, literal length,
+ * literal bytes) triples, since their histograms are mostly empty buckets.
+ * The header records the struct sizes so files from an incompatible build are
+ * rejected instead of misread.
+ */
+
+#define CHECKPOINT_MAGIC   0x4B435350u // "PSCK"
+#define CHECKPOINT_VERSION 4
+
+// Shortest stretch of zero bytes in the statistics that ends a literal
+#define CHECKPOINT_MIN_ZERO_RUN 8
+
+// Base of the server's per-session checkpoint files when no -checkpoint path is given
+#define CHECKPOINT_DEFAULT_PATH "simulation.ckpt"
+
+typedef struct checkpoint_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t params_size;
+    uint32_t stats_size;
+    uint32_t job_size;
+    uint32_t queue_length;
+    uint64_t quiesced_at_us; // wall-clock instant the run stopped advancing, used to rebase timestamps
+} checkpoint_header_t;
+
+typedef struct checkpoint_printer_state {
+    int32_t current_paper_count;
+    int32_t total_papers_used;
+    int32_t jobs_printed_count;
+} checkpoint_printer_state_t;
+
+typedef struct checkpoint_state {
+    uint32_t rng_state;
+    int32_t next_job_index;
+    uint64_t previous_job_arrival_time_us;
+    uint64_t queue_last_interaction_time_us;
+    uint64_t next_job_arrival_time_us; // when the job that had not arrived yet was due
+    checkpoint_printer_state_t printers[2];
+} checkpoint_state_t;
+
+/**
+ * @brief Writes a checkpoint of a quiesced context. The file is written as
+ *        path.tmp and renamed over path, so an earlier checkpoint stays
+ *        intact until the new one is complete.
+ *
+ * @param ctx A context whose threads have been joined after simulation_context_request_checkpoint.
+ * @param path The file to write.
+ * @return TRUE on success, FALSE on failure.
+ */
+int checkpoint_save(simulation_context_t* ctx, const char* path);
+
+/**
+ * @brief Initializes a context in place from a checkpoint, ready for
+ *        simulation_context_resume.
+ *
+ * @param ctx Pointer to the context to initialize.
+ * @param path The file to read.
+ * @param run_options Parameters of the current process; everything but the
+ *        model (checkpoint and log paths, session cap, logging options) is
+ *        taken from here.
+ * @return TRUE on success, FALSE on failure (the context is left uninitialized).
+ */
+int checkpoint_load(simulation_context_t* ctx, const char* path, const simulation_parameters_t* run_options);
+
+#endif // CHECKPOINT_H
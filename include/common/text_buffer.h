@@ -0,0 +1,73 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <stddef.h>
+
+/**
+ * @file text_buffer.h
+ * @brief printf-free text building into a caller-owned buffer.
+ *
+ * The buffer tracks its length, so callers never need strlen, and integers
+ * are written with a two-digits-at-a-time table instead of the printf
+ * machinery. Nothing is allocated. Writes that do not fit are dropped and
+ * flag the buffer as truncated; the contents are always NUL-terminated.
+ */
+
+typedef struct text_buffer {
+    char* data;
+    size_t capacity;  // including room for the terminating NUL
+    size_t length;
+    int is_truncated;
+} text_buffer_t;
+
+/**
+ * @brief Points a text buffer at caller-owned storage and empties it.
+ *
+ * @param tb The text buffer.
+ * @param data The storage to write into.
+ * @param capacity The size of the storage in bytes.
+ */
+void text_buffer_init(text_buffer_t* tb, char* data, size_t capacity);
+
+/**
+ * @brief Appends len bytes of a string.
+ */
+void text_append(text_buffer_t* tb, const char* str, size_t len);
+
+// Appends a string literal without measuring it at run time
+#define text_append_literal(tb, literal) text_append((tb), (literal), sizeof(literal) - 1)
+
+/**
+ * @brief Appends a NUL-terminated string.
+ */
+void text_append_str(text_buffer_t* tb, const char* str);
+
+/**
+ * @brief Appends an unsigned integer in decimal ("%lu").
+ */
+void text_append_uint(text_buffer_t* tb, unsigned long value);
+
+/**
+ * @brief Appends a signed integer in decimal ("%ld").
+ */
+void text_append_int(text_buffer_t* tb, long value);
+
+/**
+ * @brief Appends an unsigned integer left-padded with zeros to at least
+ *        width digits ("%0*lu").
+ */
+void text_append_uint_padded(text_buffer_t* tb, unsigned long value, int width);
+
+/**
+ * @brief Appends a microsecond count as milliseconds with three decimals,
+ *        e.g. 40016 -> "40.016" ("%d.%03d" of value / 1000 and value % 1000).
+ */
+void text_append_ms(text_buffer_t* tb, unsigned long value_us);
+
+/**
+ * @brief Appends the relative log timestamp, e.g. "00000240.627ms: "
+ *        (the same text as time_format in timeutils.h).
+ */
+void text_append_time_prefix(text_buffer_t* tb, unsigned long time_us);
+
+#endif // TEXT_BUFFER_H
@@ -1,7 +1,10 @@
 #ifndef CONSOLE_HANDLER_H
 #define CONSOLE_HANDLER_H
 
+struct host_usage;
 struct job;
+struct lock_profile_set;
+struct metrics_sample;
 struct printer;
 struct simulation_parameters;
 struct simulation_statistics;
@@ -16,14 +19,14 @@ void log_simulation_parameters(const struct simulation_parameters* params);
 /**
  * @brief Logs the start of the simulation.
  * 
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_simulation_start(struct simulation_statistics* stats);
 
 /**
  * @brief Logs the end of the simulation.
  * 
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_simulation_end(struct simulation_statistics* stats);
 
@@ -32,7 +35,7 @@ void log_simulation_end(struct simulation_statistics* stats);
  *
  * @param job The job that has been created.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_system_arrival(struct job* job, unsigned long previous_job_arrival_time_us,
     struct simulation_statistics* stats);
@@ -42,7 +45,7 @@ void log_system_arrival(struct job* job, unsigned long previous_job_arrival_time
  *
  * @param job The job that has been dropped.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_dropped_job(struct job* job, unsigned long previous_job_arrival_time_us,
     struct simulation_statistics* stats);
@@ -57,7 +60,7 @@ void log_removed_job(struct job* job);
 /**
  * @brief Logs an event when a job arrives at the queue.
  * @param job The job that has arrived at the queue.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  * @param job_queue The job queue to check the length of.
  * @param last_interaction_time_us The last interaction time of the queue in microseconds.
  */
@@ -67,7 +70,7 @@ void log_queue_arrival(const struct job* job, struct simulation_statistics* stat
  * @brief Logs an event when a job departs from the queue.
  *
  * @param job The job that has departed from the queue.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  * @param job_queue The job queue to check the length of.
  * @param last_interaction_time_us The last interaction time of the queue in microseconds.
  */
@@ -85,7 +88,7 @@ void log_printer_arrival(const struct job* job, const struct printer* printer);
  * @brief Logs an event when a job departs from a printer after processing.
  * @param job The job that has departed from the printer.
  * @param printer The printer that the job has departed from.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_system_departure(const struct job* job, const struct printer* printer,
     struct simulation_statistics* stats);
@@ -118,10 +121,59 @@ void log_paper_refill_end(struct printer* printer, int refill_duration_us, unsig
 
 /**
  * @brief Logs an event when Ctrl+C is pressed to terminate the simulation.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void log_ctrl_c_pressed(struct simulation_statistics* stats);
 
+/**
+ * @brief Logs an event when the simulation pauses to write a checkpoint.
+ * @param stats The simulation statistics.
+ */
+void log_simulation_checkpoint(struct simulation_statistics* stats);
+/**
+ * @brief Logs an event when the simulation resumes from a checkpoint.
+ * @param stats The restored simulation statistics, whose start time becomes the reference time.
+ */
+void log_simulation_resumed(struct simulation_statistics* stats);
+/**
+ * @brief Prints a metrics sample after every event logged before it.
+ * @param sample The sample.
+ * @param number The sample's number in the run's metrics ring.
+ */
+void log_metrics_sample(const struct metrics_sample* sample, unsigned long number);
+/**
+ * @brief Prints the host usage of a run after every event logged before it.
+ * @param usage The run's finished host usage.
+ */
+void log_host_usage_after_events(const struct host_usage* usage);
+/**
+ * @brief Prints the lock profiles of a run after every event logged before them.
+ * @param locks The run's lock profiles.
+ */
+void log_lock_statistics(const struct lock_profile_set* locks);
+
+/**
+ * @brief Starts the writer thread. From then on events are captured into a
+ *        lock-free ring and formatted off the simulation threads.
+ *
+ * @param overflow_policy EVENT_RING_OVERFLOW_BLOCK or EVENT_RING_OVERFLOW_DROP.
+ * @return TRUE on success, FALSE if the ring or write buffer could not be
+ *         allocated or the thread could not be started; events then keep
+ *         being printed synchronously.
+ */
+int console_handler_start_async(int overflow_policy);
+
+/**
+ * @brief Waits until every event submitted so far has been written.
+ */
+void console_handler_flush(void);
+
+/**
+ * @brief Drains the ring and stops the writer thread. Must be called after
+ *        the simulation threads have stopped logging.
+ */
+void console_handler_stop_async(void);
+
 /**
  * @brief Registers the console handler with the log router
  */
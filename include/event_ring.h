@@ -0,0 +1,84 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "log_event.h"
+
+/**
+ * @file event_ring.h
+ * @brief Bounded lock-free ring of fixed-size records, such as log_event_t,
+ *        with many producers and a single consumer.
+ *
+ * Every slot carries a sequence number: a producer claims a position with one
+ * compare-and-swap on the head and publishes the record by advancing the
+ * slot's sequence, so producers never take a lock or wait for each other
+ * while copying. The consumer owns the tail.
+ */
+
+// What a producer does when the ring is full
+#define EVENT_RING_OVERFLOW_BLOCK 0 // wait for the consumer (lossless)
+#define EVENT_RING_OVERFLOW_DROP  1 // discard the new record and count it
+
+// Header of every slot; the record follows it
+typedef struct event_ring_slot {
+    atomic_size_t sequence;
+} event_ring_slot_t;
+
+typedef struct event_ring {
+    unsigned char* slots;
+    size_t record_size;
+    size_t slot_size;          // header and record, rounded up to keep records aligned
+    size_t mask;               // capacity - 1, capacity is a power of two
+    int overflow_policy;
+    atomic_size_t head;        // next position to claim (producers)
+    atomic_ulong dropped;      // records discarded under EVENT_RING_OVERFLOW_DROP
+    char pad[64];              // keep the consumer's tail off the producers' cache line
+    size_t tail;               // next position to read (consumer only)
+} event_ring_t;
+
+/**
+ * @brief Initializes a ring.
+ *
+ * @param ring The ring to initialize.
+ * @param capacity The minimum number of records; rounded up to a power of two.
+ * @param record_size The size of one record, e.g. sizeof(log_event_t).
+ * @param overflow_policy EVENT_RING_OVERFLOW_BLOCK or EVENT_RING_OVERFLOW_DROP.
+ * @return TRUE on success, FALSE if the slots could not be allocated.
+ */
+int event_ring_init(event_ring_t* ring, size_t capacity, size_t record_size, int overflow_policy);
+
+/**
+ * @brief Frees the ring's slots.
+ *
+ * @param ring The ring to destroy.
+ */
+void event_ring_destroy(event_ring_t* ring);
+
+/**
+ * @brief Appends a record. Safe to call from any number of threads.
+ *
+ * @param ring The ring.
+ * @param record The record to copy in, record_size bytes.
+ * @return TRUE if the record was queued, FALSE if it was dropped.
+ */
+int event_ring_push(event_ring_t* ring, const void* record);
+
+/**
+ * @brief Removes the oldest record. Must only be called by the consumer.
+ *
+ * @param ring The ring.
+ * @param record Where to copy the record, record_size bytes.
+ * @return TRUE if a record was read, FALSE if the ring is empty.
+ */
+int event_ring_pop(event_ring_t* ring, void* record);
+
+/**
+ * @brief Returns the number of records dropped because the ring was full.
+ *
+ * @param ring The ring.
+ */
+unsigned long event_ring_dropped(event_ring_t* ring);
+
+#endif // EVENT_RING_H
@@ -0,0 +1,92 @@
+#ifndef HOST_USAGE_H
+#define HOST_USAGE_H
+
+/**
+ * @file host_usage.h
+ * @brief What a run's threads cost the host: CPU time and context switches
+ *        per thread, and the process's peak resident set size.
+ *
+ * The simulated utilization of the statistics is service time over
+ * duration; this is the real overhead, for sizing the host. A pipeline
+ * thread reads its own usage with getrusage(RUSAGE_THREAD) as it exits,
+ * cancelled or not. The server's event loop thread is alive at the end of
+ * a run, so its usage is read from /proc/self/task instead; it serves every
+ * session and counts from the start of the server.
+ *
+ * Voluntary context switches are the thread blocking (a sleep, a lock or
+ * condition wait, a write), so each one is one wakeup. Involuntary ones are
+ * preemptions. Per-thread usage needs Linux; elsewhere only the peak RSS
+ * is reported.
+ *
+ * Every run reports its usage after the statistics; the server sends it as
+ * {"type":"host_usage", "data":{...}}.
+ */
+
+// Pipeline threads in the order of simulation_context_t's thread_starts, then the event loop
+#define HOST_USAGE_PIPELINE_THREADS 5
+#define HOST_USAGE_EVENT_LOOP HOST_USAGE_PIPELINE_THREADS
+#define HOST_USAGE_THREADS (HOST_USAGE_PIPELINE_THREADS + 1)
+
+typedef struct thread_usage {
+    int is_recorded;           // FALSE if the thread did not run or its usage is unavailable
+    double user_time_sec;
+    double system_time_sec;
+    long voluntary_switches;   // the thread blocked, then woke up
+    long involuntary_switches; // the thread was preempted
+} thread_usage_t;
+
+typedef struct host_usage {
+    thread_usage_t threads[HOST_USAGE_THREADS];
+    long peak_rss_kb;          // of the whole process, since it started
+    double jobs;               // jobs that arrived in the run, for the cost per job
+} host_usage_t;
+
+/**
+ * @brief Reads the calling thread's usage.
+ *
+ * @param usage Filled with the usage.
+ */
+void thread_usage_read_self(thread_usage_t* usage);
+
+/**
+ * @brief Marks the calling thread as the process's event loop, whose usage
+ *        host_usage_finish reads.
+ */
+void host_usage_set_event_loop_thread(void);
+
+/**
+ * @brief Completes a run's usage once its pipeline threads have exited:
+ *        reads the event loop thread, if one was set, and the peak RSS.
+ *
+ * @param usage The run's usage, with its pipeline threads recorded.
+ * @param jobs The number of jobs that arrived in the run.
+ */
+void host_usage_finish(host_usage_t* usage, double jobs);
+
+/**
+ * @brief Returns the CPU time of the pipeline threads per arrived job.
+ *
+ * @param usage A finished usage.
+ * @return The user and system time per job in microseconds, or 0 without jobs.
+ */
+double host_usage_cpu_per_job_us(const host_usage_t* usage);
+
+/**
+ * @brief Writes the usage as a JSON object: the peak RSS, the CPU time per
+ *        job and a "threads" array of every recorded thread.
+ *
+ * @param usage A finished usage.
+ * @param buf A character buffer to hold the JSON object.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written, as snprintf.
+ */
+int write_host_usage_to_buffer(const host_usage_t* usage, char* buf, int buf_size);
+
+/**
+ * @brief Prints the usage as a table to stdout.
+ *
+ * @param usage A finished usage.
+ */
+void log_host_usage(const host_usage_t* usage);
+
+#endif // HOST_USAGE_H
@@ -57,12 +57,18 @@ void debug_job(job_t* job);
 typedef struct job_thread_args {
     pthread_mutex_t* job_queue_mutex;
     pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects all_jobs_arrived and g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects all_jobs_arrived, terminate_now and checkpoint_now
     pthread_cond_t* job_queue_not_empty_cv;
     struct timed_queue* job_queue;
     struct simulation_parameters* simulation_params;
     struct simulation_statistics* stats;
     int* all_jobs_arrived;
+    int* terminate_now; // set when the run is stopped prematurely
+    int* checkpoint_now; // set to quiesce the run for a checkpoint; the pending job is not generated
+    unsigned int* rng_state; // per-run random generator state, seeded from the parameters
+    int* next_job_index; // number of jobs generated so far, carried across checkpoints
+    unsigned long* previous_job_arrival_time_us; // arrival time of the last job, 0 before the first
+    unsigned long* next_job_arrival_time_us; // when the pending job is due; a resumed run waits out the rest
 } job_thread_args_t;
 
 // --- Thread function ---
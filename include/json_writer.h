@@ -0,0 +1,87 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file json_writer.h
+ * @brief Streaming JSON writer: values go straight to a stdio stream as they
+ *        are written, so a document has no size limit and needs no buffer
+ *        of its own.
+ *
+ * The writer tracks only whether the open object or array already has a
+ * member, for the commas; keys and nesting are the caller's to balance.
+ * Numbers keep full double precision; NaN and infinities, which JSON
+ * cannot hold, are written as null.
+ */
+
+#define JSON_WRITER_MAX_DEPTH 16
+#define JSON_NUMBER_SIZE 32 // enough for any double in json_format_number
+
+typedef struct json_writer {
+    FILE* file;
+    int depth;                                  // open objects and arrays
+    int has_member[JSON_WRITER_MAX_DEPTH + 1];  // per level; level 0 is the top
+    int is_after_key;                           // the next value completes a member
+} json_writer_t;
+
+/**
+ * @brief Starts writing JSON to a stream.
+ *
+ * @param writer The writer to initialize.
+ * @param file The stream to write to.
+ */
+void json_writer_init(json_writer_t* writer, FILE* file);
+
+/**
+ * @brief Opens an object, as a value or as the top of the document.
+ */
+void json_begin_object(json_writer_t* writer);
+
+/**
+ * @brief Closes the innermost object.
+ */
+void json_end_object(json_writer_t* writer);
+
+/**
+ * @brief Opens an array.
+ */
+void json_begin_array(json_writer_t* writer);
+
+/**
+ * @brief Closes the innermost array.
+ */
+void json_end_array(json_writer_t* writer);
+
+/**
+ * @brief Writes the key of an object member; the next value is its value.
+ */
+void json_key(json_writer_t* writer, const char* key);
+
+/**
+ * @brief Formats a finite number with the fewest of 15 or 17 significant
+ *        digits that read back as the same double.
+ *
+ * @param buf The buffer to write into, at least JSON_NUMBER_SIZE bytes.
+ * @param buf_size The size of the buffer.
+ * @param value The number.
+ */
+void json_format_number(char* buf, size_t buf_size, double value);
+
+/**
+ * @brief Writes a number, or null if it is not finite.
+ */
+void json_number(json_writer_t* writer, double value);
+
+/**
+ * @brief Writes an escaped string.
+ */
+void json_string(json_writer_t* writer, const char* value);
+
+/**
+ * @brief Writes true or false.
+ */
+void json_bool(json_writer_t* writer, int value);
+
+#endif // JSON_WRITER_H
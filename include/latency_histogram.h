@@ -0,0 +1,59 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+/**
+ * @file latency_histogram.h
+ * @brief Log-linear (HDR-style) histogram of durations in microseconds with
+ *        a fixed footprint and O(1) recording, for tail percentiles.
+ *
+ * Values below 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS microseconds are counted
+ * exactly. Above that, every power of two is split into 2^(bits - 1) equal
+ * buckets, so a reported percentile is within 1/64 of the recorded value at
+ * any scale. Values beyond 2^LATENCY_HISTOGRAM_MAX_EXPONENT microseconds
+ * (about 19 hours) share the last bucket; the maximum is always exact.
+ *
+ * The histogram holds no pointers, so it can live inside a struct that is
+ * copied or written to a checkpoint as is. A zeroed histogram is empty.
+ */
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 7
+#define LATENCY_HISTOGRAM_MAX_EXPONENT 36
+#define LATENCY_HISTOGRAM_HALF_SUB_BUCKETS (1 << (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1))
+#define LATENCY_HISTOGRAM_BUCKETS \
+    ((LATENCY_HISTOGRAM_MAX_EXPONENT - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 2) * LATENCY_HISTOGRAM_HALF_SUB_BUCKETS)
+
+typedef struct latency_histogram {
+    unsigned int counts[LATENCY_HISTOGRAM_BUCKETS];
+    unsigned long total_count;
+    unsigned long max_us;
+} latency_histogram_t;
+
+/**
+ * @brief Counts one duration.
+ *
+ * @param histogram The histogram.
+ * @param value_us The duration in microseconds.
+ */
+void latency_histogram_record(latency_histogram_t* histogram, unsigned long value_us);
+
+/**
+ * @brief Returns the value at or below which the given share of the recorded
+ *        durations fall, as the upper end of its bucket capped at the maximum.
+ *
+ * @param histogram The histogram.
+ * @param percentile The percentile, between 0 and 100 (e.g. 99.9).
+ * @return The duration in microseconds, or 0 if nothing was recorded.
+ */
+unsigned long latency_histogram_percentile(const latency_histogram_t* histogram, double percentile);
+
+/**
+ * @brief Returns how many recorded durations fall in buckets that end at or
+ *        below a value, e.g. for the cumulative "le" buckets of Prometheus.
+ *
+ * @param histogram The histogram.
+ * @param value_us The upper bound in microseconds.
+ * @return The count, exact below 128 us and within one bucket above.
+ */
+unsigned long latency_histogram_count_at_or_below(const latency_histogram_t* histogram, unsigned long value_us);
+
+#endif // LATENCY_HISTOGRAM_H
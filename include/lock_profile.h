@@ -0,0 +1,102 @@
+#ifndef LOCK_PROFILE_H
+#define LOCK_PROFILE_H
+
+#include <pthread.h>
+#include <time.h>
+
+#include "latency_histogram.h"
+
+/**
+ * @file lock_profile.h
+ * @brief Optional contention profiling of a run's mutexes and condition
+ *        variables, for finding the lock worth redesigning first.
+ *
+ * The pipeline locks through the profiled_* wrappers below. A thread bound
+ * to a run's profile set (see lock_profile_bind_thread) records every
+ * acquisition of a primitive in the set; any other thread, and every thread
+ * of a run without profiling, goes straight to pthreads after one
+ * thread-local load.
+ *
+ * A mutex acquisition first tries the lock: if that fails it counts as
+ * contended and the time until the lock is taken is recorded. The time the
+ * mutex is then held is recorded when it is released or handed to a
+ * condition wait. A condition variable records how long each wait blocked.
+ * A profile is only written with its mutex held, so recording needs no
+ * further synchronization; read the set once the run's threads have joined.
+ *
+ * Durations are in nanoseconds, from CLOCK_MONOTONIC, recorded into the
+ * microsecond histogram of latency_histogram.h unchanged: holds last far
+ * less than a microsecond, and its relative precision holds at any unit.
+ *
+ * -lock-stats (or "is_profiling_locks" in a "start {json}") profiles a run;
+ * its profiles follow the statistics, as {"type":"locks", "data":[...]} in
+ * the server.
+ */
+
+#define LOCK_PROFILE_MAX 8
+
+typedef struct lock_profile {
+    const char* name;
+    const void* primitive;            // the profiled pthread_mutex_t or pthread_cond_t
+    int is_condition;
+    unsigned long acquire_count;      // acquisitions, or waits of a condition variable
+    unsigned long contended_count;    // acquisitions that found the mutex taken
+    unsigned long total_wait_ns;
+    latency_histogram_t wait_ns;      // contended acquisitions, or every wait of a condition variable
+    latency_histogram_t hold_ns;      // every acquisition of a mutex
+    unsigned long acquired_at_ns;     // when the holder took the mutex
+} lock_profile_t;
+
+typedef struct lock_profile_set {
+    lock_profile_t profiles[LOCK_PROFILE_MAX];
+    int count;
+} lock_profile_set_t;
+
+/**
+ * @brief Adds a primitive to a zeroed set.
+ *
+ * @param set The set.
+ * @param name The name reported for the primitive, e.g. "stats_mutex".
+ * @param primitive The pthread_mutex_t or pthread_cond_t.
+ * @param is_condition TRUE for a condition variable.
+ */
+void lock_profile_set_add(lock_profile_set_t* set, const char* name, const void* primitive, int is_condition);
+
+/**
+ * @brief Binds the calling thread to a profile set, or unbinds it with NULL.
+ *
+ * @param set The set of the run the thread locks for.
+ */
+void lock_profile_bind_thread(lock_profile_set_t* set);
+
+/**
+ * @brief Returns the calling thread's profile set, or NULL if it is unbound.
+ */
+lock_profile_set_t* lock_profile_thread_set(void);
+
+// --- Wrappers of the pthread calls, recording for bound threads ---
+void profiled_mutex_lock(pthread_mutex_t* mutex);
+void profiled_mutex_unlock(pthread_mutex_t* mutex);
+void profiled_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex);
+int profiled_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* deadline);
+
+/**
+ * @brief Writes the profiles as a JSON array, one object per primitive with
+ *        its counts and the p50, p99 and maximum of its wait and hold times
+ *        in microseconds.
+ *
+ * @param set The set.
+ * @param buf A character buffer to hold the JSON array.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written, as snprintf.
+ */
+int write_lock_profiles_to_buffer(const lock_profile_set_t* set, char* buf, int buf_size);
+
+/**
+ * @brief Prints the profiles as a table to stdout.
+ *
+ * @param set The set.
+ */
+void log_lock_profiles(const lock_profile_set_t* set);
+
+#endif // LOCK_PROFILE_H
@@ -0,0 +1,74 @@
+#ifndef LOG_EVENT_H
+#define LOG_EVENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file log_event.h
+ * @brief Fixed-size, pointer-free record of one simulation event.
+ *
+ * Sinks that defer formatting capture an event into a record on the
+ * simulation thread and render it later, so the record holds every value the
+ * text needs. Fields that do not apply to an event are 0.
+ */
+
+typedef enum log_event_type {
+    LOG_EVENT_NONE = 0,
+    LOG_EVENT_SIMULATION_START,
+    LOG_EVENT_SIMULATION_END,
+    LOG_EVENT_SYSTEM_ARRIVAL,
+    LOG_EVENT_DROPPED_JOB,
+    LOG_EVENT_REMOVED_JOB,
+    LOG_EVENT_QUEUE_ARRIVAL,
+    LOG_EVENT_QUEUE_DEPARTURE,
+    LOG_EVENT_PRINTER_ARRIVAL,
+    LOG_EVENT_SYSTEM_DEPARTURE,
+    LOG_EVENT_PAPER_EMPTY,
+    LOG_EVENT_PAPER_REFILL_START,
+    LOG_EVENT_PAPER_REFILL_END,
+    LOG_EVENT_SIMULATION_STOPPED,
+    LOG_EVENT_SIMULATION_CHECKPOINT,
+    LOG_EVENT_SIMULATION_RESUMED,
+    LOG_EVENT_TYPE_COUNT
+} log_event_type_t;
+
+typedef struct log_event {
+    uint16_t type;          // log_event_type_t
+    uint16_t printer_id;
+    int32_t job_id;
+    uint64_t time_us;       // absolute time of the event
+    uint64_t duration_us;   // inter-arrival, queue, service, refill or run duration
+    int32_t papers;         // papers required by the job or needed by the refill
+    int32_t queue_length;   // queue length after the event
+} log_event_t;
+
+/**
+ * @brief Returns the reference time a record establishes, or 0 if it does not
+ *        change it. Start events begin a run; resumed events carry the elapsed
+ *        time of the restored run in duration_us.
+ *
+ * @param event The record.
+ */
+uint64_t log_event_reference_time(const log_event_t* event);
+
+/**
+ * @brief Returns the snake_case name of an event type, e.g. "system_arrival".
+ *
+ * @param type A log_event_type_t value.
+ */
+const char* log_event_type_name(int type);
+
+/**
+ * @brief Formats a record as the console line for the event, including the
+ *        relative timestamp and trailing newline.
+ *
+ * @param event The record to format.
+ * @param reference_time_us The start of the run, in microseconds.
+ * @param buf The buffer to write into.
+ * @param size The size of the buffer.
+ * @return The number of characters written, excluding the terminating NUL.
+ */
+int log_event_format_text(const log_event_t* event, uint64_t reference_time_us, char* buf, size_t size);
+
+#endif // LOG_EVENT_H
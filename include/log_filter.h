@@ -0,0 +1,56 @@
+#ifndef LOG_FILTER_H
+#define LOG_FILTER_H
+
+#include "log_event.h"
+
+/**
+ * @file log_filter.h
+ * @brief Decides which events reach the active log sink.
+ *
+ * Lifecycle events (start, end, stop, checkpoint, resume) and the parameters
+ * and statistics are always delivered. Everything else passes three checks:
+ * the verbosity level, a per-event-type disable mask, and deterministic 1-in-N
+ * sampling by job id, so a sampled job keeps all of its events.
+ */
+
+#define LOG_VERBOSITY_SUMMARY 0 // lifecycle and statistics only
+#define LOG_VERBOSITY_JOBS    1 // + system arrivals, drops, removals and departures
+#define LOG_VERBOSITY_ALL     2 // + queue, printer and paper events
+
+typedef struct log_filter {
+    int verbosity;                // LOG_VERBOSITY_*
+    unsigned int disabled_events; // bit (1u << log_event_type_t) set for each type turned off
+    int sample_every;             // keep per-job events of job ids divisible by N (0 or 1 = all jobs)
+} log_filter_t;
+
+#define LOG_FILTER_ALL {LOG_VERBOSITY_ALL, 0, 1}
+
+/**
+ * @brief Returns whether an event passes the filter.
+ *
+ * @param filter The filter, or NULL to allow everything.
+ * @param event_type A log_event_type_t value.
+ * @param job_id The job the event belongs to, or 0 for printer-only events.
+ * @return TRUE if the event should be delivered, FALSE otherwise.
+ */
+int log_filter_allows(const log_filter_t* filter, int event_type, int job_id);
+
+/**
+ * @brief Parses a verbosity level name: "summary", "jobs" or "all".
+ *
+ * @param name The level name.
+ * @return The LOG_VERBOSITY_* value, or -1 if the name is unknown.
+ */
+int log_verbosity_from_name(const char* name);
+
+/**
+ * @brief Parses a comma-separated list of event type names, e.g.
+ *        "queue_arrival,queue_departure", into a disable mask.
+ *
+ * @param names The list of names (see log_event_type_name).
+ * @param mask Where to store the mask.
+ * @return TRUE on success, FALSE if a name is unknown or not filterable.
+ */
+int log_event_mask_from_names(const char* names, unsigned int* mask);
+
+#endif // LOG_FILTER_H
@@ -3,8 +3,13 @@
 
 #include <stddef.h>
 
+#include "log_filter.h"
+
 // Forward decls to avoid pulling in all headers here
+struct host_usage;
 struct job;
+struct lock_profile_set;
+struct metrics_sample;
 struct printer;
 struct simulation_parameters;
 struct simulation_statistics;
@@ -13,6 +18,9 @@ struct timed_queue;
 // Output modes
 #define LOG_MODE_TERMINAL 0
 #define LOG_MODE_SERVER   1
+#define LOG_MODE_QUIET    2 // statistics only, no sink
+#define LOG_MODE_BINARY   3 // fixed-width records appended to a mapped file
+#define LOG_MODE_TRACE    4 // Chrome trace of every job, attached next to another sink
 
 // Unified logging operations vtable
 typedef struct log_ops {
@@ -42,13 +50,56 @@ typedef struct log_ops {
                              unsigned long current_time_us);
 
     void (*simulation_stopped)(struct simulation_statistics* stats);
+    void (*simulation_checkpoint)(struct simulation_statistics* stats);
+    void (*simulation_resumed)(struct simulation_statistics* stats);
     void (*statistics)(struct simulation_statistics* stats);
+    void (*metrics_sample)(const struct metrics_sample* sample, unsigned long number);
+    void (*host_usage)(const struct host_usage* usage);
+    void (*lock_statistics)(const struct lock_profile_set* locks);
 } log_ops_t;
 
-// Global active logger backend pointer bound via set_log_mode
-extern const log_ops_t* logger;
+/*
+ * Sinks: any number of log_ops backends can be attached at once (e.g. the
+ * websocket stream and a durable binary log of the same run). Every event is
+ * offered to each attached sink; a sink attached with its own filter sees the
+ * events that filter allows, other sinks follow the run's filter. Sinks are
+ * called on the simulation threads, so each one must hand events off without
+ * blocking (the console, binary log and trace event rings, the websocket
+ * batch) to keep a slow sink from stalling the run or the other sinks.
+ */
+#define LOG_ROUTER_MAX_SINKS 8
+
+/**
+ * @brief Attaches a sink. Safe while simulation threads are logging; events
+ *        already being routed may miss a sink attached concurrently.
+ *
+ * @param ops The sink's handlers; NULL entries are skipped.
+ * @param filter The sink's own filter, copied, or NULL to follow the run's filter.
+ * @return TRUE on success, FALSE if the sink is attached already or no slot is free.
+ */
+int log_router_attach_sink(const log_ops_t* ops, const log_filter_t* filter);
+
+/**
+ * @brief Detaches a sink. The sink may still receive events being routed
+ *        while it is detached, so release its resources only once the run
+ *        has stopped logging.
+ *
+ * @param ops The handlers passed to log_router_attach_sink.
+ */
+void log_router_detach_sink(const log_ops_t* ops);
+
+/**
+ * @brief Returns the number of attached sinks.
+ */
+int log_router_sink_count(void);
 
-// Bind mode and select an already-registered handler (console/websocket)
+/**
+ * @brief Returns the handlers registered for a mode (LOG_MODE_TERMINAL,
+ *        _SERVER, _BINARY or _TRACE), or NULL if none was registered.
+ */
+const log_ops_t* log_router_registered_handler(int mode);
+
+// Detach every sink and attach the mode's registered handler (quiet attaches none)
 void set_log_mode(int mode);
 
 /*
@@ -57,8 +108,27 @@ void set_log_mode(int mode);
  */
 void log_router_register_console_handler(const log_ops_t* ops);
 void log_router_register_websocket_handler(const log_ops_t* ops);
+void log_router_register_binary_handler(const log_ops_t* ops);
+void log_router_register_trace_handler(const log_ops_t* ops);
+
+/*
+ * Per-thread log context: an opaque pointer owned by whoever runs the
+ * simulation (e.g. the websocket session a run belongs to). Handlers read it
+ * to route events from concurrent runs; it is NULL unless bound.
+ */
+void log_router_bind_thread_context(void* context);
+void* log_router_thread_context(void);
+
+/*
+ * Event filtering (see log_filter.h): a thread bound to a run's filter uses
+ * it, any other thread uses the process-wide default. Statistics are recorded
+ * by the pipeline itself, so filters only change what the sinks show.
+ */
+void log_router_set_default_filter(const log_filter_t* filter);
+void log_router_bind_thread_filter(const log_filter_t* filter);
+const log_filter_t* log_router_thread_filter(void);
 
-// --- Wrapper API that routes to stdout or websocket ---
+// --- Wrapper API that filters and routes events to the attached sinks ---
 void emit_simulation_parameters(const struct simulation_parameters* params);
 void emit_simulation_start(struct simulation_statistics* stats);
 void emit_simulation_end(struct simulation_statistics* stats);
@@ -80,6 +150,11 @@ void emit_paper_refill_start(struct printer* printer, int papers_needed,
 void emit_paper_refill_end(struct printer* printer, int refill_duration_us,
                            unsigned long current_time_us);
 void emit_simulation_stopped(struct simulation_statistics* stats);
+void emit_simulation_checkpoint(struct simulation_statistics* stats);
+void emit_simulation_resumed(struct simulation_statistics* stats);
 void emit_statistics(struct simulation_statistics* stats);
+void emit_metrics_sample(const struct metrics_sample* sample, unsigned long number);
+void emit_host_usage(const struct host_usage* usage);
+void emit_lock_statistics(const struct lock_profile_set* locks);
 
 #endif // LOG_ROUTER_H
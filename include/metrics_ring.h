@@ -0,0 +1,91 @@
+#ifndef METRICS_RING_H
+#define METRICS_RING_H
+
+#include <pthread.h>
+
+#include "text_buffer.h"
+
+/**
+ * @file metrics_ring.h
+ * @brief Fixed-size ring of periodic snapshots of a running simulation, for
+ *        live charts of queue length, throughput, drops and paper levels.
+ *
+ * A run with a metrics interval (-metrics-ms) has a sampler thread that
+ * pushes one sample per interval and emits it to the log sinks as it is
+ * taken. The ring keeps the last METRICS_RING_CAPACITY samples so a client
+ * that connects late can ask for the history. Samples are numbered from 0 in
+ * the order they were taken; once the ring is full the oldest are overwritten.
+ *
+ * The server pushes each sample as {"type":"metrics", "seq":N, "v":[...]}.
+ * Its "metrics" command replies with the ring's history and "metrics <seq>"
+ * with the samples from seq on, so a client that missed frames can catch up.
+ */
+
+#define METRICS_RING_CAPACITY 1024
+
+/**
+ * @brief One snapshot. Gauges are read at time_us; counters cover the
+ *        interval_us that ended at time_us.
+ */
+typedef struct metrics_sample {
+    unsigned long time_us;      // since the start of the run
+    unsigned long interval_us;  // time since the previous sample
+    int queue_length;
+    int jobs_in_service[2];     // per printer, 0 or 1
+    int paper_level[2];         // per printer
+    unsigned int jobs_arrived;  // during the interval
+    unsigned int jobs_served;
+    unsigned int jobs_dropped;
+} metrics_sample_t;
+
+// Names of the values metrics_sample_append_values writes, in order, as a JSON array
+#define METRICS_SAMPLE_FIELDS_JSON \
+    "[\"t_us\",\"interval_us\",\"qlen\",\"busy_p1\",\"busy_p2\",\"paper_p1\",\"paper_p2\"," \
+    "\"arrived\",\"served\",\"dropped\"]"
+
+typedef struct metrics_ring {
+    metrics_sample_t samples[METRICS_RING_CAPACITY];
+    unsigned long count;        // samples pushed; sample n is at samples[n % METRICS_RING_CAPACITY]
+    pthread_mutex_t mutex;      // protects samples and count
+} metrics_ring_t;
+
+/**
+ * @brief Initializes an empty ring.
+ */
+void metrics_ring_init(metrics_ring_t* ring);
+
+/**
+ * @brief Destroys the ring's mutex.
+ */
+void metrics_ring_destroy(metrics_ring_t* ring);
+
+/**
+ * @brief Appends a sample, overwriting the oldest once the ring is full.
+ *
+ * @param ring The ring.
+ * @param sample The sample to copy in.
+ * @return The number of the sample.
+ */
+unsigned long metrics_ring_push(metrics_ring_t* ring, const metrics_sample_t* sample);
+
+/**
+ * @brief Copies the samples numbered from since onwards, oldest first. Samples
+ *        already overwritten are skipped.
+ *
+ * @param ring The ring.
+ * @param since The number of the first sample wanted.
+ * @param samples The array to fill.
+ * @param max_samples The size of the array.
+ * @param first Set to the number of the first sample copied.
+ * @return The number of samples copied.
+ */
+int metrics_ring_read(metrics_ring_t* ring, unsigned long since, metrics_sample_t* samples, int max_samples,
+    unsigned long* first);
+
+/**
+ * @brief Appends a sample as a compact JSON array of the METRICS_SAMPLE_FIELDS_JSON values,
+ *        e.g. [2500123,250004,3,1,1,55,80,2,1,0].
+ */
+void metrics_sample_append_values(text_buffer_t* tb, const metrics_sample_t* sample);
+
+#endif // METRICS_RING_H
@@ -22,13 +22,15 @@ void debug_refiller(int papers_supplied);
 typedef struct paper_refill_thread_args {
     pthread_mutex_t* paper_refill_queue_mutex;
     pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects terminate_now and checkpoint_now
     pthread_cond_t* refill_needed_cv;
     pthread_cond_t* refill_supplier_cv;
     struct linked_list* paper_refill_queue;
     struct simulation_parameters* params;
     struct simulation_statistics* stats;
     int* all_jobs_served;
+    int* terminate_now; // set when the run is stopped prematurely
+    int* checkpoint_now; // set to quiesce the run for a checkpoint
 } paper_refill_thread_args_t;
 
 // --- Thread function ---
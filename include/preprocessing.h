@@ -7,7 +7,15 @@
  *        and shared variables for command line argument processing and thread management.
  */
 
-typedef struct simulation_parameters {
+#include <stddef.h>
+
+#include "common.h"
+
+/**
+ * The model: everything that decides what a run computes. A checkpoint saves
+ * and restores exactly this part.
+ */
+typedef struct simulation_model_parameters {
     double job_arrival_time_us;
     int papers_required_lower_bound;
     int papers_required_upper_bound;
@@ -16,6 +24,36 @@ typedef struct simulation_parameters {
     int printer_paper_capacity;
     double refill_rate;
     int num_jobs;
+    unsigned int seed;        // seed for the per-run random number generator
+    int warmup_method;        // WARMUP_NONE, _JOBS, _TIME or _MSER5: where averages start
+    double warmup_amount;     // jobs or seconds of a fixed warm-up
+} simulation_model_parameters_t;
+
+typedef struct simulation_parameters {
+    simulation_model_parameters_t model;
+
+    // --- Run options: how this process runs and reports, never checkpointed ---
+    int replications;         // number of independent replications to run in parallel (0 = single run)
+    double precision;         // target relative 95% CI half-width for replications (0 = fixed count)
+    int max_sessions;         // maximum number of concurrent websocket sessions (server only)
+    int log_overflow_policy;  // EVENT_RING_OVERFLOW_BLOCK or _DROP when console, binary or trace logging falls behind
+    int log_verbosity;        // LOG_VERBOSITY_SUMMARY, _JOBS or _ALL
+    unsigned int log_disabled_events; // event types turned off, one bit per log_event_type_t
+    int log_sample_every;     // log the per-job events of 1 job in N (1 = every job)
+    int ws_flush_interval_ms; // how long websocket events are batched before sending (0 = one frame per event)
+    int ws_batch_bytes;       // pending websocket bytes that trigger an early flush
+    int ws_budget_bytes;      // bytes a websocket connection may have queued before ws_overflow_policy applies
+    int ws_overflow_policy;   // WS_OVERFLOW_DROP_OLDEST, _SUMMARY or _PAUSE
+    int ws_lag_cap_bytes;     // bytes a watcher connection may fall behind before it is disconnected
+    int ws_text_events;       // JSON events as legacy {"type":"log","message":...} sentences instead of typed fields
+    int is_quiet;             // no event output, only the final statistics (CLI benchmarks)
+    int metrics_interval_ms;  // how often a running simulation is sampled for live metrics (0 = never)
+    int is_profiling_locks;   // record contention of the pipeline's mutexes and condition variables
+    char checkpoint_path[MAXPATHLENGTH]; // where a checkpoint is written ("" = Ctrl+C stops the run)
+    char resume_path[MAXPATHLENGTH];     // checkpoint to resume from ("" = fresh run)
+    char binary_log_path[MAXPATHLENGTH]; // binary event log to write instead of console lines ("" = console)
+    char trace_path[MAXPATHLENGTH];      // Chrome trace of every job, written next to the other output ("" = none)
+    char stats_out_path[MAXPATHLENGTH];  // .csv or .json file that each finished run appends a row to ("" = none)
 } simulation_parameters_t;
 
 /**
@@ -27,8 +65,20 @@ typedef struct simulation_parameters {
  * printer_paper_capacity: 100 pages
  * refill_rate: 15 papers/sec
  * num_jobs: 20 jobs
+ * seed: 1
+ * warmup_method: 0 (averages cover the whole run), warmup_amount: 0
+ * replications: 0 (single run)
+ * precision: 0 (no precision target)
+ * max_sessions: 4 concurrent websocket sessions
+ * log_overflow_policy: 0 (block, lossless)
+ * log_verbosity: 2 (all events), log_disabled_events: none, log_sample_every: 1 (every job)
+ * ws_flush_interval_ms: 20 ms, ws_batch_bytes: 16 KB
+ * ws_budget_bytes: 1 MB, ws_overflow_policy: 0 (drop oldest per-job events)
+ * ws_lag_cap_bytes: 4 MB, ws_text_events: 0 (typed JSON events)
+ * is_quiet: 0 (log events), metrics_interval_ms: 0 (no sampling), is_profiling_locks: 0
+ * checkpoint_path, resume_path, binary_log_path, trace_path, stats_out_path: empty
  */
-#define SIMULATION_DEFAULT_PARAMS {600000, 5, 20, 15, 4, 100, 15, 20}
+#define SIMULATION_DEFAULT_PARAMS {{600000, 5, 20, 15, 4, 100, 15, 20, 1, 0, 0}, 0, 0, 4, 0, 2, 0, 1, 20, 16384, 1048576, 0, 4194304, 0, 0, 0, 0}
 
 /**
  * @brief Print usage information for the program.
@@ -43,6 +93,16 @@ void usage();
  */
 int random_between(int lower, int upper);
 
+/**
+ * @brief Generate a random integer between lower and upper (inclusive) from
+ *        a caller-owned generator state, so concurrent runs stay reproducible.
+ * @param state Pointer to the generator state, advanced on every call.
+ * @param lower The lower bound inclusive.
+ * @param upper The upper bound inclusive.
+ * @return A random integer between lower and upper.
+ */
+int random_between_r(unsigned int* state, int lower, int upper);
+
 /**
  * @brief Swap the values of lower and upper bounds if lower is greater than upper.
  * @param lower Pointer to the lower bound.
@@ -74,4 +134,18 @@ int is_positive_integer(const char* str, int value);
  */
 int process_args(int argc, char *argv[], simulation_parameters_t* params);
 
+/**
+ * @brief Reads the parameters of a websocket "start {json}" command: any
+ *        subset of the model fields, "warmup", "metrics_interval_ms" and
+ *        "is_profiling_locks", each validated as its command line option.
+ * @param json The JSON object, not necessarily NUL-terminated.
+ * @param json_len The length of json.
+ * @param params The parameters to update; left unchanged if any field is invalid.
+ * @param bad_field Set to the first unknown or invalid field ("" if the object is malformed).
+ * @param bad_field_size The size of bad_field.
+ * @return TRUE on success, FALSE if the object is malformed or a field is unknown or invalid.
+ */
+int parse_start_params(const char* json, size_t json_len, simulation_parameters_t* params, char* bad_field,
+    size_t bad_field_size);
+
 #endif // PREPROCESSING_H
\ No newline at end of file
@@ -15,6 +15,7 @@ typedef struct printer {
     int total_papers_used; // Total number of papers used by this printer
     int capacity; // Maximum paper capacity of the printer
     int jobs_printed_count; // Total number of jobs printed by this printer
+    int is_printing; // A job is in service; set under the job queue mutex, cleared under the stats mutex
 } printer_t;
 
 // --- Utility functions ---
@@ -32,7 +33,7 @@ typedef struct printer_thread_args {
     pthread_mutex_t* paper_refill_queue_mutex;
     pthread_mutex_t* job_queue_mutex;
     pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects terminate_now and checkpoint_now
     pthread_cond_t* job_queue_not_empty_cv;
     pthread_cond_t* refill_needed_cv;
     pthread_cond_t* refill_supplier_cv;
@@ -43,6 +44,8 @@ typedef struct printer_thread_args {
     struct simulation_statistics* stats;
     int* all_jobs_served;
     int* all_jobs_arrived;
+    int* terminate_now; // set when the run is stopped prematurely
+    int* checkpoint_now; // set to quiesce the run for a checkpoint; the job in service completes
     printer_t* printer;
 } printer_thread_args_t;
 
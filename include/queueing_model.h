@@ -0,0 +1,79 @@
+#ifndef QUEUEING_MODEL_H
+#define QUEUEING_MODEL_H
+
+/**
+ * @file queueing_model.h
+ * @brief Closed-form and approximate queueing-theory predictions for the
+ *        configured parameters, used as a reference point for the measured
+ *        statistics.
+ *
+ * The printers are modelled as c identical servers at the configured arrival
+ * rate. Service times come from the uniformly distributed page count divided
+ * by the printing rate. Paper refills are not modelled, so the gap between
+ * prediction and measurement shows pipeline overheads such as paper stalls,
+ * lock waits and wake-up jitter.
+ *
+ * The job receiver spaces arrivals exactly job_arrival_time_us apart, so the
+ * simulated arrival stream is deterministic, not the Poisson stream of the
+ * M/M/c, M/D/c and M/M/c/K formulas. Those are kept as the textbook
+ * baselines and overstate waiting and drops at a given load; the D/G/c
+ * prediction (Allen-Cunneen with ca^2 = 0) is the reference that matches the
+ * simulated arrivals.
+ */
+
+struct simulation_parameters;
+
+// Number of printers (servers) in the pipeline
+#define QUEUEING_MODEL_SERVERS 2
+
+typedef struct queueing_model {
+    int is_valid;                   // TRUE once predictions have been computed
+    int is_stable;                  // TRUE if utilization < 1 (infinite-queue models are finite)
+    int servers;                    // c
+    int system_capacity;            // K = c + queue capacity
+    double arrival_rate_per_sec;    // lambda
+    double mean_service_time_sec;   // E[S]
+    double service_scv;             // cs^2 = Var[S] / E[S]^2
+    double utilization;             // rho = lambda * E[S] / c
+
+    // --- Infinite-capacity models (only meaningful when stable) ---
+    double wait_probability_mmc;    // Erlang C probability that an arrival must wait
+    double avg_queue_wait_mmc_sec;  // M/M/c Wq
+    double avg_queue_wait_mdc_sec;  // M/D/c Wq (Cosmetatos approximation)
+    double avg_queue_wait_dgc_sec;  // D/G/c Wq (Allen-Cunneen, deterministic arrivals)
+    double avg_queue_length_mmc;    // M/M/c Lq
+    double avg_system_time_mmc_sec; // M/M/c W = Wq + E[S]
+
+    // --- Finite-capacity model ---
+    double drop_probability_mmck;   // M/M/c/K blocking probability
+    double carried_utilization;     // rho * (1 - P_K): the load the finite system actually serves
+} queueing_model_t;
+
+/**
+ * @brief Computes the Erlang C probability that an arrival has to wait.
+ *
+ * @param servers The number of servers c.
+ * @param offered_load The offered load a = lambda / mu in Erlangs (must be < c).
+ * @return The probability of waiting, or 1 if the system is unstable.
+ */
+double erlang_c(int servers, double offered_load);
+
+/**
+ * @brief Computes the probability that an arrival finds an M/M/c/K system full.
+ *
+ * @param servers The number of servers c.
+ * @param capacity The total system capacity K (in service plus waiting), K >= c.
+ * @param offered_load The offered load a = lambda / mu in Erlangs.
+ * @return The blocking probability.
+ */
+double mmck_blocking_probability(int servers, int capacity, double offered_load);
+
+/**
+ * @brief Computes every model prediction for the given simulation parameters.
+ *
+ * @param params The simulation parameters.
+ * @param model The struct to fill with predictions.
+ */
+void queueing_model_predict(const struct simulation_parameters* params, queueing_model_t* model);
+
+#endif // QUEUEING_MODEL_H
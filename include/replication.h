@@ -0,0 +1,31 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+/**
+ * @file replication.h
+ * @brief Monte Carlo replication runner: runs independent seeds of the same
+ *        parameters in parallel and reports every derived statistic as a mean
+ *        with a 95% confidence interval.
+ */
+
+struct simulation_parameters;
+
+/**
+ * Upper bound on the total number of replications when a precision target
+ * keeps adding batches.
+ */
+#define MAX_REPLICATIONS 200
+
+/**
+ * @brief Runs batches of `params->replications` simulations (at most one per
+ *        online CPU at a time) with seeds `params->model.seed`,
+ *        `params->model.seed + 1`, ... until the relative 95% CI half-width of
+ *        the mean system time is within `params->precision` (or after a single
+ *        batch if no precision target is set), then prints the aggregated
+ *        statistics to stdout. A zero mean never meets the precision target.
+ *
+ * @param params The simulation parameters shared by every replication.
+ */
+void replication_run(const struct simulation_parameters* params);
+
+#endif // REPLICATION_H
@@ -0,0 +1,142 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include <pthread.h>
+
+#include "preprocessing.h"
+#include "simulation_context.h"
+#include "ws_bridge.h"
+
+/**
+ * @file session_manager.h
+ * @brief Tracks one simulation session per websocket connection. Each session
+ *        owns an isolated simulation context (threads, queues, statistics and
+ *        reference time), so concurrent clients never share state.
+ *
+ * Sessions are opened, looked up, closed and reaped from the Mongoose event
+ * loop thread only; the runner thread of a session only touches its own state.
+ */
+
+typedef struct session {
+    unsigned long conn_id;
+    ws_stream_t stream;
+    simulation_parameters_t params; // parameters of the session's next run
+    simulation_context_t ctx;
+    char checkpoint_path[MAXPATHLENGTH + 24]; // the session's own checkpoint file: base path and session id
+
+    pthread_t runner_thread;
+    int runner_started;          // whether runner_thread needs joining
+    int is_running;              // protected by state_mutex
+    int is_closed;               // the connection is gone; reap once the runner finishes
+    pthread_mutex_t state_mutex;
+} session_t;
+
+/**
+ * @brief Initializes the session table.
+ *
+ * @param params The parameters every session starts from; max_sessions sets the cap.
+ * @return TRUE on success, FALSE if the table could not be allocated.
+ */
+int session_manager_init(const simulation_parameters_t* params);
+
+/**
+ * @brief Stops every session, waits for the runners and frees the table.
+ */
+void session_manager_destroy(void);
+
+/**
+ * @brief Opens a session for a new websocket connection. Its parameters start
+ *        as the ones passed to session_manager_init.
+ *
+ * @param conn_id The Mongoose connection id.
+ * @param protocol The ws_protocol_t the client asked for.
+ * @return The new session, or NULL if the session cap is reached.
+ */
+session_t* session_manager_open(unsigned long conn_id, int protocol);
+
+/**
+ * @brief Finds the open session of a connection.
+ *
+ * @param conn_id The Mongoose connection id.
+ * @return The session, or NULL if the connection has none.
+ */
+session_t* session_manager_find(unsigned long conn_id);
+
+/**
+ * @brief Closes the session of a connection: detaches its stream and stops
+ *        its simulation. The session is freed by session_manager_reap.
+ *
+ * @param conn_id The Mongoose connection id.
+ */
+void session_manager_close(unsigned long conn_id);
+
+/**
+ * @brief Frees closed sessions whose simulation has finished.
+ */
+void session_manager_reap(void);
+
+/**
+ * @brief Returns the number of sessions held, including closed ones not yet reaped.
+ */
+int session_manager_count(void);
+
+/**
+ * @brief Copies the published statistics snapshot of every open session that
+ *        has a run, without taking any of the runs' locks.
+ *
+ * @param snapshots The array to fill.
+ * @param session_ids Filled with the connection id of each snapshot's session.
+ * @param max_snapshots The size of the arrays.
+ * @return The number of snapshots copied.
+ */
+int session_manager_read_snapshots(stats_snapshot_data_t* snapshots, unsigned long* session_ids, int max_snapshots);
+
+/**
+ * @brief Starts a fresh simulation run in the session if none is running.
+ *
+ * @param session The session to start.
+ * @return TRUE if a run was started, FALSE if one was already running.
+ */
+int session_start(session_t* session);
+
+/**
+ * @brief Stops the session's simulation if it is running.
+ *
+ * @param session The session to stop.
+ */
+void session_stop(session_t* session);
+
+/**
+ * @brief Quiesces the session's simulation for a checkpoint. The runner writes
+ *        the checkpoint once the pipeline has drained and notifies the client.
+ *
+ * @param session The session to checkpoint.
+ * @return TRUE if a checkpoint was requested, FALSE if nothing is running.
+ */
+int session_checkpoint(session_t* session);
+
+/**
+ * @brief Resumes the session from its checkpoint file.
+ *
+ * @param session The session to resume.
+ * @return TRUE if the run resumed, FALSE if one is running or the file could not be restored.
+ */
+int session_resume(session_t* session);
+
+/**
+ * @brief Returns the checkpoint file the session writes to and resumes from:
+ *        the -checkpoint path (or CHECKPOINT_DEFAULT_PATH) followed by the
+ *        session id, so sessions never overwrite or resume each other's runs.
+ *
+ * @param session The session.
+ */
+const char* session_checkpoint_path(const session_t* session);
+
+/**
+ * @brief Returns whether the session's simulation is running.
+ *
+ * @param session The session to check.
+ */
+int session_is_running(session_t* session);
+
+#endif // SESSION_MANAGER_H
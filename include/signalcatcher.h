@@ -34,6 +34,7 @@ typedef struct signal_catching_thread_args {
     pthread_t* job_receiver_thread; // Pointer to job receiver thread to cancel
     pthread_t* paper_refill_thread; // Pointer to paper refill thread to cancel
     int* all_jobs_arrived; // Flag indicating if all jobs have arrived
+    int* terminate_now; // Flag telling the pipeline threads to stop
 } signal_catching_thread_args_t;
 
 // --- Thread function ---
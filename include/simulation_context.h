@@ -0,0 +1,173 @@
+#ifndef SIMULATION_CONTEXT_H
+#define SIMULATION_CONTEXT_H
+
+#include <pthread.h>
+
+#include "preprocessing.h"
+#include "simulation_stats.h"
+#include "linked_list.h"
+#include "timed_queue.h"
+#include "job_receiver.h"
+#include "printer.h"
+#include "paper_refiller.h"
+#include "host_usage.h"
+#include "lock_profile.h"
+#include "log_filter.h"
+#include "metrics_ring.h"
+#include "stats_snapshot.h"
+
+/**
+ * @file simulation_context.h
+ * @brief Owns everything a single simulation run needs: threads, synchronization
+ *        primitives, queues, printers, statistics and the per-run random state.
+ *
+ * @note The context embeds linked lists with sentinel nodes, so it must be
+ *       initialized in place and never copied by value.
+ */
+
+/**
+ * @brief Start routine of a pipeline thread, bound to the run's log context
+ *        and filter before the thread function runs.
+ */
+typedef struct simulation_thread_start {
+    void* (*func)(void*);
+    void* arg;
+    void* log_context;
+    const log_filter_t* log_filter;
+    lock_profile_set_t* locks; // NULL unless the run profiles its locks
+    thread_usage_t* usage;     // written as the thread exits
+} simulation_thread_start_t;
+
+typedef struct simulation_context {
+    // Threads
+    pthread_t printer1_thread;
+    pthread_t printer2_thread;
+    pthread_t job_receiver_thread;
+    pthread_t paper_refill_thread;
+
+    // Sync primitives
+    pthread_mutex_t job_queue_mutex;
+    pthread_mutex_t paper_refill_queue_mutex;
+    pthread_mutex_t stats_mutex;
+    pthread_mutex_t simulation_state_mutex;
+    pthread_cond_t job_queue_not_empty_cv;
+    pthread_cond_t refill_needed_cv;
+    pthread_cond_t refill_supplier_cv;
+
+    // State
+    simulation_parameters_t params;
+    simulation_statistics_t stats;
+    int all_jobs_arrived;
+    int all_jobs_served;
+    int terminate_now; // per-run stop flag, protected by simulation_state_mutex
+    int checkpoint_now; // per-run quiesce flag, protected by simulation_state_mutex
+    unsigned int rng_state;
+    int next_job_index; // jobs generated so far
+    unsigned long previous_job_arrival_time_us;
+    unsigned long next_job_arrival_time_us; // when the pending job is due, 0 if none; kept across checkpoints
+    unsigned long checkpoint_time_us; // when the run was quiesced; a resumed run continues from this instant
+    timed_queue_t job_queue;
+    linked_list_t paper_refill_queue;
+    printer_t printer1;
+    printer_t printer2;
+
+    // Args
+    job_thread_args_t job_receiver_args;
+    printer_thread_args_t printer1_args;
+    printer_thread_args_t printer2_args;
+    paper_refill_thread_args_t paper_refill_args;
+    simulation_thread_start_t thread_starts[HOST_USAGE_PIPELINE_THREADS];
+
+    // Routing
+    void* log_context; // bound on every thread that logs for this run (see log_router.h)
+    log_filter_t log_filter; // events this run delivers to the sink, from the parameters
+
+    // Metrics sampling, when params.metrics_interval_ms > 0 or is_publishing_snapshot is set
+    metrics_ring_t metrics;
+    pthread_t metrics_sampler_thread;
+    pthread_cond_t metrics_sampler_cv; // wakes the sampler for its last sample once the pipeline has joined
+    int is_sampling_done;              // protected by simulation_state_mutex
+    int is_publishing_snapshot;        // set before the run starts to publish snapshot at every sample
+    stats_snapshot_t snapshot;         // read lock-free by the server's /metrics endpoint
+
+    // Lock contention of the pipeline threads, when params.is_profiling_locks is set (see lock_profile.h)
+    lock_profile_set_t locks;
+
+    // What the threads cost the host, complete once the run is finished
+    host_usage_t usage;
+} simulation_context_t;
+
+/**
+ * @brief Initializes a context in place for a fresh run with the given parameters.
+ *
+ * @param ctx Pointer to the context to initialize.
+ * @param params The simulation parameters to copy into the context.
+ */
+void simulation_context_init(simulation_context_t* ctx, const simulation_parameters_t* params);
+
+/**
+ * @brief Frees any jobs left in the queue and destroys the synchronization
+ *        primitives owned by the context.
+ *
+ * @param ctx Pointer to the context to destroy.
+ */
+void simulation_context_destroy(simulation_context_t* ctx);
+
+/**
+ * @brief Logs the start of the simulation and creates the pipeline threads.
+ *
+ * @param ctx Pointer to an initialized context.
+ */
+void simulation_context_start(simulation_context_t* ctx);
+
+/**
+ * @brief Logs the resumption of a restored context and creates the pipeline
+ *        threads. Unlike simulation_context_start, the statistics keep their
+ *        restored start time.
+ *
+ * @param ctx Pointer to a context restored from a checkpoint.
+ */
+void simulation_context_resume(simulation_context_t* ctx);
+
+/**
+ * @brief Waits for all pipeline threads to finish, then takes the metrics
+ *        sampler's last sample and stops it.
+ *
+ * @param ctx Pointer to a started context.
+ */
+void simulation_context_join(simulation_context_t* ctx);
+
+/**
+ * @brief Logs the end of the simulation and the final statistics, followed
+ *        by the host usage and the lock profiles if the run profiles its locks.
+ *
+ * @param ctx Pointer to a joined context.
+ */
+void simulation_context_finish(simulation_context_t* ctx);
+
+/**
+ * @brief Runs a simulation to completion: start, join and finish.
+ *
+ * @param ctx Pointer to an initialized context.
+ */
+void simulation_context_run(simulation_context_t* ctx);
+
+/**
+ * @brief Stops a running simulation gracefully, mirroring the signal catcher:
+ *        cancels the producers, empties the job queue and wakes every waiter.
+ *
+ * @param ctx Pointer to a started context.
+ */
+void simulation_context_request_stop(simulation_context_t* ctx);
+
+/**
+ * @brief Quiesces a running simulation for a checkpoint: no new jobs are
+ *        generated or taken from the queue, jobs in service complete and the
+ *        refiller stops. The queue is kept intact. Once the threads have been
+ *        joined the context can be saved with checkpoint_save.
+ *
+ * @param ctx Pointer to a started context.
+ */
+void simulation_context_request_checkpoint(simulation_context_t* ctx);
+
+#endif // SIMULATION_CONTEXT_H
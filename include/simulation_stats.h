@@ -1,6 +1,13 @@
 #ifndef SIMULATION_STATS_H
 #define SIMULATION_STATS_H
 
+#include "latency_histogram.h"
+#include "streaming_moments.h"
+#include "queueing_model.h"
+#include "steady_state.h"
+
+struct job;
+
 typedef struct simulation_statistics {
     // --- General Simulation Metrics ---
     unsigned long simulation_start_time_us;     // Start time of the simulation
@@ -15,7 +22,6 @@ typedef struct simulation_statistics {
 
     // --- System & Queue Performance Metrics ---
     unsigned long total_system_time_us;         // Sum of time each SERVED job spent in the system (wait + service)
-    double sum_of_system_time_squared_us2;      // Sum of (system_time)^2 for calculating standard deviation
     unsigned long total_queue_wait_time_us;     // Sum of time each SERVED job spent waiting in the queue
     unsigned long area_num_in_job_queue_us;     // Integral of queue length over time, for avg queue length
     unsigned int max_job_queue_length;          // Peak number of jobs ever in the queue
@@ -37,8 +43,170 @@ typedef struct simulation_statistics {
     unsigned long total_refill_service_time_us; // Total time spent actively refilling paper
     int papers_refilled;                        // Total number of papers refilled during the simulation
 
+    // --- Latency Distributions (for percentiles) ---
+    latency_histogram_t system_time_histogram;     // Time each SERVED job spent in the system
+    latency_histogram_t queue_wait_histogram;      // Time each SERVED job waited in the queue
+    latency_histogram_t service_time_p1_histogram; // Service time of each job on printer 1
+    latency_histogram_t service_time_p2_histogram; // Service time of each job on printer 2
+    latency_histogram_t paper_empty_histogram;     // Each stall of either printer waiting for paper
+
+    // --- Timing Moments (for standard deviation and skewness, in microseconds) ---
+    streaming_moments_t system_time_moments;       // Time each SERVED job spent in the system
+    streaming_moments_t queue_wait_moments;        // Time each SERVED job waited in the queue
+    streaming_moments_t service_time_p1_moments;   // Service time of each job on printer 1
+    streaming_moments_t service_time_p2_moments;   // Service time of each job on printer 2
+    streaming_moments_t refill_time_moments;       // Duration of each paper refill
+
+    // --- Analytical Baseline ---
+    queueing_model_t model;                     // Queueing-theory predictions for the run's parameters
+
+    // --- Warm-up Truncation ---
+    steady_state_t steady_state;                // Where the startup transient ends
+
 } simulation_statistics_t;
 
+/**
+ * @brief Statistics derived from the raw accumulators at the end of a run.
+ *        With a warm-up cut, the averages, rates, probabilities and
+ *        utilizations cover the run from the cut on; the counts, the
+ *        duration, the percentiles and the moments cover the whole run.
+ */
+typedef struct simulation_derived_statistics {
+    double simulation_duration_sec;
+    int is_truncated;                           // FALSE if the averages cover the whole run
+    double warmup_cut_sec;                      // 0 without a cut
+    double warmup_cut_jobs_served;
+    double job_arrival_rate_per_sec;
+    double job_drop_probability;
+    double avg_inter_arrival_time_sec;
+    double avg_system_time_sec;
+    double system_time_std_dev_sec;
+    double avg_queue_wait_time_sec;
+    double avg_queue_length;
+    double avg_service_time_p1_sec;
+    double avg_service_time_p2_sec;
+    double utilization_p1;
+    double utilization_p2;
+} simulation_derived_statistics_t;
+
+// --- Accounting ---
+/*
+ * The pipeline threads call these directly, with the stats mutex held, at the
+ * point where the event happens. Log sinks only present events, so every
+ * sink, every verbosity level and a run without any sink report the same
+ * numbers.
+ */
+/**
+ * @brief Records the start of the simulation.
+ *
+ * @param stats A simulation statistics struct.
+ * @param start_time_us The simulation start time in microseconds.
+ */
+void stats_record_simulation_start(simulation_statistics_t* stats, unsigned long start_time_us);
+
+/**
+ * @brief Records the end (or premature stop) of the simulation.
+ *
+ * @param stats A simulation statistics struct.
+ * @param end_time_us The simulation end time in microseconds.
+ */
+void stats_record_simulation_end(simulation_statistics_t* stats, unsigned long end_time_us);
+
+/**
+ * @brief Records a job arriving to the system, whether or not it is later dropped.
+ *        Call once per job; a drop is recorded separately.
+ *
+ * @param stats A simulation statistics struct.
+ * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds.
+ * @param job_arrival_time_us The arrival time of this job in microseconds.
+ */
+void stats_record_job_arrival(simulation_statistics_t* stats,
+    unsigned long previous_job_arrival_time_us, unsigned long job_arrival_time_us);
+
+/**
+ * @brief Records a job dropped because the queue was full.
+ *
+ * @param stats A simulation statistics struct.
+ */
+void stats_record_job_dropped(simulation_statistics_t* stats);
+
+/**
+ * @brief Integrates the queue length over the interval that ends with a queue change.
+ *
+ * @param stats A simulation statistics struct.
+ * @param time_us The time of the queue change in microseconds.
+ * @param last_interaction_time_us The time of the previous queue change in microseconds.
+ * @param previous_length The queue length before this change.
+ */
+void stats_record_queue_length_change(simulation_statistics_t* stats, unsigned long time_us,
+    unsigned long last_interaction_time_us, int previous_length);
+
+/**
+ * @brief Records a job entering the queue: integrates the queue length up to
+ *        the arrival and tracks the longest queue seen.
+ *
+ * @param stats A simulation statistics struct.
+ * @param time_us The time the job entered the queue in microseconds.
+ * @param last_interaction_time_us The time of the previous queue change in microseconds.
+ * @param previous_length The queue length before the job entered.
+ */
+void stats_record_queue_arrival(simulation_statistics_t* stats, unsigned long time_us,
+    unsigned long last_interaction_time_us, int previous_length);
+
+/**
+ * @brief Records a job removed from the queue when the run is stopped.
+ *
+ * @param stats A simulation statistics struct.
+ */
+void stats_record_job_removed(simulation_statistics_t* stats);
+
+/**
+ * @brief Records how long a printer waited for paper before it could serve a job.
+ *
+ * @param stats A simulation statistics struct.
+ * @param printer_id The id of the printer that ran out of paper.
+ * @param duration_us The time from the refill request to the refilled printer resuming.
+ */
+void stats_record_paper_empty(simulation_statistics_t* stats, int printer_id, unsigned long duration_us);
+
+/**
+ * @brief Records a completed paper refill.
+ *
+ * @param stats A simulation statistics struct.
+ * @param papers The number of papers added.
+ * @param duration_us The time spent refilling in microseconds.
+ */
+void stats_record_paper_refill(simulation_statistics_t* stats, int papers, unsigned long duration_us);
+
+/**
+ * @brief Records a served job leaving the system.
+ *
+ * @param stats A simulation statistics struct.
+ * @param job The job that has departed, with all lifecycle timestamps set.
+ * @param printer_id The id of the printer that served the job.
+ */
+void stats_record_job_departure(simulation_statistics_t* stats, const struct job* job, int printer_id);
+
+// --- Reporting ---
+/**
+ * @brief Calculates all derived statistics from the raw accumulators.
+ *
+ * @param stats A simulation statistics struct.
+ * @param derived The struct to fill with derived statistics.
+ */
+void calculate_derived_statistics(simulation_statistics_t* stats, simulation_derived_statistics_t* derived);
+
+/**
+ * @brief Calculates the mean and 95% confidence interval half-width of a sample
+ *        using the Student t distribution.
+ *
+ * @param samples The sample values.
+ * @param count The number of samples.
+ * @param mean Pointer to store the sample mean.
+ * @param half_width Pointer to store the 95% confidence interval half-width (0 if count < 2).
+ */
+void calculate_confidence_interval_95(const double* samples, int count, double* mean, double* half_width);
+
 /**
  * @brief Calculates all relevant simulation statistics and formats them as a JSON string to the provided buffer.
  *
@@ -49,6 +217,44 @@ typedef struct simulation_statistics {
  */
 int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size);
 
+// Number of values written by write_statistics_values
+#define STATISTICS_VALUE_COUNT 84
+
+/**
+ * @brief Calculates the statistics of write_statistics_to_buffer as plain
+ *        numbers, for binary encodings. The values follow the order of the
+ *        JSON "data" keys (simulation_duration_sec ... papers_refilled, 24
+ *        values), then the analytical baseline: model_stable (0 or 1),
+ *        utilization, avg_queue_wait_mmc_sec, avg_queue_wait_mdc_sec,
+ *        avg_queue_wait_dgc_sec, avg_queue_length_mmc,
+ *        avg_system_time_mmc_sec and drop_probability_mmck. Baseline values that do not apply are NaN.
+ *        Then come p50, p90, p99, p99.9 and max in seconds of the system
+ *        time, queue wait, printer 1 and printer 2 service time and paper
+ *        empty stall distributions, in that order (25 values). Then the
+ *        mean, standard deviation, minimum and maximum in seconds and the
+ *        skewness of the system time, queue wait, printer 1 and printer 2
+ *        service time and refill time, in that order (25 values). Last of
+ *        all, the warm-up cut: its time in seconds and the jobs served by
+ *        then, both 0 without a cut.
+ *
+ * @param stats A simulation statistics struct.
+ * @param values The array to fill.
+ * @param max_values The size of the array; at least STATISTICS_VALUE_COUNT to get every value.
+ * @return The number of values written.
+ */
+int write_statistics_values(simulation_statistics_t* stats, double* values, int max_values);
+
+/**
+ * @brief Names a value of write_statistics_values after its JSON key, e.g.
+ *        "avg_system_time_sec", "model_utilization",
+ *        "latency_queue_wait_sec_p99" or "moments_refill_time_sec_skewness".
+ *
+ * @param index The index of the value.
+ * @param buf A character buffer to hold the name; 64 bytes fit every name.
+ * @param buf_size The size of the provided buffer.
+ */
+void statistics_value_name(int index, char* buf, int buf_size);
+
 /**
  * @brief Calculates and logs all relevant simulation statistics to stdout.
  *
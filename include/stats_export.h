@@ -0,0 +1,43 @@
+#ifndef STATS_EXPORT_H
+#define STATS_EXPORT_H
+
+/**
+ * @file stats_export.h
+ * @brief Appends the final statistics of each run to a results file, for
+ *        benchmarking scripts instead of scraped terminal output.
+ *
+ * The format follows the file extension: ".csv" appends one row, with a
+ * header row when the file is new or empty; anything else appends one JSON
+ * object per line (JSON Lines). A row holds the run's metadata (finish time,
+ * engine, build id, seed), its parameters, the raw accumulators and every
+ * value of write_statistics_values under the same names in both formats.
+ * Rows are written straight to the file while holding an exclusive lock on
+ * it, so concurrent runs, in one process or several, never interleave.
+ */
+
+struct simulation_parameters;
+struct simulation_statistics;
+
+// Engines: what drove a run
+#define STATS_EXPORT_ENGINE_CLI "cli"
+#define STATS_EXPORT_ENGINE_REPLICATION "replication"
+#define STATS_EXPORT_ENGINE_SERVER "server"
+
+// The build the statistics came from, set by the Makefile from git
+#ifndef BUILD_ID
+#define BUILD_ID "unknown"
+#endif
+
+/**
+ * @brief Appends one finished run to a results file.
+ *
+ * @param path The results file, created if missing.
+ * @param params The parameters of the run.
+ * @param stats The statistics of the finished run.
+ * @param engine What drove the run, e.g. STATS_EXPORT_ENGINE_CLI.
+ * @return TRUE on success, FALSE if the file could not be written.
+ */
+int stats_export_append(const char* path, const struct simulation_parameters* params,
+    struct simulation_statistics* stats, const char* engine);
+
+#endif // STATS_EXPORT_H
@@ -0,0 +1,117 @@
+#ifndef STATS_SNAPSHOT_H
+#define STATS_SNAPSHOT_H
+
+#include <stdatomic.h>
+
+struct simulation_statistics;
+
+/**
+ * @file stats_snapshot.h
+ * @brief Copy of a run's statistics and gauges that other threads read
+ *        without taking the run's locks, for the server's Prometheus
+ *        /metrics endpoint.
+ *
+ * A single writer (the run's metrics sampler, which already holds the job
+ * queue and stats mutexes while it samples) publishes a new copy every
+ * interval under a sequence counter. Readers copy the data and retry if
+ * the counter moved while they read, so a scrape never waits on, or makes
+ * wait, the simulation.
+ *
+ * Every server run publishes a snapshot each sample, or every second
+ * without -metrics-ms, and GET /metrics answers from those snapshots.
+ */
+
+// Upper bounds of the Prometheus histogram buckets, in seconds; +Inf is implied
+#define STATS_SNAPSHOT_BUCKET_BOUNDS {0.01, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300}
+#define STATS_SNAPSHOT_BUCKET_COUNT 13
+
+/**
+ * @brief A latency distribution as Prometheus buckets.
+ */
+typedef struct stats_snapshot_histogram {
+    unsigned long buckets[STATS_SNAPSHOT_BUCKET_COUNT]; // cumulative count at or below each bound
+    unsigned long count;
+    double sum_sec;
+} stats_snapshot_histogram_t;
+
+typedef struct stats_snapshot_data {
+    int is_running;
+    double duration_sec;
+
+    // --- Counters ---
+    double jobs_arrived;
+    double jobs_served;
+    double jobs_dropped;
+    double jobs_removed;
+    double paper_refills;
+    double papers_refilled;
+    double refill_time_sec;
+
+    // --- Gauges ---
+    int queue_length;
+    int max_queue_length;
+
+    // --- Per printer ---
+    double jobs_printed[2];
+    double busy_time_sec[2];
+    double utilization[2];          // busy time / duration
+    double paper_stall_time_sec[2];
+    int paper_level[2];
+    int is_printing[2];
+
+    // --- Distributions ---
+    stats_snapshot_histogram_t system_time;
+    stats_snapshot_histogram_t queue_wait;
+    stats_snapshot_histogram_t service_time[2];
+    stats_snapshot_histogram_t paper_stall;
+} stats_snapshot_data_t;
+
+typedef struct stats_snapshot {
+    atomic_ulong sequence; // odd while the writer is copying, 0 until the first publish
+    stats_snapshot_data_t data;
+} stats_snapshot_t;
+
+/**
+ * @brief Fills the statistics part of a snapshot: duration, counters, printer
+ *        totals and distributions. The caller sets the gauges it reads elsewhere.
+ *
+ * @param stats The run's statistics, with the stats mutex held.
+ * @param duration_us The time since the run started, or its length once ended.
+ * @param data The snapshot data to fill.
+ */
+void stats_snapshot_fill(const struct simulation_statistics* stats, unsigned long duration_us,
+    stats_snapshot_data_t* data);
+
+/**
+ * @brief Publishes a new copy. Only one thread may publish to a snapshot.
+ *
+ * @param snapshot The snapshot.
+ * @param data The data to copy in.
+ */
+void stats_snapshot_publish(stats_snapshot_t* snapshot, const stats_snapshot_data_t* data);
+
+/**
+ * @brief Copies the latest published data without blocking the writer.
+ *
+ * @param snapshot The snapshot.
+ * @param data Filled with a consistent copy.
+ * @return TRUE on success, FALSE if nothing was published yet.
+ */
+int stats_snapshot_read(stats_snapshot_t* snapshot, stats_snapshot_data_t* data);
+
+/**
+ * @brief Writes the snapshots of several runs in the Prometheus text
+ *        exposition format (version 0.0.4), one sample per run labelled
+ *        session="<id>" under each metric family.
+ *
+ * @param snapshots The data of each run.
+ * @param session_ids The session id of each run.
+ * @param count The number of runs.
+ * @param buf A character buffer to hold the exposition.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes the exposition needs, as snprintf.
+ */
+int write_prometheus_metrics(const stats_snapshot_data_t* snapshots, const unsigned long* session_ids, int count,
+    char* buf, int buf_size);
+
+#endif // STATS_SNAPSHOT_H
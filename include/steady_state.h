@@ -0,0 +1,124 @@
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H
+
+/**
+ * @file steady_state.h
+ * @brief Warm-up truncation: where the startup transient of a run ends, so
+ *        the averages can cover only the steady state that follows.
+ *
+ * A run starts with an empty queue, which biases every average it reports
+ * low. The run's cumulative counters are marked at job departures; the
+ * averages of the window between a cut mark and the end of the run leave
+ * the warm-up out. The cut is either fixed, at the first departure once N
+ * jobs were served or T seconds passed, or chosen at the end of the run by
+ * MSER-5 (White, 1997) on the queue length: the series is split into batches
+ * of STEADY_STATE_BATCH_JOBS departures, and the cut is the batch boundary
+ * in the first half of the run that minimizes the variance of the mean of
+ * the batches after it, divided by their count.
+ *
+ * Batch boundaries live in a fixed array, so the struct holds no pointers
+ * and can be written to a checkpoint as is. When it fills up, every second
+ * boundary is dropped and batches hold twice as many departures.
+ */
+
+// Warm-up methods
+#define WARMUP_NONE  0 // averages cover the whole run
+#define WARMUP_JOBS  1 // cut once a number of jobs were served
+#define WARMUP_TIME  2 // cut once a number of seconds passed
+#define WARMUP_MSER5 3 // cut chosen by MSER-5 at the end of the run
+
+#define STEADY_STATE_BATCH_JOBS 5
+#define STEADY_STATE_MAX_BATCHES 256
+
+/**
+ * @brief The cumulative counters of a run at one point in time.
+ */
+typedef struct stats_mark {
+    unsigned long time_us;                  // since the start of the simulation
+    double jobs_arrived;
+    double jobs_served;
+    double jobs_dropped;
+    double jobs_served_by_printer[2];
+    unsigned long inter_arrival_time_us;
+    unsigned long system_time_us;
+    unsigned long queue_wait_time_us;
+    unsigned long service_time_us[2];
+    unsigned long area_num_in_job_queue_us; // integrated up to the last queue change
+} stats_mark_t;
+
+typedef struct steady_state {
+    int method;                             // WARMUP_NONE, _JOBS, _TIME or _MSER5
+    double warmup_amount;                   // jobs or seconds for the fixed methods
+    int has_fixed_cut;
+    stats_mark_t fixed_cut;
+    stats_mark_t batch_ends[STEADY_STATE_MAX_BATCHES]; // MSER-5 only
+    int batch_count;
+    unsigned int batch_jobs;                // departures per batch
+} steady_state_t;
+
+/**
+ * @brief Sets how a zeroed steady state finds its cut.
+ *
+ * @param steady_state The steady state.
+ * @param method WARMUP_NONE, _JOBS, _TIME or _MSER5.
+ * @param warmup_amount Jobs for WARMUP_JOBS, seconds for WARMUP_TIME.
+ */
+void steady_state_configure(steady_state_t* steady_state, int method, double warmup_amount);
+
+/**
+ * @brief Takes the run's counters at a job departure.
+ *
+ * @param steady_state The steady state.
+ * @param mark The counters after the departure.
+ */
+void steady_state_observe(steady_state_t* steady_state, const stats_mark_t* mark);
+
+/**
+ * @brief Returns where the warm-up ends.
+ *
+ * @param steady_state The steady state.
+ * @param cut Filled with the counters at the cut.
+ * @return TRUE if the run is truncated, FALSE if the averages cover the
+ *         whole run: no method, a fixed warm-up the run never reached or
+ *         too few batches for MSER-5.
+ */
+int steady_state_cut(const steady_state_t* steady_state, stats_mark_t* cut);
+
+/**
+ * @brief Returns the MSER truncation point of a series of batch means: the
+ *        number of leading batches d, at most half of them, that minimizes
+ *        the sum of squared deviations of the remaining batches from their
+ *        mean divided by (count - d)^2.
+ *
+ * @param batch_means The batch means in time order.
+ * @param count The number of batches.
+ * @return The number of batches to drop, 0 with fewer than two batches.
+ */
+int mser_truncation(const double* batch_means, int count);
+
+/**
+ * @brief Subtracts the counters at the start of a window from those at its end.
+ *
+ * @param end The counters at the end of the window.
+ * @param start The counters at its start.
+ * @param window Filled with the counters of the window.
+ */
+void stats_mark_window(const stats_mark_t* end, const stats_mark_t* start, stats_mark_t* window);
+
+/**
+ * @brief Parses a warm-up argument: "auto" for MSER-5, "N" for N jobs served
+ *        or "Ts" for T seconds.
+ *
+ * @param arg The argument.
+ * @param method Set to the warm-up method.
+ * @param warmup_amount Set to the jobs or seconds of a fixed warm-up, 0 for MSER-5.
+ * @return TRUE on success, FALSE if the argument is malformed or not positive.
+ */
+int warmup_from_arg(const char* arg, int* method, double* warmup_amount);
+
+/**
+ * @brief Returns the name of a warm-up method, e.g. "mser5".
+ */
+const char* warmup_method_name(int method);
+
+#endif // STEADY_STATE_H
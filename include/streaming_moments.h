@@ -0,0 +1,61 @@
+#ifndef STREAMING_MOMENTS_H
+#define STREAMING_MOMENTS_H
+
+/**
+ * @file streaming_moments.h
+ * @brief Count, mean, variance, skewness, minimum and maximum of a stream of
+ *        values in one pass and constant space.
+ *
+ * Values update the mean and the sums of squared and cubed deviations from it
+ * (Welford's method), instead of accumulating raw sums and squares that must
+ * later be subtracted. The variance stays accurate over millions of values
+ * whose spread is small next to their magnitude, and nothing overflows.
+ * Moments kept by separate threads can be merged into the moments of the
+ * combined stream.
+ *
+ * The struct holds no pointers, so it can live inside a struct that is copied
+ * or written to a checkpoint as is. Zeroed moments are empty.
+ */
+
+typedef struct streaming_moments {
+    unsigned long count;
+    double mean;
+    double m2;  // sum of squared deviations from the mean
+    double m3;  // sum of cubed deviations from the mean
+    double min; // valid once count > 0
+    double max;
+} streaming_moments_t;
+
+/**
+ * @brief Adds one value.
+ *
+ * @param moments The moments.
+ * @param value The value.
+ */
+void streaming_moments_add(streaming_moments_t* moments, double value);
+
+/**
+ * @brief Merges the moments of another stream, as if its values had been added.
+ *
+ * @param moments The moments to update.
+ * @param other The moments of the other stream.
+ */
+void streaming_moments_merge(streaming_moments_t* moments, const streaming_moments_t* other);
+
+/**
+ * @brief Returns the sample variance, or 0 with fewer than two values.
+ */
+double streaming_moments_variance(const streaming_moments_t* moments);
+
+/**
+ * @brief Returns the sample standard deviation, or 0 with fewer than two values.
+ */
+double streaming_moments_std_dev(const streaming_moments_t* moments);
+
+/**
+ * @brief Returns the skewness (positive for a long right tail), or 0 if all
+ *        values are equal.
+ */
+double streaming_moments_skewness(const streaming_moments_t* moments);
+
+#endif // STREAMING_MOMENTS_H
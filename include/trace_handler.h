@@ -0,0 +1,49 @@
+#ifndef TRACE_HANDLER_H
+#define TRACE_HANDLER_H
+
+/**
+ * @file trace_handler.h
+ * @brief log_ops backend for LOG_MODE_TRACE: the lifecycle of every job as a
+ *        Chrome Trace Event file (see trace_writer.h) to open in
+ *        ui.perfetto.dev or chrome://tracing.
+ *
+ * Each run is a process with one track per printer, holding its service
+ * spans and paper-empty stalls, and a refiller track with the refill spans.
+ * Queue waits are overlapping spans of their own, one per job, and queue
+ * depth and paper levels are counter tracks. Dropped and removed jobs are
+ * instants on the queue track. A job's spans are written when it leaves the
+ * system, from the five timestamps it carries.
+ *
+ * The CLI's run is process 1; concurrent server sessions are numbered in the
+ * order their runs start.
+ *
+ * Simulation threads only push a record per event into a lock-free ring; a
+ * writer thread builds the spans and writes the file, so tracing does not
+ * stall the pipeline's locks.
+ */
+
+/**
+ * @brief Opens the trace file the handler writes to and starts its writer
+ *        thread. Call before the run starts.
+ *
+ * @param path The file to write.
+ * @param overflow_policy EVENT_RING_OVERFLOW_BLOCK or _DROP when the writer falls behind.
+ * @return TRUE on success, FALSE on failure.
+ */
+int trace_handler_open(const char* path, int overflow_policy);
+
+/**
+ * @brief Stops the writer thread once it has written every queued event,
+ *        closes the trace and, unless quiet, reports how many events it
+ *        holds. Call after the simulation threads have stopped logging.
+ *
+ * @param is_quiet TRUE to skip the report on stdout.
+ */
+void trace_handler_close(int is_quiet);
+
+/**
+ * @brief Registers the trace handler with the log router
+ */
+void trace_handler_register(void);
+
+#endif // TRACE_HANDLER_H
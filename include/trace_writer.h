@@ -0,0 +1,141 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file trace_writer.h
+ * @brief Buffered writer of Chrome Trace Event Format JSON, the format
+ *        chrome://tracing and ui.perfetto.dev open directly.
+ *
+ * The file is one {"traceEvents":[...]} object. Events are formatted into a
+ * buffer that is written out whenever it fills, so the trace is streamed to
+ * disk instead of held in memory. A writer is not thread-safe: one thread
+ * owns it (the trace handler's writer thread). Timestamps are microseconds
+ * since the writer was opened.
+ */
+
+#define TRACE_WRITER_BUFFER_SIZE 65536
+
+typedef struct trace_writer {
+    FILE* file;
+    char buffer[TRACE_WRITER_BUFFER_SIZE];
+    size_t length;          // bytes buffered
+    size_t event_count;
+    unsigned long origin_us; // absolute time of timestamp 0
+} trace_writer_t;
+
+/**
+ * @brief Creates (or truncates) a trace file and writes its opening.
+ *
+ * @param writer The writer to initialize.
+ * @param path The file to write.
+ * @param origin_us The absolute time in microseconds that becomes timestamp 0.
+ * @return TRUE on success, FALSE on failure.
+ */
+int trace_writer_open(trace_writer_t* writer, const char* path, unsigned long origin_us);
+
+/**
+ * @brief Writes the buffered events and the closing of the file, and closes it.
+ *
+ * @param writer An open writer.
+ */
+void trace_writer_close(trace_writer_t* writer);
+
+/**
+ * @brief Writes the buffered events to the file now, e.g. at the end of a run
+ *        in a process that may never close the writer. Viewers open a file
+ *        without its closing.
+ *
+ * @param writer An open writer.
+ */
+void trace_writer_flush(trace_writer_t* writer);
+
+/**
+ * @brief Appends one event object.
+ *
+ * @param writer An open writer.
+ * @param event The event as a JSON object, e.g. {"ph":"i",...}.
+ * @param length The length of the event.
+ */
+void trace_writer_append(trace_writer_t* writer, const char* event, size_t length);
+
+/**
+ * @brief Names a process or a thread track ("ph":"M" metadata).
+ *
+ * @param writer An open writer.
+ * @param pid The process.
+ * @param tid The thread, or 0 to name the process.
+ * @param name The name.
+ */
+void trace_writer_name(trace_writer_t* writer, int pid, int tid, const char* name);
+
+/**
+ * @brief Writes a span with a known duration ("ph":"X") on a thread track.
+ *
+ * @param writer An open writer.
+ * @param pid The process.
+ * @param tid The thread track.
+ * @param name The span's name.
+ * @param start_us The absolute start time in microseconds.
+ * @param duration_us The duration in microseconds.
+ * @param args The members of the span's "args" object, e.g. "\"job\":3", or NULL.
+ */
+void trace_writer_complete(trace_writer_t* writer, int pid, int tid, const char* name,
+    unsigned long start_us, unsigned long duration_us, const char* args);
+
+/**
+ * @brief Opens ("ph":"B") or closes ("ph":"E") a span on a thread track whose
+ *        end is not known when it starts. Spans on a track must nest.
+ *
+ * @param writer An open writer.
+ * @param is_begin TRUE to open the span, FALSE to close it.
+ * @param pid The process.
+ * @param tid The thread track.
+ * @param name The span's name.
+ * @param time_us The absolute time in microseconds.
+ */
+void trace_writer_duration(trace_writer_t* writer, int is_begin, int pid, int tid, const char* name,
+    unsigned long time_us);
+
+/**
+ * @brief Writes a span that may overlap others of the same name ("ph":"b"
+ *        and "e"), e.g. jobs waiting in a queue at the same time.
+ *
+ * @param writer An open writer.
+ * @param pid The process.
+ * @param name The span's name; spans are grouped into tracks by name.
+ * @param id The span's id, unique among the spans of its name.
+ * @param start_us The absolute start time in microseconds.
+ * @param end_us The absolute end time in microseconds.
+ * @param args The members of the span's "args" object, or NULL.
+ */
+void trace_writer_async(trace_writer_t* writer, int pid, const char* name, int id,
+    unsigned long start_us, unsigned long end_us, const char* args);
+
+/**
+ * @brief Writes a point in time ("ph":"i") on a thread track.
+ *
+ * @param writer An open writer.
+ * @param pid The process.
+ * @param tid The thread track.
+ * @param name The event's name.
+ * @param time_us The absolute time in microseconds.
+ * @param args The members of the event's "args" object, or NULL.
+ */
+void trace_writer_instant(trace_writer_t* writer, int pid, int tid, const char* name,
+    unsigned long time_us, const char* args);
+
+/**
+ * @brief Writes a value of a counter track ("ph":"C").
+ *
+ * @param writer An open writer.
+ * @param pid The process.
+ * @param name The counter's name, one track per name.
+ * @param time_us The absolute time in microseconds.
+ * @param value The counter's value from then on.
+ */
+void trace_writer_counter(trace_writer_t* writer, int pid, const char* name, unsigned long time_us, long value);
+
+#endif // TRACE_WRITER_H
@@ -1,7 +1,23 @@
 #ifndef WEBSOCKET_HANDLER_H
 #define WEBSOCKET_HANDLER_H
 
+/**
+ * @file websocket_handler.h
+ * @brief log_ops backend for the server: publishes a session's events,
+ *        statistics and samples as frames of its stream (see ws_bridge.h).
+ *
+ * JSON events are typed, e.g. {"type":"queue_departure", "t_us":..., "job":12,
+ * "wait_us":..., "qlen":3}; with events=text (or -ws-text-events) they are
+ * the legacy {"type":"log", ...} sentences instead. Which events are sent is
+ * set by the log options, taken from the websocket URL's query or a
+ * "log <options>" command in the same syntax: log_level=summary|jobs|all,
+ * log_off=event[,event...], log_sample=N, events=typed|text and metrics_ms=N.
+ */
+
+struct host_usage;
 struct job;
+struct lock_profile_set;
+struct metrics_sample;
 struct printer;
 struct simulation_parameters;
 struct simulation_statistics;
@@ -16,13 +32,13 @@ void publish_simulation_parameters(const struct simulation_parameters* params);
 /**
  * @brief Publishes the start of the simulation.
  * 
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_simulation_start(struct simulation_statistics* stats);
 /**
  * @brief Publishes the end of the simulation.
  * 
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_simulation_end(struct simulation_statistics* stats);
 
@@ -31,7 +47,7 @@ void publish_simulation_end(struct simulation_statistics* stats);
  *
  * @param job The job that has been dropped.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_system_arrival(struct job* job,
     unsigned long previous_job_arrival_time_us, struct simulation_statistics* stats);
@@ -40,7 +56,7 @@ void publish_system_arrival(struct job* job,
  *
  * @param job The job that has been dropped.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_dropped_job(struct job* job,
     unsigned long previous_job_arrival_time_us, struct simulation_statistics* stats);
@@ -54,7 +70,7 @@ void publish_removed_job(struct job* job);
 /**
  * @brief Publishes an event when a job arrives at the queue.
  * @param job The job that has arrived at the queue.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  * @param job_queue The job queue to check the length of.
  * @param last_interaction_time_us The last interaction time of the job queue.
  */
@@ -64,7 +80,7 @@ void publish_queue_arrival(const struct job* job, struct simulation_statistics*
  * @brief Publishes an event when a job departs from the queue.
  *
  * @param job The job that has departed from the queue.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  * @param job_queue The job queue to check the length of.
  * @param last_interaction_time_us The last interaction time of the job queue.
  */
@@ -82,7 +98,7 @@ void publish_printer_arrival(const struct job* job, const struct printer* printe
  * @brief Publishes an event when a job departs from a printer after processing.
  * @param job The job that has departed from the printer.
  * @param printer The printer that the job has departed from.
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_system_departure(const struct job* job, const struct printer* printer,
     struct simulation_statistics* stats);
@@ -118,10 +134,23 @@ void publish_paper_refill_end(struct printer* printer, int refill_duration_us,
 /**
  * @brief Publishes an event when the simulation is stopped.
  * 
- * @param stats The simulation statistics to update.
+ * @param stats The simulation statistics.
  */
 void publish_simulation_stopped(struct simulation_statistics* stats);
 
+/**
+ * @brief Publishes an event when the simulation pauses to write a checkpoint.
+ * 
+ * @param stats The simulation statistics.
+ */
+void publish_simulation_checkpoint(struct simulation_statistics* stats);
+/**
+ * @brief Publishes an event when the simulation resumes from a checkpoint.
+ * 
+ * @param stats The restored simulation statistics.
+ */
+void publish_simulation_resumed(struct simulation_statistics* stats);
+
 /**
  * @brief Calculates and publishes all relevant simulation statistics via WebSocket.
  *
@@ -129,6 +158,31 @@ void publish_simulation_stopped(struct simulation_statistics* stats);
  */
 void publish_statistics(struct simulation_statistics* stats);
 
+/**
+ * @brief Publishes a metrics sample as {"type":"metrics", "seq":N, "v":[...]},
+ *        with the values of metrics_sample_append_values.
+ *
+ * @param sample The sample.
+ * @param number The sample's number in the run's metrics ring.
+ */
+void publish_metrics_sample(const struct metrics_sample* sample, unsigned long number);
+
+/**
+ * @brief Publishes the host usage of a run as {"type":"host_usage", "data":{...}},
+ *        with the object of write_host_usage_to_buffer.
+ *
+ * @param usage The run's finished host usage.
+ */
+void publish_host_usage(const struct host_usage* usage);
+
+/**
+ * @brief Publishes the lock profiles of a run as {"type":"locks", "data":[...]},
+ *        with the objects of write_lock_profiles_to_buffer.
+ *
+ * @param locks The run's lock profiles.
+ */
+void publish_lock_statistics(const struct lock_profile_set* locks);
+
 /**
  * @brief Registers the websocket handler with the log router
  */
@@ -1,15 +1,327 @@
 #ifndef WS_BRIDGE_H
 #define WS_BRIDGE_H
 
+#include <pthread.h>
 #include <stddef.h>
 
-/** 
- * @brief Thread-safe enqueue of a websocket text frame to the active client.
+#include "log_event.h"
+
+/**
+ * @file ws_bridge.h
+ * @brief Delivery of frames from simulation threads to websocket clients
+ *        through the Mongoose event loop, with batching and a bounded
+ *        outbound budget per connection.
+ *
+ * The producer side (ws_bridge_send_*) may be called from any thread; the
+ * event loop side (ws_bridge_service, ws_bridge_deliver, ws_bridge_pump,
+ * ws_bridge_subscribe, ws_bridge_set_protocol) only from the thread that
+ * polls the Mongoose manager.
+ *
+ * A stream is fanned out to every subscribed connection: its owner and any
+ * watchers. Each flushed frame is built once into a reference-counted buffer
+ * that every subscriber queues, and is copied into a connection's Mongoose
+ * send buffer only as that connection drains, so the cost of a frame does
+ * not grow with the number of viewers.
+ *
+ * Every websocket connection owns its own session (see session_manager.h)
+ * and stream, except watchers: a connection opened with ?watch=<session>
+ * (the "session" of a status reply) subscribes to that session's stream, in
+ * the session's framing, and is read-only. A watcher more than -ws-lag-cap
+ * bytes behind is disconnected.
+ *
+ * A connection picks its framing with ?protocol=json|binary on the URL or a
+ * "hello json|binary" command. Frames are batched every -ws-flush-ms
+ * milliseconds, or sooner once -ws-batch-bytes are pending; -ws-flush-ms 0
+ * sends one frame per event. Each connection may have -ws-budget bytes
+ * queued; past that, per-job events are handled by -ws-overflow
+ * (see ws_overflow_policy_t).
+ */
+
+struct mg_connection;
+struct mg_mgr;
+struct ws_shared_frame;
+
+/**
+ * @brief Framing of a connection's simulation frames.
+ */
+typedef enum ws_protocol {
+    WS_PROTOCOL_JSON = 0,   // JSON text frames
+    WS_PROTOCOL_BINARY = 1  // binary record frames, see ws_record_kind_t
+} ws_protocol_t;
+
+// --- Binary protocol ---
+/*
+ * A binary frame (WEBSOCKET_OP_BINARY) is a sequence of records. Each record
+ * is a 4-byte header followed by its payload; all values are little-endian.
+ *
+ *   offset 0  uint8   kind (ws_record_kind_t)
+ *   offset 1  uint8   reserved, 0
+ *   offset 2  uint16  payload length in bytes
+ *
+ * WS_RECORD_EVENT       a log_event_t (32 bytes, see log_event.h); time_us is
+ *                       absolute and the run's simulation_start event sets the
+ *                       reference time, as in the binary event log
+ * WS_RECORD_STATISTICS  float64 values in the order of write_statistics_values
+ * WS_RECORD_PARAMS      float64 values in the order of the JSON params message
+ * WS_RECORD_JSON        UTF-8 JSON text of any other message (checkpoint,
+ *                       outbound, summary, stream state)
+ *
+ * Replies to commands are always JSON text frames.
+ */
+#define WS_PROTOCOL_VERSION 1
+
+// Event records are the log_event_t bytes as is, and values are the host's doubles
+_Static_assert(sizeof(log_event_t) == 32, "WS_RECORD_EVENT payloads are 32-byte log_event_t records");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the binary websocket protocol copies records in host byte order, which must be little-endian"
+#endif
+#define WS_RECORD_HEADER_SIZE 4
+
+typedef enum ws_record_kind {
+    WS_RECORD_EVENT = 1,
+    WS_RECORD_STATISTICS = 2,
+    WS_RECORD_PARAMS = 3,
+    WS_RECORD_JSON = 4
+} ws_record_kind_t;
+
+/**
+ * @brief What happens to per-job events once a connection's outbound budget
+ *        (pending batch plus unsent Mongoose bytes) is used up. Lifecycle,
+ *        parameter and statistics frames are always delivered.
+ */
+typedef enum ws_overflow_policy {
+    WS_OVERFLOW_DROP_OLDEST = 0, // discard the oldest pending per-job events to make room
+    WS_OVERFLOW_SUMMARY = 1,     // replace per-job events with a count per event type every flush
+    WS_OVERFLOW_PAUSE = 2        // skip per-job events until the client has drained half the budget
+} ws_overflow_policy_t;
+
+// A frame in the batch, so the oldest per-job events can be cut out
+typedef struct ws_frame {
+    size_t offset;
+    size_t length;
+    int is_droppable;
+} ws_frame_t;
+
+/**
+ * @brief A connection receiving a stream and the frames it has yet to take.
+ *        Event loop only.
+ */
+typedef struct ws_subscriber {
+    unsigned long conn_id;
+    struct ws_shared_frame** queue; // ring of shared frames, oldest at head
+    int head;
+    int count;
+    int capacity;
+    size_t queued_bytes;
+    int is_lagging;                 // a watcher that exceeded the lag cap; disconnect it
+} ws_subscriber_t;
+
+/**
+ * @brief How a connection is keeping up with its run.
+ */
+typedef struct ws_outbound_stats {
+    size_t queued_bytes;          // pending batch plus bytes Mongoose has yet to write
+    size_t peak_queued_bytes;
+    unsigned long dropped_events; // per-job events discarded by the overflow policy
+} ws_outbound_stats_t;
+
+/**
+ * @brief Destination of the events of one simulation run: the websocket
+ *        connection that owns the run and the time events are logged against.
+ *
+ * Simulation threads find their stream through the log router's thread
+ * context (see log_router_bind_thread_context).
+ *
+ * In batched mode (see ws_bridge_configure) frames are appended to the
+ * stream's batch and the event loop sends everything pending as a single
+ * frame: a JSON array, e.g. [{"type":"log",...},{"type":"log",...}], or
+ * the concatenated records of the binary protocol.
+ * Without batching the only queue is Mongoose's, so the overflow policy
+ * falls back to dropping new per-job events while it is over budget.
+ */
+typedef struct ws_stream {
+    unsigned long conn_id;               // 0 once the client has gone away
+    unsigned long reference_time_us;     // start of the run
+    unsigned long reference_end_time_us; // end of the run
+    int protocol;                        // ws_protocol_t, changed only while no run is active
+    int is_text_events;                  // JSON: legacy "log" sentences instead of typed events; set per run
+    pthread_mutex_t mutex;               // protects conn_id and the batch
+
+    // --- Batching ---
+    char* batch;              // JSON: "[" then the frames separated by ','; binary: the records
+    size_t batch_length;
+    size_t batch_capacity;
+    int batch_count;          // frames pending
+    int flush_requested;      // the size threshold was crossed and the loop has been woken
+    unsigned long last_flush_ms; // event loop only
+    ws_frame_t* frames;       // one entry per pending frame
+    int frame_capacity;
+
+    // --- Outbound budget ---
+    size_t send_backlog;      // bytes Mongoose has yet to write, refreshed by the event loop
+    size_t peak_queued_bytes;
+    unsigned long dropped_events;
+    int is_paused;            // WS_OVERFLOW_PAUSE: per-job events are being skipped
+    unsigned int suppressed[LOG_EVENT_TYPE_COUNT]; // WS_OVERFLOW_SUMMARY: events awaiting a summary
+
+    // --- Fan-out (event loop only) ---
+    ws_subscriber_t* subscribers; // [0] is the owner
+    int subscriber_count;
+    int subscriber_capacity;
+} ws_stream_t;
+
+/**
+ * @brief Sets how frames are delivered to websocket clients. Call before any
+ *        stream is initialized.
+ *
+ * @param mgr The Mongoose manager whose wakeup pipe reaches the event loop.
+ * @param flush_interval_ms How long frames may wait before the event loop
+ *        sends them as one batch (0 = one websocket frame per event).
+ * @param batch_bytes Pending bytes that trigger a flush before the interval ends.
+ * @param budget_bytes Bytes the owner may have queued before the overflow policy applies.
+ * @param overflow_policy A ws_overflow_policy_t.
+ * @param lag_cap_bytes Bytes a watcher may fall behind before it is disconnected.
+ */
+void ws_bridge_configure(struct mg_mgr *mgr, int flush_interval_ms, int batch_bytes, int budget_bytes,
+    int overflow_policy, int lag_cap_bytes);
+
+/**
+ * @brief Returns how often the event loop must service streams, in milliseconds.
+ */
+int ws_bridge_flush_interval_ms(void);
+
+/**
+ * @brief Initializes a stream for a websocket connection, its owner and first subscriber.
+ * @param stream The stream to initialize.
+ * @param conn_id The Mongoose connection id.
+ * @param protocol The ws_protocol_t the client asked for.
+ */
+void ws_bridge_init_stream(ws_stream_t *stream, unsigned long conn_id, int protocol);
+
+/**
+ * @brief Releases a stream's batch and subscribers. The stream must be
+ *        detached and no longer written to.
+ * @param stream The stream to release.
+ */
+void ws_bridge_destroy_stream(ws_stream_t *stream);
+
+/**
+ * @brief Thread-safe enqueue of a JSON message to the stream's client.
  * This can be called from any thread. Delivery is performed on the
- * Mongoose event loop via MG_EV_WAKEUP.
+ * Mongoose event loop, via MG_EV_WAKEUP per frame or batched on MG_EV_POLL.
+ * Binary streams carry it as a WS_RECORD_JSON record.
+ * @param stream The stream to send to; frames for a detached stream are discarded.
  * @param json The JSON string to send.
  * @param len The length of the JSON string.
  */
-void ws_bridge_send_json_from_any_thread(const char *json, size_t len);
+void ws_bridge_send_json_from_any_thread(ws_stream_t *stream, const char *json, size_t len);
+
+/**
+ * @brief Like ws_bridge_send_json_from_any_thread for the frame of a simulation
+ *        event. Per-job events are subject to the stream's overflow policy.
+ * @param stream The stream to send to.
+ * @param event_type The log_event_type_t the frame reports.
+ * @param json The JSON string to send.
+ * @param len The length of the JSON string.
+ */
+void ws_bridge_send_event_from_any_thread(ws_stream_t *stream, int event_type, const char *json, size_t len);
+
+/**
+ * @brief Thread-safe enqueue of a record to a binary stream. Per-job event
+ *        records are subject to the stream's overflow policy.
+ * @param stream The stream to send to; ignored unless it uses WS_PROTOCOL_BINARY.
+ * @param event_type The log_event_type_t the record reports, or -1.
+ * @param kind The ws_record_kind_t of the record.
+ * @param payload The payload, without the record header.
+ * @param len The payload length, at most 65535 bytes.
+ */
+void ws_bridge_send_record_from_any_thread(ws_stream_t *stream, int event_type, int kind,
+    const void *payload, size_t len);
+
+/**
+ * @brief Reads how the stream's connection is keeping up.
+ * @param stream The stream.
+ * @param stats Filled with the queued bytes, their peak and the dropped events.
+ */
+void ws_bridge_outbound_stats(ws_stream_t *stream, ws_outbound_stats_t *stats);
+
+/**
+ * @brief Detaches the stream from its connection so pending and later frames are discarded.
+ * @param stream The stream to detach.
+ */
+void ws_bridge_detach_stream(ws_stream_t *stream);
+
+// --- Event loop side ---
+
+/**
+ * @brief Refreshes the stream's view of the connection's backlog, applies the
+ *        overflow policy's catch-up frames and flushes the batch when due.
+ *        Call on MG_EV_POLL and on empty MG_EV_WAKEUP notifications.
+ *
+ * @param c The connection that owns the stream.
+ * @param stream The stream to service.
+ * @param now_ms The current time in milliseconds, or 0 to flush regardless of the interval.
+ */
+void ws_bridge_service(struct mg_connection *c, ws_stream_t *stream, unsigned long now_ms);
+
+/**
+ * @brief Fans out an unbatched frame carried by a non-empty MG_EV_WAKEUP.
+ *
+ * @param c The owner connection the frame was posted to.
+ * @param stream The owner's stream.
+ * @param data The wakeup data.
+ * @param len The length of the wakeup data.
+ */
+void ws_bridge_deliver(struct mg_connection *c, ws_stream_t *stream, const void *data, size_t len);
+
+/**
+ * @brief Adds a watcher connection to the stream's subscribers.
+ *
+ * @param stream The stream to watch.
+ * @param conn_id The watcher's Mongoose connection id.
+ * @return TRUE on success, FALSE if the subscriber could not be allocated.
+ */
+int ws_bridge_subscribe(ws_stream_t *stream, unsigned long conn_id);
+
+/**
+ * @brief Removes a watcher connection and releases the frames it still held.
+ *
+ * @param stream The stream watched.
+ * @param conn_id The watcher's Mongoose connection id.
+ */
+void ws_bridge_unsubscribe(ws_stream_t *stream, unsigned long conn_id);
+
+/**
+ * @brief Moves a subscriber's queued frames into its connection's send buffer
+ *        as the connection drains. Call on MG_EV_POLL for watchers.
+ *
+ * @param c The subscriber's connection.
+ * @param stream The stream it watches.
+ * @return FALSE if the subscriber fell behind the lag cap or is not subscribed,
+ *         and should be disconnected.
+ */
+int ws_bridge_pump(struct mg_connection *c, ws_stream_t *stream);
+
+/**
+ * @brief Returns the number of watchers of the stream, not counting its owner.
+ */
+int ws_bridge_watcher_count(const ws_stream_t *stream);
+
+/**
+ * @brief Switches the stream's framing after sending whatever is pending in
+ *        the previous one. Only while no run is writing to the stream.
+ *
+ * @param c The connection that owns the stream.
+ * @param stream The stream.
+ * @param protocol The new ws_protocol_t.
+ */
+void ws_bridge_set_protocol(struct mg_connection *c, ws_stream_t *stream, int protocol);
+
+/**
+ * @brief Parses a protocol name, "json" or "binary".
+ *
+ * @return The ws_protocol_t, or -1 if the name is unknown.
+ */
+int ws_protocol_from_name(const char *name);
 
 #endif // WS_BRIDGE_H
@@ -4,4 +4,23 @@ make -f MakefileTest.mk
 ./test_job_receiver
 ./test_simulation_stats
 ./test_timed_queue
+./test_queueing_model
+./test_checkpoint
+./test_event_ring
+./test_binary_log
+./test_log_filter
+./test_text_buffer
+./test_log_router
+./test_latency_histogram
+./test_metrics_ring
+./test_stats_snapshot
+./test_streaming_moments
+./test_trace_writer
+./test_lock_profile
+./test_host_usage
+./test_steady_state
+./test_stats_export
+./test_ws_bridge
+./test_websocket_handler
+./test_session_manager
 make -f MakefileTest.mk clean
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "binary_handler.h"
+#include "binary_log.h"
+#include "console_handler.h"
+#include "event_ring.h"
+#include "job_receiver.h"
+#include "log_event.h"
+#include "log_router.h"
+#include "printer.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+
+// --- Asynchronous writer ---
+/*
+ * Events are emitted with the queue and stats locks held, so, as in the
+ * console sink, simulation threads only push the record into a lock-free
+ * ring. A writer thread is the log's only appender: it copies the records
+ * into the mapping and grows the file when it fills, off the emitting
+ * threads.
+ */
+#define BINARY_RING_CAPACITY   65536
+#define BINARY_IDLE_SLEEP_US   1000
+
+static binary_log_writer_t s_writer;
+static event_ring_t s_ring;
+static pthread_t s_writer_thread;
+static atomic_int s_stop_writer;
+static int s_is_open = FALSE; // set before producers start, cleared after they stop
+static char s_path[MAXPATHLENGTH];
+
+static void* binary_writer_thread_func(void* arg) {
+    for (;;) {
+        log_event_t event;
+        int has_events = FALSE;
+        while (event_ring_pop(&s_ring, &event)) {
+            has_events = TRUE;
+            binary_log_append(&s_writer, &event);
+        }
+        if (!has_events) {
+            // Producers have stopped before the stop flag is raised, so an empty ring is final
+            if (atomic_load(&s_stop_writer)) break;
+            usleep(BINARY_IDLE_SLEEP_US);
+        }
+    }
+    return NULL;
+}
+
+static void append(const log_event_t* event) {
+    if (s_is_open) event_ring_push(&s_ring, event);
+}
+
+int binary_handler_open(const char* path, int overflow_policy) {
+    if (!binary_log_open(&s_writer, path)) return FALSE;
+    if (!event_ring_init(&s_ring, BINARY_RING_CAPACITY, sizeof(log_event_t), overflow_policy)) {
+        fprintf(stderr, "Error: Failed to allocate binary log event ring\n");
+        binary_log_close(&s_writer);
+        return FALSE;
+    }
+    snprintf(s_path, sizeof(s_path), "%s", path);
+    atomic_store(&s_stop_writer, 0);
+    s_is_open = TRUE;
+    pthread_create(&s_writer_thread, NULL, binary_writer_thread_func, NULL);
+    return TRUE;
+}
+
+void binary_handler_close(void) {
+    if (!s_is_open) return;
+    s_is_open = FALSE;
+    atomic_store(&s_stop_writer, 1);
+    pthread_join(s_writer_thread, NULL);
+
+    unsigned long dropped = event_ring_dropped(&s_ring);
+    if (dropped > 0) fprintf(stderr, "Warning: %lu log events dropped, binary log could not keep up\n", dropped);
+    event_ring_destroy(&s_ring);
+    size_t record_count = s_writer.record_count;
+    binary_log_close(&s_writer);
+    printf("Wrote %zu events to %s, decode with ./bin/evdecode %s\n", record_count, s_path, s_path);
+}
+
+// --- Event records ---
+/*
+ * The pipeline has already recorded the statistics; the event itself is
+ * copied into the mapped file without any formatting.
+ */
+static void binary_simulation_start(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_START, .time_us = stats->simulation_start_time_us};
+    append(&event);
+}
+
+static void binary_simulation_end(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_END,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us,
+        .duration_us = stats->simulation_duration_us};
+    append(&event);
+}
+
+static void binary_job_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
+    int is_dropped, simulation_statistics_t* stats)
+{
+    log_event_t event = {
+        .type = is_dropped ? LOG_EVENT_DROPPED_JOB : LOG_EVENT_SYSTEM_ARRIVAL,
+        .job_id = job->id,
+        .time_us = job->system_arrival_time_us,
+        .duration_us = job->system_arrival_time_us - previous_job_arrival_time_us,
+        .papers = job->papers_required
+    };
+    append(&event);
+}
+
+static void binary_system_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
+    simulation_statistics_t* stats)
+{
+    binary_job_arrival(job, previous_job_arrival_time_us, FALSE, stats);
+}
+
+static void binary_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
+    simulation_statistics_t* stats)
+{
+    binary_job_arrival(job, previous_job_arrival_time_us, TRUE, stats);
+}
+
+static void binary_removed_job(job_t* job) {
+    log_event_t event = {.type = LOG_EVENT_REMOVED_JOB, .job_id = job->id, .time_us = get_time_in_us()};
+    append(&event);
+}
+
+static void binary_queue_arrival(const job_t* job, simulation_statistics_t* stats,
+    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
+{
+    log_event_t event = {.type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = job->id,
+        .time_us = job->queue_arrival_time_us, .queue_length = timed_queue_length(job_queue)};
+    append(&event);
+}
+
+static void binary_queue_departure(const job_t* job, simulation_statistics_t* stats,
+    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
+{
+    log_event_t event = {.type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = job->id,
+        .time_us = job->queue_departure_time_us,
+        .duration_us = job->queue_departure_time_us - job->queue_arrival_time_us,
+        .queue_length = timed_queue_length(job_queue)};
+    append(&event);
+}
+
+static void binary_printer_arrival(const job_t* job, const printer_t* printer) {
+    log_event_t event = {.type = LOG_EVENT_PRINTER_ARRIVAL, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_arrival_time_us,
+        .duration_us = (uint64_t)job->service_time_requested_ms * 1000, .papers = job->papers_required};
+    append(&event);
+}
+
+static void binary_system_departure(const job_t* job, const printer_t* printer,
+    simulation_statistics_t* stats)
+{
+    log_event_t event = {.type = LOG_EVENT_SYSTEM_DEPARTURE, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_departure_time_us,
+        .duration_us = job->service_departure_time_us - job->service_arrival_time_us};
+    append(&event);
+}
+
+static void binary_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us) {
+    log_event_t event = {.type = LOG_EVENT_PAPER_EMPTY, .printer_id = printer->id, .job_id = job_id,
+        .time_us = current_time_us};
+    append(&event);
+}
+
+static void binary_paper_refill_start(printer_t* printer, int papers_needed,
+    int time_to_refill_us, unsigned long current_time_us)
+{
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_START, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = time_to_refill_us, .papers = papers_needed};
+    append(&event);
+}
+
+static void binary_paper_refill_end(printer_t* printer, int refill_duration_us,
+    unsigned long current_time_us)
+{
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_END, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = refill_duration_us};
+    append(&event);
+}
+
+static void binary_simulation_stopped(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_STOPPED,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us,
+        .duration_us = stats->simulation_duration_us};
+    append(&event);
+}
+
+static void binary_simulation_checkpoint(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_CHECKPOINT, .time_us = get_time_in_us()};
+    append(&event);
+}
+
+static void binary_simulation_resumed(simulation_statistics_t* stats) {
+    unsigned long current_time_us = get_time_in_us();
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_RESUMED, .time_us = current_time_us,
+        .duration_us = current_time_us - stats->simulation_start_time_us};
+    append(&event);
+}
+
+void binary_handler_register(void) {
+    static const log_ops_t ops = {
+        .simulation_parameters = log_simulation_parameters,
+        .simulation_start = binary_simulation_start,
+        .simulation_end = binary_simulation_end,
+        .system_arrival = binary_system_arrival,
+        .dropped_job = binary_dropped_job,
+        .removed_job = binary_removed_job,
+        .queue_arrival = binary_queue_arrival,
+        .queue_departure = binary_queue_departure,
+        .printer_arrival = binary_printer_arrival,
+        .system_departure = binary_system_departure,
+        .paper_empty = binary_paper_empty,
+        .paper_refill_start = binary_paper_refill_start,
+        .paper_refill_end = binary_paper_refill_end,
+        .simulation_stopped = binary_simulation_stopped,
+        .simulation_checkpoint = binary_simulation_checkpoint,
+        .simulation_resumed = binary_simulation_resumed,
+        .statistics = log_statistics,
+    };
+    log_router_register_binary_handler(&ops);
+}
@@ -0,0 +1,135 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "binary_log.h"
+
+#define BINARY_LOG_INITIAL_RECORDS 65536
+
+static size_t file_size_for(size_t record_capacity) {
+    return sizeof(binary_log_header_t) + record_capacity * sizeof(log_event_t);
+}
+
+/**
+ * @brief Resizes the file and maps it again. munmap + mmap rather than mremap
+ *        so the writer also builds on macOS.
+ *
+ * @return TRUE on success, FALSE on failure (the old mapping is kept).
+ */
+static int remap(binary_log_writer_t* writer, size_t record_capacity) {
+    size_t size = file_size_for(record_capacity);
+    if (ftruncate(writer->fd, (off_t)size) != 0) return FALSE;
+    char* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (map == MAP_FAILED) return FALSE;
+
+    if (writer->map != NULL) munmap(writer->map, writer->map_size);
+    writer->map = map;
+    writer->map_size = size;
+    writer->record_capacity = record_capacity;
+    return TRUE;
+}
+
+int binary_log_open(binary_log_writer_t* writer, const char* path) {
+    writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        fprintf(stderr, "Error: Failed to open binary log %s for writing\n", path);
+        return FALSE;
+    }
+    writer->map = NULL;
+    writer->map_size = 0;
+    writer->record_count = 0;
+    if (!remap(writer, BINARY_LOG_INITIAL_RECORDS)) {
+        fprintf(stderr, "Error: Failed to map binary log %s\n", path);
+        close(writer->fd);
+        return FALSE;
+    }
+
+    binary_log_header_t header = {
+        .magic = BINARY_LOG_MAGIC,
+        .version = BINARY_LOG_VERSION,
+        .record_size = sizeof(log_event_t),
+        .record_count = 0
+    };
+    memcpy(writer->map, &header, sizeof(header));
+    pthread_mutex_init(&writer->mutex, NULL);
+    return TRUE;
+}
+
+int binary_log_append(binary_log_writer_t* writer, const log_event_t* event) {
+    pthread_mutex_lock(&writer->mutex);
+    if (writer->record_count == writer->record_capacity
+        && !remap(writer, writer->record_capacity * 2)) {
+        pthread_mutex_unlock(&writer->mutex);
+        return FALSE;
+    }
+    char* slot = writer->map + file_size_for(writer->record_count);
+    memcpy(slot, event, sizeof(log_event_t));
+    writer->record_count++;
+    pthread_mutex_unlock(&writer->mutex);
+    return TRUE;
+}
+
+void binary_log_close(binary_log_writer_t* writer) {
+    binary_log_header_t* header = (binary_log_header_t*)writer->map;
+    header->record_count = writer->record_count;
+    munmap(writer->map, writer->map_size);
+    if (ftruncate(writer->fd, (off_t)file_size_for(writer->record_count)) != 0) {
+        fprintf(stderr, "Warning: Failed to trim binary log\n");
+    }
+    close(writer->fd);
+    writer->map = NULL;
+    pthread_mutex_destroy(&writer->mutex);
+}
+
+int binary_log_read(binary_log_reader_t* reader, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Failed to open binary log %s\n", path);
+        return FALSE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(binary_log_header_t)) {
+        fprintf(stderr, "Error: %s is not a binary event log\n", path);
+        close(fd);
+        return FALSE;
+    }
+    const char* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Failed to map binary log %s\n", path);
+        return FALSE;
+    }
+
+    const binary_log_header_t* header = (const binary_log_header_t*)map;
+    if (header->magic != BINARY_LOG_MAGIC || header->version != BINARY_LOG_VERSION
+        || header->record_size != sizeof(log_event_t)) {
+        fprintf(stderr, "Error: %s is not a compatible binary event log\n", path);
+        munmap((void*)map, st.st_size);
+        return FALSE;
+    }
+
+    reader->map = map;
+    reader->map_size = st.st_size;
+    reader->records = (const log_event_t*)(map + sizeof(binary_log_header_t));
+    size_t available = (st.st_size - sizeof(binary_log_header_t)) / sizeof(log_event_t);
+    if (header->record_count > 0 && header->record_count <= available) {
+        reader->record_count = header->record_count;
+    } else {
+        // Not closed cleanly: the records end at the first unused (zeroed) slot
+        size_t count = 0;
+        while (count < available && reader->records[count].type != LOG_EVENT_NONE) count++;
+        reader->record_count = count;
+    }
+    return TRUE;
+}
+
+void binary_log_release(binary_log_reader_t* reader) {
+    munmap((void*)reader->map, reader->map_size);
+    reader->map = NULL;
+    reader->records = NULL;
+    reader->record_count = 0;
+}
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "checkpoint.h"
+#include "job_receiver.h"
+#include "linked_list.h"
+#include "printer.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+
+extern int g_debug;
+
+static void save_printer_state(const printer_t* printer, checkpoint_printer_state_t* state) {
+    state->current_paper_count = printer->current_paper_count;
+    state->total_papers_used = printer->total_papers_used;
+    state->jobs_printed_count = printer->jobs_printed_count;
+}
+
+static void restore_printer_state(printer_t* printer, const checkpoint_printer_state_t* state) {
+    printer->current_paper_count = state->current_paper_count;
+    printer->total_papers_used = state->total_papers_used;
+    printer->jobs_printed_count = state->jobs_printed_count;
+}
+
+// Shifts an absolute timestamp by the paused interval; 0 means "not set" and is kept
+static unsigned long rebase(unsigned long time_us, unsigned long offset_us) {
+    return time_us == 0 ? 0 : time_us + offset_us;
+}
+
+static void rebase_job(job_t* job, unsigned long offset_us) {
+    job->system_arrival_time_us = rebase(job->system_arrival_time_us, offset_us);
+    job->queue_arrival_time_us = rebase(job->queue_arrival_time_us, offset_us);
+    job->queue_departure_time_us = rebase(job->queue_departure_time_us, offset_us);
+    job->service_arrival_time_us = rebase(job->service_arrival_time_us, offset_us);
+    job->service_departure_time_us = rebase(job->service_departure_time_us, offset_us);
+}
+
+/**
+ * @brief Returns the instant the run stopped advancing: when the checkpoint
+ *        was requested, or the last arrival or queue change if one slipped in
+ *        just after, so no restored timestamp lies ahead of the resumed clock.
+ */
+static unsigned long quiesce_time(const simulation_context_t* ctx) {
+    unsigned long time_us = ctx->checkpoint_time_us;
+    if (ctx->previous_job_arrival_time_us > time_us) time_us = ctx->previous_job_arrival_time_us;
+    if (ctx->job_queue.last_interaction_time_us > time_us) time_us = ctx->job_queue.last_interaction_time_us;
+    return time_us;
+}
+
+/**
+ * @brief Writes a block as alternating zero runs and literal bytes, each pair
+ *        prefixed by its two lengths. The latency histograms and the unused
+ *        warm-up batch marks are mostly zero, so the statistics shrink from
+ *        tens of kilobytes to a few hundred bytes.
+ * @return TRUE on success, FALSE on a write error.
+ */
+static int write_zero_runs(FILE* file, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    size_t pos = 0;
+    while (pos < size) {
+        size_t zeros = 0;
+        while (pos + zeros < size && bytes[pos + zeros] == 0) zeros++;
+        // Literals run until the next stretch of zeros long enough to pay for a run header
+        size_t literal_start = pos + zeros;
+        size_t literal_end = literal_start;
+        size_t zero_stretch = 0;
+        while (literal_end + zero_stretch < size && zero_stretch < CHECKPOINT_MIN_ZERO_RUN) {
+            if (bytes[literal_end + zero_stretch] == 0) {
+                zero_stretch++;
+            } else {
+                literal_end += zero_stretch + 1;
+                zero_stretch = 0;
+            }
+        }
+        uint32_t lengths[2] = {(uint32_t)zeros, (uint32_t)(literal_end - literal_start)};
+        if (fwrite(lengths, sizeof(lengths), 1, file) != 1) return FALSE;
+        if (lengths[1] > 0 && fwrite(bytes + literal_start, lengths[1], 1, file) != 1) return FALSE;
+        pos = literal_end;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Reads a block written by write_zero_runs.
+ * @return TRUE on success, FALSE if the file is truncated or the runs overflow the block.
+ */
+static int read_zero_runs(FILE* file, void* data, size_t size) {
+    unsigned char* bytes = data;
+    memset(bytes, 0, size);
+    size_t pos = 0;
+    while (pos < size) {
+        uint32_t lengths[2];
+        if (fread(lengths, sizeof(lengths), 1, file) != 1) return FALSE;
+        if (lengths[0] > size - pos || lengths[1] > size - pos - lengths[0]) return FALSE;
+        pos += lengths[0];
+        if (lengths[1] > 0 && fread(bytes + pos, lengths[1], 1, file) != 1) return FALSE;
+        pos += lengths[1];
+        if (lengths[0] == 0 && lengths[1] == 0) return FALSE; // would never finish
+    }
+    return TRUE;
+}
+
+int checkpoint_save(simulation_context_t* ctx, const char* path) {
+    // Written beside the target and renamed over it, so a reader never sees half a file
+    char temp_path[MAXPATHLENGTH + 32];
+    int length = snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    if (length < 0 || (size_t)length >= sizeof(temp_path)) {
+        fprintf(stderr, "Error: Checkpoint path %s is too long\n", path);
+        return FALSE;
+    }
+    FILE* file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Failed to open checkpoint file %s for writing\n", temp_path);
+        return FALSE;
+    }
+
+    checkpoint_header_t header = {
+        .magic = CHECKPOINT_MAGIC,
+        .version = CHECKPOINT_VERSION,
+        .params_size = sizeof(simulation_model_parameters_t),
+        .stats_size = sizeof(simulation_statistics_t),
+        .job_size = sizeof(job_t),
+        .queue_length = (uint32_t)timed_queue_length(&ctx->job_queue),
+        .quiesced_at_us = quiesce_time(ctx)
+    };
+    checkpoint_state_t state = {
+        .rng_state = ctx->rng_state,
+        .next_job_index = ctx->next_job_index,
+        .previous_job_arrival_time_us = ctx->previous_job_arrival_time_us,
+        .queue_last_interaction_time_us = ctx->job_queue.last_interaction_time_us,
+        .next_job_arrival_time_us = ctx->next_job_arrival_time_us
+    };
+    save_printer_state(&ctx->printer1, &state.printers[0]);
+    save_printer_state(&ctx->printer2, &state.printers[1]);
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(&ctx->params.model, sizeof(ctx->params.model), 1, file) == 1
+        && write_zero_runs(file, &ctx->stats, sizeof(ctx->stats))
+        && fwrite(&state, sizeof(state), 1, file) == 1;
+
+    list_node_t* node = timed_queue_first(&ctx->job_queue);
+    for (uint32_t i = 0; ok && i < header.queue_length; i++, node = node->next) {
+        ok = fwrite(node->data, sizeof(job_t), 1, file) == 1;
+    }
+
+    if (fclose(file) != 0) ok = FALSE;
+    if (ok && rename(temp_path, path) != 0) ok = FALSE;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write checkpoint file %s\n", path);
+        remove(temp_path);
+        return FALSE;
+    }
+    if (g_debug) printf("Checkpoint saved to %s with %u queued jobs\n", path, header.queue_length);
+    return TRUE;
+}
+
+int checkpoint_load(simulation_context_t* ctx, const char* path, const simulation_parameters_t* run_options) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Failed to open checkpoint file %s\n", path);
+        return FALSE;
+    }
+
+    checkpoint_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != CHECKPOINT_MAGIC) {
+        fprintf(stderr, "Error: %s is not a checkpoint file\n", path);
+        fclose(file);
+        return FALSE;
+    }
+    if (header.version != CHECKPOINT_VERSION
+        || header.params_size != sizeof(simulation_model_parameters_t)
+        || header.stats_size != sizeof(simulation_statistics_t)
+        || header.job_size != sizeof(job_t)) {
+        fprintf(stderr, "Error: Checkpoint file %s was written by an incompatible build\n", path);
+        fclose(file);
+        return FALSE;
+    }
+
+    // The model comes from the file; how to run and report comes from this process
+    simulation_parameters_t params = *run_options;
+    params.resume_path[0] = '\0';
+    simulation_statistics_t stats;
+    checkpoint_state_t state;
+    if (fread(&params.model, sizeof(params.model), 1, file) != 1
+        || !read_zero_runs(file, &stats, sizeof(stats))
+        || fread(&state, sizeof(state), 1, file) != 1) {
+        fprintf(stderr, "Error: Checkpoint file %s is truncated\n", path);
+        fclose(file);
+        return FALSE;
+    }
+
+    simulation_context_init(ctx, &params);
+
+    unsigned long offset_us = get_time_in_us() - header.quiesced_at_us;
+    ctx->stats = stats;
+    ctx->stats.simulation_start_time_us = rebase(stats.simulation_start_time_us, offset_us);
+    ctx->rng_state = state.rng_state;
+    ctx->next_job_index = state.next_job_index;
+    ctx->previous_job_arrival_time_us = rebase(state.previous_job_arrival_time_us, offset_us);
+    ctx->next_job_arrival_time_us = rebase(state.next_job_arrival_time_us, offset_us);
+    restore_printer_state(&ctx->printer1, &state.printers[0]);
+    restore_printer_state(&ctx->printer2, &state.printers[1]);
+
+    for (uint32_t i = 0; i < header.queue_length; i++) {
+        job_t* job = malloc(sizeof(job_t));
+        if (job == NULL || fread(job, sizeof(job_t), 1, file) != 1) {
+            fprintf(stderr, "Error: Checkpoint file %s is truncated\n", path);
+            free(job);
+            fclose(file);
+            simulation_context_destroy(ctx);
+            return FALSE;
+        }
+        rebase_job(job, offset_us);
+        timed_queue_enqueue(&ctx->job_queue, job);
+    }
+    ctx->job_queue.last_interaction_time_us = rebase(state.queue_last_interaction_time_us, offset_us);
+
+    fclose(file);
+    if (g_debug) printf("Checkpoint restored from %s with %u queued jobs\n", path, header.queue_length);
+    return TRUE;
+}
@@ -5,20 +5,36 @@
 #include <signal.h>
 #include <unistd.h>
 
-#include "linked_list.h"
-#include "timed_queue.h"
-#include "job_receiver.h"
-#include "paper_refiller.h"
-#include "printer.h"
 #include "common.h"
 #include "preprocessing.h"
 #include "log_router.h"
 #include "console_handler.h"
-#include "simulation_stats.h"
+#include "binary_handler.h"
+#include "trace_handler.h"
+#include "simulation_context.h"
+#include "replication.h"
 #include "signalcatcher.h"
+#include "checkpoint.h"
+#include "stats_export.h"
 
 extern int g_debug;
-extern int g_terminate_now;
+
+/**
+ * @brief Waits for SIGINT and quiesces the run for a checkpoint instead of stopping it.
+ *
+ * @param arg Pointer to the running simulation context.
+ * @return NULL
+ */
+static void* sig_int_checkpoint_thread_func(void* arg) {
+    simulation_context_t* ctx = (simulation_context_t*)arg;
+    sigset_t set;
+    int sig;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigwait(&set, &sig);
+    simulation_context_request_checkpoint(ctx);
+    return NULL;
+}
 
 int main(int argc, char *argv[]) {
     sigset_t set;
@@ -26,153 +42,125 @@ int main(int argc, char *argv[]) {
     sigaddset(&set, SIGINT);
     sigprocmask(SIG_BLOCK, &set, (sigset_t*)0);
 
-    // --- Thread identifiers ---
-    pthread_t printer1_thread;
-    pthread_t printer2_thread;
-    pthread_t job_receiver_thread;
-    pthread_t paper_refill_thread;
-    pthread_t signal_catching_thread;
-
-    // --- Synchronization primitives (shared) ---
-    pthread_mutex_t job_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-    pthread_mutex_t paper_refill_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-    pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
-    pthread_mutex_t simulation_state_mutex = PTHREAD_MUTEX_INITIALIZER;
-    pthread_cond_t job_queue_not_empty_cv = PTHREAD_COND_INITIALIZER;
-    pthread_cond_t refill_needed_cv = PTHREAD_COND_INITIALIZER;
-    pthread_cond_t refill_supplier_cv = PTHREAD_COND_INITIALIZER;
-
     // --- Simulation state ---
     simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
-    simulation_statistics_t stats = (simulation_statistics_t){0};
-    int all_jobs_arrived = 0;
-    int all_jobs_served = 0;
-    timed_queue_t job_queue;
-    linked_list_t paper_refill_queue;
-    timed_queue_init(&job_queue);
-    list_init(&paper_refill_queue);
-
     if (!process_args(argc, argv, &params)) return 1;
 
-    // --- Thread argument structs ---
-    job_thread_args_t job_receiver_args = {
-        .job_queue_mutex = &job_queue_mutex,
-        .stats_mutex = &stats_mutex,
-        .simulation_state_mutex = &simulation_state_mutex,
-        .job_queue_not_empty_cv = &job_queue_not_empty_cv,
-        .job_queue = &job_queue,
-        .simulation_params = &params,
-        .stats = &stats,
-        .all_jobs_arrived = &all_jobs_arrived
-    };
-
-    // Concrete printer instances
-    printer_t printer1 = {.id = 1, .current_paper_count = params.printer_paper_capacity, .capacity = params.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
-    printer_t printer2 = {.id = 2, .current_paper_count = params.printer_paper_capacity, .capacity = params.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
-
-    printer_thread_args_t printer1_args = {
-        .paper_refill_queue_mutex = &paper_refill_queue_mutex,
-        .job_queue_mutex = &job_queue_mutex,
-        .stats_mutex = &stats_mutex,
-        .simulation_state_mutex = &simulation_state_mutex,
-        .job_queue_not_empty_cv = &job_queue_not_empty_cv,
-        .refill_needed_cv = &refill_needed_cv,
-        .refill_supplier_cv = &refill_supplier_cv,
-        .paper_refill_thread = &paper_refill_thread,
-        .job_queue = &job_queue,
-        .paper_refill_queue = &paper_refill_queue,
-        .params = &params,
-        .stats = &stats,
-        .all_jobs_served = &all_jobs_served,
-        .all_jobs_arrived = &all_jobs_arrived,
-        .printer = &printer1
-    };
-
-    printer_thread_args_t printer2_args = printer1_args;
-	printer2_args.printer = &printer2;
-
-    paper_refill_thread_args_t paper_refill_args = {
-        .paper_refill_queue_mutex = &paper_refill_queue_mutex,
-        .stats_mutex = &stats_mutex,
-        .simulation_state_mutex = &simulation_state_mutex,
-        .refill_needed_cv = &refill_needed_cv,
-        .refill_supplier_cv = &refill_supplier_cv,
-        .paper_refill_queue = &paper_refill_queue,
-        .params = &params,
-        .stats = &stats,
-        .all_jobs_served = &all_jobs_served
-    };
+    // Register console handler (stdout logger) via handler module
+    console_handler_register();
+    binary_handler_register();
+    trace_handler_register();
+
+    if (params.replications > 0) {
+        // Replications run unattended; let Ctrl+C terminate the whole study
+        sigprocmask(SIG_UNBLOCK, &set, (sigset_t*)0);
+        replication_run(&params);
+        return 0;
+    }
+
+    if (params.is_quiet) {
+        // Benchmark mode: no sink is attached, so emitting an event costs one atomic load
+        set_log_mode(LOG_MODE_QUIET);
+    } else if (params.binary_log_path[0] != '\0') {
+        // Binary mode: events go to a mapped file, decoded later with bin/evdecode
+        if (!binary_handler_open(params.binary_log_path, params.log_overflow_policy)) return 1;
+        set_log_mode(LOG_MODE_BINARY);
+    } else {
+        // Terminal mode: print to stdout
+        set_log_mode(LOG_MODE_TERMINAL);
+        if (!console_handler_start_async(params.log_overflow_policy)) return 1;
+    }
+    // Trace: every job's spans, next to whichever output the mode chose
+    if (params.trace_path[0] != '\0') {
+        static const log_filter_t s_trace_filter = LOG_FILTER_ALL;
+        if (!trace_handler_open(params.trace_path, params.log_overflow_policy)) return 1;
+        log_router_attach_sink(log_router_registered_handler(LOG_MODE_TRACE), &s_trace_filter);
+    }
+
+    simulation_context_t ctx;
+    int is_resumed = params.resume_path[0] != '\0';
+    if (is_resumed) {
+        if (!checkpoint_load(&ctx, params.resume_path, &params)) {
+            console_handler_stop_async();
+            binary_handler_close();
+            trace_handler_close(params.is_quiet);
+            return 1;
+        }
+    } else {
+        simulation_context_init(&ctx, &params);
+    }
+    int is_checkpointing = params.checkpoint_path[0] != '\0';
+    // The signal catcher logs for this run too
+    log_router_set_default_filter(&ctx.log_filter);
 
+    pthread_t signal_catching_thread;
     signal_catching_thread_args_t signal_catching_args = {
         .signal_set = &set,
-        .job_queue_mutex = &job_queue_mutex,
-        .simulation_state_mutex = &simulation_state_mutex,
-        .paper_refill_queue_mutex = &paper_refill_queue_mutex,
-        .stats_mutex = &stats_mutex,
-        .job_queue_not_empty_cv = &job_queue_not_empty_cv,
-        .refill_needed_cv = &refill_needed_cv,
-        .refill_supplier_cv = &refill_supplier_cv,
-        .job_queue = &job_queue,
-        .stats = &stats,
-        .job_receiver_thread = &job_receiver_thread,
-        .paper_refill_thread = &paper_refill_thread,
-        .all_jobs_arrived = &all_jobs_arrived
+        .job_queue_mutex = &ctx.job_queue_mutex,
+        .simulation_state_mutex = &ctx.simulation_state_mutex,
+        .paper_refill_queue_mutex = &ctx.paper_refill_queue_mutex,
+        .stats_mutex = &ctx.stats_mutex,
+        .job_queue_not_empty_cv = &ctx.job_queue_not_empty_cv,
+        .refill_needed_cv = &ctx.refill_needed_cv,
+        .refill_supplier_cv = &ctx.refill_supplier_cv,
+        .job_queue = &ctx.job_queue,
+        .stats = &ctx.stats,
+        .job_receiver_thread = &ctx.job_receiver_thread,
+        .paper_refill_thread = &ctx.paper_refill_thread,
+        .all_jobs_arrived = &ctx.all_jobs_arrived,
+        .terminate_now = &ctx.terminate_now
     };
 
-    // Register console handler (stdout logger) via handler module
-    console_handler_register();
-    // Terminal mode: print to stdout
-    set_log_mode(LOG_MODE_TERMINAL);
-    // --- Start of simulation logging ---
-    emit_simulation_parameters(&params);
-    emit_simulation_start(&stats);
+    // Start of simulation logging and pipeline threads
+    if (is_resumed) {
+        simulation_context_resume(&ctx);
+    } else {
+        simulation_context_start(&ctx);
+    }
 
-    // --- Create threads in order ---
-    // 1) Job receiver (produces jobs)
-    pthread_create(&job_receiver_thread, NULL, job_receiver_thread_func, &job_receiver_args);
-
-    // 2) Paper refiller (services refill requests)
-    pthread_create(&paper_refill_thread, NULL, paper_refill_thread_func, &paper_refill_args);
-
-    // 3) Printers (consumers)
-    pthread_create(&printer1_thread, NULL, printer_thread_func, &printer1_args);
-    pthread_create(&printer2_thread, NULL, printer_thread_func, &printer2_args);
-
-    // 4) Signal catcher (created last, after we have thread IDs to pass by pointer)
-    pthread_create(&signal_catching_thread, NULL, sig_int_catching_thread_func, &signal_catching_args);
+    // Signal catcher (created last, after we have thread IDs to pass by pointer)
+    if (is_checkpointing) {
+        pthread_create(&signal_catching_thread, NULL, sig_int_checkpoint_thread_func, &ctx);
+    } else {
+        pthread_create(&signal_catching_thread, NULL, sig_int_catching_thread_func, &signal_catching_args);
+    }
 
     // --- Wait for threads to finish ---
-    // Join producer first so no new jobs are created
-    pthread_join(job_receiver_thread, NULL);
-    if (g_debug) printf("job_receiver_thread joined\n");
-
-    // Join the printers
-    pthread_join(printer1_thread, NULL);
-    if (g_debug) printf("printer1 thread joined\n");
-    pthread_join(printer2_thread, NULL);
-    if (g_debug) printf("printer2 thread joined\n");
-
-    // Join paper refiller
-    pthread_join(paper_refill_thread, NULL);
-    if (g_debug) printf("paper_refill_thread joined\n");
+    simulation_context_join(&ctx);
 
     // Signal catcher might still be waiting for SIGINT; cancel and join
     pthread_cancel(signal_catching_thread);
     pthread_join(signal_catching_thread, NULL);
     if (g_debug) printf("signal catching thread joined\n");
 
-    // --- Final logging ---
-    emit_simulation_end(&stats);
-    emit_statistics(&stats);
+    // --- Final logging, or save the quiesced run ---
+    if (ctx.checkpoint_now) {
+        int is_saved = checkpoint_save(&ctx, params.checkpoint_path);
+        console_handler_stop_async();
+        binary_handler_close();
+        trace_handler_close(params.is_quiet);
+        if (is_saved) {
+            printf("Checkpoint written to %s, continue with -resume %s\n",
+                params.checkpoint_path, params.checkpoint_path);
+        }
+    } else {
+        simulation_context_finish(&ctx);
+        console_handler_stop_async();
+        binary_handler_close();
+        trace_handler_close(params.is_quiet);
+        // Statistics are kept by the pipeline whether or not anything was logged
+        if (params.is_quiet) {
+            log_statistics(&ctx.stats);
+            log_host_usage(&ctx.usage);
+            if (ctx.locks.count > 0) log_lock_profiles(&ctx.locks);
+        }
+        if (params.stats_out_path[0] != '\0') {
+            stats_export_append(params.stats_out_path, &ctx.params, &ctx.stats, STATS_EXPORT_ENGINE_CLI);
+        }
+    }
 
     // --- Cleanup synchronization primitives ---
-    pthread_mutex_destroy(&job_queue_mutex);
-    pthread_mutex_destroy(&paper_refill_queue_mutex);
-    pthread_mutex_destroy(&stats_mutex);
-    pthread_mutex_destroy(&simulation_state_mutex);
-    pthread_cond_destroy(&job_queue_not_empty_cv);
-    pthread_cond_destroy(&refill_needed_cv);
-    pthread_cond_destroy(&refill_supplier_cv);
+    simulation_context_destroy(&ctx);
 
     if (g_debug) printf("All threads joined and resources cleaned up.\n");
     return 0;
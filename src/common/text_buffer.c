@@ -0,0 +1,98 @@
+#include <string.h>
+
+#include "text_buffer.h"
+
+// "00" "01" ... "99": two digits per lookup halves the divisions
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+void text_buffer_init(text_buffer_t* tb, char* data, size_t capacity) {
+    tb->data = data;
+    tb->capacity = capacity;
+    tb->length = 0;
+    tb->is_truncated = 0;
+    if (capacity > 0) data[0] = '\0';
+}
+
+void text_append(text_buffer_t* tb, const char* str, size_t len) {
+    if (tb->length + len >= tb->capacity) {
+        tb->is_truncated = 1;
+        return;
+    }
+    memcpy(tb->data + tb->length, str, len);
+    tb->length += len;
+    tb->data[tb->length] = '\0';
+}
+
+void text_append_str(text_buffer_t* tb, const char* str) {
+    text_append(tb, str, strlen(str));
+}
+
+/**
+ * @brief Writes the digits of value right-aligned so they end at end.
+ *
+ * @return A pointer to the first digit written.
+ */
+static char* write_digits(char* end, unsigned long value) {
+    char* p = end;
+    while (value >= 100) {
+        unsigned long pair = (value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digit_pairs[value * 2 + 1];
+        *--p = digit_pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return p;
+}
+
+void text_append_uint(text_buffer_t* tb, unsigned long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* start = write_digits(end, value);
+    text_append(tb, start, end - start);
+}
+
+void text_append_int(text_buffer_t* tb, long value) {
+    if (value < 0) {
+        text_append_literal(tb, "-");
+        text_append_uint(tb, 0UL - (unsigned long)value);
+    } else {
+        text_append_uint(tb, (unsigned long)value);
+    }
+}
+
+void text_append_uint_padded(text_buffer_t* tb, unsigned long value, int width) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* start = write_digits(end, value);
+    if (width > (int)sizeof(digits)) width = sizeof(digits);
+    while (end - start < width) *--start = '0';
+    text_append(tb, start, end - start);
+}
+
+void text_append_ms(text_buffer_t* tb, unsigned long value_us) {
+    text_append_uint(tb, value_us / 1000);
+    text_append_literal(tb, ".");
+    text_append_uint_padded(tb, value_us % 1000, 3);
+}
+
+void text_append_time_prefix(text_buffer_t* tb, unsigned long time_us) {
+    text_append_uint_padded(tb, time_us / 1000, 8);
+    text_append_literal(tb, ".");
+    text_append_uint_padded(tb, time_us % 1000, 3);
+    text_append_literal(tb, "ms: ");
+}
@@ -1,6 +1,10 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "common.h"
 #include "preprocessing.h"
@@ -8,228 +12,341 @@
 #include "printer.h"
 #include "simulation_stats.h"
 #include "console_handler.h"
+#include "host_usage.h"
+#include "lock_profile.h"
 #include "log_router.h"
+#include "metrics_ring.h"
+#include "text_buffer.h"
 #include "timed_queue.h"
 #include "timeutils.h"
+#include "log_event.h"
+#include "event_ring.h"
 
-static unsigned long reference_time_us = 0;
-static unsigned long reference_end_time_us = 0;
+// --- Asynchronous writer ---
+/*
+ * Simulation threads log while holding the queue and stats locks, so they only
+ * capture a log_event_t and push it into a lock-free ring. A writer thread
+ * formats the records and writes them to stdout in large chunks. Without a
+ * running writer (tests, or before console_handler_start_async) lines are
+ * formatted and printed synchronously.
+ */
+#define CONSOLE_RING_CAPACITY      65536
+#define CONSOLE_WRITE_BUFFER_SIZE  (256 * 1024)
+#define CONSOLE_MAX_LINE_LENGTH    256
+#define CONSOLE_IDLE_SLEEP_US      1000
+
+static event_ring_t s_ring;
+static char* s_write_buffer;        // allocated before the writer starts, owned by it while it runs
+static pthread_t s_writer_thread;
+static int s_is_async = FALSE;      // set before producers start, cleared after they stop
+static atomic_int s_stop_writer;
+static atomic_ulong s_submitted;    // records pushed into the ring
+static atomic_ulong s_written;      // records written to stdout
+
+// Start of the run; owned by the writer thread in async mode
+static uint64_t reference_time_us = 0;
+
+static void write_to_stdout(const char* buf, size_t len) {
+    flockfile(stdout);
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+    funlockfile(stdout);
+}
 
 /**
- * @brief Logs the given time in milliseconds (ms) relative to the given reference
- * time.
- * 
- * @param time_us The time to log, in microseconds (us).
- * @param reference_time_us The reference time to log against, in microseconds (us).
+ * @brief Formats a record into the buffer, tracking the run's reference time.
  *
- * Sample output called 250ms (250,000us) after reference time is "00000251.457ms: "
+ * @return The number of characters written.
  */
-static void log_time(unsigned long time_us, unsigned long reference_time_us) {
-    time_us -= reference_time_us;
+static int format_event(const log_event_t* event, char* buf, size_t size) {
+    uint64_t event_reference_time_us = log_event_reference_time(event);
+    if (event_reference_time_us != 0) reference_time_us = event_reference_time_us;
+    return log_event_format_text(event, reference_time_us, buf, size);
+}
+
+static void* console_writer_thread_func(void* arg) {
+    char* buf = s_write_buffer;
+    size_t used = 0;
+    unsigned long formatted = 0;
 
-    int milliseconds = 0;
-    int microseconds = 0;
-    time_in_us_to_ms(time_us, &milliseconds, &microseconds);
-    printf(time_format, milliseconds, microseconds);
+    for (;;) {
+        log_event_t event;
+        int has_events = FALSE;
+        while (event_ring_pop(&s_ring, &event)) {
+            has_events = TRUE;
+            if (CONSOLE_WRITE_BUFFER_SIZE - used < CONSOLE_MAX_LINE_LENGTH) {
+                write_to_stdout(buf, used);
+                used = 0;
+                atomic_store(&s_written, formatted);
+            }
+            used += format_event(&event, buf + used, CONSOLE_WRITE_BUFFER_SIZE - used);
+            formatted++;
+        }
+        if (used > 0) {
+            write_to_stdout(buf, used);
+            used = 0;
+            atomic_store(&s_written, formatted);
+        }
+        if (!has_events) {
+            // Producers have stopped before the stop flag is raised, so an empty ring is final
+            if (atomic_load(&s_stop_writer)) break;
+            usleep(CONSOLE_IDLE_SLEEP_US);
+        }
+    }
+
+    return NULL;
+}
+
+int console_handler_start_async(int overflow_policy) {
+    if (s_is_async) return TRUE;
+    if (!event_ring_init(&s_ring, CONSOLE_RING_CAPACITY, sizeof(log_event_t), overflow_policy)) {
+        fprintf(stderr, "Error: Failed to allocate console event ring\n");
+        return FALSE;
+    }
+    // Everything the writer needs exists before producers see s_is_async
+    s_write_buffer = malloc(CONSOLE_WRITE_BUFFER_SIZE);
+    if (s_write_buffer == NULL) {
+        fprintf(stderr, "Error: Failed to allocate console write buffer\n");
+        event_ring_destroy(&s_ring);
+        return FALSE;
+    }
+    atomic_store(&s_stop_writer, 0);
+    atomic_store(&s_submitted, 0);
+    atomic_store(&s_written, 0);
+    if (pthread_create(&s_writer_thread, NULL, console_writer_thread_func, NULL) != 0) {
+        fprintf(stderr, "Error: Failed to start console writer thread\n");
+        free(s_write_buffer);
+        s_write_buffer = NULL;
+        event_ring_destroy(&s_ring);
+        return FALSE;
+    }
+    s_is_async = TRUE;
+    return TRUE;
+}
+
+void console_handler_flush(void) {
+    if (!s_is_async) {
+        fflush(stdout);
+        return;
+    }
+    unsigned long target = atomic_load(&s_submitted);
+    while (atomic_load(&s_written) < target) usleep(CONSOLE_IDLE_SLEEP_US);
+}
+
+void console_handler_stop_async(void) {
+    if (!s_is_async) return;
+    atomic_store(&s_stop_writer, 1);
+    pthread_join(s_writer_thread, NULL);
+    s_is_async = FALSE;
+    free(s_write_buffer);
+    s_write_buffer = NULL;
+
+    unsigned long dropped = event_ring_dropped(&s_ring);
+    if (dropped > 0) fprintf(stderr, "Warning: %lu log events dropped, console could not keep up\n", dropped);
+    event_ring_destroy(&s_ring);
+}
+
+/**
+ * @brief Hands a record to the writer thread, or prints it directly when no writer runs.
+ *
+ * @param event The record to log.
+ */
+static void submit_event(const log_event_t* event) {
+    if (s_is_async) {
+        if (event_ring_push(&s_ring, event)) atomic_fetch_add(&s_submitted, 1);
+        return;
+    }
+    char line[CONSOLE_MAX_LINE_LENGTH];
+    flockfile(stdout);
+    int len = format_event(event, line, sizeof(line));
+    fwrite(line, 1, len, stdout);
+    funlockfile(stdout);
 }
 
 void log_simulation_parameters(const simulation_parameters_t* params) {
+    console_handler_flush();
     flockfile(stdout);
     printf("================= Simulation parameters =================\n");
-    printf("  Number of jobs: %d\n", params->num_jobs);
-    printf("  Job arrival time: %.6g ms\n", params->job_arrival_time_us / 1000.0);
-    printf("  Printing rate: %.6g pages/sec\n", params->printing_rate);
-    printf("  Printer paper capacity: %d\n", params->printer_paper_capacity);
-    printf("  Queue capacity: %d\n", params->queue_capacity);
-    printf("  Refill rate: %.6g papers/sec\n", params->refill_rate);
-    printf("  Papers required (lower bound): %d\n", params->papers_required_lower_bound);
-    printf("  Papers required (upper bound): %d\n", params->papers_required_upper_bound);
+    printf("  Number of jobs: %d\n", params->model.num_jobs);
+    printf("  Job arrival time: %.6g ms\n", params->model.job_arrival_time_us / 1000.0);
+    printf("  Printing rate: %.6g pages/sec\n", params->model.printing_rate);
+    printf("  Printer paper capacity: %d\n", params->model.printer_paper_capacity);
+    printf("  Queue capacity: %d\n", params->model.queue_capacity);
+    printf("  Refill rate: %.6g papers/sec\n", params->model.refill_rate);
+    printf("  Papers required (lower bound): %d\n", params->model.papers_required_lower_bound);
+    printf("  Papers required (upper bound): %d\n", params->model.papers_required_upper_bound);
     funlockfile(stdout);
 }
 
 void log_simulation_start(simulation_statistics_t* stats) {
-    reference_time_us = get_time_in_us();
-    stats->simulation_start_time_us = reference_time_us;
-    flockfile(stdout);
-    log_time(reference_time_us, reference_time_us);
-    printf("simulation begins\n");
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_START, .time_us = stats->simulation_start_time_us};
+    submit_event(&event);
 }
 
 void log_simulation_end(simulation_statistics_t* stats) {
-    reference_end_time_us = get_time_in_us();
-    flockfile(stdout);
-    log_time(reference_end_time_us, reference_time_us);
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    printf("simulation ends, duration = %d.%03dms\n",
-        (int)(stats->simulation_duration_us / 1000), (int)(stats->simulation_duration_us % 1000));
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_END,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us,
+        .duration_us = stats->simulation_duration_us};
+    submit_event(&event);
 }
 
 /**
  * @brief Logs an event when a new job is created in the system or when a job is dropped
  * 
- * @param job_id The id of the job that has been created or dropped.
- * @param papers_required The number of papers required by the job.
+ * @param job The job that has been created or dropped.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds
- * @param current_job_arrival_time_us The current simulation time in microseconds.
  * @param is_dropped Whether the job was dropped (TRUE) or created (FALSE).
- * @param stats The simulation statistics to update.
- * @param ws_conn The WebSocket connection to publish the event to.
+ * @param stats The simulation statistics.
  */
-static void job_arrival_helper(int job_id, int papers_required,
-    unsigned long previous_job_arrival_time_us, unsigned long current_job_arrival_time_us,
+static void job_arrival_helper(const job_t* job, unsigned long previous_job_arrival_time_us,
     int is_dropped, simulation_statistics_t* stats)
 {
-    flockfile(stdout);
-    log_time(current_job_arrival_time_us, reference_time_us);
-
-    int inter_arrival_time_us = current_job_arrival_time_us - previous_job_arrival_time_us;
-    stats->total_inter_arrival_time_us += inter_arrival_time_us; // stats: avg job inter-arrival time
-    stats->total_jobs_arrived ++; // stats: total jobs arrived
-    int time_in_ms = inter_arrival_time_us / 1000;
-    int time_in_us = inter_arrival_time_us % 1000;
-    printf("job%d arrives, needs %d paper%s, inter-arrival time = %d.%03dms%s\n",
-        job_id, papers_required,
-        papers_required == 1 ? "" : "s", time_in_ms, time_in_us,
-        is_dropped ? ", dropped" : "");
-    funlockfile(stdout);
+    log_event_t event = {
+        .type = is_dropped ? LOG_EVENT_DROPPED_JOB : LOG_EVENT_SYSTEM_ARRIVAL,
+        .job_id = job->id,
+        .time_us = job->system_arrival_time_us,
+        .duration_us = job->system_arrival_time_us - previous_job_arrival_time_us,
+        .papers = job->papers_required
+    };
+    submit_event(&event);
 }
 
 void log_system_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
     simulation_statistics_t* stats) {
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, FALSE, stats);
+    job_arrival_helper(job, previous_job_arrival_time_us, FALSE, stats);
 }
 
 void log_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
     simulation_statistics_t* stats) {
-    stats->total_jobs_dropped += 1;
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, TRUE, stats);
+    job_arrival_helper(job, previous_job_arrival_time_us, TRUE, stats);
 }
 
 void log_removed_job(job_t* job) {
-    unsigned long current_time_us = get_time_in_us();
-    flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("job%d removed from system\n", job->id);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_REMOVED_JOB, .job_id = job->id, .time_us = get_time_in_us()};
+    submit_event(&event);
 }
 
 void log_queue_arrival(const job_t* job, simulation_statistics_t* stats,
     timed_queue_t* job_queue, unsigned long last_interaction_time_us)
 {
-    stats->area_num_in_job_queue_us +=
-        (job->queue_arrival_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) - 1); // -1 for the job that just entered the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_arrival_time_us;
-
-    flockfile(stdout);
-    log_time(job->queue_arrival_time_us, reference_time_us);
-    printf("job%d enters queue, queue length = %d\n", job->id,
-        timed_queue_length(job_queue));
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = job->id,
+        .time_us = job->queue_arrival_time_us, .queue_length = timed_queue_length(job_queue)};
+    submit_event(&event);
 }
 
 void log_queue_departure(const job_t* job, simulation_statistics_t* stats,
     timed_queue_t* job_queue, unsigned long last_interaction_time_us)
 {
-    stats->area_num_in_job_queue_us +=
-        (job->queue_departure_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) + 1); // +1 for the job that just left the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_departure_time_us;
-
-    flockfile(stdout);
-    log_time(job->queue_departure_time_us, reference_time_us);
-    int queue_duration = job->queue_departure_time_us - job->queue_arrival_time_us;
-    int time_ms = queue_duration / 1000;
-    int time_us = queue_duration % 1000;
-    printf("job%d leaves queue, time in queue = %d.%03dms, queue_length = %d\n",
-        job->id, time_ms, time_us, timed_queue_length(job_queue));
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = job->id,
+        .time_us = job->queue_departure_time_us,
+        .duration_us = job->queue_departure_time_us - job->queue_arrival_time_us,
+        .queue_length = timed_queue_length(job_queue)};
+    submit_event(&event);
 }
 
 void log_printer_arrival(const job_t* job, const printer_t* printer) {
-    flockfile(stdout);
-    log_time(job->service_arrival_time_us, reference_time_us);
-    printf("job%d begins service at printer%d, printing %d pages in about %dms\n",
-        job->id, printer->id, job->papers_required, job->service_time_requested_ms);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_PRINTER_ARRIVAL, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_arrival_time_us,
+        .duration_us = (uint64_t)job->service_time_requested_ms * 1000, .papers = job->papers_required};
+    submit_event(&event);
 }
 
 void log_system_departure(const job_t* job, const printer_t* printer,
     simulation_statistics_t* stats)
 {
-    flockfile(stdout);
-    log_time(job->service_departure_time_us, reference_time_us);
-
-    int system_time = job->service_departure_time_us - job->system_arrival_time_us;
-    stats->total_system_time_us += system_time; // stats: avg job system time
-    stats->sum_of_system_time_squared_us2 += system_time * system_time; // stats: stddev job system time
-    stats->total_jobs_served += 1; // stats: total jobs served
-    
-    int service_duration = job->service_departure_time_us - job->service_arrival_time_us;
-    if (printer->id == 1) {
-        stats->total_service_time_p1_us += service_duration; // stats: avg job service time
-        stats->jobs_served_by_printer1 += 1; // stats: total jobs served by printer 1
-        stats->printer1_paper_used += job->papers_required; // stats: total paper used by printer 1
-    } else if (printer->id == 2) {
-        stats->total_service_time_p2_us += service_duration; // stats: avg job service time
-        stats->jobs_served_by_printer2 += 1; // stats: total jobs served by printer 2
-        stats->printer2_paper_used += job->papers_required; // stats: total paper used by printer 2
-    }
-    stats->total_queue_wait_time_us +=
-        (job->queue_departure_time_us - job->queue_arrival_time_us); // stats: avg job queue wait time
-
-    int time_ms = service_duration / 1000;
-    int time_us = service_duration % 1000;
-    printf("job%d departs from printer%d, service time = %d.%03dms\n",
-        job->id, printer->id, time_ms, time_us);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_SYSTEM_DEPARTURE, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_departure_time_us,
+        .duration_us = job->service_departure_time_us - job->service_arrival_time_us};
+    submit_event(&event);
 }
 
 void log_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us) {
-    flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("printer%d does not have enough paper for job%d and is requesting refill\n", printer->id, job_id);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_PAPER_EMPTY, .printer_id = printer->id, .job_id = job_id,
+        .time_us = current_time_us};
+    submit_event(&event);
 }
 
 void log_paper_refill_start(printer_t* printer, int papers_needed, 
     int time_to_refill_us, unsigned long current_time_us)
 {
-    flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    int time_ms = time_to_refill_us / 1000;
-    int time_us = time_to_refill_us % 1000;
-    printf("printer%d starts refilling %d papers, estimated time = %d.%03dms\n",
-        printer->id, papers_needed, time_ms, time_us);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_START, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = time_to_refill_us, .papers = papers_needed};
+    submit_event(&event);
 }
 
 void log_paper_refill_end(printer_t* printer, int refill_duration_us,
     unsigned long current_time_us)
 {
-    flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    int time_ms = refill_duration_us / 1000;
-    int time_us = refill_duration_us % 1000;
-    printf("printer%d finishes refilling paper, actual time = %d.%03d ms\n",
-        printer->id, time_ms, time_us);
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_END, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = refill_duration_us};
+    submit_event(&event);
 }
 
 void log_ctrl_c_pressed(simulation_statistics_t* stats) {
-    reference_end_time_us = get_time_in_us();
-    flockfile(stdout);
-    log_time(reference_end_time_us, reference_time_us);
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    printf("simulation stopped, duration = %d.%03dms\n",
-        (int)(stats->simulation_duration_us / 1000), (int)(stats->simulation_duration_us % 1000));
-    funlockfile(stdout);
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_STOPPED,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us,
+        .duration_us = stats->simulation_duration_us};
+    submit_event(&event);
+}
+
+void log_simulation_checkpoint(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_CHECKPOINT, .time_us = get_time_in_us()};
+    submit_event(&event);
+}
+
+void log_simulation_resumed(simulation_statistics_t* stats) {
+    unsigned long current_time_us = get_time_in_us();
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_RESUMED, .time_us = current_time_us,
+        .duration_us = current_time_us - stats->simulation_start_time_us};
+    submit_event(&event);
+}
+
+/**
+ * @brief Prints the statistics after every event logged before them.
+ *
+ * @param stats A simulation statistics struct.
+ */
+static void log_statistics_after_events(simulation_statistics_t* stats) {
+    console_handler_flush();
+    log_statistics(stats);
+}
+
+void log_metrics_sample(const metrics_sample_t* sample, unsigned long number) {
+    char line[CONSOLE_MAX_LINE_LENGTH];
+    text_buffer_t tb;
+    text_buffer_init(&tb, line, sizeof(line));
+    text_append_time_prefix(&tb, sample->time_us);
+    text_append_literal(&tb, "Metrics: queue ");
+    text_append_int(&tb, sample->queue_length);
+    text_append_literal(&tb, ", printing ");
+    text_append_int(&tb, sample->jobs_in_service[0]);
+    text_append_literal(&tb, "/");
+    text_append_int(&tb, sample->jobs_in_service[1]);
+    text_append_literal(&tb, ", paper ");
+    text_append_int(&tb, sample->paper_level[0]);
+    text_append_literal(&tb, "/");
+    text_append_int(&tb, sample->paper_level[1]);
+    text_append_literal(&tb, ", served ");
+    text_append_uint(&tb, sample->jobs_served);
+    text_append_literal(&tb, ", dropped ");
+    text_append_uint(&tb, sample->jobs_dropped);
+    text_append_literal(&tb, " of ");
+    text_append_uint(&tb, sample->jobs_arrived);
+    text_append_literal(&tb, " arrived in ");
+    text_append_ms(&tb, sample->interval_us);
+    text_append_literal(&tb, " ms\n");
+    console_handler_flush();
+    write_to_stdout(tb.data, tb.length);
+}
+
+void log_host_usage_after_events(const host_usage_t* usage) {
+    console_handler_flush();
+    log_host_usage(usage);
+}
+
+void log_lock_statistics(const lock_profile_set_t* locks) {
+    console_handler_flush();
+    log_lock_profiles(locks);
 }
 
 void console_handler_register(void) {
@@ -248,7 +365,12 @@ void console_handler_register(void) {
         .paper_refill_start = log_paper_refill_start,
         .paper_refill_end = log_paper_refill_end,
         .simulation_stopped = log_ctrl_c_pressed,
-        .statistics = log_statistics,
+        .simulation_checkpoint = log_simulation_checkpoint,
+        .simulation_resumed = log_simulation_resumed,
+        .statistics = log_statistics_after_events,
+        .metrics_sample = log_metrics_sample,
+        .host_usage = log_host_usage_after_events,
+        .lock_statistics = log_lock_statistics,
     };
     log_router_register_console_handler(&ops);
 }
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "binary_log.h"
+#include "log_event.h"
+
+#define FORMAT_TEXT 0
+#define FORMAT_CSV  1
+#define FORMAT_JSON 2
+
+#define STDOUT_BUFFER_SIZE (1024 * 1024)
+
+static void usage(void) {
+    fprintf(stderr, "usage: ./bin/evdecode [-format text|csv|json] binary_log\n");
+}
+
+static void print_csv(const log_event_t* event, uint64_t reference_time_us) {
+    printf("%s,%llu,%llu,%d,%u,%llu,%d,%d\n", log_event_type_name(event->type),
+        (unsigned long long)event->time_us, (unsigned long long)(event->time_us - reference_time_us),
+        event->job_id, (unsigned int)event->printer_id, (unsigned long long)event->duration_us,
+        event->papers, event->queue_length);
+}
+
+static void print_json(const log_event_t* event, uint64_t reference_time_us, int is_first) {
+    printf("%s{\"type\":\"%s\",\"time_us\":%llu,\"relative_time_us\":%llu,\"job_id\":%d,"
+        "\"printer_id\":%u,\"duration_us\":%llu,\"papers\":%d,\"queue_length\":%d}",
+        is_first ? "" : ",\n", log_event_type_name(event->type),
+        (unsigned long long)event->time_us, (unsigned long long)(event->time_us - reference_time_us),
+        event->job_id, (unsigned int)event->printer_id, (unsigned long long)event->duration_us,
+        event->papers, event->queue_length);
+}
+
+int main(int argc, char* argv[]) {
+    int format = FORMAT_TEXT;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-format") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "text") == 0) format = FORMAT_TEXT;
+            else if (strcmp(name, "csv") == 0) format = FORMAT_CSV;
+            else if (strcmp(name, "json") == 0) format = FORMAT_JSON;
+            else {
+                fprintf(stderr, "Error: unknown format %s.\n", name);
+                usage();
+                return 1;
+            }
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (path == NULL) {
+        usage();
+        return 1;
+    }
+
+    binary_log_reader_t reader;
+    if (!binary_log_read(&reader, path)) return 1;
+
+    static char stdout_buffer[STDOUT_BUFFER_SIZE];
+    setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+
+    if (format == FORMAT_CSV) printf("type,time_us,relative_time_us,job_id,printer_id,duration_us,papers,queue_length\n");
+    if (format == FORMAT_JSON) printf("[\n");
+
+    // Times are shown relative to the start of the run, as on the console
+    uint64_t reference_time_us = reader.record_count > 0 ? reader.records[0].time_us : 0;
+    char line[256];
+    for (size_t i = 0; i < reader.record_count; i++) {
+        const log_event_t* event = &reader.records[i];
+        uint64_t event_reference_time_us = log_event_reference_time(event);
+        if (event_reference_time_us != 0) reference_time_us = event_reference_time_us;
+
+        if (format == FORMAT_TEXT) {
+            int len = log_event_format_text(event, reference_time_us, line, sizeof(line));
+            fwrite(line, 1, len, stdout);
+        } else if (format == FORMAT_CSV) {
+            print_csv(event, reference_time_us);
+        } else {
+            print_json(event, reference_time_us, i == 0);
+        }
+    }
+
+    if (format == FORMAT_JSON) printf("\n]\n");
+    fflush(stdout);
+    binary_log_release(&reader);
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "event_ring.h"
+
+/**
+ * @brief Returns the slot at a position.
+ */
+static event_ring_slot_t* slot_at(const event_ring_t* ring, size_t position) {
+    return (event_ring_slot_t*)(ring->slots + (position & ring->mask) * ring->slot_size);
+}
+
+int event_ring_init(event_ring_t* ring, size_t capacity, size_t record_size, int overflow_policy) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    size_t alignment = _Alignof(max_align_t);
+    ring->record_size = record_size;
+    ring->slot_size = (sizeof(event_ring_slot_t) + record_size + alignment - 1) / alignment * alignment;
+    ring->slots = malloc(size * ring->slot_size);
+    if (ring->slots == NULL) return FALSE;
+    ring->mask = size - 1;
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&slot_at(ring, i)->sequence, i);
+    }
+    ring->overflow_policy = overflow_policy;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->tail = 0;
+    return TRUE;
+}
+
+void event_ring_destroy(event_ring_t* ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+int event_ring_push(event_ring_t* ring, const void* record) {
+    size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    for (;;) {
+        event_ring_slot_t* slot = slot_at(ring, position);
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        long difference = (long)sequence - (long)position;
+
+        if (difference == 0) {
+            // The slot is free for this lap: claim it
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &position, position + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(slot + 1, record, ring->record_size);
+                atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+                return TRUE;
+            }
+            // position was reloaded by the failed exchange
+        } else if (difference < 0) {
+            // The consumer has not freed this slot yet: the ring is full
+            if (ring->overflow_policy == EVENT_RING_OVERFLOW_DROP) {
+                atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+                return FALSE;
+            }
+            sched_yield();
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        } else {
+            // Another producer claimed this position first
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+}
+
+int event_ring_pop(event_ring_t* ring, void* record) {
+    event_ring_slot_t* slot = slot_at(ring, ring->tail);
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != ring->tail + 1) return FALSE; // not yet published
+
+    memcpy(record, slot + 1, ring->record_size);
+    // Hand the slot back to producers for the next lap
+    atomic_store_explicit(&slot->sequence, ring->tail + ring->mask + 1, memory_order_release);
+    ring->tail++;
+    return TRUE;
+}
+
+unsigned long event_ring_dropped(event_ring_t* ring) {
+    return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
@@ -0,0 +1,139 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // RUSAGE_THREAD
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "common.h"
+#include "host_usage.h"
+
+// Thread names in report order
+static const char* const thread_names[HOST_USAGE_THREADS] = {
+    "Job receiver", "Paper refiller", "Printer 1", "Printer 2", "Metrics sampler", "Event loop"
+};
+
+static long s_event_loop_tid = 0; // set before any run starts
+
+static double timeval_to_sec(struct timeval time) {
+    return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+void thread_usage_read_self(thread_usage_t* usage) {
+#ifdef RUSAGE_THREAD
+    struct rusage rusage;
+    if (getrusage(RUSAGE_THREAD, &rusage) != 0) return;
+    usage->user_time_sec = timeval_to_sec(rusage.ru_utime);
+    usage->system_time_sec = timeval_to_sec(rusage.ru_stime);
+    usage->voluntary_switches = rusage.ru_nvcsw;
+    usage->involuntary_switches = rusage.ru_nivcsw;
+    usage->is_recorded = TRUE;
+#endif
+}
+
+void host_usage_set_event_loop_thread(void) {
+#ifdef __linux__
+    s_event_loop_tid = (long)syscall(SYS_gettid);
+#endif
+}
+
+/**
+ * @brief Reads another thread of this process from /proc/self/task/<tid>:
+ *        the CPU times from its stat file, the switches from its status file.
+ *
+ * @return TRUE on success, FALSE if the files could not be read.
+ */
+static int read_task_usage(long tid, thread_usage_t* usage) {
+    char path[64];
+    char line[512];
+    snprintf(path, sizeof(path), "/proc/self/task/%ld/stat", tid);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return FALSE;
+    int is_read = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    // The command name may hold spaces, so fields are counted from its closing parenthesis
+    char* fields = is_read ? strrchr(line, ')') : NULL;
+    unsigned long user_ticks, system_ticks;
+    if (fields == NULL || sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+            &user_ticks, &system_ticks) != 2) {
+        return FALSE;
+    }
+    long ticks_per_sec = sysconf(_SC_CLK_TCK);
+    usage->user_time_sec = (double)user_ticks / ticks_per_sec;
+    usage->system_time_sec = (double)system_ticks / ticks_per_sec;
+
+    snprintf(path, sizeof(path), "/proc/self/task/%ld/status", tid);
+    file = fopen(path, "r");
+    if (file == NULL) return FALSE;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        sscanf(line, "voluntary_ctxt_switches: %ld", &usage->voluntary_switches);
+        sscanf(line, "nonvoluntary_ctxt_switches: %ld", &usage->involuntary_switches);
+    }
+    fclose(file);
+    usage->is_recorded = TRUE;
+    return TRUE;
+}
+
+void host_usage_finish(host_usage_t* usage, double jobs) {
+    if (s_event_loop_tid != 0) read_task_usage(s_event_loop_tid, &usage->threads[HOST_USAGE_EVENT_LOOP]);
+
+    struct rusage rusage;
+    if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+#ifdef __APPLE__
+        usage->peak_rss_kb = rusage.ru_maxrss / 1024; // bytes on macOS
+#else
+        usage->peak_rss_kb = rusage.ru_maxrss;
+#endif
+    }
+    usage->jobs = jobs;
+}
+
+double host_usage_cpu_per_job_us(const host_usage_t* usage) {
+    if (usage->jobs <= 0) return 0;
+    double cpu_time_sec = 0;
+    for (int i = 0; i < HOST_USAGE_PIPELINE_THREADS; i++) {
+        cpu_time_sec += usage->threads[i].user_time_sec + usage->threads[i].system_time_sec;
+    }
+    return cpu_time_sec * 1000000.0 / usage->jobs;
+}
+
+int write_host_usage_to_buffer(const host_usage_t* usage, char* buf, int buf_size) {
+    int len = snprintf(buf, buf_size, "{\"peak_rss_kb\":%ld,\"cpu_per_job_us\":%.3g,\"threads\":[",
+        usage->peak_rss_kb, host_usage_cpu_per_job_us(usage));
+    int is_first = TRUE;
+    for (int i = 0; i < HOST_USAGE_THREADS && len < buf_size; i++) {
+        const thread_usage_t* thread = &usage->threads[i];
+        if (!thread->is_recorded) continue;
+        len += snprintf(buf + len, buf_size - len,
+            "%s{\"name\":\"%s\",\"user_sec\":%.6f,\"system_sec\":%.6f,\"voluntary_switches\":%ld,"
+            "\"involuntary_switches\":%ld}",
+            is_first ? "" : ",", thread_names[i], thread->user_time_sec, thread->system_time_sec,
+            thread->voluntary_switches, thread->involuntary_switches);
+        is_first = FALSE;
+    }
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, "]}");
+    return len;
+}
+
+void log_host_usage(const host_usage_t* usage) {
+    flockfile(stdout);
+    printf("\n");
+    printf("--- Host Usage ---\n");
+    printf("%-18s %10s %10s %10s %10s\n", "", "user ms", "system ms", "wakeups", "preempted");
+    for (int i = 0; i < HOST_USAGE_THREADS; i++) {
+        const thread_usage_t* thread = &usage->threads[i];
+        if (!thread->is_recorded) continue;
+        printf("%-18s %10.3f %10.3f %10ld %10ld\n", thread_names[i], thread->user_time_sec * 1000,
+            thread->system_time_sec * 1000, thread->voluntary_switches, thread->involuntary_switches);
+    }
+    printf("CPU Time per Job:                  %.3g us\n", host_usage_cpu_per_job_us(usage));
+    printf("Peak Resident Set Size:            %ld KB\n", usage->peak_rss_kb);
+    printf("=========================================================\n");
+    funlockfile(stdout);
+}
@@ -10,10 +10,10 @@
 #include "linked_list.h"
 #include "timed_queue.h"
 #include "timeutils.h"
+#include "lock_profile.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 
-extern int g_terminate_now;
 extern int g_debug;
 
 int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_required) {
@@ -40,7 +40,8 @@ int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_requi
 void drop_job_from_system(job_t* job, unsigned long previous_job_arrival_time_us, simulation_statistics_t* stats) {
     if (job == NULL) return;
     
-    // Log the dropped job (this will update statistics internally)
+    // The arrival itself was recorded when the job arrived
+    stats_record_job_dropped(stats);
     emit_dropped_job(job, previous_job_arrival_time_us, stats);
 
     // Free the job memory
@@ -85,11 +86,18 @@ void* job_receiver_thread_func(void* arg) {
     simulation_statistics_t* stats = args->stats;
     int* all_jobs_arrived = args->all_jobs_arrived;
 
-    unsigned long previous_job_arrival_time_us = stats->simulation_start_time_us;
+    int* next_job_index = args->next_job_index;
+    if (*args->previous_job_arrival_time_us == 0) {
+        *args->previous_job_arrival_time_us = stats->simulation_start_time_us;
+    }
+    unsigned long previous_job_arrival_time_us = *args->previous_job_arrival_time_us;
     
-    for (int job_id = 0; job_id < params->num_jobs; job_id++) {
-        const int inter_arrival_time_us = (int)params->job_arrival_time_us;
-        const int papers_required = random_between(params->papers_required_lower_bound, params->papers_required_upper_bound);
+    for (; *next_job_index < params->model.num_jobs; (*next_job_index)++) {
+        const int job_id = *next_job_index;
+        const unsigned int rng_state_before_job = *args->rng_state; // restored if the job never arrives
+        const int inter_arrival_time_us = (int)params->model.job_arrival_time_us;
+        const int papers_required = random_between_r(args->rng_state,
+            params->model.papers_required_lower_bound, params->model.papers_required_upper_bound);
 
         // Allocate and initialize job
         job_t* job = (job_t*)malloc(sizeof(job_t));
@@ -99,41 +107,54 @@ void* job_receiver_thread_func(void* arg) {
             continue;
         }
         
-        // Sleep for inter-arrival time
+        // Sleep for inter-arrival time; after a checkpoint, only for what was left of it
+        unsigned long now_us = get_time_in_us();
+        if (*args->next_job_arrival_time_us == 0) *args->next_job_arrival_time_us = now_us + inter_arrival_time_us;
+        unsigned long due_us = *args->next_job_arrival_time_us;
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-        usleep(inter_arrival_time_us);
+        if (due_us > now_us) usleep(due_us - now_us);
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
         
         // Check for termination signal
-        pthread_mutex_lock(simulation_state_mutex);
-        int terminate_now = g_terminate_now;
-        pthread_mutex_unlock(simulation_state_mutex);
+        profiled_mutex_lock(simulation_state_mutex);
+        int terminate_now = *(args->terminate_now);
+        int checkpoint_now = *(args->checkpoint_now);
+        profiled_mutex_unlock(simulation_state_mutex);
         if (terminate_now) {
             *all_jobs_arrived = 1;
             free(job);
             break;
         }
+        if (checkpoint_now) {
+            // The job has not arrived yet: generate it again after resuming, due at the same point
+            *args->rng_state = rng_state_before_job;
+            free(job);
+            break;
+        }
+        *args->next_job_arrival_time_us = 0;
         
         // Set system arrival time
         job->system_arrival_time_us = get_time_in_us();
-        pthread_mutex_lock(stats_mutex);
+        profiled_mutex_lock(stats_mutex);
+        stats_record_job_arrival(stats, previous_job_arrival_time_us, job->system_arrival_time_us);
         emit_system_arrival(job, previous_job_arrival_time_us, stats);
-        pthread_mutex_unlock(stats_mutex);
+        profiled_mutex_unlock(stats_mutex);
         
         // Check if job should be dropped (e.g., if queue is full)
-        pthread_mutex_lock(job_queue_mutex);
+        profiled_mutex_lock(job_queue_mutex);
 
         int queue_length = timed_queue_length(job_queue);
-        if (queue_length >= params->queue_capacity) {
+        if (queue_length >= params->model.queue_capacity) {
             // Drop the job
-            pthread_mutex_unlock(job_queue_mutex);
+            profiled_mutex_unlock(job_queue_mutex);
             unsigned long temp_arrival_time_us = job->system_arrival_time_us; // store before freeing
             
-            pthread_mutex_lock(stats_mutex);
+            profiled_mutex_lock(stats_mutex);
             drop_job_from_system(job, previous_job_arrival_time_us, stats);
-            pthread_mutex_unlock(stats_mutex);
+            profiled_mutex_unlock(stats_mutex);
 
             previous_job_arrival_time_us = temp_arrival_time_us;
+            *args->previous_job_arrival_time_us = previous_job_arrival_time_us;
             continue;
         }
         
@@ -143,28 +164,29 @@ void* job_receiver_thread_func(void* arg) {
         timed_queue_enqueue(job_queue, job);
         
         // Update statistics
-        pthread_mutex_lock(stats_mutex);
-        stats->max_job_queue_length = 
-            (queue_length > stats->max_job_queue_length) ? (queue_length) : stats->max_job_queue_length;
+        profiled_mutex_lock(stats_mutex);
+        stats_record_queue_arrival(stats, job->queue_arrival_time_us, queue_last_interaction_time_us, queue_length);
+        job_queue->last_interaction_time_us = job->queue_arrival_time_us;
         emit_queue_arrival(job, stats, job_queue, queue_last_interaction_time_us);
-        pthread_mutex_unlock(stats_mutex);
+        profiled_mutex_unlock(stats_mutex);
         
         previous_job_arrival_time_us = job->system_arrival_time_us;
+        *args->previous_job_arrival_time_us = previous_job_arrival_time_us;
         
         // Signal that a job is available
         pthread_cond_broadcast(job_queue_not_empty_cv);
-        pthread_mutex_unlock(job_queue_mutex);
+        profiled_mutex_unlock(job_queue_mutex);
     }
     
     // Mark that all jobs have arrived
-    pthread_mutex_lock(simulation_state_mutex);
+    profiled_mutex_lock(simulation_state_mutex);
     *all_jobs_arrived = 1;
-    pthread_mutex_unlock(simulation_state_mutex);
+    profiled_mutex_unlock(simulation_state_mutex);
     
     // Wake up any waiting threads
-    pthread_mutex_lock(job_queue_mutex);
+    profiled_mutex_lock(job_queue_mutex);
     pthread_cond_broadcast(job_queue_not_empty_cv);
-    pthread_mutex_unlock(job_queue_mutex);
+    profiled_mutex_unlock(job_queue_mutex);
     if (g_debug) printf("Job receiver thread gracefully exited\n");
     return NULL;
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "json_writer.h"
+
+void json_writer_init(json_writer_t* writer, FILE* file) {
+    writer->file = file;
+    writer->depth = 0;
+    writer->has_member[0] = FALSE;
+    writer->is_after_key = FALSE;
+}
+
+/**
+ * @brief Writes the comma that separates a value from the previous one in
+ *        the same array, unless the value completes an object member.
+ */
+static void begin_value(json_writer_t* writer) {
+    if (writer->is_after_key) {
+        writer->is_after_key = FALSE;
+        return;
+    }
+    if (writer->has_member[writer->depth]) fputc(',', writer->file);
+    writer->has_member[writer->depth] = TRUE;
+}
+
+static void open_level(json_writer_t* writer, char bracket) {
+    begin_value(writer);
+    fputc(bracket, writer->file);
+    if (writer->depth < JSON_WRITER_MAX_DEPTH) writer->depth++;
+    writer->has_member[writer->depth] = FALSE;
+}
+
+static void close_level(json_writer_t* writer, char bracket) {
+    fputc(bracket, writer->file);
+    if (writer->depth > 0) writer->depth--;
+}
+
+void json_begin_object(json_writer_t* writer) {
+    open_level(writer, '{');
+}
+
+void json_end_object(json_writer_t* writer) {
+    close_level(writer, '}');
+}
+
+void json_begin_array(json_writer_t* writer) {
+    open_level(writer, '[');
+}
+
+void json_end_array(json_writer_t* writer) {
+    close_level(writer, ']');
+}
+
+/**
+ * @brief Writes a quoted string, escaping quotes, backslashes and control characters.
+ */
+static void write_escaped(FILE* file, const char* value) {
+    fputc('"', file);
+    for (const unsigned char* p = (const unsigned char*)value; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        } else if (*p == '\n') {
+            fputs("\\n", file);
+        } else if (*p < 0x20) {
+            fprintf(file, "\\u%04x", *p);
+        } else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void json_key(json_writer_t* writer, const char* key) {
+    begin_value(writer);
+    write_escaped(writer->file, key);
+    fputc(':', writer->file);
+    writer->is_after_key = TRUE;
+}
+
+void json_format_number(char* buf, size_t buf_size, double value) {
+    // 15 digits read back exactly for most values and print 0.1 as 0.1
+    snprintf(buf, buf_size, "%.15g", value);
+    if (strtod(buf, NULL) != value) snprintf(buf, buf_size, "%.17g", value);
+}
+
+void json_number(json_writer_t* writer, double value) {
+    begin_value(writer);
+    if (isfinite(value)) {
+        char text[JSON_NUMBER_SIZE];
+        json_format_number(text, sizeof(text), value);
+        fputs(text, writer->file);
+    } else {
+        fputs("null", writer->file);
+    }
+}
+
+void json_string(json_writer_t* writer, const char* value) {
+    begin_value(writer);
+    write_escaped(writer->file, value);
+}
+
+void json_bool(json_writer_t* writer, int value) {
+    begin_value(writer);
+    fputs(value ? "true" : "false", writer->file);
+}
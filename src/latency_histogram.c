@@ -0,0 +1,59 @@
+#include <math.h>
+
+#include "latency_histogram.h"
+
+#define SUB_BUCKET_COUNT (1UL << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+/**
+ * @brief Returns the bucket of a value: the value itself below SUB_BUCKET_COUNT,
+ *        otherwise its top SUB_BUCKET_BITS bits offset by how far they were shifted.
+ */
+static int bucket_index(unsigned long value_us) {
+    if (value_us < SUB_BUCKET_COUNT) return (int)value_us;
+    int shift = (63 - __builtin_clzl(value_us)) - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1);
+    int index = shift * LATENCY_HISTOGRAM_HALF_SUB_BUCKETS + (int)(value_us >> shift);
+    return index < LATENCY_HISTOGRAM_BUCKETS ? index : LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns the largest value that falls in a bucket.
+ */
+static unsigned long bucket_highest_value(int index) {
+    if (index < (int)SUB_BUCKET_COUNT) return (unsigned long)index;
+    int shift = index / LATENCY_HISTOGRAM_HALF_SUB_BUCKETS - 1;
+    unsigned long sub_bucket = (unsigned long)(index - shift * LATENCY_HISTOGRAM_HALF_SUB_BUCKETS);
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void latency_histogram_record(latency_histogram_t* histogram, unsigned long value_us) {
+    histogram->counts[bucket_index(value_us)]++;
+    histogram->total_count++;
+    if (value_us > histogram->max_us) histogram->max_us = value_us;
+}
+
+unsigned long latency_histogram_count_at_or_below(const latency_histogram_t* histogram, unsigned long value_us) {
+    if (value_us >= histogram->max_us) return histogram->total_count;
+    unsigned long count = 0;
+    int last = bucket_index(value_us);
+    for (int i = 0; i < last; i++) count += histogram->counts[i];
+    // The value's own bucket counts only if the value is its upper end
+    if (bucket_highest_value(last) == value_us) count += histogram->counts[last];
+    return count;
+}
+
+unsigned long latency_histogram_percentile(const latency_histogram_t* histogram, double percentile) {
+    if (histogram->total_count == 0) return 0;
+    if (percentile >= 100.0) return histogram->max_us;
+
+    unsigned long rank = (unsigned long)ceil(percentile / 100.0 * histogram->total_count);
+    if (rank == 0) rank = 1;
+    unsigned long seen = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            unsigned long value_us = bucket_highest_value(i);
+            return value_us < histogram->max_us ? value_us : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
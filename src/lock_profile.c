@@ -0,0 +1,171 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "lock_profile.h"
+
+static __thread lock_profile_set_t* t_lock_profiles = NULL;
+
+/**
+ * @brief Returns the current time in nanoseconds from a clock that never steps.
+ */
+static unsigned long now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000000000UL + (unsigned long)now.tv_nsec;
+}
+
+/**
+ * @brief Returns the calling thread's profile of a primitive, or NULL if the
+ *        thread is unbound or the primitive is not in its set.
+ */
+static lock_profile_t* find_profile(const void* primitive) {
+    lock_profile_set_t* set = t_lock_profiles;
+    if (set == NULL) return NULL;
+    for (int i = 0; i < set->count; i++) {
+        if (set->profiles[i].primitive == primitive) return &set->profiles[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Records the end of a hold of a mutex. Called with the mutex held.
+ */
+static void record_release(lock_profile_t* profile) {
+    if (profile != NULL) latency_histogram_record(&profile->hold_ns, now_ns() - profile->acquired_at_ns);
+}
+
+void lock_profile_set_add(lock_profile_set_t* set, const char* name, const void* primitive, int is_condition) {
+    if (set->count >= LOCK_PROFILE_MAX) return;
+    lock_profile_t* profile = &set->profiles[set->count++];
+    profile->name = name;
+    profile->primitive = primitive;
+    profile->is_condition = is_condition;
+}
+
+void lock_profile_bind_thread(lock_profile_set_t* set) {
+    t_lock_profiles = set;
+}
+
+lock_profile_set_t* lock_profile_thread_set(void) {
+    return t_lock_profiles;
+}
+
+void profiled_mutex_lock(pthread_mutex_t* mutex) {
+    lock_profile_t* profile = find_profile(mutex);
+    if (profile == NULL) {
+        pthread_mutex_lock(mutex);
+        return;
+    }
+
+    if (pthread_mutex_trylock(mutex) == 0) {
+        profile->acquired_at_ns = now_ns();
+    } else {
+        unsigned long wait_start_ns = now_ns();
+        pthread_mutex_lock(mutex);
+        profile->acquired_at_ns = now_ns();
+        unsigned long wait_ns = profile->acquired_at_ns - wait_start_ns;
+        profile->contended_count++;
+        profile->total_wait_ns += wait_ns;
+        latency_histogram_record(&profile->wait_ns, wait_ns);
+    }
+    profile->acquire_count++;
+}
+
+void profiled_mutex_unlock(pthread_mutex_t* mutex) {
+    record_release(find_profile(mutex));
+    pthread_mutex_unlock(mutex);
+}
+
+/**
+ * @brief Records a condition wait that started at wait_start_ns and has just
+ *        returned, and the mutex taken back. Called with the mutex held.
+ */
+static void record_condition_wait(lock_profile_t* cond_profile, lock_profile_t* mutex_profile,
+    unsigned long wait_start_ns)
+{
+    unsigned long wake_ns = now_ns();
+    if (mutex_profile != NULL) mutex_profile->acquired_at_ns = wake_ns;
+    if (cond_profile != NULL) {
+        cond_profile->acquire_count++;
+        cond_profile->total_wait_ns += wake_ns - wait_start_ns;
+        latency_histogram_record(&cond_profile->wait_ns, wake_ns - wait_start_ns);
+    }
+}
+
+void profiled_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    lock_profile_t* mutex_profile = find_profile(mutex);
+    lock_profile_t* cond_profile = find_profile(cond);
+    if (mutex_profile == NULL && cond_profile == NULL) {
+        pthread_cond_wait(cond, mutex);
+        return;
+    }
+
+    record_release(mutex_profile);
+    unsigned long wait_start_ns = now_ns();
+    pthread_cond_wait(cond, mutex);
+    record_condition_wait(cond_profile, mutex_profile, wait_start_ns);
+}
+
+int profiled_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* deadline) {
+    lock_profile_t* mutex_profile = find_profile(mutex);
+    lock_profile_t* cond_profile = find_profile(cond);
+    if (mutex_profile == NULL && cond_profile == NULL) return pthread_cond_timedwait(cond, mutex, deadline);
+
+    record_release(mutex_profile);
+    unsigned long wait_start_ns = now_ns();
+    int result = pthread_cond_timedwait(cond, mutex, deadline);
+    record_condition_wait(cond_profile, mutex_profile, wait_start_ns);
+    return result;
+}
+
+// --- Reports ---
+/**
+ * @brief Returns a histogram's p50, p99 and maximum in microseconds.
+ */
+static void summarize_ns(const latency_histogram_t* histogram, double* values) {
+    values[0] = latency_histogram_percentile(histogram, 50.0) / 1000.0;
+    values[1] = latency_histogram_percentile(histogram, 99.0) / 1000.0;
+    values[2] = histogram->max_us / 1000.0;
+}
+
+int write_lock_profiles_to_buffer(const lock_profile_set_t* set, char* buf, int buf_size) {
+    int len = snprintf(buf, buf_size, "[");
+    for (int i = 0; i < set->count && len < buf_size; i++) {
+        const lock_profile_t* profile = &set->profiles[i];
+        double wait[3], hold[3];
+        summarize_ns(&profile->wait_ns, wait);
+        summarize_ns(&profile->hold_ns, hold);
+        len += snprintf(buf + len, buf_size - len,
+            "%s{\"name\":\"%s\",\"kind\":\"%s\",\"acquired\":%lu,\"contended\":%lu,\"total_wait_us\":%.3f,"
+            "\"wait_us\":{\"p50\":%.3g,\"p99\":%.3g,\"max\":%.3g},\"hold_us\":{\"p50\":%.3g,\"p99\":%.3g,\"max\":%.3g}}",
+            i > 0 ? "," : "", profile->name, profile->is_condition ? "condition" : "mutex",
+            profile->acquire_count, profile->contended_count, profile->total_wait_ns / 1000.0,
+            wait[0], wait[1], wait[2], hold[0], hold[1], hold[2]);
+    }
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, "]");
+    return len;
+}
+
+void log_lock_profiles(const lock_profile_set_t* set) {
+    flockfile(stdout);
+    printf("\n");
+    printf("--- Lock Contention (wait and hold in us) ---\n");
+    printf("%-25s %9s %9s %9s %9s %9s %9s %9s\n", "", "acquired", "contended",
+        "wait p50", "wait p99", "wait max", "hold p50", "hold p99");
+    for (int i = 0; i < set->count; i++) {
+        const lock_profile_t* profile = &set->profiles[i];
+        double wait[3], hold[3];
+        summarize_ns(&profile->wait_ns, wait);
+        summarize_ns(&profile->hold_ns, hold);
+        if (profile->is_condition) {
+            // A condition variable has waits only
+            printf("%-25s %9lu %9s %9.3g %9.3g %9.3g %9s %9s\n", profile->name, profile->acquire_count, "-",
+                wait[0], wait[1], wait[2], "-", "-");
+        } else {
+            printf("%-25s %9lu %9lu %9.3g %9.3g %9.3g %9.3g %9.3g\n", profile->name, profile->acquire_count,
+                profile->contended_count, wait[0], wait[1], wait[2], hold[0], hold[1]);
+        }
+    }
+    printf("=========================================================\n");
+    funlockfile(stdout);
+}
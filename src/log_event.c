@@ -0,0 +1,142 @@
+#include "log_event.h"
+#include "text_buffer.h"
+
+static const char* const event_type_names[LOG_EVENT_TYPE_COUNT] = {
+    [LOG_EVENT_NONE] = "none",
+    [LOG_EVENT_SIMULATION_START] = "simulation_start",
+    [LOG_EVENT_SIMULATION_END] = "simulation_end",
+    [LOG_EVENT_SYSTEM_ARRIVAL] = "system_arrival",
+    [LOG_EVENT_DROPPED_JOB] = "dropped_job",
+    [LOG_EVENT_REMOVED_JOB] = "removed_job",
+    [LOG_EVENT_QUEUE_ARRIVAL] = "queue_arrival",
+    [LOG_EVENT_QUEUE_DEPARTURE] = "queue_departure",
+    [LOG_EVENT_PRINTER_ARRIVAL] = "printer_arrival",
+    [LOG_EVENT_SYSTEM_DEPARTURE] = "system_departure",
+    [LOG_EVENT_PAPER_EMPTY] = "paper_empty",
+    [LOG_EVENT_PAPER_REFILL_START] = "paper_refill_start",
+    [LOG_EVENT_PAPER_REFILL_END] = "paper_refill_end",
+    [LOG_EVENT_SIMULATION_STOPPED] = "simulation_stopped",
+    [LOG_EVENT_SIMULATION_CHECKPOINT] = "simulation_checkpoint",
+    [LOG_EVENT_SIMULATION_RESUMED] = "simulation_resumed",
+};
+
+const char* log_event_type_name(int type) {
+    if (type < 0 || type >= LOG_EVENT_TYPE_COUNT) return "unknown";
+    return event_type_names[type];
+}
+
+uint64_t log_event_reference_time(const log_event_t* event) {
+    if (event->type == LOG_EVENT_SIMULATION_START) return event->time_us;
+    if (event->type == LOG_EVENT_SIMULATION_RESUMED) return event->time_us - event->duration_us;
+    return 0;
+}
+
+int log_event_format_text(const log_event_t* event, uint64_t reference_time_us, char* buf, size_t size) {
+    text_buffer_t tb;
+    text_buffer_init(&tb, buf, size);
+    text_append_time_prefix(&tb, event->time_us - reference_time_us);
+
+    switch (event->type) {
+        case LOG_EVENT_SIMULATION_START:
+            text_append_literal(&tb, "simulation begins\n");
+            break;
+        case LOG_EVENT_SIMULATION_END:
+            text_append_literal(&tb, "simulation ends, duration = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_SYSTEM_ARRIVAL:
+        case LOG_EVENT_DROPPED_JOB:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " arrives, needs ");
+            text_append_int(&tb, event->papers);
+            if (event->papers == 1) text_append_literal(&tb, " paper, inter-arrival time = ");
+            else text_append_literal(&tb, " papers, inter-arrival time = ");
+            text_append_ms(&tb, event->duration_us);
+            if (event->type == LOG_EVENT_DROPPED_JOB) text_append_literal(&tb, "ms, dropped\n");
+            else text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_REMOVED_JOB:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " removed from system\n");
+            break;
+        case LOG_EVENT_QUEUE_ARRIVAL:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " enters queue, queue length = ");
+            text_append_int(&tb, event->queue_length);
+            text_append_literal(&tb, "\n");
+            break;
+        case LOG_EVENT_QUEUE_DEPARTURE:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " leaves queue, time in queue = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, "ms, queue_length = ");
+            text_append_int(&tb, event->queue_length);
+            text_append_literal(&tb, "\n");
+            break;
+        case LOG_EVENT_PRINTER_ARRIVAL:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " begins service at printer");
+            text_append_uint(&tb, event->printer_id);
+            text_append_literal(&tb, ", printing ");
+            text_append_int(&tb, event->papers);
+            text_append_literal(&tb, " pages in about ");
+            text_append_uint(&tb, event->duration_us / 1000);
+            text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_SYSTEM_DEPARTURE:
+            text_append_literal(&tb, "job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " departs from printer");
+            text_append_uint(&tb, event->printer_id);
+            text_append_literal(&tb, ", service time = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_PAPER_EMPTY:
+            text_append_literal(&tb, "printer");
+            text_append_uint(&tb, event->printer_id);
+            text_append_literal(&tb, " does not have enough paper for job");
+            text_append_int(&tb, event->job_id);
+            text_append_literal(&tb, " and is requesting refill\n");
+            break;
+        case LOG_EVENT_PAPER_REFILL_START:
+            text_append_literal(&tb, "printer");
+            text_append_uint(&tb, event->printer_id);
+            text_append_literal(&tb, " starts refilling ");
+            text_append_int(&tb, event->papers);
+            text_append_literal(&tb, " papers, estimated time = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_PAPER_REFILL_END:
+            text_append_literal(&tb, "printer");
+            text_append_uint(&tb, event->printer_id);
+            text_append_literal(&tb, " finishes refilling paper, actual time = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, " ms\n");
+            break;
+        case LOG_EVENT_SIMULATION_STOPPED:
+            text_append_literal(&tb, "simulation stopped, duration = ");
+            text_append_ms(&tb, event->duration_us);
+            text_append_literal(&tb, "ms\n");
+            break;
+        case LOG_EVENT_SIMULATION_CHECKPOINT:
+            text_append_literal(&tb, "simulation pausing for checkpoint, jobs in service will complete\n");
+            break;
+        case LOG_EVENT_SIMULATION_RESUMED:
+            text_append_literal(&tb, "simulation resumes from checkpoint\n");
+            break;
+        default:
+            text_append_literal(&tb, "unknown event ");
+            text_append_uint(&tb, event->type);
+            text_append_literal(&tb, "\n");
+            break;
+    }
+    return tb.is_truncated ? 0 : (int)tb.length;
+}
@@ -0,0 +1,65 @@
+#include <string.h>
+
+#include "common.h"
+#include "log_filter.h"
+
+/**
+ * @brief Returns the lowest verbosity an event type is shown at, or -1 for
+ *        lifecycle events that are never filtered.
+ */
+static int event_verbosity(int event_type) {
+    switch (event_type) {
+        case LOG_EVENT_SYSTEM_ARRIVAL:
+        case LOG_EVENT_DROPPED_JOB:
+        case LOG_EVENT_REMOVED_JOB:
+        case LOG_EVENT_SYSTEM_DEPARTURE:
+            return LOG_VERBOSITY_JOBS;
+        case LOG_EVENT_QUEUE_ARRIVAL:
+        case LOG_EVENT_QUEUE_DEPARTURE:
+        case LOG_EVENT_PRINTER_ARRIVAL:
+        case LOG_EVENT_PAPER_EMPTY:
+        case LOG_EVENT_PAPER_REFILL_START:
+        case LOG_EVENT_PAPER_REFILL_END:
+            return LOG_VERBOSITY_ALL;
+        default:
+            return -1;
+    }
+}
+
+int log_filter_allows(const log_filter_t* filter, int event_type, int job_id) {
+    if (filter == NULL) return TRUE;
+    int verbosity = event_verbosity(event_type);
+    if (verbosity < 0) return TRUE;
+    if (verbosity > filter->verbosity) return FALSE;
+    if (filter->disabled_events & (1u << event_type)) return FALSE;
+    if (filter->sample_every > 1 && job_id % filter->sample_every != 0) return FALSE;
+    return TRUE;
+}
+
+int log_verbosity_from_name(const char* name) {
+    if (strcmp(name, "summary") == 0) return LOG_VERBOSITY_SUMMARY;
+    if (strcmp(name, "jobs") == 0) return LOG_VERBOSITY_JOBS;
+    if (strcmp(name, "all") == 0) return LOG_VERBOSITY_ALL;
+    return -1;
+}
+
+int log_event_mask_from_names(const char* names, unsigned int* mask) {
+    *mask = 0;
+    const char* start = names;
+    while (*start != '\0') {
+        size_t len = strcspn(start, ",");
+        int found = FALSE;
+        for (int type = 0; type < LOG_EVENT_TYPE_COUNT; type++) {
+            const char* name = log_event_type_name(type);
+            if (event_verbosity(type) >= 0 && strlen(name) == len && strncmp(start, name, len) == 0) {
+                *mask |= 1u << type;
+                found = TRUE;
+                break;
+            }
+        }
+        if (!found) return FALSE;
+        start += len;
+        if (*start == ',') start++;
+    }
+    return TRUE;
+}
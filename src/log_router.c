@@ -1,13 +1,42 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "common.h"
 #include "log_router.h"
+#include "log_event.h"
+#include "job_receiver.h"
+#include "printer.h"
 
 static int log_mode = LOG_MODE_TERMINAL;
 
 // Registered handlers provided by CLI/server at startup
 static const log_ops_t* s_console_handler = NULL;
 static const log_ops_t* s_websocket_handler = NULL;
-
-// Active backend pointer
-const log_ops_t* logger = NULL;
+static const log_ops_t* s_binary_handler = NULL;
+static const log_ops_t* s_trace_handler = NULL;
+
+/*
+ * Attached sinks. A slot's filter is written before its handlers are
+ * published and slots are never compacted, so emitting threads read the
+ * table without a lock; s_sink_slots bounds the scan.
+ */
+typedef struct log_sink {
+    _Atomic(const log_ops_t*) ops; // NULL = free slot
+    log_filter_t filter;
+    int has_filter;                // FALSE: the run's filter applies
+} log_sink_t;
+
+static log_sink_t s_sinks[LOG_ROUTER_MAX_SINKS];
+static atomic_int s_sink_slots = 0;      // slots in use or used before
+static pthread_mutex_t s_sinks_mutex = PTHREAD_MUTEX_INITIALIZER; // serializes attach and detach
+
+// Context of the run the calling thread belongs to
+static __thread void* t_log_context = NULL;
+
+// Filter of the run the calling thread belongs to; threads without one use the default
+static log_filter_t s_default_filter = LOG_FILTER_ALL;
+static __thread const log_filter_t* t_log_filter = NULL;
 
 void log_router_register_console_handler(const log_ops_t* ops) {
     s_console_handler = ops;
@@ -17,80 +46,201 @@ void log_router_register_websocket_handler(const log_ops_t* ops) {
     s_websocket_handler = ops;
 }
 
+void log_router_register_binary_handler(const log_ops_t* ops) {
+    s_binary_handler = ops;
+}
+
+void log_router_register_trace_handler(const log_ops_t* ops) {
+    s_trace_handler = ops;
+}
+
+const log_ops_t* log_router_registered_handler(int mode) {
+    if (mode == LOG_MODE_SERVER) return s_websocket_handler;
+    if (mode == LOG_MODE_BINARY) return s_binary_handler;
+    if (mode == LOG_MODE_TRACE) return s_trace_handler;
+    if (mode == LOG_MODE_TERMINAL) return s_console_handler;
+    return NULL;
+}
+
+int log_router_attach_sink(const log_ops_t* ops, const log_filter_t* filter) {
+    if (ops == NULL) return FALSE;
+    pthread_mutex_lock(&s_sinks_mutex);
+    int free_slot = -1;
+    for (int i = 0; i < LOG_ROUTER_MAX_SINKS; i++) {
+        const log_ops_t* attached = atomic_load(&s_sinks[i].ops);
+        if (attached == ops) {
+            pthread_mutex_unlock(&s_sinks_mutex);
+            return FALSE;
+        }
+        if (attached == NULL && free_slot < 0) free_slot = i;
+    }
+    if (free_slot < 0) {
+        pthread_mutex_unlock(&s_sinks_mutex);
+        fprintf(stderr, "Error: No free log sink slot\n");
+        return FALSE;
+    }
+    log_sink_t* sink = &s_sinks[free_slot];
+    sink->has_filter = filter != NULL;
+    if (filter != NULL) sink->filter = *filter;
+    atomic_store(&sink->ops, ops);
+    if (free_slot >= atomic_load(&s_sink_slots)) atomic_store(&s_sink_slots, free_slot + 1);
+    pthread_mutex_unlock(&s_sinks_mutex);
+    return TRUE;
+}
+
+void log_router_detach_sink(const log_ops_t* ops) {
+    pthread_mutex_lock(&s_sinks_mutex);
+    for (int i = 0; i < LOG_ROUTER_MAX_SINKS; i++) {
+        if (atomic_load(&s_sinks[i].ops) == ops) atomic_store(&s_sinks[i].ops, NULL);
+    }
+    pthread_mutex_unlock(&s_sinks_mutex);
+}
+
+int log_router_sink_count(void) {
+    int count = 0;
+    for (int i = 0; i < LOG_ROUTER_MAX_SINKS; i++) {
+        if (atomic_load(&s_sinks[i].ops) != NULL) count++;
+    }
+    return count;
+}
+
 void set_log_mode(int mode) {
     log_mode = mode;
-    if (log_mode == LOG_MODE_SERVER) {
-        logger = s_websocket_handler;
-    } else {
-        logger = s_console_handler;
-    }
+    pthread_mutex_lock(&s_sinks_mutex);
+    for (int i = 0; i < LOG_ROUTER_MAX_SINKS; i++) atomic_store(&s_sinks[i].ops, NULL);
+    pthread_mutex_unlock(&s_sinks_mutex);
+    log_router_attach_sink(log_router_registered_handler(log_mode), NULL);
 }
 
-static inline int has(const void* fn) { return fn != NULL; }
+void log_router_bind_thread_context(void* context) {
+    t_log_context = context;
+}
+
+void* log_router_thread_context(void) {
+    return t_log_context;
+}
 
+void log_router_set_default_filter(const log_filter_t* filter) {
+    s_default_filter = *filter;
+}
+
+void log_router_bind_thread_filter(const log_filter_t* filter) {
+    t_log_filter = filter;
+}
+
+const log_filter_t* log_router_thread_filter(void) {
+    return t_log_filter;
+}
+
+static inline const log_filter_t* run_filter(void) {
+    return t_log_filter != NULL ? t_log_filter : &s_default_filter;
+}
+
+/*
+ * Offers an event to every attached sink whose filter allows it. Events
+ * without a type (parameters, statistics) and lifecycle events reach every
+ * sink.
+ */
+#define route(event_type, job_id, handler, ...)                                              \
+    do {                                                                                     \
+        int slots_ = atomic_load_explicit(&s_sink_slots, memory_order_acquire);             \
+        for (int i_ = 0; i_ < slots_; i_++) {                                                \
+            const log_ops_t* ops_ = atomic_load_explicit(&s_sinks[i_].ops, memory_order_acquire); \
+            if (ops_ == NULL || ops_->handler == NULL) continue;                             \
+            const log_filter_t* filter_ = s_sinks[i_].has_filter ? &s_sinks[i_].filter : run_filter(); \
+            if ((event_type) != LOG_EVENT_NONE && !log_filter_allows(filter_, (event_type), (job_id))) continue; \
+            ops_->handler(__VA_ARGS__);                                                      \
+        }                                                                                    \
+    } while (0)
+
+/*
+ * The emit_* calls only present events: the pipeline has already recorded
+ * the statistics (see simulation_stats.h). With no sink attached they return
+ * after one load.
+ */
 void emit_simulation_parameters(const struct simulation_parameters* params) {
-    if (logger && has(logger->simulation_parameters)) logger->simulation_parameters(params);
+    route(LOG_EVENT_NONE, 0, simulation_parameters, params);
 }
 
 void emit_simulation_start(struct simulation_statistics* stats) {
-    if (logger && has(logger->simulation_start)) logger->simulation_start(stats);
+    route(LOG_EVENT_SIMULATION_START, 0, simulation_start, stats);
 }
 
 void emit_simulation_end(struct simulation_statistics* stats) {
-    if (logger && has(logger->simulation_end)) logger->simulation_end(stats);
+    route(LOG_EVENT_SIMULATION_END, 0, simulation_end, stats);
 }
 
 void emit_system_arrival(struct job* job, unsigned long previous_job_arrival_time_us,
                          struct simulation_statistics* stats) {
-    if (logger && has(logger->system_arrival)) logger->system_arrival(job, previous_job_arrival_time_us, stats);
+    route(LOG_EVENT_SYSTEM_ARRIVAL, job->id, system_arrival, job, previous_job_arrival_time_us, stats);
 }
 
 void emit_dropped_job(struct job* job, unsigned long previous_job_arrival_time_us,
                       struct simulation_statistics* stats) {
-    if (logger && has(logger->dropped_job)) logger->dropped_job(job, previous_job_arrival_time_us, stats);
+    route(LOG_EVENT_DROPPED_JOB, job->id, dropped_job, job, previous_job_arrival_time_us, stats);
 }
 
 void emit_removed_job(struct job* job) {
-    if (logger && has(logger->removed_job)) logger->removed_job(job);
+    route(LOG_EVENT_REMOVED_JOB, job->id, removed_job, job);
 }
 
 void emit_queue_arrival(const struct job* job, struct simulation_statistics* stats,
                         struct timed_queue* job_queue, unsigned long last_interaction_time_us) {
-    if (logger && has(logger->queue_arrival)) logger->queue_arrival(job, stats, job_queue, last_interaction_time_us);
+    route(LOG_EVENT_QUEUE_ARRIVAL, job->id, queue_arrival, job, stats, job_queue, last_interaction_time_us);
 }
 
 void emit_queue_departure(const struct job* job, struct simulation_statistics* stats,
                           struct timed_queue* job_queue, unsigned long last_interaction_time_us) {
-    if (logger && has(logger->queue_departure)) logger->queue_departure(job, stats, job_queue, last_interaction_time_us);
+    route(LOG_EVENT_QUEUE_DEPARTURE, job->id, queue_departure, job, stats, job_queue, last_interaction_time_us);
 }
 
 void emit_printer_arrival(const struct job* job, const struct printer* printer) {
-    if (logger && has(logger->printer_arrival)) logger->printer_arrival(job, printer);
+    route(LOG_EVENT_PRINTER_ARRIVAL, job->id, printer_arrival, job, printer);
 }
 
 void emit_system_departure(const struct job* job, const struct printer* printer,
                            struct simulation_statistics* stats) {
-    if (logger && has(logger->system_departure)) logger->system_departure(job, printer, stats);
+    route(LOG_EVENT_SYSTEM_DEPARTURE, job->id, system_departure, job, printer, stats);
 }
 
 void emit_paper_empty(struct printer* printer, int job_id, unsigned long current_time_us) {
-    if (logger && has(logger->paper_empty)) logger->paper_empty(printer, job_id, current_time_us);
+    route(LOG_EVENT_PAPER_EMPTY, job_id, paper_empty, printer, job_id, current_time_us);
 }
 
 void emit_paper_refill_start(struct printer* printer, int papers_needed,
                              int time_to_refill_us, unsigned long current_time_us) {
-    if (logger && has(logger->paper_refill_start)) logger->paper_refill_start(printer, papers_needed, time_to_refill_us, current_time_us);
+    route(LOG_EVENT_PAPER_REFILL_START, 0, paper_refill_start, printer, papers_needed, time_to_refill_us, current_time_us);
 }
 
 void emit_paper_refill_end(struct printer* printer, int refill_duration_us,
                            unsigned long current_time_us) {
-    if (logger && has(logger->paper_refill_end)) logger->paper_refill_end(printer, refill_duration_us, current_time_us);
+    route(LOG_EVENT_PAPER_REFILL_END, 0, paper_refill_end, printer, refill_duration_us, current_time_us);
 }
 
 void emit_simulation_stopped(struct simulation_statistics* stats) {
-    if (logger && has(logger->simulation_stopped)) logger->simulation_stopped(stats);
+    route(LOG_EVENT_SIMULATION_STOPPED, 0, simulation_stopped, stats);
+}
+
+void emit_simulation_checkpoint(struct simulation_statistics* stats) {
+    route(LOG_EVENT_SIMULATION_CHECKPOINT, 0, simulation_checkpoint, stats);
+}
+
+void emit_simulation_resumed(struct simulation_statistics* stats) {
+    route(LOG_EVENT_SIMULATION_RESUMED, 0, simulation_resumed, stats);
 }
 
 void emit_statistics(struct simulation_statistics* stats) {
-    if (logger && has(logger->statistics)) logger->statistics(stats);
+    route(LOG_EVENT_NONE, 0, statistics, stats);
+}
+
+void emit_metrics_sample(const struct metrics_sample* sample, unsigned long number) {
+    route(LOG_EVENT_NONE, 0, metrics_sample, sample, number);
+}
+
+void emit_host_usage(const struct host_usage* usage) {
+    route(LOG_EVENT_NONE, 0, host_usage, usage);
+}
+
+void emit_lock_statistics(const struct lock_profile_set* locks) {
+    route(LOG_EVENT_NONE, 0, lock_statistics, locks);
 }
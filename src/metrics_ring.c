@@ -0,0 +1,57 @@
+#include "metrics_ring.h"
+
+void metrics_ring_init(metrics_ring_t* ring) {
+    ring->count = 0;
+    pthread_mutex_init(&ring->mutex, NULL);
+}
+
+void metrics_ring_destroy(metrics_ring_t* ring) {
+    pthread_mutex_destroy(&ring->mutex);
+}
+
+unsigned long metrics_ring_push(metrics_ring_t* ring, const metrics_sample_t* sample) {
+    pthread_mutex_lock(&ring->mutex);
+    unsigned long number = ring->count++;
+    ring->samples[number % METRICS_RING_CAPACITY] = *sample;
+    pthread_mutex_unlock(&ring->mutex);
+    return number;
+}
+
+int metrics_ring_read(metrics_ring_t* ring, unsigned long since, metrics_sample_t* samples, int max_samples,
+    unsigned long* first)
+{
+    pthread_mutex_lock(&ring->mutex);
+    unsigned long oldest = ring->count > METRICS_RING_CAPACITY ? ring->count - METRICS_RING_CAPACITY : 0;
+    if (since < oldest) since = oldest;
+    int copied = 0;
+    for (unsigned long n = since; n < ring->count && copied < max_samples; n++) {
+        samples[copied++] = ring->samples[n % METRICS_RING_CAPACITY];
+    }
+    pthread_mutex_unlock(&ring->mutex);
+    *first = since;
+    return copied;
+}
+
+void metrics_sample_append_values(text_buffer_t* tb, const metrics_sample_t* sample) {
+    text_append_literal(tb, "[");
+    text_append_uint(tb, sample->time_us);
+    text_append_literal(tb, ",");
+    text_append_uint(tb, sample->interval_us);
+    text_append_literal(tb, ",");
+    text_append_int(tb, sample->queue_length);
+    text_append_literal(tb, ",");
+    text_append_int(tb, sample->jobs_in_service[0]);
+    text_append_literal(tb, ",");
+    text_append_int(tb, sample->jobs_in_service[1]);
+    text_append_literal(tb, ",");
+    text_append_int(tb, sample->paper_level[0]);
+    text_append_literal(tb, ",");
+    text_append_int(tb, sample->paper_level[1]);
+    text_append_literal(tb, ",");
+    text_append_uint(tb, sample->jobs_arrived);
+    text_append_literal(tb, ",");
+    text_append_uint(tb, sample->jobs_served);
+    text_append_literal(tb, ",");
+    text_append_uint(tb, sample->jobs_dropped);
+    text_append_literal(tb, "]");
+}
@@ -9,11 +9,11 @@
 #include "printer.h"
 #include "linked_list.h"
 #include "preprocessing.h"
+#include "lock_profile.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 void debug_refiller(int papers_supplied) {
     printf("Debug: Paper Refiller supplied %d papers\n", papers_supplied);
@@ -40,19 +40,19 @@ void* paper_refill_thread_func(void* arg) {
 
     if (g_debug) printf("Paper refiller thread started\n");
     while (1) {
-        pthread_mutex_lock(args->paper_refill_queue_mutex);
+        profiled_mutex_lock(args->paper_refill_queue_mutex);
 
         for (;;) {
             // Safely check shared flags
-            pthread_mutex_lock(args->simulation_state_mutex);
-            int terminate_now = g_terminate_now;
+            profiled_mutex_lock(args->simulation_state_mutex);
+            int terminate_now = *(args->terminate_now) || *(args->checkpoint_now);
             int are_all_jobs_served = *(args->all_jobs_served);
-            pthread_mutex_unlock(args->simulation_state_mutex);
+            profiled_mutex_unlock(args->simulation_state_mutex);
 
             if (terminate_now || is_exit_condition_met(are_all_jobs_served)) {
                 if (g_debug) printf("Paper refiller thread signaled to terminate\n");
                 pthread_cond_broadcast(args->refill_needed_cv); // wake up printer threads to let them exit if needed
-                pthread_mutex_unlock(args->paper_refill_queue_mutex);
+                profiled_mutex_unlock(args->paper_refill_queue_mutex);
                 goto exit_refiller;
             }
 
@@ -66,12 +66,12 @@ void* paper_refill_thread_func(void* arg) {
              *
              * Wait until signaled to refill paper or terminate
              */
-            pthread_cond_wait(args->refill_supplier_cv, args->paper_refill_queue_mutex);
+            profiled_cond_wait(args->refill_supplier_cv, args->paper_refill_queue_mutex);
         }
         unsigned long refill_start_time_us = get_time_in_us();
         list_node_t* elem = list_pop_left(args->paper_refill_queue);
         printer_t* printer = (printer_t*)elem->data;
-        pthread_mutex_unlock(args->paper_refill_queue_mutex); // unlock while refilling
+        profiled_mutex_unlock(args->paper_refill_queue_mutex); // unlock while refilling
 
         // Refill paper
         int papers_needed = printer->capacity - printer->current_paper_count;
@@ -79,7 +79,7 @@ void* paper_refill_thread_func(void* arg) {
             if (g_debug) printf("Debug: Paper Refiller found printer %d already full\n", printer->id);
         }
 
-        int time_to_refill_us = (unsigned long)((papers_needed / args->params->refill_rate) * 1000000);
+        int time_to_refill_us = (unsigned long)((papers_needed / args->params->model.refill_rate) * 1000000);
         emit_paper_refill_start(printer, papers_needed, time_to_refill_us, refill_start_time_us);
         
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
@@ -91,19 +91,17 @@ void* paper_refill_thread_func(void* arg) {
         emit_paper_refill_end(printer, refill_duration_us, refill_end_time_us);
 
         // Done refilling: update printer state and simulation stats
+        profiled_mutex_lock(args->stats_mutex);
         printer->current_paper_count += papers_needed;
-        pthread_mutex_lock(args->stats_mutex);
-        args->stats->papers_refilled += papers_needed;
-        args->stats->total_refill_service_time_us += refill_end_time_us - refill_start_time_us;
-        args->stats->paper_refill_events++;
-        pthread_mutex_unlock(args->stats_mutex);
+        stats_record_paper_refill(args->stats, papers_needed, refill_duration_us);
+        profiled_mutex_unlock(args->stats_mutex);
         free(elem);
         if (g_debug) debug_refiller(papers_needed);
 
         // Notify waiting printers that refill is done
-        pthread_mutex_lock(args->paper_refill_queue_mutex);
+        profiled_mutex_lock(args->paper_refill_queue_mutex);
         pthread_cond_broadcast(args->refill_needed_cv);
-        pthread_mutex_unlock(args->paper_refill_queue_mutex);
+        profiled_mutex_unlock(args->paper_refill_queue_mutex);
     }
 exit_refiller:
     if (g_debug) printf("Paper refiller gracefully exited\n");
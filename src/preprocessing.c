@@ -1,3 +1,5 @@
+#include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -5,9 +7,13 @@
 #include <math.h>
 #include "common.h"
 #include "preprocessing.h"
+#include "event_ring.h"
+#include "log_filter.h"
+#include "mongoose.h"
+#include "steady_state.h"
+#include "ws_bridge.h"
 
 int g_debug = 0;
-int g_terminate_now = 0;
 
 void usage() {
     fprintf(stderr, "usage: ./bin/cli [-debug] [-help] [-num num_jobs] [-q queue_capacity]\n");
@@ -15,12 +21,26 @@ void usage() {
     fprintf(stderr, "                 [-s service_rate] [-ref refill_rate]\n");
     fprintf(stderr, "                 [-papers_lower papers_required_lower_bound]\n");
     fprintf(stderr, "                 [-papers_upper papers_required_upper_bound]\n");
+    fprintf(stderr, "                 [-seed seed] [-reps replications]\n");
+    fprintf(stderr, "                 [-precision relative_half_width]\n");
+    fprintf(stderr, "                 [-sessions max_sessions] [-log-overflow block|drop]\n");
+    fprintf(stderr, "                 [-log-level summary|jobs|all] [-log-off event[,event...]]\n");
+    fprintf(stderr, "                 [-log-sample N] [-ws-flush-ms ms] [-ws-batch-bytes bytes]\n");
+    fprintf(stderr, "                 [-ws-budget bytes] [-ws-overflow drop|summary|pause]\n");
+    fprintf(stderr, "                 [-ws-lag-cap bytes] [-ws-text-events] [-quiet]\n");
+    fprintf(stderr, "                 [-metrics-ms ms] [-lock-stats] [-warmup N|Ts|auto]\n");
+    fprintf(stderr, "                 [-checkpoint path] [-resume path] [-binlog path]\n");
+    fprintf(stderr, "                 [-trace path] [-stats-out path.csv|path.json]\n");
 }
 
 int random_between(int lower, int upper) {
     return (rand() % (upper - lower + 1)) + lower;
 }
 
+int random_between_r(unsigned int* state, int lower, int upper) {
+    return (rand_r(state) % (upper - lower + 1)) + lower;
+}
+
 void swap_bounds(int* lower, int* upper) {
     int temp = *lower;
     *lower = (int)fmin(*upper, *lower);
@@ -51,31 +71,127 @@ int process_args(int argc, char *argv[], simulation_parameters_t* params) {
         }
 
         if (strcmp(argv[i], "-num") == 0) {
-            params->num_jobs = atoi(argv[++i]);
-            if (!is_positive_integer("num_jobs", params->num_jobs)) return FALSE;
+            params->model.num_jobs = atoi(argv[++i]);
+            if (!is_positive_integer("num_jobs", params->model.num_jobs)) return FALSE;
         } else if (strcmp(argv[i], "-q") == 0) {
-            params->queue_capacity = atoi(argv[++i]);
-            if (!is_positive_integer("queue_capacity", params->queue_capacity)) return FALSE;
+            params->model.queue_capacity = atoi(argv[++i]);
+            if (!is_positive_integer("queue_capacity", params->model.queue_capacity)) return FALSE;
         } else if (strcmp(argv[i], "-papers_lower") == 0) {
-            params->papers_required_lower_bound = atoi(argv[++i]);
-            if (!is_positive_integer("papers_required_lower_bound", params->papers_required_lower_bound)) return FALSE;
+            params->model.papers_required_lower_bound = atoi(argv[++i]);
+            if (!is_positive_integer("papers_required_lower_bound", params->model.papers_required_lower_bound)) return FALSE;
         } else if (strcmp(argv[i], "-papers_upper") == 0) {
-            params->papers_required_upper_bound = atoi(argv[++i]);
-            if (!is_positive_integer("papers_required_upper_bound", params->papers_required_upper_bound)) return FALSE;
+            params->model.papers_required_upper_bound = atoi(argv[++i]);
+            if (!is_positive_integer("papers_required_upper_bound", params->model.papers_required_upper_bound)) return FALSE;
         } else if (strcmp(argv[i], "-p_cap") == 0) {
-            params->printer_paper_capacity = atoi(argv[++i]);
-            if (!is_positive_integer("printer_paper_capacity", params->printer_paper_capacity)) return FALSE;
+            params->model.printer_paper_capacity = atoi(argv[++i]);
+            if (!is_positive_integer("printer_paper_capacity", params->model.printer_paper_capacity)) return FALSE;
         } else if (strcmp(argv[i], "-arr") == 0) {
             double arrival_rate = atof(argv[++i]);
             if (!is_positive_double("arrival_rate", arrival_rate)) return FALSE;
-            params->job_arrival_time_us = (int)(1000000.0 / arrival_rate);
+            params->model.job_arrival_time_us = (int)(1000000.0 / arrival_rate);
         } else if (strcmp(argv[i], "-s") == 0) {
             double service_rate = atof(argv[++i]);
             if (!is_positive_double("service_rate", service_rate)) return FALSE;
-            params->printing_rate = service_rate;
+            params->model.printing_rate = service_rate;
         } else if (strcmp(argv[i], "-ref") == 0) {
-            params->refill_rate = atof(argv[++i]);
-            if (!is_positive_double("refill_rate", params->refill_rate)) return FALSE;
+            params->model.refill_rate = atof(argv[++i]);
+            if (!is_positive_double("refill_rate", params->model.refill_rate)) return FALSE;
+        } else if (strcmp(argv[i], "-seed") == 0) {
+            int seed = atoi(argv[++i]);
+            if (!is_positive_integer("seed", seed)) return FALSE;
+            params->model.seed = (unsigned int)seed;
+        } else if (strcmp(argv[i], "-reps") == 0) {
+            params->replications = atoi(argv[++i]);
+            if (!is_positive_integer("replications", params->replications)) return FALSE;
+            if (params->replications < 2) {
+                fprintf(stderr, "Error: replications must be at least 2 to form a confidence interval.\n");
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-precision") == 0) {
+            params->precision = atof(argv[++i]);
+            if (!is_positive_double("precision", params->precision)) return FALSE;
+        } else if (strcmp(argv[i], "-sessions") == 0) {
+            params->max_sessions = atoi(argv[++i]);
+            if (!is_positive_integer("max_sessions", params->max_sessions)) return FALSE;
+        } else if (strcmp(argv[i], "-log-overflow") == 0) {
+            const char* policy = argv[++i];
+            if (strcmp(policy, "block") == 0) {
+                params->log_overflow_policy = EVENT_RING_OVERFLOW_BLOCK;
+            } else if (strcmp(policy, "drop") == 0) {
+                params->log_overflow_policy = EVENT_RING_OVERFLOW_DROP;
+            } else {
+                fprintf(stderr, "Error: log overflow policy must be block or drop, got %s.\n", policy);
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-log-level") == 0) {
+            params->log_verbosity = log_verbosity_from_name(argv[++i]);
+            if (params->log_verbosity < 0) {
+                fprintf(stderr, "Error: log level must be summary, jobs or all, got %s.\n", argv[i]);
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-log-off") == 0) {
+            if (!log_event_mask_from_names(argv[++i], &params->log_disabled_events)) {
+                fprintf(stderr, "Error: unknown event type in %s.\n", argv[i]);
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-log-sample") == 0) {
+            params->log_sample_every = atoi(argv[++i]);
+            if (!is_positive_integer("log_sample", params->log_sample_every)) return FALSE;
+        } else if (strcmp(argv[i], "-ws-flush-ms") == 0) {
+            params->ws_flush_interval_ms = atoi(argv[++i]);
+            if (params->ws_flush_interval_ms < 0) {
+                fprintf(stderr, "Error: ws_flush_ms must be zero or a positive integer.\n");
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-ws-batch-bytes") == 0) {
+            params->ws_batch_bytes = atoi(argv[++i]);
+            if (!is_positive_integer("ws_batch_bytes", params->ws_batch_bytes)) return FALSE;
+        } else if (strcmp(argv[i], "-ws-budget") == 0) {
+            params->ws_budget_bytes = atoi(argv[++i]);
+            if (!is_positive_integer("ws_budget", params->ws_budget_bytes)) return FALSE;
+        } else if (strcmp(argv[i], "-ws-overflow") == 0) {
+            const char* policy = argv[++i];
+            if (strcmp(policy, "drop") == 0) {
+                params->ws_overflow_policy = WS_OVERFLOW_DROP_OLDEST;
+            } else if (strcmp(policy, "summary") == 0) {
+                params->ws_overflow_policy = WS_OVERFLOW_SUMMARY;
+            } else if (strcmp(policy, "pause") == 0) {
+                params->ws_overflow_policy = WS_OVERFLOW_PAUSE;
+            } else {
+                fprintf(stderr, "Error: websocket overflow policy must be drop, summary or pause, got %s.\n", policy);
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-ws-lag-cap") == 0) {
+            params->ws_lag_cap_bytes = atoi(argv[++i]);
+            if (!is_positive_integer("ws_lag_cap", params->ws_lag_cap_bytes)) return FALSE;
+        } else if (strcmp(argv[i], "-ws-text-events") == 0) {
+            params->ws_text_events = 1;
+        } else if (strcmp(argv[i], "-quiet") == 0) {
+            params->is_quiet = 1;
+        } else if (strcmp(argv[i], "-metrics-ms") == 0) {
+            params->metrics_interval_ms = atoi(argv[++i]);
+            if (params->metrics_interval_ms < 0) {
+                fprintf(stderr, "Error: metrics_ms must be zero or a positive integer.\n");
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-lock-stats") == 0) {
+            params->is_profiling_locks = 1;
+        } else if (strcmp(argv[i], "-warmup") == 0) {
+            if (!warmup_from_arg(argv[++i], &params->model.warmup_method, &params->model.warmup_amount)) {
+                fprintf(stderr, "Error: warmup must be a positive job count, seconds such as 30s or auto, got %s.\n",
+                    argv[i]);
+                return FALSE;
+            }
+        } else if (strcmp(argv[i], "-checkpoint") == 0) {
+            snprintf(params->checkpoint_path, sizeof(params->checkpoint_path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "-resume") == 0) {
+            snprintf(params->resume_path, sizeof(params->resume_path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "-binlog") == 0) {
+            snprintf(params->binary_log_path, sizeof(params->binary_log_path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "-trace") == 0) {
+            snprintf(params->trace_path, sizeof(params->trace_path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "-stats-out") == 0) {
+            snprintf(params->stats_out_path, sizeof(params->stats_out_path), "%s", argv[++i]);
         } else if (strcmp(argv[i], "-debug") == 0) {
             g_debug = 1;
         } else {
@@ -83,7 +199,129 @@ int process_args(int argc, char *argv[], simulation_parameters_t* params) {
             usage();
             return FALSE;
         }
-        swap_bounds(&params->papers_required_lower_bound, &params->papers_required_upper_bound);
+        swap_bounds(&params->model.papers_required_lower_bound, &params->model.papers_required_upper_bound);
+    }
+    if (params->precision > 0 && params->replications == 0) {
+        fprintf(stderr, "Error: precision needs replications (-reps) to form confidence intervals.\n");
+        return FALSE;
+    }
+    if (params->replications > 0) {
+        // A study runs many fresh, unlogged runs: options about a single run's input or output do not apply
+        const char* single_run_option = params->resume_path[0] != '\0' ? "-resume"
+            : params->checkpoint_path[0] != '\0' ? "-checkpoint"
+            : params->trace_path[0] != '\0' ? "-trace"
+            : params->binary_log_path[0] != '\0' ? "-binlog"
+            : params->is_quiet ? "-quiet"
+            : NULL;
+        if (single_run_option != NULL) {
+            fprintf(stderr, "Error: %s cannot be combined with replications (-reps).\n", single_run_option);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Fields of simulation_parameters_t that "start {json}" may set
+typedef enum {START_FIELD_INT, START_FIELD_DOUBLE, START_FIELD_COUNT_MS, START_FIELD_FLAG} start_field_kind_t;
+static const struct {
+    const char* name;
+    start_field_kind_t kind;
+    size_t offset;
+} s_start_fields[] = {
+    {"job_arrival_time_us",         START_FIELD_DOUBLE,   offsetof(simulation_parameters_t, model.job_arrival_time_us)},
+    {"papers_required_lower_bound", START_FIELD_INT,      offsetof(simulation_parameters_t, model.papers_required_lower_bound)},
+    {"papers_required_upper_bound", START_FIELD_INT,      offsetof(simulation_parameters_t, model.papers_required_upper_bound)},
+    {"queue_capacity",              START_FIELD_INT,      offsetof(simulation_parameters_t, model.queue_capacity)},
+    {"printing_rate",               START_FIELD_DOUBLE,   offsetof(simulation_parameters_t, model.printing_rate)},
+    {"printer_paper_capacity",      START_FIELD_INT,      offsetof(simulation_parameters_t, model.printer_paper_capacity)},
+    {"refill_rate",                 START_FIELD_DOUBLE,   offsetof(simulation_parameters_t, model.refill_rate)},
+    {"num_jobs",                    START_FIELD_INT,      offsetof(simulation_parameters_t, model.num_jobs)},
+    {"seed",                        START_FIELD_INT,      offsetof(simulation_parameters_t, model.seed)},
+    {"metrics_interval_ms",         START_FIELD_COUNT_MS, offsetof(simulation_parameters_t, metrics_interval_ms)},
+    {"is_profiling_locks",          START_FIELD_FLAG,     offsetof(simulation_parameters_t, is_profiling_locks)},
+};
+#define START_FIELD_COUNT (int)(sizeof(s_start_fields) / sizeof(s_start_fields[0]))
+
+/**
+ * @brief Reads a JSON number that must be a whole number within the range of int.
+ */
+static int json_get_int(struct mg_str value, int* result) {
+    double number;
+    if (!mg_json_get_num(value, "$", &number)) return FALSE;
+    // Range first: casting a double outside int is undefined
+    if (!(number >= INT_MIN && number <= INT_MAX) || number != (int)number) return FALSE;
+    *result = (int)number;
+    return TRUE;
+}
+
+/**
+ * @brief Sets one field of a "start {json}" object, validated as the matching command line option.
+ *
+ * @param name The field name.
+ * @param value The JSON value.
+ * @param params The parameters to update.
+ * @return TRUE on success, FALSE if the field is unknown or its value invalid.
+ */
+static int parse_start_field(const char* name, struct mg_str value, simulation_parameters_t* params) {
+    if (strcmp(name, "warmup") == 0) {
+        // "auto", a job count or seconds such as "30s", as -warmup
+        char* text = value.len > 0 && value.buf[0] == '"' ? mg_json_get_str(value, "$") : NULL;
+        char number[32];
+        if (text == NULL) {
+            if (value.len >= sizeof(number)) return FALSE;
+            memcpy(number, value.buf, value.len);
+            number[value.len] = '\0';
+        }
+        int is_valid = warmup_from_arg(text != NULL ? text : number, &params->model.warmup_method,
+            &params->model.warmup_amount);
+        free(text);
+        return is_valid;
     }
+    for (int i = 0; i < START_FIELD_COUNT; i++) {
+        if (strcmp(name, s_start_fields[i].name) != 0) continue;
+        void* field = (char*)params + s_start_fields[i].offset;
+        int integer;
+        double number;
+        bool flag;
+        switch (s_start_fields[i].kind) {
+        case START_FIELD_INT:
+            if (!json_get_int(value, &integer) || !is_positive_integer(name, integer)) return FALSE;
+            *(int*)field = integer;
+            return TRUE;
+        case START_FIELD_DOUBLE:
+            if (!mg_json_get_num(value, "$", &number) || !is_positive_double(name, number)) return FALSE;
+            *(double*)field = number;
+            return TRUE;
+        case START_FIELD_COUNT_MS:
+            if (!json_get_int(value, &integer) || integer < 0) return FALSE;
+            *(int*)field = integer;
+            return TRUE;
+        case START_FIELD_FLAG:
+            if (!mg_json_get_bool(value, "$", &flag)) return FALSE;
+            *(int*)field = flag;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int parse_start_params(const char* json, size_t json_len, simulation_parameters_t* params, char* bad_field,
+    size_t bad_field_size) {
+    simulation_parameters_t parsed = *params;
+    struct mg_str object = mg_str_n(json, json_len);
+    snprintf(bad_field, bad_field_size, "%s", "");
+    if (object.len < 2 || object.buf[0] != '{' || mg_json_get(object, "$", NULL) < 0) return FALSE;
+    struct mg_str key, value;
+    size_t ofs = 0;
+    while ((ofs = mg_json_next(object, ofs, &key, &value)) > 0) {
+        char* name = mg_json_get_str(key, "$");
+        if (name == NULL) return FALSE;
+        int is_valid = parse_start_field(name, value, &parsed);
+        snprintf(bad_field, bad_field_size, "%s", name);
+        free(name);
+        if (!is_valid) return FALSE;
+    }
+    swap_bounds(&parsed.model.papers_required_lower_bound, &parsed.model.papers_required_upper_bound);
+    *params = parsed;
     return TRUE;
-}
\ No newline at end of file
+}
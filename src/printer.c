@@ -6,6 +6,7 @@
 #include "preprocessing.h"
 #include "common.h"
 #include "timeutils.h"
+#include "lock_profile.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 #include "linked_list.h"
@@ -14,7 +15,6 @@
 #include "printer.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 /**
  * @brief Checks if the exit condition for the server thread is met.
@@ -38,14 +38,14 @@ void* printer_thread_func(void* arg) {
     while (1) {
         for (;;) {
             // Safely check shared flags
-            pthread_mutex_lock(args->simulation_state_mutex);
-            int terminate = g_terminate_now;
-            pthread_mutex_unlock(args->simulation_state_mutex);
+            profiled_mutex_lock(args->simulation_state_mutex);
+            int terminate = *(args->terminate_now) || *(args->checkpoint_now);
+            profiled_mutex_unlock(args->simulation_state_mutex);
 
-            pthread_mutex_lock(args->job_queue_mutex);
+            profiled_mutex_lock(args->job_queue_mutex);
             if (terminate || is_exit_condition_met(*(args->all_jobs_arrived), args->job_queue)) {
                 if (g_debug) printf("Printer %d is terminating or finished\n", args->printer->id);
-                pthread_mutex_unlock(args->job_queue_mutex);
+                profiled_mutex_unlock(args->job_queue_mutex);
                 goto exit_printer;
             }
 
@@ -54,8 +54,8 @@ void* printer_thread_func(void* arg) {
             }
 
             // Wait for a job to be available
-            pthread_cond_wait(args->job_queue_not_empty_cv, args->job_queue_mutex);
-            pthread_mutex_unlock(args->job_queue_mutex);
+            profiled_cond_wait(args->job_queue_not_empty_cv, args->job_queue_mutex);
+            profiled_mutex_unlock(args->job_queue_mutex);
         }
 
         // Check if there are enough papers for the job at the front of the queue
@@ -63,28 +63,31 @@ void* printer_thread_func(void* arg) {
         job_t* job_to_dequeue = (job_t*)elem->data;
         if (job_to_dequeue->papers_required > args->printer->current_paper_count) {
             // Not enough paper for the job at the front of the queue
-            pthread_mutex_unlock(args->job_queue_mutex);
-            pthread_mutex_lock(args->paper_refill_queue_mutex);
+            profiled_mutex_unlock(args->job_queue_mutex);
+            profiled_mutex_lock(args->paper_refill_queue_mutex);
+
+            // Do not wait for a refill the quiescing refiller will never deliver
+            profiled_mutex_lock(args->simulation_state_mutex);
+            int quiescing = *(args->terminate_now) || *(args->checkpoint_now);
+            profiled_mutex_unlock(args->simulation_state_mutex);
+            if (quiescing) {
+                profiled_mutex_unlock(args->paper_refill_queue_mutex);
+                continue;
+            }
+
             unsigned long refill_start_time_us = get_time_in_us();
             emit_paper_empty(args->printer, job_to_dequeue->id, refill_start_time_us);
             list_append(args->paper_refill_queue, args->printer);
             pthread_cond_broadcast(args->refill_supplier_cv); // Notify refill thread
             
             // Wait until paper is refilled
-            pthread_cond_wait(args->refill_needed_cv, args->paper_refill_queue_mutex);
-            pthread_mutex_unlock(args->paper_refill_queue_mutex);
+            profiled_cond_wait(args->refill_needed_cv, args->paper_refill_queue_mutex);
+            profiled_mutex_unlock(args->paper_refill_queue_mutex);
             
             // Update stats for paper empty duration
-            pthread_mutex_lock(args->stats_mutex);
-            int paper_empty_duration_us = get_time_in_us() - refill_start_time_us;
-            if (args->printer->id == 1) {
-                args->stats->printer1_paper_empty_time_us +=
-                    paper_empty_duration_us; // stats: total time printer 1 was idle due to no paper
-            } else if (args->printer->id == 2) {
-                args->stats->printer2_paper_empty_time_us +=
-                    paper_empty_duration_us; // stats: total time printer 2 was idle due to no paper
-            }
-            pthread_mutex_unlock(args->stats_mutex);
+            profiled_mutex_lock(args->stats_mutex);
+            stats_record_paper_empty(args->stats, args->printer->id, get_time_in_us() - refill_start_time_us);
+            profiled_mutex_unlock(args->stats_mutex);
             continue;
         }
 
@@ -93,13 +96,22 @@ void* printer_thread_func(void* arg) {
         elem = timed_queue_dequeue_front(args->job_queue);
         job_t* job = (job_t*)elem->data;
         job->queue_departure_time_us = get_time_in_us();
+
+        // Update statistics and printer state; the stats mutex nests inside the queue mutex, as for arrivals
+        profiled_mutex_lock(args->stats_mutex);
+        args->printer->is_printing = 1;
+        // +1 for the job that just left the queue
+        stats_record_queue_length_change(args->stats, job->queue_departure_time_us, queue_last_interaction_time_us,
+            timed_queue_length(args->job_queue) + 1);
+        args->job_queue->last_interaction_time_us = job->queue_departure_time_us;
         emit_queue_departure(job, args->stats, args->job_queue, queue_last_interaction_time_us);
+        profiled_mutex_unlock(args->stats_mutex);
 
-        pthread_mutex_unlock(args->job_queue_mutex);
+        profiled_mutex_unlock(args->job_queue_mutex);
 
         // Update job service_time_requested_ms based on printer speed
         job->service_time_requested_ms =
-                (int)((job->papers_required / args->params->printing_rate) * 1000); // in ms
+                (int)((job->papers_required / args->params->model.printing_rate) * 1000); // in ms
 
         // Log job arrival at printer
         job->service_arrival_time_us = get_time_in_us();
@@ -107,48 +119,49 @@ void* printer_thread_func(void* arg) {
 
         // Service the job
         usleep(job->service_time_requested_ms * 1000); // Convert ms to us
-        args->printer->current_paper_count -= job->papers_required;
-        args->printer->total_papers_used += job->papers_required;
 
         // Update job departure time
         job->service_departure_time_us = get_time_in_us();
 
-        // Update stats
-        pthread_mutex_lock(args->stats_mutex);
+        // Update printer state and stats; the metrics sampler reads the printer under the stats mutex
+        profiled_mutex_lock(args->stats_mutex);
+        args->printer->current_paper_count -= job->papers_required;
+        args->printer->total_papers_used += job->papers_required;
+        args->printer->is_printing = 0;
         args->printer->jobs_printed_count++;
-        // Log job departure from system and update stats
+        stats_record_job_departure(args->stats, job, args->printer->id);
         emit_system_departure(job, args->printer, args->stats);
-        pthread_mutex_unlock(args->stats_mutex);
+        profiled_mutex_unlock(args->stats_mutex);
 
         // Free job resources
         free(elem);
         free(job);
 
         // Check exit condition.
-        pthread_mutex_lock(args->simulation_state_mutex);
+        profiled_mutex_lock(args->simulation_state_mutex);
         int have_all_jobs_arrived = *(args->all_jobs_arrived);
-        pthread_mutex_unlock(args->simulation_state_mutex);
-        pthread_mutex_lock(args->job_queue_mutex);
+        profiled_mutex_unlock(args->simulation_state_mutex);
+        profiled_mutex_lock(args->job_queue_mutex);
         if (is_exit_condition_met(have_all_jobs_arrived, args->job_queue)) {
-            pthread_mutex_unlock(args->job_queue_mutex);
+            profiled_mutex_unlock(args->job_queue_mutex);
             if (g_debug) printf("Printer %d has finished\n", args->printer->id);
             goto exit_printer;
         }
-        pthread_mutex_unlock(args->job_queue_mutex);
+        profiled_mutex_unlock(args->job_queue_mutex);
 
         if (g_debug) printf("Printer %d is looking for next job\n", args->printer->id);
         if (g_debug) debug_printer(args->printer);
     }
 
 exit_printer:
-    pthread_mutex_lock(args->simulation_state_mutex);
+    profiled_mutex_lock(args->simulation_state_mutex);
     *(args->all_jobs_served) = 1;
-    pthread_mutex_unlock(args->simulation_state_mutex);
+    profiled_mutex_unlock(args->simulation_state_mutex);
     
-    pthread_mutex_lock(args->paper_refill_queue_mutex);
+    profiled_mutex_lock(args->paper_refill_queue_mutex);
     pthread_cond_broadcast(args->refill_supplier_cv); // Notify refill thread in case it's waiting
     pthread_cond_broadcast(args->refill_needed_cv); // Notify printer thread in case it's waiting
-    pthread_mutex_unlock(args->paper_refill_queue_mutex);
+    profiled_mutex_unlock(args->paper_refill_queue_mutex);
     pthread_cancel(*args->paper_refill_thread); // Cancel the paper refill thread in case it's refilling a printer
     if (g_debug) printf("Printer %d gracefully exited\n", args->printer->id);
     return NULL;
@@ -0,0 +1,97 @@
+#include <math.h>
+#include <string.h>
+
+#include "common.h"
+#include "preprocessing.h"
+#include "queueing_model.h"
+
+double erlang_c(int servers, double offered_load) {
+    if (offered_load >= servers) return 1.0;
+
+    // Erlang B by recurrence, then convert to Erlang C
+    double erlang_b = 1.0;
+    for (int k = 1; k <= servers; k++) {
+        erlang_b = offered_load * erlang_b / (k + offered_load * erlang_b);
+    }
+    double utilization = offered_load / servers;
+    return erlang_b / (1.0 - utilization * (1.0 - erlang_b));
+}
+
+double mmck_blocking_probability(int servers, int capacity, double offered_load) {
+    if (capacity < servers || offered_load <= 0) return 0.0;
+
+    /*
+     * Unnormalized state probabilities in log space so large capacities at
+     * high load do not overflow:
+     *   p_n ~ a^n / n!                for n <= c
+     *   p_n ~ a^n / (c! * c^(n - c))  for c < n <= K
+     */
+    double log_a = log(offered_load);
+    double log_c = log((double)servers);
+
+    // First pass: find the largest term for a stable log-sum-exp
+    double log_term = 0.0; // log p_0
+    double log_max = 0.0;
+    for (int n = 1; n <= capacity; n++) {
+        log_term += log_a - (n <= servers ? log((double)n) : log_c);
+        if (log_term > log_max) log_max = log_term;
+    }
+    double log_term_k = log_term;
+
+    // Second pass: normalize
+    double sum = exp(-log_max);
+    log_term = 0.0;
+    for (int n = 1; n <= capacity; n++) {
+        log_term += log_a - (n <= servers ? log((double)n) : log_c);
+        sum += exp(log_term - log_max);
+    }
+    return exp(log_term_k - log_max) / sum;
+}
+
+void queueing_model_predict(const simulation_parameters_t* params, queueing_model_t* model) {
+    memset(model, 0, sizeof(*model));
+    if (params->model.job_arrival_time_us <= 0 || params->model.printing_rate <= 0) return;
+
+    int c = QUEUEING_MODEL_SERVERS;
+    double lower = params->model.papers_required_lower_bound;
+    double upper = params->model.papers_required_upper_bound;
+
+    // Page count is discrete uniform on [lower, upper]; service time = pages / rate
+    double mean_pages = (lower + upper) / 2.0;
+    double mean_service_time = mean_pages / params->model.printing_rate;
+    // Variance of a discrete uniform on n values is (n^2 - 1) / 12
+    double page_values = upper - lower + 1;
+    double service_scv = (page_values * page_values - 1.0) / 12.0 / (mean_pages * mean_pages);
+    double arrival_rate = 1000000.0 / params->model.job_arrival_time_us;
+    double offered_load = arrival_rate * mean_service_time;
+    double utilization = offered_load / c;
+
+    model->is_valid = TRUE;
+    model->servers = c;
+    model->system_capacity = c + params->model.queue_capacity;
+    model->arrival_rate_per_sec = arrival_rate;
+    model->mean_service_time_sec = mean_service_time;
+    model->service_scv = service_scv;
+    model->utilization = utilization;
+    model->drop_probability_mmck = mmck_blocking_probability(c, model->system_capacity, offered_load);
+    model->carried_utilization = utilization * (1.0 - model->drop_probability_mmck);
+
+    if (utilization >= 1.0) {
+        model->is_stable = FALSE;
+        return;
+    }
+    model->is_stable = TRUE;
+
+    double service_rate = 1.0 / mean_service_time;
+    model->wait_probability_mmc = erlang_c(c, offered_load);
+    model->avg_queue_wait_mmc_sec = model->wait_probability_mmc / (c * service_rate - arrival_rate);
+    model->avg_queue_length_mmc = arrival_rate * model->avg_queue_wait_mmc_sec;
+    model->avg_system_time_mmc_sec = model->avg_queue_wait_mmc_sec + mean_service_time;
+
+    // Cosmetatos correction to half the M/M/c wait for deterministic service
+    double correction = 1.0 + (1.0 - utilization) * (c - 1) * (sqrt(4.0 + 5.0 * c) - 2.0) / (16.0 * utilization * c);
+    model->avg_queue_wait_mdc_sec = 0.5 * correction * model->avg_queue_wait_mmc_sec;
+
+    // Allen-Cunneen scales the M/M/c wait by (ca^2 + cs^2) / 2; arrivals are evenly spaced, so ca^2 = 0
+    model->avg_queue_wait_dgc_sec = 0.5 * service_scv * model->avg_queue_wait_mmc_sec;
+}
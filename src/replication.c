@@ -0,0 +1,180 @@
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "replication.h"
+#include "preprocessing.h"
+#include "simulation_context.h"
+#include "simulation_stats.h"
+#include "log_router.h"
+#include "stats_export.h"
+
+extern int g_debug;
+
+// --- Aggregation ---
+typedef struct replication_metric {
+    const char* label;
+    size_t offset; // offset into simulation_derived_statistics_t
+} replication_metric_t;
+
+static const replication_metric_t metrics[] = {
+    {"Simulation Duration (sec)",        offsetof(simulation_derived_statistics_t, simulation_duration_sec)},
+    {"Job Arrival Rate (jobs/sec)",      offsetof(simulation_derived_statistics_t, job_arrival_rate_per_sec)},
+    {"Job Drop Probability",             offsetof(simulation_derived_statistics_t, job_drop_probability)},
+    {"Average Inter-arrival Time (sec)", offsetof(simulation_derived_statistics_t, avg_inter_arrival_time_sec)},
+    {"Average System Time (sec)",        offsetof(simulation_derived_statistics_t, avg_system_time_sec)},
+    {"System Time Std Dev (sec)",        offsetof(simulation_derived_statistics_t, system_time_std_dev_sec)},
+    {"Average Queue Wait Time (sec)",    offsetof(simulation_derived_statistics_t, avg_queue_wait_time_sec)},
+    {"Average Queue Length (jobs)",      offsetof(simulation_derived_statistics_t, avg_queue_length)},
+    {"Avg Service Time P1 (sec)",        offsetof(simulation_derived_statistics_t, avg_service_time_p1_sec)},
+    {"Avg Service Time P2 (sec)",        offsetof(simulation_derived_statistics_t, avg_service_time_p2_sec)},
+    {"Utilization (Printer 1)",          offsetof(simulation_derived_statistics_t, utilization_p1)},
+    {"Utilization (Printer 2)",          offsetof(simulation_derived_statistics_t, utilization_p2)},
+};
+#define NUM_METRICS ((int)(sizeof(metrics) / sizeof(metrics[0])))
+
+// Index of the metric whose confidence interval drives the precision target
+#define PRECISION_METRIC 4 // Average System Time
+
+static double metric_value(const simulation_derived_statistics_t* derived, int metric) {
+    return *(const double*)((const char*)derived + metrics[metric].offset);
+}
+
+static void* replication_thread_func(void* arg) {
+    simulation_context_run((simulation_context_t*)arg);
+    return NULL;
+}
+
+/**
+ * @brief Returns how many replications may run at once: the number of online
+ *        CPUs, since the simulations are CPU-bound and extra threads only add
+ *        scheduling noise to the measured timings.
+ */
+static int max_parallel_replications(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+/**
+ * @brief Runs one batch of replications, at most one per CPU at a time, and
+ *        appends each derived metric to the sample arrays.
+ *
+ * @param params The shared simulation parameters.
+ * @param first_index The index of the first replication in this batch (seed offset).
+ * @param batch_size The number of replications in this batch.
+ * @param samples Per-metric sample arrays of capacity MAX_REPLICATIONS.
+ */
+static void run_batch(const simulation_parameters_t* params, int first_index, int batch_size,
+    double* samples[])
+{
+    int parallel = max_parallel_replications();
+    if (parallel > batch_size) parallel = batch_size;
+
+    simulation_context_t* contexts = malloc(sizeof(simulation_context_t) * parallel);
+    pthread_t* threads = malloc(sizeof(pthread_t) * parallel);
+    if (contexts == NULL || threads == NULL) {
+        fprintf(stderr, "Error: Failed to allocate replication batch\n");
+        exit(1);
+    }
+
+    for (int wave_start = 0; wave_start < batch_size; wave_start += parallel) {
+        int wave_size = batch_size - wave_start < parallel ? batch_size - wave_start : parallel;
+
+        for (int i = 0; i < wave_size; i++) {
+            simulation_parameters_t replication_params = *params;
+            replication_params.model.seed = params->model.seed + first_index + wave_start + i;
+            simulation_context_init(&contexts[i], &replication_params);
+            pthread_create(&threads[i], NULL, replication_thread_func, &contexts[i]);
+        }
+
+        for (int i = 0; i < wave_size; i++) {
+            pthread_join(threads[i], NULL);
+
+            simulation_derived_statistics_t derived;
+            calculate_derived_statistics(&contexts[i].stats, &derived);
+            for (int m = 0; m < NUM_METRICS; m++) {
+                samples[m][first_index + wave_start + i] = metric_value(&derived, m);
+            }
+            if (params->stats_out_path[0] != '\0') {
+                stats_export_append(params->stats_out_path, &contexts[i].params, &contexts[i].stats,
+                    STATS_EXPORT_ENGINE_REPLICATION);
+            }
+            if (g_debug) debug_statistics(&contexts[i].stats);
+            simulation_context_destroy(&contexts[i]);
+        }
+    }
+
+    free(threads);
+    free(contexts);
+}
+
+static void print_replication_statistics(double* samples[], int count) {
+    flockfile(stdout);
+    printf("\n");
+    printf("=========== REPLICATION STATISTICS (95%% CI, n = %d) ===========\n", count);
+    printf("%-34s %12s %12s %12s\n", "Metric", "Mean", "+/-", "Rel. +/-");
+    for (int m = 0; m < NUM_METRICS; m++) {
+        double mean, half_width;
+        calculate_confidence_interval_95(samples[m], count, &mean, &half_width);
+        if (mean != 0.0) {
+            printf("%-34s %12.4g %12.3g %11.2f%%\n", metrics[m].label, mean, half_width,
+                fabs(half_width / mean) * 100);
+        } else {
+            printf("%-34s %12.4g %12.3g %12s\n", metrics[m].label, mean, half_width, "-");
+        }
+    }
+    printf("===============================================================\n");
+    funlockfile(stdout);
+}
+
+void replication_run(const simulation_parameters_t* params) {
+    set_log_mode(LOG_MODE_QUIET);
+
+    double* samples[NUM_METRICS];
+    for (int m = 0; m < NUM_METRICS; m++) {
+        samples[m] = calloc(MAX_REPLICATIONS, sizeof(double));
+        if (samples[m] == NULL) {
+            fprintf(stderr, "Error: Failed to allocate replication samples\n");
+            exit(1);
+        }
+    }
+
+    int batch_size = params->replications < MAX_REPLICATIONS ? params->replications : MAX_REPLICATIONS;
+    int count = 0;
+    for (;;) {
+        printf("Running replications %d-%d (seeds %u-%u)\n", count + 1, count + batch_size,
+            params->model.seed + count, params->model.seed + count + batch_size - 1);
+        run_batch(params, count, batch_size, samples);
+        count += batch_size;
+
+        double mean, half_width;
+        calculate_confidence_interval_95(samples[PRECISION_METRIC], count, &mean, &half_width);
+        // A zero mean has no relative precision; never count it as converged
+        int has_relative = mean != 0.0;
+        double relative_half_width = has_relative ? fabs(half_width / mean) : 0.0;
+        if (has_relative) {
+            printf("  %s = %.4g +/- %.3g (%.2f%%)\n", metrics[PRECISION_METRIC].label,
+                mean, half_width, relative_half_width * 100);
+        } else {
+            printf("  %s = %.4g +/- %.3g (-)\n", metrics[PRECISION_METRIC].label,
+                mean, half_width);
+        }
+
+        if (params->precision <= 0) break;
+        if (has_relative && relative_half_width <= params->precision) break;
+        if (count >= MAX_REPLICATIONS) {
+            printf("  precision target %.2f%% not reached after %d replications\n",
+                params->precision * 100, count);
+            break;
+        }
+        if (count + batch_size > MAX_REPLICATIONS) batch_size = MAX_REPLICATIONS - count;
+    }
+
+    print_replication_statistics(samples, count);
+
+    for (int m = 0; m < NUM_METRICS; m++) free(samples[m]);
+}
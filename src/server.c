@@ -1,5 +1,6 @@
 // Mongoose-based websocket server that drives the print simulation.
-// Websocket endpoint accepts text frames: "start", "stop", "status".
+// Websocket endpoint accepts text frames: "start", "start {json}", "stop", "status", "checkpoint",
+// "resume", "metrics", "metrics <seq>", "hello json|binary", "log <options>"; GET /metrics for Prometheus.
 
 #include <pthread.h>
 #include <signal.h>
@@ -8,223 +9,107 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "binary_handler.h"
+#include "trace_handler.h"
 #include "common.h"
+#include "host_usage.h"
 #include "mongoose.h"
 #include "preprocessing.h"
-#include "linked_list.h"
-#include "timed_queue.h"
-#include "job_receiver.h"
-#include "paper_refiller.h"
-#include "printer.h"
+#include "session_manager.h"
 #include "websocket_handler.h"
 #include "ws_bridge.h"
 #include "log_router.h"
-#include "simulation_stats.h"
-#include "signalcatcher.h"
+#include "metrics_ring.h"
+#include "stats_snapshot.h"
+#include "steady_state.h"
+#include "text_buffer.h"
 
 // Default listen address and websocket paths
 static const char *s_listen_on = "http://127.0.0.1:8000";
 static const char *s_ws_path_primary = "/websocket";
 static const char *s_web_root = "./tests";
 
-// Mongoose manager and active websocket tracking
+// Mongoose manager and websocket stream routing
 static struct mg_mgr g_mgr; // used for mg_wakeup
-static pthread_mutex_t g_ws_mutex = PTHREAD_MUTEX_INITIALIZER;
-static unsigned long g_ws_conn_id = 0; // 0 means none
 
 extern int g_debug;
-extern int g_terminate_now;
 
-typedef struct simulation_context {
-	// Threads
-	pthread_t printer1_thread;
-	pthread_t printer2_thread;
-	pthread_t job_receiver_thread;
-	pthread_t paper_refill_thread;
-	pthread_t simulation_runner_thread; // background wrapper
+static simulation_parameters_t g_params = SIMULATION_DEFAULT_PARAMS;
 
-	// Sync primitives
-	pthread_mutex_t job_queue_mutex;
-	pthread_mutex_t paper_refill_queue_mutex;
-	pthread_mutex_t stats_mutex;
-	pthread_mutex_t simulation_state_mutex;
-	pthread_cond_t job_queue_not_empty_cv;
-	pthread_cond_t refill_needed_cv;
-	pthread_cond_t refill_supplier_cv;
-
-	// State
-	simulation_parameters_t params;
-	simulation_statistics_t stats;
-	int all_jobs_arrived;
-	int all_jobs_served;
-	timed_queue_t job_queue;
-	linked_list_t paper_refill_queue;
-
-	// Args
-	job_thread_args_t job_receiver_args;
-	printer_thread_args_t printer1_args;
-	printer_thread_args_t printer2_args;
-	paper_refill_thread_args_t paper_refill_args;
-
-	// Control
-	int is_running;
-} simulation_context_t;
-
-static simulation_context_t g_ctx; // single simulation instance
-static pthread_mutex_t g_server_state_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-static void init_context(simulation_context_t* ctx) {
-	memset(ctx, 0, sizeof(*ctx));
-	ctx->params = (simulation_parameters_t)SIMULATION_DEFAULT_PARAMS;
-	ctx->stats = (simulation_statistics_t){0};
-	ctx->all_jobs_arrived = 0;
-	ctx->all_jobs_served = 0;
-	ctx->is_running = 0;
-
-	pthread_mutex_init(&ctx->job_queue_mutex, NULL);
-	pthread_mutex_init(&ctx->paper_refill_queue_mutex, NULL);
-	pthread_mutex_init(&ctx->stats_mutex, NULL);
-	pthread_mutex_init(&ctx->simulation_state_mutex, NULL);
-	pthread_cond_init(&ctx->job_queue_not_empty_cv, NULL);
-	pthread_cond_init(&ctx->refill_needed_cv, NULL);
-	pthread_cond_init(&ctx->refill_supplier_cv, NULL);
-
-	timed_queue_init(&ctx->job_queue);
-	list_init(&ctx->paper_refill_queue);
-}
-
-static void destroy_context(simulation_context_t* ctx) {
-	pthread_mutex_destroy(&ctx->job_queue_mutex);
-	pthread_mutex_destroy(&ctx->paper_refill_queue_mutex);
-	pthread_mutex_destroy(&ctx->stats_mutex);
-	pthread_mutex_destroy(&ctx->simulation_state_mutex);
-	pthread_cond_destroy(&ctx->job_queue_not_empty_cv);
-	pthread_cond_destroy(&ctx->refill_needed_cv);
-	pthread_cond_destroy(&ctx->refill_supplier_cv);
+// Helper to send a text frame from the event loop
+static void ws_send_text(struct mg_connection *c, const char *text) {
+	mg_ws_send(c, text, strlen(text), WEBSOCKET_OP_TEXT);
 }
 
-static void* simulation_runner(void* arg) {
-    if (g_debug) printf("Simulation runner thread started\n");
-	simulation_context_t* ctx = (simulation_context_t*)arg;
-
-	// Prepare thread args
-	job_thread_args_t job_receiver_args = {
-		.job_queue_mutex = &ctx->job_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
-		.simulation_state_mutex = &ctx->simulation_state_mutex,
-		.job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
-		.job_queue = &ctx->job_queue,
-		.simulation_params = &ctx->params,
-		.stats = &ctx->stats,
-		.all_jobs_arrived = &ctx->all_jobs_arrived
-	};
-	ctx->job_receiver_args = job_receiver_args;
-
-	// Concrete printers
-	printer_t printer1 = {.id = 1, .current_paper_count = ctx->params.printer_paper_capacity, .capacity = ctx->params.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
-	printer_t printer2 = {.id = 2, .current_paper_count = ctx->params.printer_paper_capacity, .capacity = ctx->params.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
-
-	printer_thread_args_t printer1_args = {
-		.paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
-		.job_queue_mutex = &ctx->job_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
-		.simulation_state_mutex = &ctx->simulation_state_mutex,
-		.job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
-		.refill_needed_cv = &ctx->refill_needed_cv,
-		.refill_supplier_cv = &ctx->refill_supplier_cv,
-		.paper_refill_thread = &ctx->paper_refill_thread,
-		.job_queue = &ctx->job_queue,
-		.paper_refill_queue = &ctx->paper_refill_queue,
-		.params = &ctx->params,
-		.stats = &ctx->stats,
-		.all_jobs_served = &ctx->all_jobs_served,
-		.all_jobs_arrived = &ctx->all_jobs_arrived,
-		.printer = &printer1
-	};
-	ctx->printer1_args = printer1_args;
-
-	printer_thread_args_t printer2_args = printer1_args;
-	printer2_args.printer = &printer2;
-	ctx->printer2_args = printer2_args;
-
-	paper_refill_thread_args_t paper_refill_args = {
-		.paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
-		.simulation_state_mutex = &ctx->simulation_state_mutex,
-		.refill_needed_cv = &ctx->refill_needed_cv,
-		.refill_supplier_cv = &ctx->refill_supplier_cv,
-		.paper_refill_queue = &ctx->paper_refill_queue,
-		.params = &ctx->params,
-		.stats = &ctx->stats,
-		.all_jobs_served = &ctx->all_jobs_served
-	};
-	ctx->paper_refill_args = paper_refill_args;
-
-	// Start of simulation logging
-	emit_simulation_parameters(&ctx->params);
-	emit_simulation_start(&ctx->stats);
-
-	// Create threads
-	pthread_create(&ctx->job_receiver_thread, NULL, job_receiver_thread_func, &ctx->job_receiver_args);
-	pthread_create(&ctx->paper_refill_thread, NULL, paper_refill_thread_func, &ctx->paper_refill_args);
-	pthread_create(&ctx->printer1_thread, NULL, printer_thread_func, &ctx->printer1_args);
-	pthread_create(&ctx->printer2_thread, NULL, printer_thread_func, &ctx->printer2_args);
-
-	// Join threads
-	pthread_join(ctx->job_receiver_thread, NULL);
-	pthread_join(ctx->printer1_thread, NULL);
-	pthread_join(ctx->printer2_thread, NULL);
-	pthread_join(ctx->paper_refill_thread, NULL);
-
-	// Final logging
-	emit_simulation_end(&ctx->stats);
-	emit_statistics(&ctx->stats);
-
-	pthread_mutex_lock(&g_server_state_mutex);
-	ctx->is_running = 0;
-	pthread_mutex_unlock(&g_server_state_mutex);
-    if (g_debug) printf("Simulation runner thread finished\n");
-	return NULL;
-}
-
-static void start_simulation_async(simulation_context_t* ctx) {
-	pthread_mutex_lock(&g_server_state_mutex);
-	if (ctx->is_running) {
-		pthread_mutex_unlock(&g_server_state_mutex);
-		return;
+/**
+ * @brief Reads the log options (log_level, log_off, log_sample, events, metrics_ms) of a query string.
+ *
+ * @param query The query string, e.g. "log_level=jobs&log_sample=10".
+ * @param params The parameters to update; left unchanged if any option is invalid.
+ * @return TRUE on success, FALSE if an option is invalid.
+ */
+static int parse_log_options(struct mg_str query, simulation_parameters_t *params) {
+	simulation_parameters_t parsed = *params;
+	char value[256];
+	if (mg_http_get_var(&query, "log_level", value, sizeof(value)) > 0) {
+		parsed.log_verbosity = log_verbosity_from_name(value);
+		if (parsed.log_verbosity < 0) return FALSE;
+	}
+	if (mg_http_get_var(&query, "log_off", value, sizeof(value)) > 0) {
+		if (!log_event_mask_from_names(value, &parsed.log_disabled_events)) return FALSE;
+	}
+	if (mg_http_get_var(&query, "log_sample", value, sizeof(value)) > 0) {
+		parsed.log_sample_every = atoi(value);
+		if (parsed.log_sample_every <= 0) return FALSE;
+	}
+	if (mg_http_get_var(&query, "events", value, sizeof(value)) > 0) {
+		if (strcmp(value, "typed") == 0) parsed.ws_text_events = 0;
+		else if (strcmp(value, "text") == 0) parsed.ws_text_events = 1;
+		else return FALSE;
 	}
-	ctx->is_running = 1;
-	pthread_mutex_unlock(&g_server_state_mutex);
-	pthread_create(&ctx->simulation_runner_thread, NULL, simulation_runner, ctx);
+	if (mg_http_get_var(&query, "metrics_ms", value, sizeof(value)) > 0) {
+		parsed.metrics_interval_ms = atoi(value);
+		if (parsed.metrics_interval_ms < 0) return FALSE;
+	}
+	*params = parsed;
+	return TRUE;
 }
 
-static void request_stop_simulation(simulation_context_t* ctx) {
-	// Emulate signal catcher logic to stop simulation gracefully
-	pthread_mutex_lock(&ctx->simulation_state_mutex);
-	g_terminate_now = 1;
-	ctx->all_jobs_arrived = 1;
-	pthread_mutex_unlock(&ctx->simulation_state_mutex);
-
-	pthread_mutex_lock(&ctx->stats_mutex);
-	emit_simulation_stopped(&ctx->stats);
-	pthread_mutex_unlock(&ctx->stats_mutex);
-
-    pthread_cancel(ctx->job_receiver_thread);
-    pthread_cancel(ctx->paper_refill_thread);
-
-	// Lock in defined order and empty queue
-	pthread_mutex_lock(&ctx->job_queue_mutex);
-	pthread_mutex_lock(&ctx->stats_mutex);
-	empty_queue_if_terminating(&ctx->job_queue, &ctx->stats);
-	pthread_cond_broadcast(&ctx->job_queue_not_empty_cv);
-	pthread_mutex_unlock(&ctx->stats_mutex);
-	pthread_mutex_unlock(&ctx->job_queue_mutex);
+/**
+ * @brief Replies to a start with the parameters the run uses.
+ */
+static void send_start_reply(struct mg_connection *c, const simulation_parameters_t *params) {
+	mg_ws_printf(c, WEBSOCKET_OP_TEXT,
+		"{%m:%m, %m:{%m:%g, %m:%d, %m:%d, %m:%d, %m:%g, %m:%d, %m:%g, %m:%d, %m:%u, %m:%d, %m:%s, %m:%m, %m:%g}}",
+		MG_ESC("status"), MG_ESC("starting"), MG_ESC("params"),
+		MG_ESC("job_arrival_time_us"), params->model.job_arrival_time_us,
+		MG_ESC("papers_required_lower_bound"), params->model.papers_required_lower_bound,
+		MG_ESC("papers_required_upper_bound"), params->model.papers_required_upper_bound,
+		MG_ESC("queue_capacity"), params->model.queue_capacity,
+		MG_ESC("printing_rate"), params->model.printing_rate,
+		MG_ESC("printer_paper_capacity"), params->model.printer_paper_capacity,
+		MG_ESC("refill_rate"), params->model.refill_rate,
+		MG_ESC("num_jobs"), params->model.num_jobs,
+		MG_ESC("seed"), params->model.seed,
+		MG_ESC("metrics_interval_ms"), params->metrics_interval_ms,
+		MG_ESC("is_profiling_locks"), params->is_profiling_locks ? "true" : "false",
+		MG_ESC("warmup_method"), MG_ESC(warmup_method_name(params->model.warmup_method)),
+		MG_ESC("warmup_amount"), params->model.warmup_amount);
+}
 
-    // Wake up any printers or refiller that might be waiting
-    pthread_mutex_lock(&ctx->paper_refill_queue_mutex);
-    pthread_cond_broadcast(&ctx->refill_needed_cv);
-    pthread_cond_broadcast(&ctx->refill_supplier_cv);
-    pthread_mutex_unlock(&ctx->paper_refill_queue_mutex);
+// Options from the websocket URL ride in c->data from the upgrade until the session opens
+typedef struct connection_options {
+	log_filter_t log_filter;
+	int protocol; // ws_protocol_t
+	int is_text_events;
+	int metrics_interval_ms;
+	unsigned long watch_id; // session watched by a read-only connection, 0 for an owner
+} connection_options_t;
+_Static_assert(sizeof(connection_options_t) <= MG_DATA_SIZE, "connection options must fit in mg_connection data");
+
+// Returns the session a watcher connection follows, or 0 if the connection owns its own
+static unsigned long watched_session(const struct mg_connection *c) {
+	return ((const connection_options_t *) c->data)->watch_id;
 }
 
 // Helper to compare incoming ws message with a C string literal
@@ -233,6 +118,77 @@ static int ws_msg_equals(struct mg_str s, const char *lit) {
 	return s.len == n && memcmp(s.buf, lit, n) == 0;
 }
 
+/**
+ * @brief Replies with the samples of the session's latest run from a sample
+ *        number on: {"type":"metrics_history", "interval_ms":N, "first_seq":N,
+ *        "fields":[...], "samples":[[...],...]}.
+ *
+ * @param c The connection that asked.
+ * @param session Its session.
+ * @param since The number of the first sample wanted.
+ */
+static void send_metrics_history(struct mg_connection *c, session_t *session, unsigned long since) {
+	if (!session->runner_started) {
+		ws_send_text(c, "{\"error\":\"no run\"}");
+		return;
+	}
+	metrics_sample_t *samples = malloc(METRICS_RING_CAPACITY * sizeof(metrics_sample_t));
+	size_t capacity = 256 + METRICS_RING_CAPACITY * 128;
+	char *buf = malloc(capacity);
+	if (samples == NULL || buf == NULL) {
+		free(samples);
+		free(buf);
+		ws_send_text(c, "{\"error\":\"out of memory\"}");
+		return;
+	}
+	unsigned long first = 0;
+	int count = metrics_ring_read(&session->ctx.metrics, since, samples, METRICS_RING_CAPACITY, &first);
+
+	text_buffer_t tb;
+	text_buffer_init(&tb, buf, capacity);
+	text_append_literal(&tb, "{\"type\":\"metrics_history\", \"interval_ms\":");
+	text_append_int(&tb, session->ctx.params.metrics_interval_ms);
+	text_append_literal(&tb, ", \"first_seq\":");
+	text_append_uint(&tb, first);
+	text_append_literal(&tb, ", \"fields\":" METRICS_SAMPLE_FIELDS_JSON ", \"samples\":[");
+	for (int i = 0; i < count; i++) {
+		if (i > 0) text_append_literal(&tb, ",");
+		metrics_sample_append_values(&tb, &samples[i]);
+	}
+	text_append_literal(&tb, "]}");
+	mg_ws_send(c, tb.data, tb.length, WEBSOCKET_OP_TEXT);
+	free(samples);
+	free(buf);
+}
+
+/**
+ * @brief Replies to a Prometheus scrape with the latest snapshot of every session's run.
+ *
+ * @param c The HTTP connection.
+ */
+static void send_prometheus_metrics(struct mg_connection *c) {
+	stats_snapshot_data_t *snapshots = malloc(g_params.max_sessions * sizeof(*snapshots));
+	unsigned long *session_ids = malloc(g_params.max_sessions * sizeof(*session_ids));
+	char *buf = NULL;
+	int count = 0, size = 0;
+	if (snapshots != NULL && session_ids != NULL) {
+		count = session_manager_read_snapshots(snapshots, session_ids, g_params.max_sessions);
+		size = write_prometheus_metrics(snapshots, session_ids, count, NULL, 0) + 1;
+		buf = malloc(size);
+	}
+	if (buf == NULL) {
+		mg_http_reply(c, 500, "Content-Type: text/plain\r\n", "out of memory\n");
+	} else {
+		write_prometheus_metrics(snapshots, session_ids, count, buf, size);
+		mg_printf(c, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n",
+			size - 1);
+		mg_send(c, buf, size - 1);
+	}
+	free(buf);
+	free(session_ids);
+	free(snapshots);
+}
+
 // Mongoose event handler
 /**
  * @brief Mongoose event handler for HTTP and WebSocket events
@@ -245,71 +201,194 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 	if (ev == MG_EV_HTTP_MSG) {
 		struct mg_http_message *hm = (struct mg_http_message *) ev_data;
 		if (mg_match(hm->uri, mg_str(s_ws_path_primary), NULL)) {
+			simulation_parameters_t options = g_params;
+			if (!parse_log_options(hm->query, &options)) {
+				mg_http_reply(c, 400, "Content-Type: text/plain\r\n", "invalid log options\n");
+				return;
+			}
+			connection_options_t connection = {
+				{options.log_verbosity, options.log_disabled_events, options.log_sample_every}, WS_PROTOCOL_JSON,
+				options.ws_text_events, options.metrics_interval_ms};
+			char protocol[16];
+			if (mg_http_get_var(&hm->query, "protocol", protocol, sizeof(protocol)) > 0
+				&& (connection.protocol = ws_protocol_from_name(protocol)) < 0) {
+				mg_http_reply(c, 400, "Content-Type: text/plain\r\n", "unknown protocol\n");
+				return;
+			}
+			char watch[24];
+			if (mg_http_get_var(&hm->query, "watch", watch, sizeof(watch)) > 0) {
+				connection.watch_id = strtoul(watch, NULL, 10);
+				if (connection.watch_id == 0 || session_manager_find(connection.watch_id) == NULL) {
+					mg_http_reply(c, 404, "Content-Type: text/plain\r\n", "no such session\n");
+					return;
+				}
+			}
+			memcpy(c->data, &connection, sizeof(connection));
 			mg_ws_upgrade(c, hm, NULL);
+		} else if (mg_match(hm->uri, mg_str("/metrics"), NULL)) {
+			send_prometheus_metrics(c);
 		} else {
 			// mg_http_reply(c, 200, "Content-Type: text/plain\r\n", "ConcurrentPrintService API\n");
             struct mg_http_serve_opts opts = {.root_dir = s_web_root};
             mg_http_serve_dir(c, ev_data, &opts);
 		}
+	} else if (ev == MG_EV_WS_OPEN && watched_session(c) != 0) {
+		// Subscribe a watcher to the session's stream; it never opens a session of its own
+		session_t *session = session_manager_find(watched_session(c));
+		if (session == NULL || !ws_bridge_subscribe(&session->stream, c->id)) {
+			ws_send_text(c, "{\"error\":\"no such session\"}");
+			c->is_draining = 1;
+		} else {
+			mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%lu, %m:%m}", MG_ESC("status"), MG_ESC("watching"),
+				MG_ESC("session"), watched_session(c),
+				MG_ESC("protocol"), MG_ESC(session->stream.protocol == WS_PROTOCOL_BINARY ? "binary" : "json"));
+		}
 	} else if (ev == MG_EV_WS_OPEN) {
-		// Track the active websocket client
-		pthread_mutex_lock(&g_ws_mutex);
-		g_ws_conn_id = c->id;
-		pthread_mutex_unlock(&g_ws_mutex);
+		// Give the client its own session, or turn it away at the cap
+		const connection_options_t *connection = (const connection_options_t *) c->data;
+		session_t *session = session_manager_open(c->id, connection->protocol);
+		if (session == NULL) {
+			ws_send_text(c, "{\"error\":\"session limit reached\"}");
+			c->is_draining = 1;
+		} else {
+			session->params.log_verbosity = connection->log_filter.verbosity;
+			session->params.log_disabled_events = connection->log_filter.disabled_events;
+			session->params.log_sample_every = connection->log_filter.sample_every;
+			session->params.ws_text_events = connection->is_text_events;
+			session->params.metrics_interval_ms = connection->metrics_interval_ms;
+		}
 	} else if (ev == MG_EV_WS_MSG) {
 		struct mg_ws_message *wm = (struct mg_ws_message *) ev_data;
-		if (ws_msg_equals(wm->data, "start")) {
-			start_simulation_async(&g_ctx);
-			const char *resp = "{\"status\":\"starting\"}";
-			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+		session_t *session = session_manager_find(c->id);
+		if (watched_session(c) != 0) {
+			ws_send_text(c, "{\"error\":\"watchers are read-only\"}");
+		} else if (session == NULL) {
+			ws_send_text(c, "{\"error\":\"no session\"}");
+		} else if (ws_msg_equals(wm->data, "start")) {
+			if (session_start(session)) {
+				send_start_reply(c, &session->params);
+			} else {
+				ws_send_text(c, "{\"error\":\"already running\"}");
+			}
+		} else if (wm->data.len > 6 && memcmp(wm->data.buf, "start ", 6) == 0) {
+			// Sets the given parameters for this and later runs of the session, then starts
+			char bad_field[64];
+			struct mg_str json = mg_str_n(wm->data.buf + 6, wm->data.len - 6);
+			if (session_is_running(session)) {
+				ws_send_text(c, "{\"error\":\"already running\"}");
+			} else if (!parse_start_params(json.buf, json.len, &session->params, bad_field, sizeof(bad_field))) {
+				mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%m}", MG_ESC("error"), MG_ESC("invalid parameters"),
+					MG_ESC("field"), MG_ESC(bad_field));
+			} else if (session_start(session)) {
+				send_start_reply(c, &session->params);
+			} else {
+				ws_send_text(c, "{\"error\":\"already running\"}");
+			}
 		} else if (ws_msg_equals(wm->data, "stop")) {
-			request_stop_simulation(&g_ctx);
-			const char *resp = "{\"status\":\"stopping\"}";
-			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			session_stop(session);
+			ws_send_text(c, "{\"status\":\"stopping\"}");
+		} else if (ws_msg_equals(wm->data, "checkpoint")) {
+			if (session_checkpoint(session)) {
+				mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%m}", MG_ESC("status"), MG_ESC("checkpointing"),
+					MG_ESC("path"), MG_ESC(session_checkpoint_path(session)));
+			} else {
+				ws_send_text(c, "{\"error\":\"not running\"}");
+			}
+		} else if (ws_msg_equals(wm->data, "resume")) {
+			if (session_resume(session)) {
+				mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%m}", MG_ESC("status"), MG_ESC("resuming"),
+					MG_ESC("path"), MG_ESC(session_checkpoint_path(session)));
+			} else {
+				ws_send_text(c, "{\"error\":\"cannot resume\"}");
+			}
+		} else if (wm->data.len > 4 && memcmp(wm->data.buf, "log ", 4) == 0) {
+			// Applies from the session's next start or resume
+			struct mg_str options = mg_str_n(wm->data.buf + 4, wm->data.len - 4);
+			ws_send_text(c, parse_log_options(options, &session->params) ? "{\"status\":\"log options set\"}" : "{\"error\":\"invalid log options\"}");
+		} else if (wm->data.len > 6 && memcmp(wm->data.buf, "hello ", 6) == 0) {
+			// Negotiates the framing of simulation frames: "hello json" or "hello binary"
+			char name[16];
+			int protocol = -1;
+			if (wm->data.len - 6 < sizeof(name)) {
+				memcpy(name, wm->data.buf + 6, wm->data.len - 6);
+				name[wm->data.len - 6] = '\0';
+				protocol = ws_protocol_from_name(name);
+			}
+			if (protocol < 0) {
+				ws_send_text(c, "{\"error\":\"unknown protocol\"}");
+			} else if (session_is_running(session)) {
+				ws_send_text(c, "{\"error\":\"cannot change protocol while running\"}");
+			} else {
+				ws_bridge_set_protocol(c, &session->stream, protocol);
+				mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%m, %m:%d}", MG_ESC("status"), MG_ESC("hello"),
+					MG_ESC("protocol"), MG_ESC(name), MG_ESC("version"), WS_PROTOCOL_VERSION);
+			}
+		} else if (ws_msg_equals(wm->data, "metrics")) {
+			send_metrics_history(c, session, 0);
+		} else if (wm->data.len > 8 && memcmp(wm->data.buf, "metrics ", 8) == 0) {
+			char since[24];
+			size_t len = wm->data.len - 8 < sizeof(since) - 1 ? wm->data.len - 8 : sizeof(since) - 1;
+			memcpy(since, wm->data.buf + 8, len);
+			since[len] = '\0';
+			send_metrics_history(c, session, strtoul(since, NULL, 10));
 		} else if (ws_msg_equals(wm->data, "status")) {
-			pthread_mutex_lock(&g_server_state_mutex);
-			int running = g_ctx.is_running;
-			pthread_mutex_unlock(&g_server_state_mutex);
-			const char *resp = running ? "{\"status\":\"running\"}" : "{\"status\":\"idle\"}";
-			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			ws_outbound_stats_t outbound;
+			ws_bridge_outbound_stats(&session->stream, &outbound);
+			mg_ws_printf(c, WEBSOCKET_OP_TEXT, "{%m:%m, %m:%lu, %m:%lu, %m:%lu, %m:%d}",
+				MG_ESC("status"), MG_ESC(session_is_running(session) ? "running" : "idle"),
+				MG_ESC("session"), c->id,
+				MG_ESC("queued_bytes"), (unsigned long) outbound.queued_bytes,
+				MG_ESC("dropped_events"), outbound.dropped_events,
+				MG_ESC("watchers"), ws_bridge_watcher_count(&session->stream));
 		} else {
-			const char *resp = "{\"error\":\"unknown command\"}";
-			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			ws_send_text(c, "{\"error\":\"unknown command\"}");
 		}
 	} else if (ev == MG_EV_WAKEUP) {
-		// Deliver data enqueued from other threads
+		// Deliver a frame enqueued from another thread, or flush a batch that reached its size threshold
 		struct mg_str *data = (struct mg_str *) ev_data;
+		session_t *session = session_manager_find(c->id);
+		if (session == NULL) return;
 		if (data && data->buf && data->len > 0) {
-			mg_ws_send(c, data->buf, data->len, WEBSOCKET_OP_TEXT);
+			ws_bridge_deliver(c, &session->stream, data->buf, data->len);
+		} else {
+			ws_bridge_service(c, &session->stream, 0);
+		}
+	} else if (ev == MG_EV_POLL && c->is_websocket && watched_session(c) != 0) {
+		// Hand the watcher its share of the frames fanned out since the last tick
+		if (c->is_draining) return;
+		session_t *session = session_manager_find(watched_session(c));
+		if (session == NULL) {
+			ws_send_text(c, "{\"error\":\"session closed\"}");
+			c->is_draining = 1;
+		} else if (!ws_bridge_pump(c, &session->stream)) {
+			ws_bridge_unsubscribe(&session->stream, c->id);
+			ws_send_text(c, "{\"error\":\"too far behind, disconnected\"}");
+			c->is_draining = 1;
 		}
+	} else if (ev == MG_EV_POLL && c->is_websocket) {
+		// Track the client's backlog and flush whatever the session's run produced since the last tick
+		session_t *session = session_manager_find(c->id);
+		if (session != NULL) ws_bridge_service(c, &session->stream, (unsigned long) *(uint64_t *) ev_data);
 	} else if (ev == MG_EV_CLOSE) {
-		// Clear active websocket if it is closing
-		pthread_mutex_lock(&g_ws_mutex);
-		if (g_ws_conn_id == c->id) g_ws_conn_id = 0;
-		pthread_mutex_unlock(&g_ws_mutex);
-	}
-}
-
-/**
- * @brief Thread-safe enqueue of a JSON frame for websocket client
- * 
- * @param json The JSON data to send
- * @param len The length of the JSON data
- */
-void ws_bridge_send_json_from_any_thread(const char *json, size_t len) {
-	if (json == NULL || len == 0) return;
-	pthread_mutex_lock(&g_ws_mutex);
-	unsigned long id = g_ws_conn_id;
-	pthread_mutex_unlock(&g_ws_mutex);
-	if (id != 0) {
-		mg_wakeup(&g_mgr, id, json, len);
+		// Stop the connection's simulation; the session is reaped once it finishes
+		if (!c->is_websocket) return;
+		if (watched_session(c) == 0) {
+			session_manager_close(c->id);
+		} else {
+			session_t *session = session_manager_find(watched_session(c));
+			if (session != NULL) ws_bridge_unsubscribe(&session->stream, c->id);
+		}
 	}
 }
 
 int main(int argc, char *argv[]) {
-	// Initialize context and process args
-	init_context(&g_ctx);
-	if (!process_args(argc, argv, &g_ctx.params)) return 1;
+	// Process args; each session initializes its own context per run on "start"
+	if (!process_args(argc, argv, &g_params)) return 1;
+	if (g_params.binary_log_path[0] != '\0' && g_params.max_sessions > 1) {
+		fprintf(stderr, "Error: -binlog records carry no session; run the server with -sessions 1.\n");
+		return 1;
+	}
+	if (!session_manager_init(&g_params)) return 1;
 
 	// Register websocket handler
 	websocket_handler_register();
@@ -317,13 +396,29 @@ int main(int argc, char *argv[]) {
 	// Server mode: send over websocket
 	set_log_mode(LOG_MODE_SERVER);
 
+	// Durable log: the binary sink next to the websocket one, with a filter of its own
+	if (g_params.binary_log_path[0] != '\0') {
+		static const log_filter_t s_durable_filter = LOG_FILTER_ALL;
+		binary_handler_register();
+		if (!binary_handler_open(g_params.binary_log_path, g_params.log_overflow_policy)) return 1;
+		log_router_attach_sink(log_router_registered_handler(LOG_MODE_BINARY), &s_durable_filter);
+	}
+	if (g_params.trace_path[0] != '\0') {
+		static const log_filter_t s_trace_filter = LOG_FILTER_ALL;
+		trace_handler_register();
+		if (!trace_handler_open(g_params.trace_path, g_params.log_overflow_policy)) return 1;
+		log_router_attach_sink(log_router_registered_handler(LOG_MODE_TRACE), &s_trace_filter);
+	}
+
 	mg_mgr_init(&g_mgr); // Initialise event manager
+	host_usage_set_event_loop_thread(); // this thread polls it
+	ws_bridge_configure(&g_mgr, g_params.ws_flush_interval_ms, g_params.ws_batch_bytes,
+		g_params.ws_budget_bytes, g_params.ws_overflow_policy, g_params.ws_lag_cap_bytes);
 
 	// Initialise wakeup pipe for cross-thread notifications
 	if (!mg_wakeup_init(&g_mgr)) {
 		fprintf(stderr, "Failed to initialise Mongoose wakeup pipe\n");
 		mg_mgr_free(&g_mgr);
-		destroy_context(&g_ctx);
 		return 1;
 	}
 
@@ -331,16 +426,24 @@ int main(int argc, char *argv[]) {
 	if (mg_http_listen(&g_mgr, s_listen_on, fn, NULL) == NULL) {
 		fprintf(stderr, "Failed to start Mongoose at %s\n", s_listen_on);
 		mg_mgr_free(&g_mgr);
-		destroy_context(&g_ctx);
 		return 1;
 	}
 
-	printf("Starting WS listener on %s%s\n", s_listen_on, s_ws_path_primary);
-	for (;;) mg_mgr_poll(&g_mgr, 100); // Infinite event loop
+	printf("Starting WS listener on %s%s (up to %d sessions)\n", s_listen_on, s_ws_path_primary,
+		g_params.max_sessions);
+	// Wake at least once per flush interval so batches never wait longer
+	int flush_ms = ws_bridge_flush_interval_ms();
+	int poll_ms = flush_ms > 0 && flush_ms < 100 ? flush_ms : 100;
+	for (;;) { // Infinite event loop
+		mg_mgr_poll(&g_mgr, poll_ms);
+		session_manager_reap();
+	}
 
 	// Unreachable in normal flow
+	session_manager_destroy();
+	binary_handler_close();
+	trace_handler_close(g_params.is_quiet);
 	mg_mgr_free(&g_mgr);
-	destroy_context(&g_ctx);
 	return 0;
 }
 
@@ -0,0 +1,230 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "session_manager.h"
+#include "log_router.h"
+#include "checkpoint.h"
+#include "stats_export.h"
+
+extern int g_debug;
+
+static simulation_parameters_t g_session_params;
+static session_t** g_sessions = NULL; // max_sessions slots, NULL when free
+static int g_max_sessions = 0;
+
+int session_manager_init(const simulation_parameters_t* params) {
+    g_session_params = *params;
+    g_max_sessions = params->max_sessions;
+    g_sessions = calloc(g_max_sessions, sizeof(session_t*));
+    if (g_sessions == NULL) {
+        fprintf(stderr, "Error: Failed to allocate session table\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Joins the session's runner and releases its context.
+ *
+ * @param session A session whose simulation is not running.
+ */
+static void release_run(session_t* session) {
+    if (!session->runner_started) return;
+    pthread_join(session->runner_thread, NULL);
+    simulation_context_destroy(&session->ctx);
+    session->runner_started = 0;
+}
+
+static void free_session(int slot) {
+    session_t* session = g_sessions[slot];
+    release_run(session);
+    ws_bridge_destroy_stream(&session->stream);
+    pthread_mutex_destroy(&session->state_mutex);
+    free(session);
+    g_sessions[slot] = NULL;
+}
+
+void session_manager_destroy(void) {
+    for (int i = 0; i < g_max_sessions; i++) {
+        if (g_sessions[i] == NULL) continue;
+        session_manager_close(g_sessions[i]->conn_id);
+        free_session(i);
+    }
+    free(g_sessions);
+    g_sessions = NULL;
+    g_max_sessions = 0;
+}
+
+session_t* session_manager_open(unsigned long conn_id, int protocol) {
+    for (int i = 0; i < g_max_sessions; i++) {
+        if (g_sessions[i] != NULL) continue;
+
+        session_t* session = calloc(1, sizeof(session_t));
+        if (session == NULL) {
+            fprintf(stderr, "Error: Failed to allocate session\n");
+            return NULL;
+        }
+        session->conn_id = conn_id;
+        ws_bridge_init_stream(&session->stream, conn_id, protocol);
+        session->params = g_session_params;
+        snprintf(session->checkpoint_path, sizeof(session->checkpoint_path), "%s.%lu",
+            g_session_params.checkpoint_path[0] != '\0' ? g_session_params.checkpoint_path : CHECKPOINT_DEFAULT_PATH,
+            conn_id);
+        pthread_mutex_init(&session->state_mutex, NULL);
+        g_sessions[i] = session;
+        if (g_debug) printf("Session opened for connection %lu\n", conn_id);
+        return session;
+    }
+    return NULL;
+}
+
+session_t* session_manager_find(unsigned long conn_id) {
+    for (int i = 0; i < g_max_sessions; i++) {
+        if (g_sessions[i] != NULL && !g_sessions[i]->is_closed && g_sessions[i]->conn_id == conn_id) {
+            return g_sessions[i];
+        }
+    }
+    return NULL;
+}
+
+void session_manager_close(unsigned long conn_id) {
+    session_t* session = session_manager_find(conn_id);
+    if (session == NULL) return;
+
+    ws_bridge_detach_stream(&session->stream);
+    session_stop(session);
+    session->is_closed = 1;
+    if (g_debug) printf("Session closed for connection %lu\n", conn_id);
+}
+
+void session_manager_reap(void) {
+    for (int i = 0; i < g_max_sessions; i++) {
+        if (g_sessions[i] == NULL || !g_sessions[i]->is_closed) continue;
+        if (session_is_running(g_sessions[i])) continue;
+        free_session(i);
+    }
+}
+
+int session_manager_count(void) {
+    int count = 0;
+    for (int i = 0; i < g_max_sessions; i++) {
+        if (g_sessions[i] != NULL) count++;
+    }
+    return count;
+}
+
+int session_manager_read_snapshots(stats_snapshot_data_t* snapshots, unsigned long* session_ids, int max_snapshots) {
+    int count = 0;
+    for (int i = 0; i < g_max_sessions && count < max_snapshots; i++) {
+        session_t* session = g_sessions[i];
+        if (session == NULL || session->is_closed || !session->runner_started) continue;
+        if (!stats_snapshot_read(&session->ctx.snapshot, &snapshots[count])) continue;
+        session_ids[count++] = session->conn_id;
+    }
+    return count;
+}
+
+static void* session_runner(void* arg) {
+    session_t* session = (session_t*)arg;
+    if (g_debug) printf("Session runner for connection %lu started\n", session->conn_id);
+
+    simulation_context_join(&session->ctx);
+    if (session->ctx.checkpoint_now) {
+        char buf[sizeof(session->checkpoint_path) + 64];
+        int saved = checkpoint_save(&session->ctx, session->checkpoint_path);
+        snprintf(buf, sizeof(buf), "{\"type\":\"checkpoint\", \"saved\":%s, \"path\":\"%s\"}",
+            saved ? "true" : "false", session->checkpoint_path);
+        ws_bridge_send_json_from_any_thread(&session->stream, buf, strlen(buf));
+    } else {
+        simulation_context_finish(&session->ctx);
+        if (session->params.stats_out_path[0] != '\0') {
+            stats_export_append(session->params.stats_out_path, &session->ctx.params, &session->ctx.stats,
+                STATS_EXPORT_ENGINE_SERVER);
+        }
+    }
+
+    pthread_mutex_lock(&session->state_mutex);
+    session->is_running = 0;
+    pthread_mutex_unlock(&session->state_mutex);
+    if (g_debug) printf("Session runner for connection %lu finished\n", session->conn_id);
+    return NULL;
+}
+
+int session_start(session_t* session) {
+    pthread_mutex_lock(&session->state_mutex);
+    if (session->is_running) {
+        pthread_mutex_unlock(&session->state_mutex);
+        return FALSE;
+    }
+    session->is_running = 1;
+    pthread_mutex_unlock(&session->state_mutex);
+
+    // Reap the previous run and start from a fresh context
+    release_run(session);
+    simulation_context_init(&session->ctx, &session->params);
+    session->ctx.log_context = &session->stream;
+    session->ctx.is_publishing_snapshot = 1;
+    session->stream.is_text_events = session->params.ws_text_events;
+
+    // Create the pipeline threads here so a stop can never race their creation
+    simulation_context_start(&session->ctx);
+    log_router_bind_thread_context(NULL);
+    log_router_bind_thread_filter(NULL);
+
+    session->runner_started = 1;
+    pthread_create(&session->runner_thread, NULL, session_runner, session);
+    return TRUE;
+}
+
+int session_checkpoint(session_t* session) {
+    if (!session_is_running(session)) return FALSE;
+    simulation_context_request_checkpoint(&session->ctx);
+    return TRUE;
+}
+
+int session_resume(session_t* session) {
+    pthread_mutex_lock(&session->state_mutex);
+    if (session->is_running) {
+        pthread_mutex_unlock(&session->state_mutex);
+        return FALSE;
+    }
+    session->is_running = 1;
+    pthread_mutex_unlock(&session->state_mutex);
+
+    release_run(session);
+    if (!checkpoint_load(&session->ctx, session->checkpoint_path, &session->params)) {
+        pthread_mutex_lock(&session->state_mutex);
+        session->is_running = 0;
+        pthread_mutex_unlock(&session->state_mutex);
+        return FALSE;
+    }
+    session->ctx.log_context = &session->stream;
+    session->ctx.is_publishing_snapshot = 1;
+    session->stream.is_text_events = session->params.ws_text_events;
+
+    simulation_context_resume(&session->ctx);
+    log_router_bind_thread_context(NULL);
+    log_router_bind_thread_filter(NULL);
+
+    session->runner_started = 1;
+    pthread_create(&session->runner_thread, NULL, session_runner, session);
+    return TRUE;
+}
+
+const char* session_checkpoint_path(const session_t* session) {
+    return session->checkpoint_path;
+}
+
+void session_stop(session_t* session) {
+    if (session_is_running(session)) simulation_context_request_stop(&session->ctx);
+}
+
+int session_is_running(session_t* session) {
+    pthread_mutex_lock(&session->state_mutex);
+    int running = session->is_running;
+    pthread_mutex_unlock(&session->state_mutex);
+    return running;
+}
@@ -0,0 +1,451 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "simulation_context.h"
+#include "log_router.h"
+#include "signalcatcher.h"
+#include "timeutils.h"
+
+extern int g_debug;
+
+void simulation_context_init(simulation_context_t* ctx, const simulation_parameters_t* params) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->params = *params;
+    ctx->stats = (simulation_statistics_t){0};
+    queueing_model_predict(&ctx->params, &ctx->stats.model);
+    steady_state_configure(&ctx->stats.steady_state, params->model.warmup_method, params->model.warmup_amount);
+    ctx->all_jobs_arrived = 0;
+    ctx->all_jobs_served = 0;
+    ctx->terminate_now = 0;
+    ctx->checkpoint_now = 0;
+    ctx->rng_state = params->model.seed;
+    ctx->next_job_index = 0;
+    ctx->previous_job_arrival_time_us = 0;
+    ctx->next_job_arrival_time_us = 0;
+    ctx->checkpoint_time_us = 0;
+    ctx->log_filter = (log_filter_t){
+        .verbosity = params->log_verbosity,
+        .disabled_events = params->log_disabled_events,
+        .sample_every = params->log_sample_every
+    };
+
+    pthread_mutex_init(&ctx->job_queue_mutex, NULL);
+    pthread_mutex_init(&ctx->paper_refill_queue_mutex, NULL);
+    pthread_mutex_init(&ctx->stats_mutex, NULL);
+    pthread_mutex_init(&ctx->simulation_state_mutex, NULL);
+    pthread_cond_init(&ctx->job_queue_not_empty_cv, NULL);
+    pthread_cond_init(&ctx->refill_needed_cv, NULL);
+    pthread_cond_init(&ctx->refill_supplier_cv, NULL);
+    pthread_cond_init(&ctx->metrics_sampler_cv, NULL);
+    metrics_ring_init(&ctx->metrics);
+
+    if (params->is_profiling_locks) {
+        lock_profile_set_add(&ctx->locks, "job_queue_mutex", &ctx->job_queue_mutex, FALSE);
+        lock_profile_set_add(&ctx->locks, "paper_refill_queue_mutex", &ctx->paper_refill_queue_mutex, FALSE);
+        lock_profile_set_add(&ctx->locks, "stats_mutex", &ctx->stats_mutex, FALSE);
+        lock_profile_set_add(&ctx->locks, "simulation_state_mutex", &ctx->simulation_state_mutex, FALSE);
+        lock_profile_set_add(&ctx->locks, "job_queue_not_empty_cv", &ctx->job_queue_not_empty_cv, TRUE);
+        lock_profile_set_add(&ctx->locks, "refill_needed_cv", &ctx->refill_needed_cv, TRUE);
+        lock_profile_set_add(&ctx->locks, "refill_supplier_cv", &ctx->refill_supplier_cv, TRUE);
+        lock_profile_set_add(&ctx->locks, "metrics_sampler_cv", &ctx->metrics_sampler_cv, TRUE);
+    }
+
+    timed_queue_init(&ctx->job_queue);
+    list_init(&ctx->paper_refill_queue);
+
+    // Concrete printer instances
+    ctx->printer1 = (printer_t){.id = 1, .current_paper_count = params->model.printer_paper_capacity, .capacity = params->model.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
+    ctx->printer2 = (printer_t){.id = 2, .current_paper_count = params->model.printer_paper_capacity, .capacity = params->model.printer_paper_capacity, .total_papers_used = 0, .jobs_printed_count = 0};
+
+    // Thread argument structs
+    ctx->job_receiver_args = (job_thread_args_t){
+        .job_queue_mutex = &ctx->job_queue_mutex,
+        .stats_mutex = &ctx->stats_mutex,
+        .simulation_state_mutex = &ctx->simulation_state_mutex,
+        .job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
+        .job_queue = &ctx->job_queue,
+        .simulation_params = &ctx->params,
+        .stats = &ctx->stats,
+        .all_jobs_arrived = &ctx->all_jobs_arrived,
+        .terminate_now = &ctx->terminate_now,
+        .checkpoint_now = &ctx->checkpoint_now,
+        .rng_state = &ctx->rng_state,
+        .next_job_index = &ctx->next_job_index,
+        .previous_job_arrival_time_us = &ctx->previous_job_arrival_time_us,
+        .next_job_arrival_time_us = &ctx->next_job_arrival_time_us
+    };
+
+    ctx->printer1_args = (printer_thread_args_t){
+        .paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
+        .job_queue_mutex = &ctx->job_queue_mutex,
+        .stats_mutex = &ctx->stats_mutex,
+        .simulation_state_mutex = &ctx->simulation_state_mutex,
+        .job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
+        .refill_needed_cv = &ctx->refill_needed_cv,
+        .refill_supplier_cv = &ctx->refill_supplier_cv,
+        .paper_refill_thread = &ctx->paper_refill_thread,
+        .job_queue = &ctx->job_queue,
+        .paper_refill_queue = &ctx->paper_refill_queue,
+        .params = &ctx->params,
+        .stats = &ctx->stats,
+        .all_jobs_served = &ctx->all_jobs_served,
+        .all_jobs_arrived = &ctx->all_jobs_arrived,
+        .terminate_now = &ctx->terminate_now,
+        .checkpoint_now = &ctx->checkpoint_now,
+        .printer = &ctx->printer1
+    };
+    ctx->printer2_args = ctx->printer1_args;
+    ctx->printer2_args.printer = &ctx->printer2;
+
+    ctx->paper_refill_args = (paper_refill_thread_args_t){
+        .paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
+        .stats_mutex = &ctx->stats_mutex,
+        .simulation_state_mutex = &ctx->simulation_state_mutex,
+        .refill_needed_cv = &ctx->refill_needed_cv,
+        .refill_supplier_cv = &ctx->refill_supplier_cv,
+        .paper_refill_queue = &ctx->paper_refill_queue,
+        .params = &ctx->params,
+        .stats = &ctx->stats,
+        .all_jobs_served = &ctx->all_jobs_served,
+        .terminate_now = &ctx->terminate_now,
+        .checkpoint_now = &ctx->checkpoint_now
+    };
+}
+
+void simulation_context_destroy(simulation_context_t* ctx) {
+    // Jobs left queued by a checkpoint (or a failed restore) belong to the context
+    while (!timed_queue_is_empty(&ctx->job_queue)) {
+        list_node_t* node = timed_queue_dequeue_front(&ctx->job_queue);
+        free(node->data);
+        free(node);
+    }
+
+    pthread_mutex_destroy(&ctx->job_queue_mutex);
+    pthread_mutex_destroy(&ctx->paper_refill_queue_mutex);
+    pthread_mutex_destroy(&ctx->stats_mutex);
+    pthread_mutex_destroy(&ctx->simulation_state_mutex);
+    pthread_cond_destroy(&ctx->job_queue_not_empty_cv);
+    pthread_cond_destroy(&ctx->refill_needed_cv);
+    pthread_cond_destroy(&ctx->refill_supplier_cv);
+    pthread_cond_destroy(&ctx->metrics_sampler_cv);
+    metrics_ring_destroy(&ctx->metrics);
+}
+
+/**
+ * @brief Records the exiting thread's host usage; runs on cancellation too.
+ */
+static void record_thread_usage(void* arg) {
+    thread_usage_read_self((thread_usage_t*)arg);
+}
+
+static void* pipeline_thread_start(void* arg) {
+    simulation_thread_start_t* start = (simulation_thread_start_t*)arg;
+    log_router_bind_thread_context(start->log_context);
+    log_router_bind_thread_filter(start->log_filter);
+    lock_profile_bind_thread(start->locks);
+    void* result;
+    pthread_cleanup_push(record_thread_usage, start->usage);
+    result = start->func(start->arg);
+    pthread_cleanup_pop(1);
+    return result;
+}
+
+/**
+ * @brief Binds the calling thread to the run's log context and filter.
+ *
+ * @param ctx The context the thread logs for.
+ */
+static void bind_log_thread(simulation_context_t* ctx) {
+    log_router_bind_thread_context(ctx->log_context);
+    log_router_bind_thread_filter(&ctx->log_filter);
+}
+
+/**
+ * @brief Creates a pipeline thread that logs on behalf of the context.
+ *
+ * @param ctx The context the thread belongs to.
+ * @param slot The index of the start routine slot to use.
+ * @param thread Pointer to store the thread identifier.
+ * @param func The thread function.
+ * @param arg The thread function argument.
+ */
+static void create_pipeline_thread(simulation_context_t* ctx, int slot, pthread_t* thread,
+    void* (*func)(void*), void* arg)
+{
+    ctx->thread_starts[slot] = (simulation_thread_start_t){
+        .func = func, .arg = arg, .log_context = ctx->log_context, .log_filter = &ctx->log_filter,
+        .locks = ctx->locks.count > 0 ? &ctx->locks : NULL, .usage = &ctx->usage.threads[slot]};
+    pthread_create(thread, NULL, pipeline_thread_start, &ctx->thread_starts[slot]);
+}
+
+// --- Metrics sampler ---
+// Sampling interval of a run that only publishes its snapshot
+#define SNAPSHOT_INTERVAL_MS 1000
+
+// Cumulative counts at the previous sample, to turn them into per-interval counts
+typedef struct metrics_totals {
+    double jobs_arrived;
+    double jobs_served;
+    double jobs_dropped;
+} metrics_totals_t;
+
+/**
+ * @brief Returns whether the sampler thread runs for this context.
+ */
+static int is_sampling(const simulation_context_t* ctx) {
+    return ctx->params.metrics_interval_ms > 0 || ctx->is_publishing_snapshot;
+}
+
+/**
+ * @brief Snapshots the run. Takes the job queue mutex then the stats mutex,
+ *        the order the pipeline uses, so every gauge is read consistently.
+ *        Publishes the statistics snapshot too if the context has one.
+ *
+ * @param ctx The context to sample.
+ * @param previous The previous sample's cumulative counts, updated to the current ones.
+ * @param sample Filled with the snapshot.
+ * @param is_last Whether this is the last sample, taken once the pipeline has joined.
+ */
+static void take_metrics_sample(simulation_context_t* ctx, metrics_totals_t* previous,
+    metrics_sample_t* sample, int is_last)
+{
+    profiled_mutex_lock(&ctx->job_queue_mutex);
+    profiled_mutex_lock(&ctx->stats_mutex);
+    unsigned long time_us = get_time_in_us() - ctx->stats.simulation_start_time_us;
+    sample->interval_us = time_us - sample->time_us;
+    sample->time_us = time_us;
+    sample->queue_length = timed_queue_length(&ctx->job_queue);
+    sample->jobs_in_service[0] = ctx->printer1.is_printing;
+    sample->jobs_in_service[1] = ctx->printer2.is_printing;
+    sample->paper_level[0] = ctx->printer1.current_paper_count;
+    sample->paper_level[1] = ctx->printer2.current_paper_count;
+    sample->jobs_arrived = (unsigned int)(ctx->stats.total_jobs_arrived - previous->jobs_arrived);
+    sample->jobs_served = (unsigned int)(ctx->stats.total_jobs_served - previous->jobs_served);
+    sample->jobs_dropped = (unsigned int)(ctx->stats.total_jobs_dropped - previous->jobs_dropped);
+    previous->jobs_arrived = ctx->stats.total_jobs_arrived;
+    previous->jobs_served = ctx->stats.total_jobs_served;
+    previous->jobs_dropped = ctx->stats.total_jobs_dropped;
+
+    if (ctx->is_publishing_snapshot) {
+        stats_snapshot_data_t data;
+        stats_snapshot_fill(&ctx->stats, time_us, &data);
+        data.is_running = !is_last;
+        data.queue_length = sample->queue_length;
+        data.is_printing[0] = sample->jobs_in_service[0];
+        data.is_printing[1] = sample->jobs_in_service[1];
+        data.paper_level[0] = sample->paper_level[0];
+        data.paper_level[1] = sample->paper_level[1];
+        stats_snapshot_publish(&ctx->snapshot, &data);
+    }
+    profiled_mutex_unlock(&ctx->stats_mutex);
+    profiled_mutex_unlock(&ctx->job_queue_mutex);
+}
+
+/**
+ * @brief Samples the run every metrics interval into the ring and emits each
+ *        sample, or only publishes the snapshot every SNAPSHOT_INTERVAL_MS when
+ *        the run has no metrics interval, until simulation_context_join stops
+ *        it after a last sample.
+ *
+ * @param arg Pointer to the simulation context.
+ * @return NULL
+ */
+static void* metrics_sampler_thread_func(void* arg) {
+    simulation_context_t* ctx = (simulation_context_t*)arg;
+    metrics_sample_t sample = {0};
+
+    // A resumed run counts from its checkpoint
+    profiled_mutex_lock(&ctx->stats_mutex);
+    metrics_totals_t previous = {ctx->stats.total_jobs_arrived, ctx->stats.total_jobs_served,
+        ctx->stats.total_jobs_dropped};
+    sample.time_us = get_time_in_us() - ctx->stats.simulation_start_time_us;
+    profiled_mutex_unlock(&ctx->stats_mutex);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    int is_done = FALSE;
+    while (!is_done) {
+        // Deadlines advance by whole intervals so sampling does not drift
+        int interval_ms = ctx->params.metrics_interval_ms > 0 ? ctx->params.metrics_interval_ms : SNAPSHOT_INTERVAL_MS;
+        long interval_ns = (long)interval_ms * 1000000L;
+        deadline.tv_sec += interval_ns / 1000000000L;
+        deadline.tv_nsec += interval_ns % 1000000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+
+        profiled_mutex_lock(&ctx->simulation_state_mutex);
+        while (!ctx->is_sampling_done) {
+            // ETIMEDOUT: time for the next sample
+            if (profiled_cond_timedwait(&ctx->metrics_sampler_cv, &ctx->simulation_state_mutex, &deadline) != 0) break;
+        }
+        is_done = ctx->is_sampling_done;
+        profiled_mutex_unlock(&ctx->simulation_state_mutex);
+
+        take_metrics_sample(ctx, &previous, &sample, is_done);
+        if (ctx->params.metrics_interval_ms > 0) {
+            unsigned long number = metrics_ring_push(&ctx->metrics, &sample);
+            emit_metrics_sample(&sample, number);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Creates the pipeline threads in dependency order.
+ *
+ * @param ctx The context to run.
+ */
+static void create_pipeline_threads(simulation_context_t* ctx) {
+    // 1) Job receiver (produces jobs)
+    create_pipeline_thread(ctx, 0, &ctx->job_receiver_thread, job_receiver_thread_func, &ctx->job_receiver_args);
+
+    // 2) Paper refiller (services refill requests)
+    create_pipeline_thread(ctx, 1, &ctx->paper_refill_thread, paper_refill_thread_func, &ctx->paper_refill_args);
+
+    // 3) Printers (consumers)
+    create_pipeline_thread(ctx, 2, &ctx->printer1_thread, printer_thread_func, &ctx->printer1_args);
+    create_pipeline_thread(ctx, 3, &ctx->printer2_thread, printer_thread_func, &ctx->printer2_args);
+
+    // 4) Metrics sampler (observes the others)
+    if (is_sampling(ctx)) {
+        create_pipeline_thread(ctx, 4, &ctx->metrics_sampler_thread, metrics_sampler_thread_func, ctx);
+    }
+}
+
+void simulation_context_start(simulation_context_t* ctx) {
+    bind_log_thread(ctx);
+
+    // --- Start of simulation logging ---
+    emit_simulation_parameters(&ctx->params);
+    stats_record_simulation_start(&ctx->stats, get_time_in_us());
+    emit_simulation_start(&ctx->stats);
+
+    create_pipeline_threads(ctx);
+}
+
+void simulation_context_resume(simulation_context_t* ctx) {
+    bind_log_thread(ctx);
+
+    emit_simulation_parameters(&ctx->params);
+    emit_simulation_resumed(&ctx->stats);
+
+    create_pipeline_threads(ctx);
+}
+
+void simulation_context_join(simulation_context_t* ctx) {
+    // Join producer first so no new jobs are created
+    pthread_join(ctx->job_receiver_thread, NULL);
+    if (g_debug) printf("job_receiver_thread joined\n");
+
+    // Join the printers
+    pthread_join(ctx->printer1_thread, NULL);
+    if (g_debug) printf("printer1 thread joined\n");
+    pthread_join(ctx->printer2_thread, NULL);
+    if (g_debug) printf("printer2 thread joined\n");
+
+    // Join paper refiller
+    pthread_join(ctx->paper_refill_thread, NULL);
+    if (g_debug) printf("paper_refill_thread joined\n");
+
+    // Stop the sampler once it has recorded the drained pipeline
+    if (is_sampling(ctx)) {
+        profiled_mutex_lock(&ctx->simulation_state_mutex);
+        ctx->is_sampling_done = 1;
+        pthread_cond_signal(&ctx->metrics_sampler_cv);
+        profiled_mutex_unlock(&ctx->simulation_state_mutex);
+        pthread_join(ctx->metrics_sampler_thread, NULL);
+        if (g_debug) printf("metrics_sampler_thread joined\n");
+    }
+}
+
+void simulation_context_finish(simulation_context_t* ctx) {
+    bind_log_thread(ctx);
+    stats_record_simulation_end(&ctx->stats, get_time_in_us());
+    emit_simulation_end(&ctx->stats);
+    emit_statistics(&ctx->stats);
+    host_usage_finish(&ctx->usage, ctx->stats.total_jobs_arrived);
+    emit_host_usage(&ctx->usage);
+    if (ctx->locks.count > 0) emit_lock_statistics(&ctx->locks);
+}
+
+void simulation_context_run(simulation_context_t* ctx) {
+    simulation_context_start(ctx);
+    simulation_context_join(ctx);
+    simulation_context_finish(ctx);
+}
+
+void simulation_context_request_stop(simulation_context_t* ctx) {
+    // The caller may serve several runs; log on behalf of this one only
+    void* previous_log_context = log_router_thread_context();
+    const log_filter_t* previous_log_filter = log_router_thread_filter();
+    bind_log_thread(ctx);
+
+    // Emulate signal catcher logic to stop simulation gracefully
+    profiled_mutex_lock(&ctx->simulation_state_mutex);
+    ctx->terminate_now = 1;
+    ctx->all_jobs_arrived = 1;
+    profiled_mutex_unlock(&ctx->simulation_state_mutex);
+
+    profiled_mutex_lock(&ctx->stats_mutex);
+    stats_record_simulation_end(&ctx->stats, get_time_in_us());
+    emit_simulation_stopped(&ctx->stats);
+    profiled_mutex_unlock(&ctx->stats_mutex);
+
+    pthread_cancel(ctx->job_receiver_thread);
+    pthread_cancel(ctx->paper_refill_thread);
+
+    // Lock in defined order and empty queue
+    profiled_mutex_lock(&ctx->job_queue_mutex);
+    profiled_mutex_lock(&ctx->stats_mutex);
+    empty_queue_if_terminating(&ctx->job_queue, &ctx->stats);
+    pthread_cond_broadcast(&ctx->job_queue_not_empty_cv);
+    profiled_mutex_unlock(&ctx->stats_mutex);
+    profiled_mutex_unlock(&ctx->job_queue_mutex);
+
+    // Wake up any printers or refiller that might be waiting
+    profiled_mutex_lock(&ctx->paper_refill_queue_mutex);
+    pthread_cond_broadcast(&ctx->refill_needed_cv);
+    pthread_cond_broadcast(&ctx->refill_supplier_cv);
+    profiled_mutex_unlock(&ctx->paper_refill_queue_mutex);
+
+    log_router_bind_thread_context(previous_log_context);
+    log_router_bind_thread_filter(previous_log_filter);
+}
+
+void simulation_context_request_checkpoint(simulation_context_t* ctx) {
+    void* previous_log_context = log_router_thread_context();
+    const log_filter_t* previous_log_filter = log_router_thread_filter();
+    bind_log_thread(ctx);
+
+    profiled_mutex_lock(&ctx->simulation_state_mutex);
+    ctx->checkpoint_now = 1;
+    ctx->checkpoint_time_us = get_time_in_us();
+    profiled_mutex_unlock(&ctx->simulation_state_mutex);
+
+    profiled_mutex_lock(&ctx->stats_mutex);
+    emit_simulation_checkpoint(&ctx->stats);
+    profiled_mutex_unlock(&ctx->stats_mutex);
+
+    // The receiver finishes its current sleep and rolls back the pending job by itself.
+    // A refill in progress is abandoned; the printer asks again after resuming.
+    pthread_cancel(ctx->paper_refill_thread);
+
+    // Wake idle printers so they see the flag; the queue stays intact
+    profiled_mutex_lock(&ctx->job_queue_mutex);
+    pthread_cond_broadcast(&ctx->job_queue_not_empty_cv);
+    profiled_mutex_unlock(&ctx->job_queue_mutex);
+
+    profiled_mutex_lock(&ctx->paper_refill_queue_mutex);
+    pthread_cond_broadcast(&ctx->refill_needed_cv);
+    pthread_cond_broadcast(&ctx->refill_supplier_cv);
+    profiled_mutex_unlock(&ctx->paper_refill_queue_mutex);
+
+    log_router_bind_thread_context(previous_log_context);
+    log_router_bind_thread_filter(previous_log_filter);
+}
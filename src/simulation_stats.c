@@ -1,169 +1,509 @@
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 #include <pthread.h>
 
 #include "simulation_stats.h"
+#include "job_receiver.h"
+
+/**
+ * Two-sided 95% critical values of the Student t distribution for 1..30
+ * degrees of freedom. Larger samples use the normal approximation.
+ */
+static const double t_critical_95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+// Percentiles reported for every latency distribution, followed by the maximum
+static const double reported_percentiles[] = {50.0, 90.0, 99.0, 99.9};
+#define REPORTED_PERCENTILE_COUNT (int)(sizeof(reported_percentiles) / sizeof(reported_percentiles[0]))
+
+// The latency distributions in report order
+static const struct {
+    const char* json_key;
+    const char* label;
+    size_t offset; // offset into simulation_statistics_t
+} latency_metrics[] = {
+    {"system_time_sec",      "System Time:           ", offsetof(simulation_statistics_t, system_time_histogram)},
+    {"queue_wait_sec",       "Queue Wait:            ", offsetof(simulation_statistics_t, queue_wait_histogram)},
+    {"service_time_p1_sec",  "Service (Printer 1):   ", offsetof(simulation_statistics_t, service_time_p1_histogram)},
+    {"service_time_p2_sec",  "Service (Printer 2):   ", offsetof(simulation_statistics_t, service_time_p2_histogram)},
+    {"paper_empty_stall_sec", "Paper Empty Stall:     ", offsetof(simulation_statistics_t, paper_empty_histogram)},
+};
+#define LATENCY_METRIC_COUNT (int)(sizeof(latency_metrics) / sizeof(latency_metrics[0]))
+
+// The timing moments in report order
+static const struct {
+    const char* json_key;
+    const char* label;
+    size_t offset; // offset into simulation_statistics_t
+} moment_metrics[] = {
+    {"system_time_sec",      "System Time:           ", offsetof(simulation_statistics_t, system_time_moments)},
+    {"queue_wait_sec",       "Queue Wait:            ", offsetof(simulation_statistics_t, queue_wait_moments)},
+    {"service_time_p1_sec",  "Service (Printer 1):   ", offsetof(simulation_statistics_t, service_time_p1_moments)},
+    {"service_time_p2_sec",  "Service (Printer 2):   ", offsetof(simulation_statistics_t, service_time_p2_moments)},
+    {"refill_time_sec",      "Paper Refill:          ", offsetof(simulation_statistics_t, refill_time_moments)},
+};
+#define MOMENT_METRIC_COUNT (int)(sizeof(moment_metrics) / sizeof(moment_metrics[0]))
+// Mean, standard deviation, minimum, maximum and skewness
+#define MOMENT_VALUE_COUNT 5
+
+// Names of the values of write_statistics_values before the latency percentiles
+static const char* const summary_value_names[] = {
+    "simulation_duration_sec", "total_jobs_arrived", "total_jobs_served", "total_jobs_dropped",
+    "total_jobs_removed", "job_arrival_rate_per_sec", "job_drop_probability", "avg_inter_arrival_time_sec",
+    "avg_system_time_sec", "system_time_std_dev_sec", "avg_queue_wait_time_sec", "avg_queue_length",
+    "max_queue_length", "jobs_served_by_printer1", "printer1_paper_used", "jobs_served_by_printer2",
+    "printer2_paper_used", "avg_service_time_p1_sec", "avg_service_time_p2_sec", "utilization_p1",
+    "utilization_p2", "paper_refill_events", "total_refill_service_time_sec", "papers_refilled",
+    "model_stable", "model_utilization", "model_avg_queue_wait_mmc_sec", "model_avg_queue_wait_mdc_sec",
+    "model_avg_queue_wait_dgc_sec", "model_avg_queue_length_mmc", "model_avg_system_time_mmc_sec", "model_drop_probability_mmck"
+};
+#define SUMMARY_VALUE_COUNT (int)(sizeof(summary_value_names) / sizeof(summary_value_names[0]))
+static const char* const latency_value_names[] = {"p50", "p90", "p99", "p99_9", "max"};
+static const char* const moment_value_names[] = {"mean", "std_dev", "min", "max", "skewness"};
+static const char* const steady_state_value_names[] = {"warmup_cut_sec", "warmup_cut_jobs_served"};
 
 // --- Private Helper Functions ---
 /**
- * @brief Calculates the average inter-arrival time in seconds.
+ * @brief Takes the run's cumulative counters.
  * @param stats Pointer to simulation_statistics_t struct.
+ * @param time_us The time of the mark since the start of the simulation.
+ * @param mark Filled with the counters.
+ */
+static void stats_mark_take(const simulation_statistics_t* stats, unsigned long time_us, stats_mark_t* mark) {
+    mark->time_us = time_us;
+    mark->jobs_arrived = stats->total_jobs_arrived;
+    mark->jobs_served = stats->total_jobs_served;
+    mark->jobs_dropped = stats->total_jobs_dropped;
+    mark->jobs_served_by_printer[0] = stats->jobs_served_by_printer1;
+    mark->jobs_served_by_printer[1] = stats->jobs_served_by_printer2;
+    mark->inter_arrival_time_us = stats->total_inter_arrival_time_us;
+    mark->system_time_us = stats->total_system_time_us;
+    mark->queue_wait_time_us = stats->total_queue_wait_time_us;
+    mark->service_time_us[0] = stats->total_service_time_p1_us;
+    mark->service_time_us[1] = stats->total_service_time_p2_us;
+    mark->area_num_in_job_queue_us = stats->area_num_in_job_queue_us;
+}
+
+/**
+ * @brief Calculates the average inter-arrival time in seconds.
+ * @param window The counters of the averaged window.
+ * @param intervals The number of inter-arrival times in the window.
  * @return Average inter-arrival time in seconds.
  */
-static double calculate_average_inter_arrival_time(simulation_statistics_t* stats) {
-    if (stats->total_jobs_arrived <= 1) {
+static double calculate_average_inter_arrival_time(const stats_mark_t* window, double intervals) {
+    if (intervals <= 0) {
         return 0.0;
     }
-    return ((double)stats->total_inter_arrival_time_us / 1000000.0) / (stats->total_jobs_arrived - 1);
+    return ((double)window->inter_arrival_time_us / 1000000.0) / intervals;
 }
 
 /**
  * @brief Calculates the average system time in seconds.
- * @param stats Pointer to simulation_statistics_t struct.
+ * @param window The counters of the averaged window.
  * @return Average system time in seconds.
  */
-static double calculate_average_system_time(simulation_statistics_t* stats) {
-    if (stats->total_jobs_served == 0) {
+static double calculate_average_system_time(const stats_mark_t* window) {
+    if (window->jobs_served == 0) {
         return 0.0;
     }
-    return ((double)stats->total_system_time_us / 1000000.0) / stats->total_jobs_served;
+    return ((double)window->system_time_us / 1000000.0) / window->jobs_served;
 }
 
 /**
  * @brief Calculates the average queue wait time in seconds.
- * @param stats Pointer to simulation_statistics_t struct.
+ * @param window The counters of the averaged window.
  * @return Average queue wait time in seconds.
  */
-static double calculate_average_queue_wait_time(simulation_statistics_t* stats) {
-    if (stats->total_jobs_served == 0) {
+static double calculate_average_queue_wait_time(const stats_mark_t* window) {
+    if (window->jobs_served == 0) {
         return 0.0;
     }
-    return ((double)stats->total_queue_wait_time_us / 1000000.0) / stats->total_jobs_served;
+    return ((double)window->queue_wait_time_us / 1000000.0) / window->jobs_served;
 }
 
 /**
- * @brief Calculates the average service time for Printer 1 in seconds.
- * @param stats Pointer to simulation_statistics_t struct.
- * @return Average service time for Printer 1 in seconds.
+ * @brief Calculates the average service time of a printer in seconds.
+ * @param window The counters of the averaged window.
+ * @param printer The index of the printer, 0 for printer 1.
+ * @return Average service time of the printer in seconds.
  */
-static double calculate_average_service_time_p1(simulation_statistics_t* stats) {
-    if (stats->jobs_served_by_printer1 == 0) {
+static double calculate_average_service_time(const stats_mark_t* window, int printer) {
+    if (window->jobs_served_by_printer[printer] == 0) {
         return 0.0;
     }
-    return ((double)stats->total_service_time_p1_us / 1000000.0) / stats->jobs_served_by_printer1;
+    return ((double)window->service_time_us[printer] / 1000000.0) / window->jobs_served_by_printer[printer];
 }
 
 /**
- * @brief Calculates the average service time for Printer 2 in seconds.
- * @param stats Pointer to simulation_statistics_t struct.
- * @return Average service time for Printer 2 in seconds.
+ * @brief Calculates the average number of jobs in the queue.
+ * @param window The counters of the averaged window.
+ * @return Average number of jobs in the queue.
  */
-static double calculate_average_service_time_p2(simulation_statistics_t* stats) {
-    if (stats->jobs_served_by_printer2 == 0) {
+static double calculate_average_queue_length(const stats_mark_t* window) {
+    if (window->time_us == 0) {
         return 0.0;
     }
-    return ((double)stats->total_service_time_p2_us / 1000000.0) / stats->jobs_served_by_printer2;
+    return ((double)window->area_num_in_job_queue_us) / window->time_us;
 }
 
 /**
- * @brief Calculates the average number of jobs in the queue.
+ * @brief Calculates the standard deviation of system time in seconds.
  * @param stats Pointer to simulation_statistics_t struct.
- * @return Average number of jobs in the queue.
+ * @return Standard deviation of system time in seconds.
  */
-static double calculate_average_queue_length(simulation_statistics_t* stats) {
-    if (stats->simulation_duration_us == 0) {
+static double calculate_system_time_std_dev(simulation_statistics_t* stats) {
+    return streaming_moments_std_dev(&stats->system_time_moments) / 1000000.0;
+}
+
+/**
+ * @brief Calculates the utilization of a printer.
+ * @param window The counters of the averaged window.
+ * @param printer The index of the printer, 0 for printer 1.
+ * @return Utilization of the printer (a value between 0 and 1).
+ */
+static double calculate_system_utilization(const stats_mark_t* window, int printer) {
+    if (window->time_us == 0) {
         return 0.0;
     }
-    return ((double)stats->area_num_in_job_queue_us) / stats->simulation_duration_us;
+    return ((double)window->service_time_us[printer]) / window->time_us;
 }
 
 /**
- * @brief Calculates the standard deviation of system time in seconds.
- * @param stats Pointer to simulation_statistics_t struct.
- * @return Standard deviation of system time in seconds.
+ * @brief Calculates the job arrival rate (jobs per second).
+ * @param window The counters of the averaged window.
+ * @return Job arrival rate in jobs per second.
  */
-static double calculate_system_time_std_dev(simulation_statistics_t* stats) {
-    if (stats->total_jobs_served <= 1) {
+static double calculate_job_arrival_rate(const stats_mark_t* window) {
+    if (window->time_us == 0) {
+        return 0.0;
+    }
+    // Convert the window duration from microseconds to seconds (multiply by 1.0e-6)
+    double window_duration_sec = window->time_us * 1.0e-6;
+    return window->jobs_arrived / window_duration_sec;
+}
+
+/**
+ * @brief Calculates the job drop probability.
+ * @param window The counters of the averaged window.
+ * @return Job drop probability (a value between 0 and 1).
+ */
+static double calculate_job_drop_probability(const stats_mark_t* window) {
+    if (window->jobs_arrived == 0) {
         return 0.0;
     }
-    double avg_system_time = calculate_average_system_time(stats);
-    double avg_system_time_us = avg_system_time * 1000000.0;
+    return window->jobs_dropped / window->jobs_arrived;
+}
 
-    double avg_time_sq = stats->sum_of_system_time_squared_us2 / stats->total_jobs_served;
+/**
+ * @brief Calculates the relative error of a measurement against a prediction.
+ * @param measured The measured value.
+ * @param predicted The predicted value.
+ * @return (measured - predicted) / predicted, or 0 if the prediction is 0.
+ */
+static double relative_error(double measured, double predicted) {
+    if (predicted == 0.0) {
+        return 0.0;
+    }
+    return (measured - predicted) / predicted;
+}
 
-    double variance = avg_time_sq - (avg_system_time_us * avg_system_time_us);
-    return sqrt(variance > 0 ? variance : 0) / 1000000.0; // Convert back to seconds for display consistency
+/**
+ * @brief Returns the histogram of a latency distribution.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param metric The index into latency_metrics.
+ */
+static const latency_histogram_t* latency_metric_histogram(const simulation_statistics_t* stats, int metric) {
+    return (const latency_histogram_t*)((const char*)stats + latency_metrics[metric].offset);
 }
 
 /**
- * @brief Calculates the system utilization for Printer 1.
+ * @brief Returns the moments of a timing metric.
  * @param stats Pointer to simulation_statistics_t struct.
- * @return Utilization of Printer 1 (a value between 0 and 1).
+ * @param metric The index into moment_metrics.
  */
-static double calculate_system_utilization_p1(simulation_statistics_t* stats) {
-    if (stats->simulation_duration_us == 0) {
-        return 0.0;
+static const streaming_moments_t* moment_metric_moments(const simulation_statistics_t* stats, int metric) {
+    return (const streaming_moments_t*)((const char*)stats + moment_metrics[metric].offset);
+}
+
+/**
+ * @brief Calculates the summary of a timing metric's moments.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param metric The index into moment_metrics.
+ * @param values Filled with the mean, standard deviation, minimum and maximum in seconds, then the skewness.
+ */
+static void calculate_moment_summary(const simulation_statistics_t* stats, int metric, double* values) {
+    const streaming_moments_t* moments = moment_metric_moments(stats, metric);
+    int is_empty = moments->count == 0;
+    values[0] = moments->mean / 1000000.0;
+    values[1] = streaming_moments_std_dev(moments) / 1000000.0;
+    values[2] = is_empty ? 0.0 : moments->min / 1000000.0;
+    values[3] = is_empty ? 0.0 : moments->max / 1000000.0;
+    values[4] = streaming_moments_skewness(moments);
+}
+
+/**
+ * @brief Writes the timing moments as a JSON object, one member per metric.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param buf A character buffer to hold the JSON object.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written, as snprintf.
+ */
+static int write_moments_to_buffer(const simulation_statistics_t* stats, char* buf, int buf_size) {
+    int len = snprintf(buf, buf_size, "{");
+    for (int metric = 0; metric < MOMENT_METRIC_COUNT && len < buf_size; metric++) {
+        double values[MOMENT_VALUE_COUNT];
+        calculate_moment_summary(stats, metric, values);
+        len += snprintf(buf + len, buf_size - len,
+            "%s\"%s\":{\"count\":%lu,\"mean\":%.3g,\"std_dev\":%.3g,\"min\":%.3g,\"max\":%.3g,\"skewness\":%.3g}",
+            metric > 0 ? "," : "", moment_metrics[metric].json_key,
+            moment_metric_moments(stats, metric)->count,
+            values[0], values[1], values[2], values[3], values[4]);
     }
-    return ((double)stats->total_service_time_p1_us) / stats->simulation_duration_us;
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, "}");
+    return len;
 }
 
 /**
- * @brief Calculates the system utilization for Printer 2.
+ * @brief Calculates the reported percentiles and the maximum of a latency distribution.
  * @param stats Pointer to simulation_statistics_t struct.
- * @return Utilization of Printer 2 (a value between 0 and 1).
+ * @param metric The index into latency_metrics.
+ * @param values Filled with REPORTED_PERCENTILE_COUNT percentiles then the maximum, in seconds.
  */
-static double calculate_system_utilization_p2(simulation_statistics_t* stats) {
-    if (stats->simulation_duration_us == 0) {
-        return 0.0;
+static void calculate_latency_summary(const simulation_statistics_t* stats, int metric, double* values) {
+    const latency_histogram_t* histogram = latency_metric_histogram(stats, metric);
+    for (int i = 0; i < REPORTED_PERCENTILE_COUNT; i++) {
+        values[i] = latency_histogram_percentile(histogram, reported_percentiles[i]) / 1000000.0;
     }
-    return ((double)stats->total_service_time_p2_us) / stats->simulation_duration_us;
+    values[REPORTED_PERCENTILE_COUNT] = histogram->max_us / 1000000.0;
 }
 
 /**
- * @brief Calculates the job arrival rate (jobs per second).
+ * @brief Writes the latency percentiles as a JSON object, one member per distribution.
  * @param stats Pointer to simulation_statistics_t struct.
- * @return Job arrival rate in jobs per second.
+ * @param buf A character buffer to hold the JSON object.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written, as snprintf.
  */
-static double calculate_job_arrival_rate(simulation_statistics_t* stats) {
-    if (stats->simulation_duration_us == 0) {
-        return 0.0;
+static int write_latency_to_buffer(const simulation_statistics_t* stats, char* buf, int buf_size) {
+    int len = snprintf(buf, buf_size, "{");
+    for (int metric = 0; metric < LATENCY_METRIC_COUNT && len < buf_size; metric++) {
+        double values[REPORTED_PERCENTILE_COUNT + 1];
+        calculate_latency_summary(stats, metric, values);
+        len += snprintf(buf + len, buf_size - len,
+            "%s\"%s\":{\"count\":%lu,\"p50\":%.3g,\"p90\":%.3g,\"p99\":%.3g,\"p99_9\":%.3g,\"max\":%.3g}",
+            metric > 0 ? "," : "", latency_metrics[metric].json_key,
+            latency_metric_histogram(stats, metric)->total_count,
+            values[0], values[1], values[2], values[3], values[4]);
     }
-    // Convert simulation duration from microseconds to seconds (multiply by 1.0e-6)
-    double simulation_duration_sec = stats->simulation_duration_us * 1.0e-6;
-    return stats->total_jobs_arrived / simulation_duration_sec;
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, "}");
+    return len;
 }
 
 /**
- * @brief Calculates the job drop probability.
+ * @brief Writes the queueing model predictions with their relative errors as a JSON object.
  * @param stats Pointer to simulation_statistics_t struct.
- * @return Job drop probability (a value between 0 and 1).
+ * @param derived The derived statistics to compare the predictions against.
+ * @param buf A character buffer to hold the JSON object.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes that the object needs, as snprintf.
  */
-static double calculate_job_drop_probability(simulation_statistics_t* stats) {
-    if (stats->total_jobs_arrived == 0) {
-        return 0.0;
+static int write_model_to_buffer(simulation_statistics_t* stats,
+    const simulation_derived_statistics_t* derived, char* buf, int buf_size)
+{
+    const queueing_model_t* model = &stats->model;
+    double measured_utilization = (derived->utilization_p1 + derived->utilization_p2) / 2.0;
+
+    if (!model->is_stable) {
+        // Offered load is above capacity, so only the carried load is comparable to the measurement
+        return snprintf(buf, buf_size,
+            "{\"stable\":false,\"utilization\":%.3g,"
+            "\"carried_utilization\":%.3g,\"carried_utilization_rel_error\":%.3g,"
+            "\"drop_probability_mmck\":%.3g,\"drop_probability_rel_error\":%.3g}",
+            model->utilization, model->carried_utilization,
+            relative_error(measured_utilization, model->carried_utilization),
+            model->drop_probability_mmck,
+            relative_error(derived->job_drop_probability, model->drop_probability_mmck));
     }
-    return stats->total_jobs_dropped / stats->total_jobs_arrived;
+    return snprintf(buf, buf_size,
+        "{\"stable\":true,"
+        "\"utilization\":%.3g,\"utilization_rel_error\":%.3g,"
+        "\"avg_queue_wait_mmc_sec\":%.3g,\"avg_queue_wait_mmc_rel_error\":%.3g,"
+        "\"avg_queue_wait_mdc_sec\":%.3g,\"avg_queue_wait_mdc_rel_error\":%.3g,"
+        "\"avg_queue_wait_dgc_sec\":%.3g,\"avg_queue_wait_dgc_rel_error\":%.3g,"
+        "\"avg_queue_length_mmc\":%.3g,\"avg_queue_length_rel_error\":%.3g,"
+        "\"avg_system_time_mmc_sec\":%.3g,\"avg_system_time_rel_error\":%.3g,"
+        "\"drop_probability_mmck\":%.3g,\"drop_probability_rel_error\":%.3g}",
+        model->utilization, relative_error(measured_utilization, model->utilization),
+        model->avg_queue_wait_mmc_sec,
+        relative_error(derived->avg_queue_wait_time_sec, model->avg_queue_wait_mmc_sec),
+        model->avg_queue_wait_mdc_sec,
+        relative_error(derived->avg_queue_wait_time_sec, model->avg_queue_wait_mdc_sec),
+        model->avg_queue_wait_dgc_sec,
+        relative_error(derived->avg_queue_wait_time_sec, model->avg_queue_wait_dgc_sec),
+        model->avg_queue_length_mmc,
+        relative_error(derived->avg_queue_length, model->avg_queue_length_mmc),
+        model->avg_system_time_mmc_sec,
+        relative_error(derived->avg_system_time_sec, model->avg_system_time_mmc_sec),
+        model->drop_probability_mmck,
+        relative_error(derived->job_drop_probability, model->drop_probability_mmck));
+}
+
+/**
+ * @brief Prints one prediction next to its measurement and relative error.
+ * @param label The padded label of the line.
+ * @param predicted The predicted value.
+ * @param measured The measured value.
+ */
+static void log_model_line(const char* label, double predicted, double measured) {
+    printf("%spredicted %.3g, measured %.3g (%+.1f%%)\n",
+        label, predicted, measured, relative_error(measured, predicted) * 100);
 }
 
 // --- Public API Function Implementations ---
+void stats_record_simulation_start(simulation_statistics_t* stats, unsigned long start_time_us) {
+    stats->simulation_start_time_us = start_time_us;
+}
+
+void stats_record_simulation_end(simulation_statistics_t* stats, unsigned long end_time_us) {
+    stats->simulation_duration_us = end_time_us - stats->simulation_start_time_us;
+}
+
+void stats_record_job_arrival(simulation_statistics_t* stats,
+    unsigned long previous_job_arrival_time_us, unsigned long job_arrival_time_us)
+{
+    stats->total_inter_arrival_time_us +=
+        job_arrival_time_us - previous_job_arrival_time_us; // stats: avg job inter-arrival time
+    stats->total_jobs_arrived += 1; // stats: total jobs arrived
+}
+
+void stats_record_job_dropped(simulation_statistics_t* stats) {
+    stats->total_jobs_dropped += 1; // stats: total jobs dropped
+}
+
+void stats_record_queue_length_change(simulation_statistics_t* stats, unsigned long time_us,
+    unsigned long last_interaction_time_us, int previous_length)
+{
+    stats->area_num_in_job_queue_us +=
+        (time_us - last_interaction_time_us) * previous_length; // stats: avg job queue length
+}
+
+void stats_record_queue_arrival(simulation_statistics_t* stats, unsigned long time_us,
+    unsigned long last_interaction_time_us, int previous_length)
+{
+    stats_record_queue_length_change(stats, time_us, last_interaction_time_us, previous_length);
+    if (previous_length > stats->max_job_queue_length) {
+        stats->max_job_queue_length = previous_length; // stats: max job queue length
+    }
+}
+
+void stats_record_job_removed(simulation_statistics_t* stats) {
+    stats->total_jobs_removed += 1; // stats: total jobs removed
+}
+
+void stats_record_paper_empty(simulation_statistics_t* stats, int printer_id, unsigned long duration_us) {
+    latency_histogram_record(&stats->paper_empty_histogram, duration_us); // stats: paper empty stall percentiles
+    if (printer_id == 1) {
+        stats->printer1_paper_empty_time_us += duration_us; // stats: total time printer 1 was idle due to no paper
+    } else if (printer_id == 2) {
+        stats->printer2_paper_empty_time_us += duration_us; // stats: total time printer 2 was idle due to no paper
+    }
+}
+
+void stats_record_paper_refill(simulation_statistics_t* stats, int papers, unsigned long duration_us) {
+    stats->papers_refilled += papers; // stats: total papers refilled
+    stats->total_refill_service_time_us += duration_us; // stats: total time spent refilling
+    stats->paper_refill_events++; // stats: number of refills
+    streaming_moments_add(&stats->refill_time_moments, duration_us); // stats: refill time spread
+}
+
+void stats_record_job_departure(simulation_statistics_t* stats, const job_t* job, int printer_id) {
+    unsigned long system_time = job->service_departure_time_us - job->system_arrival_time_us;
+    stats->total_system_time_us += system_time; // stats: avg job system time
+    streaming_moments_add(&stats->system_time_moments, system_time); // stats: stddev job system time
+    stats->total_jobs_served += 1; // stats: total jobs served
+    latency_histogram_record(&stats->system_time_histogram, system_time); // stats: system time percentiles
+
+    unsigned long service_duration = job->service_departure_time_us - job->service_arrival_time_us;
+    if (printer_id == 1) {
+        stats->total_service_time_p1_us += service_duration; // stats: avg job service time
+        streaming_moments_add(&stats->service_time_p1_moments, service_duration); // stats: service time spread
+        latency_histogram_record(&stats->service_time_p1_histogram, service_duration); // stats: service time percentiles
+        stats->jobs_served_by_printer1 += 1; // stats: total jobs served by printer 1
+        stats->printer1_paper_used += job->papers_required; // stats: total paper used by printer 1
+    } else if (printer_id == 2) {
+        stats->total_service_time_p2_us += service_duration; // stats: avg job service time
+        streaming_moments_add(&stats->service_time_p2_moments, service_duration); // stats: service time spread
+        latency_histogram_record(&stats->service_time_p2_histogram, service_duration); // stats: service time percentiles
+        stats->jobs_served_by_printer2 += 1; // stats: total jobs served by printer 2
+        stats->printer2_paper_used += job->papers_required; // stats: total paper used by printer 2
+    }
+    unsigned long queue_wait = job->queue_departure_time_us - job->queue_arrival_time_us;
+    stats->total_queue_wait_time_us += queue_wait; // stats: avg job queue wait time
+    streaming_moments_add(&stats->queue_wait_moments, queue_wait); // stats: queue wait spread
+    latency_histogram_record(&stats->queue_wait_histogram, queue_wait); // stats: queue wait percentiles
+
+    stats_mark_t mark;
+    stats_mark_take(stats, job->service_departure_time_us - stats->simulation_start_time_us, &mark);
+    steady_state_observe(&stats->steady_state, &mark); // stats: warm-up cut
+}
+
+void calculate_derived_statistics(simulation_statistics_t* stats, simulation_derived_statistics_t* derived) {
+    // Averages cover the window from the warm-up cut, if any, to the end of the run
+    stats_mark_t end, cut, window;
+    stats_mark_take(stats, stats->simulation_duration_us, &end);
+    derived->is_truncated = steady_state_cut(&stats->steady_state, &cut);
+    stats_mark_window(&end, &cut, &window);
+    // The first arrival of the run has no inter-arrival time; one after the cut has
+    double intervals = derived->is_truncated ? window.jobs_arrived : window.jobs_arrived - 1;
+
+    derived->simulation_duration_sec = stats->simulation_duration_us / 1000000.0;
+    derived->warmup_cut_sec = cut.time_us / 1000000.0;
+    derived->warmup_cut_jobs_served = cut.jobs_served;
+    derived->job_arrival_rate_per_sec = calculate_job_arrival_rate(&window);
+    derived->job_drop_probability = calculate_job_drop_probability(&window);
+    derived->avg_inter_arrival_time_sec = calculate_average_inter_arrival_time(&window, intervals);
+    derived->avg_system_time_sec = calculate_average_system_time(&window);
+    derived->system_time_std_dev_sec = calculate_system_time_std_dev(stats);
+    derived->avg_queue_wait_time_sec = calculate_average_queue_wait_time(&window);
+    derived->avg_queue_length = calculate_average_queue_length(&window);
+    derived->avg_service_time_p1_sec = calculate_average_service_time(&window, 0);
+    derived->avg_service_time_p2_sec = calculate_average_service_time(&window, 1);
+    derived->utilization_p1 = calculate_system_utilization(&window, 0);
+    derived->utilization_p2 = calculate_system_utilization(&window, 1);
+}
+
+void calculate_confidence_interval_95(const double* samples, int count, double* mean, double* half_width) {
+    *mean = 0.0;
+    *half_width = 0.0;
+    if (count <= 0) return;
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    *mean = sum / count;
+    if (count < 2) return;
+
+    double sum_sq_dev = 0.0;
+    for (int i = 0; i < count; i++) sum_sq_dev += (samples[i] - *mean) * (samples[i] - *mean);
+    double std_dev = sqrt(sum_sq_dev / (count - 1));
+
+    int degrees_of_freedom = count - 1;
+    int table_size = sizeof(t_critical_95) / sizeof(t_critical_95[0]);
+    double t = degrees_of_freedom <= table_size ? t_critical_95[degrees_of_freedom - 1] : 1.960;
+    *half_width = t * std_dev / sqrt(count);
+}
+
 int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size) {
     if (stats == NULL || buf == NULL || buf_size <= 0) return -1;
 
     // Calculate derived statistics
-    double avg_inter_arrival_time = calculate_average_inter_arrival_time(stats);
-    double avg_system_time = calculate_average_system_time(stats);
-    double avg_queue_wait_time = calculate_average_queue_wait_time(stats);
-    double avg_service_time_p1 = calculate_average_service_time_p1(stats);
-    double avg_service_time_p2 = calculate_average_service_time_p2(stats);
-    double avg_queue_length = calculate_average_queue_length(stats);
-    double system_time_std_dev = calculate_system_time_std_dev(stats);
-    double utilization_p1 = calculate_system_utilization_p1(stats);
-    double utilization_p2 = calculate_system_utilization_p2(stats);
-    double job_arrival_rate = calculate_job_arrival_rate(stats);
-    double job_drop_probability = calculate_job_drop_probability(stats);
-    double simulation_time_sec = stats->simulation_duration_us / 1000000.0;
-    
+    simulation_derived_statistics_t derived;
+    calculate_derived_statistics(stats, &derived);
+
     // Build comprehensive JSON statistics message
     int len = snprintf(buf, buf_size,
         "{\"type\":\"statistics\", \"data\":{"
@@ -190,77 +530,159 @@ int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int bu
         "\"utilization_p2\":%.3g,"
         "\"paper_refill_events\":%.0f,"
         "\"total_refill_service_time_us\":%.3g,"
-        "\"papers_refilled\":%d"
-        "}}",
-        simulation_time_sec,
+        "\"papers_refilled\":%d",
+        derived.simulation_duration_sec,
         stats->total_jobs_arrived,
         stats->total_jobs_served,
         stats->total_jobs_dropped,
         stats->total_jobs_removed,
-        job_arrival_rate,
-        job_drop_probability,
-        avg_inter_arrival_time,
-        avg_system_time,
-        system_time_std_dev,
-        avg_queue_wait_time,
-        avg_queue_length,
+        derived.job_arrival_rate_per_sec,
+        derived.job_drop_probability,
+        derived.avg_inter_arrival_time_sec,
+        derived.avg_system_time_sec,
+        derived.system_time_std_dev_sec,
+        derived.avg_queue_wait_time_sec,
+        derived.avg_queue_length,
         stats->max_job_queue_length,
         stats->jobs_served_by_printer1,
         stats->printer1_paper_used,
         stats->jobs_served_by_printer2,
         stats->printer2_paper_used,
-        avg_service_time_p1,
-        avg_service_time_p2,
-        utilization_p1,
-        utilization_p2,
+        derived.avg_service_time_p1_sec,
+        derived.avg_service_time_p2_sec,
+        derived.utilization_p1,
+        derived.utilization_p2,
         stats->paper_refill_events,
         stats->total_refill_service_time_us / 1000000.0,
         stats->papers_refilled
     );
 
+    // Append the warm-up cut, the latency percentiles, the timing moments, the analytical baseline and close the message
+    if (len < buf_size) {
+        len += snprintf(buf + len, buf_size - len,
+            ",\"steady_state\":{\"method\":\"%s\",\"truncated\":%s,\"cut_time_sec\":%.3g,\"cut_jobs_served\":%.0f}",
+            warmup_method_name(stats->steady_state.method), derived.is_truncated ? "true" : "false",
+            derived.warmup_cut_sec, derived.warmup_cut_jobs_served);
+    }
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, ",\"latency\":");
+    if (len < buf_size) len += write_latency_to_buffer(stats, buf + len, buf_size - len);
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, ",\"moments\":");
+    if (len < buf_size) len += write_moments_to_buffer(stats, buf + len, buf_size - len);
+    if (stats->model.is_valid && len < buf_size) {
+        len += snprintf(buf + len, buf_size - len, ",\"model\":");
+        if (len < buf_size) len += write_model_to_buffer(stats, &derived, buf + len, buf_size - len);
+    }
+    if (len < buf_size) len += snprintf(buf + len, buf_size - len, "}}");
+
     return len;
 }
 
+int write_statistics_values(simulation_statistics_t* stats, double* values, int max_values) {
+    simulation_derived_statistics_t derived;
+    calculate_derived_statistics(stats, &derived);
+    const queueing_model_t* model = &stats->model;
+    int is_stable = model->is_valid && model->is_stable;
+
+    double all[STATISTICS_VALUE_COUNT] = {
+        derived.simulation_duration_sec,
+        stats->total_jobs_arrived,
+        stats->total_jobs_served,
+        stats->total_jobs_dropped,
+        stats->total_jobs_removed,
+        derived.job_arrival_rate_per_sec,
+        derived.job_drop_probability,
+        derived.avg_inter_arrival_time_sec,
+        derived.avg_system_time_sec,
+        derived.system_time_std_dev_sec,
+        derived.avg_queue_wait_time_sec,
+        derived.avg_queue_length,
+        stats->max_job_queue_length,
+        stats->jobs_served_by_printer1,
+        stats->printer1_paper_used,
+        stats->jobs_served_by_printer2,
+        stats->printer2_paper_used,
+        derived.avg_service_time_p1_sec,
+        derived.avg_service_time_p2_sec,
+        derived.utilization_p1,
+        derived.utilization_p2,
+        stats->paper_refill_events,
+        stats->total_refill_service_time_us / 1000000.0,
+        stats->papers_refilled,
+        model->is_valid ? model->is_stable : NAN,
+        model->is_valid ? model->utilization : NAN,
+        is_stable ? model->avg_queue_wait_mmc_sec : NAN,
+        is_stable ? model->avg_queue_wait_mdc_sec : NAN,
+        is_stable ? model->avg_queue_wait_dgc_sec : NAN,
+        is_stable ? model->avg_queue_length_mmc : NAN,
+        is_stable ? model->avg_system_time_mmc_sec : NAN,
+        model->is_valid ? model->drop_probability_mmck : NAN
+    };
+    double* steady_state = all + STATISTICS_VALUE_COUNT - 2;
+    steady_state[0] = derived.warmup_cut_sec;
+    steady_state[1] = derived.warmup_cut_jobs_served;
+    double* moments = steady_state - MOMENT_METRIC_COUNT * MOMENT_VALUE_COUNT;
+    double* latency = moments - LATENCY_METRIC_COUNT * (REPORTED_PERCENTILE_COUNT + 1);
+    for (int metric = 0; metric < LATENCY_METRIC_COUNT; metric++) {
+        calculate_latency_summary(stats, metric, latency + metric * (REPORTED_PERCENTILE_COUNT + 1));
+    }
+    for (int metric = 0; metric < MOMENT_METRIC_COUNT; metric++) {
+        calculate_moment_summary(stats, metric, moments + metric * MOMENT_VALUE_COUNT);
+    }
+    int count = max_values < STATISTICS_VALUE_COUNT ? max_values : STATISTICS_VALUE_COUNT;
+    memcpy(values, all, count * sizeof(double));
+    return count;
+}
+
+void statistics_value_name(int index, char* buf, int buf_size) {
+    int latency_end = SUMMARY_VALUE_COUNT + LATENCY_METRIC_COUNT * (REPORTED_PERCENTILE_COUNT + 1);
+    int moments_end = latency_end + MOMENT_METRIC_COUNT * MOMENT_VALUE_COUNT;
+    if (index < 0 || index >= STATISTICS_VALUE_COUNT) {
+        snprintf(buf, buf_size, "value_%d", index);
+    } else if (index < SUMMARY_VALUE_COUNT) {
+        snprintf(buf, buf_size, "%s", summary_value_names[index]);
+    } else if (index < latency_end) {
+        int offset = index - SUMMARY_VALUE_COUNT;
+        snprintf(buf, buf_size, "latency_%s_%s", latency_metrics[offset / (REPORTED_PERCENTILE_COUNT + 1)].json_key,
+            latency_value_names[offset % (REPORTED_PERCENTILE_COUNT + 1)]);
+    } else if (index < moments_end) {
+        int offset = index - latency_end;
+        snprintf(buf, buf_size, "moments_%s_%s", moment_metrics[offset / MOMENT_VALUE_COUNT].json_key,
+            moment_value_names[offset % MOMENT_VALUE_COUNT]);
+    } else {
+        snprintf(buf, buf_size, "%s", steady_state_value_names[index - moments_end]);
+    }
+}
+
 void log_statistics(simulation_statistics_t* stats) {
     if (stats == NULL) return;
     
     // Calculate derived statistics (same calculations as publish_statistics)
-    double avg_inter_arrival_time = calculate_average_inter_arrival_time(stats);
-    double avg_system_time = calculate_average_system_time(stats);
-    double avg_queue_wait_time = calculate_average_queue_wait_time(stats);
-    double avg_service_time_p1 = calculate_average_service_time_p1(stats);
-    double avg_service_time_p2 = calculate_average_service_time_p2(stats);
-    double avg_queue_length = calculate_average_queue_length(stats);
-    double system_time_std_dev = calculate_system_time_std_dev(stats);
-    double utilization_p1 = calculate_system_utilization_p1(stats);
-    double utilization_p2 = calculate_system_utilization_p2(stats);
-    double job_arrival_rate = calculate_job_arrival_rate(stats);
-    double job_drop_probability = calculate_job_drop_probability(stats);
-    double simulation_time_sec = stats->simulation_duration_us / 1000000.0;
+    simulation_derived_statistics_t derived;
+    calculate_derived_statistics(stats, &derived);
     
     // Print formatted statistics to stdout
     flockfile(stdout);
     
     printf("\n");
     printf("================= SIMULATION STATISTICS =================\n");
-    printf("Simulation Duration:               %.3g sec\n", simulation_time_sec);
+    printf("Simulation Duration:               %.3g sec\n", derived.simulation_duration_sec);
     printf("\n");
     printf("--- Job Flow Statistics ---\n");
     printf("Total Jobs Arrived:                %.0f\n", stats->total_jobs_arrived);
     printf("Total Jobs Served:                 %.0f\n", stats->total_jobs_served);
     printf("Total Jobs Dropped:                %.0f\n", stats->total_jobs_dropped);
     printf("Total Jobs Removed:                %.0f\n", stats->total_jobs_removed);
-    printf("Job Arrival Rate (λ):              %.3g jobs/sec\n", job_arrival_rate);
-    printf("Job Drop Probability:              %.3g (%.2f%%)\n", job_drop_probability, job_drop_probability * 100);
+    printf("Job Arrival Rate (λ):              %.3g jobs/sec\n", derived.job_arrival_rate_per_sec);
+    printf("Job Drop Probability:              %.3g (%.2f%%)\n", derived.job_drop_probability, derived.job_drop_probability * 100);
     printf("\n");
     printf("--- Timing Statistics ---\n");
-    printf("Average Inter-arrival Time:        %.3g sec\n", avg_inter_arrival_time);
-    printf("Average System Time:               %.3g sec\n", avg_system_time);
-    printf("System Time Standard Deviation:    %.3g sec\n", system_time_std_dev);
-    printf("Average Queue Wait Time:           %.3g sec\n", avg_queue_wait_time);
+    printf("Average Inter-arrival Time:        %.3g sec\n", derived.avg_inter_arrival_time_sec);
+    printf("Average System Time:               %.3g sec\n", derived.avg_system_time_sec);
+    printf("System Time Standard Deviation:    %.3g sec\n", derived.system_time_std_dev_sec);
+    printf("Average Queue Wait Time:           %.3g sec\n", derived.avg_queue_wait_time_sec);
     printf("\n");
     printf("--- Queue Statistics ---\n");
-    printf("Average Queue Length:              %.3g jobs\n", avg_queue_length);
+    printf("Average Queue Length:              %.3g jobs\n", derived.avg_queue_length);
     printf("Maximum Queue Length:              %u jobs\n", stats->max_job_queue_length);
     printf("\n");
     printf("--- Printer Statistics ---\n");
@@ -268,15 +690,60 @@ void log_statistics(simulation_statistics_t* stats) {
     printf("Total Paper Used by Printer 1:     %d\n", stats->printer1_paper_used);
     printf("Jobs Served by Printer 2:          %.0f\n", stats->jobs_served_by_printer2);
     printf("Total Paper Used by Printer 2:     %d\n", stats->printer2_paper_used);
-    printf("Avg Service Time (Printer 1):      %.3g sec\n", avg_service_time_p1);
-    printf("Avg Service Time (Printer 2):      %.3g sec\n", avg_service_time_p2);
-    printf("Utilization (Printer 1):           %.3g%%\n", utilization_p1 * 100);
-    printf("Utilization (Printer 2):           %.3g%%\n", utilization_p2 * 100);
+    printf("Avg Service Time (Printer 1):      %.3g sec\n", derived.avg_service_time_p1_sec);
+    printf("Avg Service Time (Printer 2):      %.3g sec\n", derived.avg_service_time_p2_sec);
+    printf("Utilization (Printer 1):           %.3g%%\n", derived.utilization_p1 * 100);
+    printf("Utilization (Printer 2):           %.3g%%\n", derived.utilization_p2 * 100);
     printf("\n");
     printf("--- Paper Management ---\n");
     printf("Paper Refill Events:               %.0f\n", stats->paper_refill_events);
     printf("Total Refill Service Time:         %.3g sec\n", stats->total_refill_service_time_us / 1000000.0);
     printf("Papers Refilled:                   %d\n", stats->papers_refilled);
+    printf("\n");
+    printf("--- Steady State ---\n");
+    if (derived.is_truncated) {
+        printf("Warm-up Cut:                       %.3g sec, %.0f jobs served (%s)\n", derived.warmup_cut_sec,
+            derived.warmup_cut_jobs_served, warmup_method_name(stats->steady_state.method));
+    } else {
+        printf("Warm-up Cut:                       none, averages cover the whole run\n");
+    }
+    printf("\n");
+    printf("--- Latency Percentiles (sec) ---\n");
+    printf("%23s %8s %8s %8s %8s %8s\n", "", "p50", "p90", "p99", "p99.9", "max");
+    for (int metric = 0; metric < LATENCY_METRIC_COUNT; metric++) {
+        double values[REPORTED_PERCENTILE_COUNT + 1];
+        calculate_latency_summary(stats, metric, values);
+        printf("%s %8.3g %8.3g %8.3g %8.3g %8.3g\n", latency_metrics[metric].label,
+            values[0], values[1], values[2], values[3], values[4]);
+    }
+    printf("\n");
+    printf("--- Timing Moments (sec) ---\n");
+    printf("%23s %8s %8s %8s %8s %8s\n", "", "mean", "std dev", "min", "max", "skew");
+    for (int metric = 0; metric < MOMENT_METRIC_COUNT; metric++) {
+        double values[MOMENT_VALUE_COUNT];
+        calculate_moment_summary(stats, metric, values);
+        printf("%s %8.3g %8.3g %8.3g %8.3g %8.3g\n", moment_metrics[metric].label,
+            values[0], values[1], values[2], values[3], values[4]);
+    }
+    if (stats->model.is_valid) {
+        const queueing_model_t* model = &stats->model;
+        printf("\n");
+        printf("--- Queueing Model Baseline (c = %d, K = %d) ---\n", model->servers, model->system_capacity);
+        printf("Arrivals are evenly spaced: the M/ models assume Poisson arrivals, D/G/c does not.\n");
+        double measured_utilization = (derived.utilization_p1 + derived.utilization_p2) / 2.0;
+        if (model->is_stable) {
+            log_model_line("Utilization (ρ):                   ", model->utilization, measured_utilization);
+            log_model_line("Avg Queue Wait M/M/c (sec):        ", model->avg_queue_wait_mmc_sec, derived.avg_queue_wait_time_sec);
+            log_model_line("Avg Queue Wait M/D/c (sec):        ", model->avg_queue_wait_mdc_sec, derived.avg_queue_wait_time_sec);
+            log_model_line("Avg Queue Wait D/G/c (sec):        ", model->avg_queue_wait_dgc_sec, derived.avg_queue_wait_time_sec);
+            log_model_line("Avg Queue Length M/M/c (jobs):     ", model->avg_queue_length_mmc, derived.avg_queue_length);
+            log_model_line("Avg System Time M/M/c (sec):       ", model->avg_system_time_mmc_sec, derived.avg_system_time_sec);
+        } else {
+            printf("Offered Load (ρ):                  %.3g, unstable (ρ >= 1)\n", model->utilization);
+            log_model_line("Carried Load M/M/c/K:              ", model->carried_utilization, measured_utilization);
+        }
+        log_model_line("Drop Probability M/M/c/K:          ", model->drop_probability_mmck, derived.job_drop_probability);
+    }
     printf("=========================================================\n");
     
     funlockfile(stdout);
@@ -298,7 +765,8 @@ void debug_statistics(const simulation_statistics_t* stats) {
     printf("total_jobs_removed: %.0f\n", stats->total_jobs_removed);
     printf("total_inter_arrival_time_us: %lu\n", stats->total_inter_arrival_time_us);
     printf("total_system_time_us: %lu\n", stats->total_system_time_us);
-    printf("sum_of_system_time_squared_us2: %.0f\n", stats->sum_of_system_time_squared_us2);
+    printf("system_time_moments: count %lu, mean %.0f, m2 %.0f\n", stats->system_time_moments.count,
+        stats->system_time_moments.mean, stats->system_time_moments.m2);
     printf("total_queue_wait_time_us: %lu\n", stats->total_queue_wait_time_us);
     printf("area_num_in_job_queue_us: %lu\n", stats->area_num_in_job_queue_us);
     printf("max_job_queue_length: %u\n", stats->max_job_queue_length);
@@ -0,0 +1,185 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <time.h>
+
+#include "common.h"
+#include "json_writer.h"
+#include "preprocessing.h"
+#include "simulation_stats.h"
+#include "stats_export.h"
+#include "steady_state.h"
+
+/**
+ * @brief Where the fields of a row go: members of a JSON object, or the
+ *        cells of a CSV row or of its header.
+ */
+typedef struct field_sink {
+    FILE* file;
+    int is_csv;
+    int is_header;        // CSV: write the column names instead of the values
+    int field_count;      // CSV: cells written in the current row
+    const char* group;    // CSV: the group that prefixes the column names, NULL at the top
+    json_writer_t json;
+} field_sink_t;
+
+// --- Field Sink ---
+static void begin_group(field_sink_t* sink, const char* name) {
+    if (sink->is_csv) {
+        sink->group = name;
+    } else {
+        json_key(&sink->json, name);
+        json_begin_object(&sink->json);
+    }
+}
+
+static void end_group(field_sink_t* sink) {
+    if (sink->is_csv) {
+        sink->group = NULL;
+    } else {
+        json_end_object(&sink->json);
+    }
+}
+
+/**
+ * @brief Starts a CSV cell; in a header row, writes the column name, e.g. "params.num_jobs".
+ *
+ * @return TRUE if the caller should write the cell's value.
+ */
+static int begin_csv_cell(field_sink_t* sink, const char* name) {
+    if (sink->field_count++ > 0) fputc(',', sink->file);
+    if (!sink->is_header) return TRUE;
+    if (sink->group != NULL) fprintf(sink->file, "%s.", sink->group);
+    fputs(name, sink->file);
+    return FALSE;
+}
+
+static void field_number(field_sink_t* sink, const char* name, double value) {
+    if (!sink->is_csv) {
+        json_key(&sink->json, name);
+        json_number(&sink->json, value);
+    } else if (begin_csv_cell(sink, name) && isfinite(value)) {
+        char text[JSON_NUMBER_SIZE];
+        json_format_number(text, sizeof(text), value);
+        fputs(text, sink->file);
+    }
+}
+
+static void field_string(field_sink_t* sink, const char* name, const char* value) {
+    if (!sink->is_csv) {
+        json_key(&sink->json, name);
+        json_string(&sink->json, value);
+    } else if (begin_csv_cell(sink, name)) {
+        // Quoted, with quotes doubled, as RFC 4180
+        fputc('"', sink->file);
+        for (const char* p = value; *p != '\0'; p++) {
+            if (*p == '"') fputc('"', sink->file);
+            fputc(*p, sink->file);
+        }
+        fputc('"', sink->file);
+    }
+}
+
+// --- Row ---
+/**
+ * @brief Writes the fields of one run, in the same order for every format.
+ */
+static void write_run(field_sink_t* sink, const simulation_parameters_t* params,
+    const simulation_statistics_t* stats, const double* values, const char* engine, time_t finished_at)
+{
+    field_number(sink, "finished_at", (double)finished_at);
+    field_string(sink, "engine", engine);
+    field_string(sink, "build_id", BUILD_ID);
+    field_number(sink, "seed", params->model.seed);
+
+    begin_group(sink, "params");
+    field_number(sink, "job_arrival_time_us", params->model.job_arrival_time_us);
+    field_number(sink, "papers_required_lower_bound", params->model.papers_required_lower_bound);
+    field_number(sink, "papers_required_upper_bound", params->model.papers_required_upper_bound);
+    field_number(sink, "queue_capacity", params->model.queue_capacity);
+    field_number(sink, "printing_rate", params->model.printing_rate);
+    field_number(sink, "printer_paper_capacity", params->model.printer_paper_capacity);
+    field_number(sink, "refill_rate", params->model.refill_rate);
+    field_number(sink, "num_jobs", params->model.num_jobs);
+    field_string(sink, "warmup_method", warmup_method_name(params->model.warmup_method));
+    field_number(sink, "warmup_amount", params->model.warmup_amount);
+    end_group(sink);
+
+    begin_group(sink, "raw");
+    field_number(sink, "simulation_duration_us", stats->simulation_duration_us);
+    field_number(sink, "total_jobs_arrived", stats->total_jobs_arrived);
+    field_number(sink, "total_jobs_served", stats->total_jobs_served);
+    field_number(sink, "total_jobs_dropped", stats->total_jobs_dropped);
+    field_number(sink, "total_jobs_removed", stats->total_jobs_removed);
+    field_number(sink, "total_inter_arrival_time_us", stats->total_inter_arrival_time_us);
+    field_number(sink, "total_system_time_us", stats->total_system_time_us);
+    field_number(sink, "total_queue_wait_time_us", stats->total_queue_wait_time_us);
+    field_number(sink, "area_num_in_job_queue_us", stats->area_num_in_job_queue_us);
+    field_number(sink, "max_job_queue_length", stats->max_job_queue_length);
+    field_number(sink, "jobs_served_by_printer1", stats->jobs_served_by_printer1);
+    field_number(sink, "printer1_paper_used", stats->printer1_paper_used);
+    field_number(sink, "total_service_time_p1_us", stats->total_service_time_p1_us);
+    field_number(sink, "printer1_paper_empty_time_us", stats->printer1_paper_empty_time_us);
+    field_number(sink, "jobs_served_by_printer2", stats->jobs_served_by_printer2);
+    field_number(sink, "printer2_paper_used", stats->printer2_paper_used);
+    field_number(sink, "total_service_time_p2_us", stats->total_service_time_p2_us);
+    field_number(sink, "printer2_paper_empty_time_us", stats->printer2_paper_empty_time_us);
+    field_number(sink, "paper_refill_events", stats->paper_refill_events);
+    field_number(sink, "total_refill_service_time_us", stats->total_refill_service_time_us);
+    field_number(sink, "papers_refilled", stats->papers_refilled);
+    end_group(sink);
+
+    begin_group(sink, "statistics");
+    for (int i = 0; i < STATISTICS_VALUE_COUNT; i++) {
+        char name[64];
+        statistics_value_name(i, name, sizeof(name));
+        field_number(sink, name, values[i]);
+    }
+    end_group(sink);
+}
+
+static int has_suffix(const char* str, const char* suffix) {
+    size_t length = strlen(str), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(str + length - suffix_length, suffix) == 0;
+}
+
+int stats_export_append(const char* path, const simulation_parameters_t* params,
+    simulation_statistics_t* stats, const char* engine)
+{
+    double values[STATISTICS_VALUE_COUNT];
+    write_statistics_values(stats, values, STATISTICS_VALUE_COUNT);
+    time_t finished_at = time(NULL);
+
+    FILE* file = fopen(path, "a");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Failed to open statistics file %s\n", path);
+        return FALSE;
+    }
+    // Held until the row is flushed, so rows of concurrent runs never interleave
+    flock(fileno(file), LOCK_EX);
+    fseek(file, 0, SEEK_END);
+
+    field_sink_t sink = {.file = file, .is_csv = has_suffix(path, ".csv")};
+    if (sink.is_csv) {
+        if (ftell(file) == 0) {
+            sink.is_header = TRUE;
+            write_run(&sink, params, stats, values, engine, finished_at);
+            fputc('\n', file);
+            sink.is_header = FALSE;
+            sink.field_count = 0;
+        }
+    } else {
+        json_writer_init(&sink.json, file);
+        json_begin_object(&sink.json);
+    }
+    write_run(&sink, params, stats, values, engine, finished_at);
+    if (!sink.is_csv) json_end_object(&sink.json);
+    fputc('\n', file);
+
+    int is_written = fflush(file) == 0 && !ferror(file);
+    flock(fileno(file), LOCK_UN);
+    if (fclose(file) != 0) is_written = FALSE;
+    if (!is_written) fprintf(stderr, "Error: Failed to write statistics file %s\n", path);
+    return is_written;
+}
@@ -0,0 +1,230 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "simulation_stats.h"
+#include "stats_snapshot.h"
+
+static const double bucket_bounds_sec[STATS_SNAPSHOT_BUCKET_COUNT] = STATS_SNAPSHOT_BUCKET_BOUNDS;
+
+/**
+ * @brief Converts a latency histogram into cumulative Prometheus buckets.
+ */
+static void fill_histogram(const latency_histogram_t* histogram, unsigned long sum_us,
+    stats_snapshot_histogram_t* out)
+{
+    for (int i = 0; i < STATS_SNAPSHOT_BUCKET_COUNT; i++) {
+        unsigned long bound_us = (unsigned long)(bucket_bounds_sec[i] * 1000000.0 + 0.5);
+        out->buckets[i] = latency_histogram_count_at_or_below(histogram, bound_us);
+    }
+    out->count = histogram->total_count;
+    out->sum_sec = sum_us / 1000000.0;
+}
+
+void stats_snapshot_fill(const simulation_statistics_t* stats, unsigned long duration_us,
+    stats_snapshot_data_t* data)
+{
+    data->duration_sec = duration_us / 1000000.0;
+    data->jobs_arrived = stats->total_jobs_arrived;
+    data->jobs_served = stats->total_jobs_served;
+    data->jobs_dropped = stats->total_jobs_dropped;
+    data->jobs_removed = stats->total_jobs_removed;
+    data->paper_refills = stats->paper_refill_events;
+    data->papers_refilled = stats->papers_refilled;
+    data->refill_time_sec = stats->total_refill_service_time_us / 1000000.0;
+    data->max_queue_length = (int)stats->max_job_queue_length;
+
+    data->jobs_printed[0] = stats->jobs_served_by_printer1;
+    data->jobs_printed[1] = stats->jobs_served_by_printer2;
+    data->busy_time_sec[0] = stats->total_service_time_p1_us / 1000000.0;
+    data->busy_time_sec[1] = stats->total_service_time_p2_us / 1000000.0;
+    for (int p = 0; p < 2; p++) {
+        data->utilization[p] = duration_us > 0 ? data->busy_time_sec[p] / data->duration_sec : 0.0;
+    }
+    data->paper_stall_time_sec[0] = stats->printer1_paper_empty_time_us / 1000000.0;
+    data->paper_stall_time_sec[1] = stats->printer2_paper_empty_time_us / 1000000.0;
+
+    fill_histogram(&stats->system_time_histogram, stats->total_system_time_us, &data->system_time);
+    fill_histogram(&stats->queue_wait_histogram, stats->total_queue_wait_time_us, &data->queue_wait);
+    fill_histogram(&stats->service_time_p1_histogram, stats->total_service_time_p1_us, &data->service_time[0]);
+    fill_histogram(&stats->service_time_p2_histogram, stats->total_service_time_p2_us, &data->service_time[1]);
+    fill_histogram(&stats->paper_empty_histogram,
+        stats->printer1_paper_empty_time_us + stats->printer2_paper_empty_time_us, &data->paper_stall);
+}
+
+// --- Sequence lock ---
+/*
+ * The writer makes the sequence odd before it copies and even again after,
+ * with release ordering so a reader that sees the final even value also sees
+ * the data. A reader that sees an odd value, or a different value after its
+ * copy, raced the writer and copies again.
+ */
+void stats_snapshot_publish(stats_snapshot_t* snapshot, const stats_snapshot_data_t* data) {
+    unsigned long sequence = atomic_load_explicit(&snapshot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&snapshot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&snapshot->data, data, sizeof(*data));
+    atomic_store_explicit(&snapshot->sequence, sequence + 2, memory_order_release);
+}
+
+int stats_snapshot_read(stats_snapshot_t* snapshot, stats_snapshot_data_t* data) {
+    for (;;) {
+        unsigned long before = atomic_load_explicit(&snapshot->sequence, memory_order_acquire);
+        if (before == 0) return FALSE;
+        if (before & 1) continue;
+        memcpy(data, &snapshot->data, sizeof(*data));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&snapshot->sequence, memory_order_relaxed) == before) return TRUE;
+    }
+}
+
+// --- Prometheus exposition ---
+typedef struct prometheus_metric {
+    const char* name;
+    const char* type;
+    const char* help;
+    size_t offset;      // of the value, or of printer 1's value
+    int is_int;         // int rather than double
+    int is_per_printer; // two values, labelled printer="1" and printer="2"
+} prometheus_metric_t;
+
+#define SNAPSHOT_DOUBLE(field) offsetof(stats_snapshot_data_t, field), FALSE
+#define SNAPSHOT_INT(field) offsetof(stats_snapshot_data_t, field), TRUE
+
+static const prometheus_metric_t prometheus_metrics[] = {
+    {"printsim_running", "gauge", "1 while the run is in progress, 0 once it has ended.",
+        SNAPSHOT_INT(is_running), FALSE},
+    {"printsim_run_duration_seconds", "gauge", "Time since the run started, or its length once ended.",
+        SNAPSHOT_DOUBLE(duration_sec), FALSE},
+    {"printsim_jobs_arrived_total", "counter", "Jobs that arrived, including dropped ones.",
+        SNAPSHOT_DOUBLE(jobs_arrived), FALSE},
+    {"printsim_jobs_served_total", "counter", "Jobs printed.",
+        SNAPSHOT_DOUBLE(jobs_served), FALSE},
+    {"printsim_jobs_dropped_total", "counter", "Jobs dropped because the queue was full.",
+        SNAPSHOT_DOUBLE(jobs_dropped), FALSE},
+    {"printsim_jobs_removed_total", "counter", "Jobs removed from the queue when the run was stopped.",
+        SNAPSHOT_DOUBLE(jobs_removed), FALSE},
+    {"printsim_queue_length", "gauge", "Jobs waiting in the queue.",
+        SNAPSHOT_INT(queue_length), FALSE},
+    {"printsim_queue_length_max", "gauge", "Longest queue seen during the run.",
+        SNAPSHOT_INT(max_queue_length), FALSE},
+    {"printsim_printer_jobs_printed_total", "counter", "Jobs printed by each printer.",
+        SNAPSHOT_DOUBLE(jobs_printed), TRUE},
+    {"printsim_printer_busy_seconds_total", "counter", "Time each printer spent printing.",
+        SNAPSHOT_DOUBLE(busy_time_sec), TRUE},
+    {"printsim_printer_utilization", "gauge", "Share of the run each printer spent printing.",
+        SNAPSHOT_DOUBLE(utilization), TRUE},
+    {"printsim_printer_printing", "gauge", "1 while the printer has a job in service.",
+        SNAPSHOT_INT(is_printing), TRUE},
+    {"printsim_printer_paper_level", "gauge", "Sheets of paper left in each printer.",
+        SNAPSHOT_INT(paper_level), TRUE},
+    {"printsim_printer_paper_stall_seconds_total", "counter", "Time each printer waited for paper.",
+        SNAPSHOT_DOUBLE(paper_stall_time_sec), TRUE},
+    {"printsim_paper_refills_total", "counter", "Paper refills performed.",
+        SNAPSHOT_DOUBLE(paper_refills), FALSE},
+    {"printsim_papers_refilled_total", "counter", "Sheets of paper added by refills.",
+        SNAPSHOT_DOUBLE(papers_refilled), FALSE},
+    {"printsim_paper_refill_seconds_total", "counter", "Time spent refilling paper.",
+        SNAPSHOT_DOUBLE(refill_time_sec), FALSE},
+};
+#define PROMETHEUS_METRIC_COUNT ((int)(sizeof(prometheus_metrics) / sizeof(prometheus_metrics[0])))
+
+typedef struct prometheus_histogram {
+    const char* name;
+    const char* help;
+    size_t offset;
+    int is_per_printer;
+} prometheus_histogram_t;
+
+static const prometheus_histogram_t prometheus_histograms[] = {
+    {"printsim_system_time_seconds", "Time each served job spent in the system.",
+        offsetof(stats_snapshot_data_t, system_time), FALSE},
+    {"printsim_queue_wait_seconds", "Time each served job waited in the queue.",
+        offsetof(stats_snapshot_data_t, queue_wait), FALSE},
+    {"printsim_service_time_seconds", "Service time of each job, per printer.",
+        offsetof(stats_snapshot_data_t, service_time), TRUE},
+    {"printsim_paper_stall_seconds", "Each stall of either printer waiting for paper.",
+        offsetof(stats_snapshot_data_t, paper_stall), FALSE},
+};
+#define PROMETHEUS_HISTOGRAM_COUNT ((int)(sizeof(prometheus_histograms) / sizeof(prometheus_histograms[0])))
+
+/**
+ * @brief Appends to the exposition like snprintf, but keeps counting the
+ *        length needed once the buffer is full.
+ */
+static void append(char* buf, int buf_size, int* len, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = *len < buf_size
+        ? vsnprintf(buf + *len, buf_size - *len, format, args)
+        : vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (written > 0) *len += written;
+}
+
+/**
+ * @brief Appends the labels of a sample, e.g. session="2",printer="1", without braces.
+ */
+static void append_labels(char* buf, int buf_size, int* len, unsigned long session_id, int printer) {
+    append(buf, buf_size, len, "session=\"%lu\"", session_id);
+    if (printer > 0) append(buf, buf_size, len, ",printer=\"%d\"", printer);
+}
+
+static void append_histogram(char* buf, int buf_size, int* len, const char* name,
+    const stats_snapshot_histogram_t* histogram, unsigned long session_id, int printer)
+{
+    for (int i = 0; i < STATS_SNAPSHOT_BUCKET_COUNT; i++) {
+        append(buf, buf_size, len, "%s_bucket{", name);
+        append_labels(buf, buf_size, len, session_id, printer);
+        append(buf, buf_size, len, ",le=\"%g\"} %lu\n", bucket_bounds_sec[i], histogram->buckets[i]);
+    }
+    append(buf, buf_size, len, "%s_bucket{", name);
+    append_labels(buf, buf_size, len, session_id, printer);
+    append(buf, buf_size, len, ",le=\"+Inf\"} %lu\n", histogram->count);
+
+    append(buf, buf_size, len, "%s_sum{", name);
+    append_labels(buf, buf_size, len, session_id, printer);
+    append(buf, buf_size, len, "} %.9g\n", histogram->sum_sec);
+    append(buf, buf_size, len, "%s_count{", name);
+    append_labels(buf, buf_size, len, session_id, printer);
+    append(buf, buf_size, len, "} %lu\n", histogram->count);
+}
+
+int write_prometheus_metrics(const stats_snapshot_data_t* snapshots, const unsigned long* session_ids, int count,
+    char* buf, int buf_size)
+{
+    int len = 0;
+    if (buf_size > 0) buf[0] = '\0';
+
+    for (int m = 0; m < PROMETHEUS_METRIC_COUNT; m++) {
+        const prometheus_metric_t* metric = &prometheus_metrics[m];
+        append(buf, buf_size, &len, "# HELP %s %s\n# TYPE %s %s\n",
+            metric->name, metric->help, metric->name, metric->type);
+        for (int s = 0; s < count; s++) {
+            const char* base = (const char*)&snapshots[s] + metric->offset;
+            for (int p = 0; p < (metric->is_per_printer ? 2 : 1); p++) {
+                double value = metric->is_int ? ((const int*)base)[p] : ((const double*)base)[p];
+                append(buf, buf_size, &len, "%s{", metric->name);
+                append_labels(buf, buf_size, &len, session_ids[s], metric->is_per_printer ? p + 1 : 0);
+                append(buf, buf_size, &len, "} %.9g\n", value);
+            }
+        }
+    }
+
+    for (int h = 0; h < PROMETHEUS_HISTOGRAM_COUNT; h++) {
+        const prometheus_histogram_t* histogram = &prometheus_histograms[h];
+        append(buf, buf_size, &len, "# HELP %s %s\n# TYPE %s histogram\n",
+            histogram->name, histogram->help, histogram->name);
+        for (int s = 0; s < count; s++) {
+            const stats_snapshot_histogram_t* values =
+                (const stats_snapshot_histogram_t*)((const char*)&snapshots[s] + histogram->offset);
+            for (int p = 0; p < (histogram->is_per_printer ? 2 : 1); p++) {
+                append_histogram(buf, buf_size, &len, histogram->name, &values[p], session_ids[s],
+                    histogram->is_per_printer ? p + 1 : 0);
+            }
+        }
+    }
+    return len;
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "steady_state.h"
+
+void steady_state_configure(steady_state_t* steady_state, int method, double warmup_amount) {
+    steady_state->method = method;
+    steady_state->warmup_amount = warmup_amount;
+    steady_state->batch_jobs = STEADY_STATE_BATCH_JOBS;
+}
+
+/**
+ * @brief Ends a batch at every batch_jobs-th departure, halving the number
+ *        of boundaries kept once the array is full.
+ */
+static void observe_batch_end(steady_state_t* steady_state, const stats_mark_t* mark) {
+    if ((unsigned long)mark->jobs_served % steady_state->batch_jobs != 0) return;
+    if (steady_state->batch_count == STEADY_STATE_MAX_BATCHES) {
+        // Boundaries at every other old batch end: multiples of the doubled batch size
+        for (int i = 0; i < STEADY_STATE_MAX_BATCHES / 2; i++) {
+            steady_state->batch_ends[i] = steady_state->batch_ends[2 * i + 1];
+        }
+        steady_state->batch_count = STEADY_STATE_MAX_BATCHES / 2;
+        steady_state->batch_jobs *= 2;
+        if ((unsigned long)mark->jobs_served % steady_state->batch_jobs != 0) return;
+    }
+    steady_state->batch_ends[steady_state->batch_count++] = *mark;
+}
+
+void steady_state_observe(steady_state_t* steady_state, const stats_mark_t* mark) {
+    switch (steady_state->method) {
+    case WARMUP_JOBS:
+    case WARMUP_TIME:
+        if (!steady_state->has_fixed_cut && (steady_state->method == WARMUP_JOBS
+                ? mark->jobs_served >= steady_state->warmup_amount
+                : mark->time_us >= steady_state->warmup_amount * 1000000.0)) {
+            steady_state->fixed_cut = *mark;
+            steady_state->has_fixed_cut = TRUE;
+        }
+        break;
+    case WARMUP_MSER5:
+        observe_batch_end(steady_state, mark);
+        break;
+    }
+}
+
+int mser_truncation(const double* batch_means, int count) {
+    if (count < 2) return 0;
+    // Suffix sums give the mean and squared deviations of every tail in one pass
+    double sum = 0.0, sum_of_squares = 0.0;
+    int best_d = 0;
+    double best_statistic = -1.0;
+    for (int d = count - 1; d >= 0; d--) {
+        sum += batch_means[d];
+        sum_of_squares += batch_means[d] * batch_means[d];
+        if (d > count / 2) continue;
+        int kept = count - d;
+        double squared_deviations = sum_of_squares - sum * sum / kept;
+        if (squared_deviations < 0.0) squared_deviations = 0.0; // rounding
+        double statistic = squared_deviations / ((double)kept * kept);
+        if (best_statistic < 0.0 || statistic <= best_statistic) {
+            best_statistic = statistic;
+            best_d = d; // ties go to the earliest cut
+        }
+    }
+    return best_d;
+}
+
+int steady_state_cut(const steady_state_t* steady_state, stats_mark_t* cut) {
+    memset(cut, 0, sizeof(*cut));
+    if (steady_state->method == WARMUP_JOBS || steady_state->method == WARMUP_TIME) {
+        if (!steady_state->has_fixed_cut) return FALSE;
+        *cut = steady_state->fixed_cut;
+        return TRUE;
+    }
+    if (steady_state->method != WARMUP_MSER5 || steady_state->batch_count < 2) return FALSE;
+
+    // Time-average queue length of every batch
+    double batch_means[STEADY_STATE_MAX_BATCHES];
+    stats_mark_t previous = {0};
+    for (int i = 0; i < steady_state->batch_count; i++) {
+        const stats_mark_t* end = &steady_state->batch_ends[i];
+        unsigned long duration_us = end->time_us - previous.time_us;
+        batch_means[i] = duration_us > 0
+            ? (double)(end->area_num_in_job_queue_us - previous.area_num_in_job_queue_us) / duration_us : 0.0;
+        previous = *end;
+    }
+    int d = mser_truncation(batch_means, steady_state->batch_count);
+    if (d > 0) *cut = steady_state->batch_ends[d - 1];
+    return TRUE;
+}
+
+void stats_mark_window(const stats_mark_t* end, const stats_mark_t* start, stats_mark_t* window) {
+    window->time_us = end->time_us - start->time_us;
+    window->jobs_arrived = end->jobs_arrived - start->jobs_arrived;
+    window->jobs_served = end->jobs_served - start->jobs_served;
+    window->jobs_dropped = end->jobs_dropped - start->jobs_dropped;
+    for (int i = 0; i < 2; i++) {
+        window->jobs_served_by_printer[i] = end->jobs_served_by_printer[i] - start->jobs_served_by_printer[i];
+        window->service_time_us[i] = end->service_time_us[i] - start->service_time_us[i];
+    }
+    window->inter_arrival_time_us = end->inter_arrival_time_us - start->inter_arrival_time_us;
+    window->system_time_us = end->system_time_us - start->system_time_us;
+    window->queue_wait_time_us = end->queue_wait_time_us - start->queue_wait_time_us;
+    window->area_num_in_job_queue_us = end->area_num_in_job_queue_us - start->area_num_in_job_queue_us;
+}
+
+int warmup_from_arg(const char* arg, int* method, double* warmup_amount) {
+    if (strcmp(arg, "auto") == 0) {
+        *method = WARMUP_MSER5;
+        *warmup_amount = 0;
+        return TRUE;
+    }
+    char* end;
+    double amount = strtod(arg, &end);
+    if (end == arg || amount <= 0) return FALSE;
+    if (strcmp(end, "s") == 0) {
+        *method = WARMUP_TIME;
+    } else if (*end == '\0' && amount == (int)amount) {
+        *method = WARMUP_JOBS;
+    } else {
+        return FALSE;
+    }
+    *warmup_amount = amount;
+    return TRUE;
+}
+
+const char* warmup_method_name(int method) {
+    switch (method) {
+    case WARMUP_JOBS:  return "jobs";
+    case WARMUP_TIME:  return "time";
+    case WARMUP_MSER5: return "mser5";
+    default:           return "none";
+    }
+}
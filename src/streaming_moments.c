@@ -0,0 +1,53 @@
+#include <math.h>
+
+#include "streaming_moments.h"
+
+void streaming_moments_add(streaming_moments_t* moments, double value) {
+    double previous_count = moments->count;
+    double count = ++moments->count;
+    double delta = value - moments->mean;
+    double delta_n = delta / count;
+    double term = delta * delta_n * previous_count;
+
+    moments->mean += delta_n;
+    moments->m3 += term * delta_n * (count - 2) - 3 * delta_n * moments->m2;
+    moments->m2 += term;
+    if (count == 1 || value < moments->min) moments->min = value;
+    if (count == 1 || value > moments->max) moments->max = value;
+}
+
+void streaming_moments_merge(streaming_moments_t* moments, const streaming_moments_t* other) {
+    if (other->count == 0) return;
+    if (moments->count == 0) {
+        *moments = *other;
+        return;
+    }
+    double count_a = moments->count;
+    double count_b = other->count;
+    double count = count_a + count_b;
+    double delta = other->mean - moments->mean;
+    double delta_n = delta / count;
+
+    moments->m3 += other->m3
+        + delta * delta_n * delta_n * count_a * count_b * (count_a - count_b)
+        + 3 * delta_n * (count_a * other->m2 - count_b * moments->m2);
+    moments->m2 += other->m2 + delta * delta_n * count_a * count_b;
+    moments->mean += delta_n * count_b;
+    moments->count += other->count;
+    if (other->min < moments->min) moments->min = other->min;
+    if (other->max > moments->max) moments->max = other->max;
+}
+
+double streaming_moments_variance(const streaming_moments_t* moments) {
+    if (moments->count < 2) return 0.0;
+    return moments->m2 / (moments->count - 1);
+}
+
+double streaming_moments_std_dev(const streaming_moments_t* moments) {
+    return sqrt(streaming_moments_variance(moments));
+}
+
+double streaming_moments_skewness(const streaming_moments_t* moments) {
+    if (moments->m2 <= 0.0) return 0.0;
+    return sqrt((double)moments->count) * moments->m3 / pow(moments->m2, 1.5);
+}
@@ -0,0 +1,337 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "event_ring.h"
+#include "job_receiver.h"
+#include "log_event.h"
+#include "log_router.h"
+#include "printer.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+#include "trace_handler.h"
+#include "trace_writer.h"
+
+// Thread tracks of a run; the printers use their ids
+#define TRACK_REFILLER 3
+#define TRACK_QUEUE    4
+
+// Runs remembered at once; older runs' slots are reused
+#define TRACE_MAX_RUNS 64
+
+// --- Asynchronous writer ---
+/*
+ * Events are emitted with the queue and stats locks held, so, as in the
+ * console and binary sinks, simulation threads only push a record into a
+ * lock-free ring. A writer thread owns the trace writer and the run table:
+ * it resolves each record's run to a process, formats the spans and does all
+ * file I/O.
+ */
+#define TRACE_RING_CAPACITY   65536
+#define TRACE_IDLE_SLEEP_US   1000
+
+typedef struct trace_record {
+    log_event_t event;          // type, printer, job, time, duration and papers, as the other sinks record them
+    void* log_context;          // the emitting thread's run, resolved to a process by the writer
+    int32_t paper_level;        // printer's paper after a system departure or refill end
+    uint64_t system_arrival_time_us; // the job's other timestamps, for system departures
+    uint64_t queue_arrival_time_us;
+    uint64_t queue_departure_time_us;
+    uint64_t service_arrival_time_us;
+} trace_record_t;
+
+static trace_writer_t s_writer;
+static event_ring_t s_ring;
+static pthread_t s_writer_thread;
+static atomic_int s_stop_writer;
+static int s_is_open = FALSE; // set before producers start, cleared after they stop
+static char s_path[MAXPATHLENGTH];
+
+// Process id of each run, keyed by the run's log context (NULL for the CLI); writer thread only
+static struct {
+    void* log_context;
+    int pid;
+} s_runs[TRACE_MAX_RUNS];
+static int s_run_count = 0;
+
+/**
+ * @brief Gives a run a new process, named with its tracks.
+ */
+static int start_run_process(void* log_context) {
+    int pid = ++s_run_count;
+    s_runs[(pid - 1) % TRACE_MAX_RUNS].log_context = log_context;
+    s_runs[(pid - 1) % TRACE_MAX_RUNS].pid = pid;
+
+    char name[32];
+    snprintf(name, sizeof(name), "Run %d", pid);
+    trace_writer_name(&s_writer, pid, 0, name);
+    trace_writer_name(&s_writer, pid, 1, "Printer 1");
+    trace_writer_name(&s_writer, pid, 2, "Printer 2");
+    trace_writer_name(&s_writer, pid, TRACK_REFILLER, "Paper refiller");
+    trace_writer_name(&s_writer, pid, TRACK_QUEUE, "Job queue");
+    return pid;
+}
+
+/**
+ * @brief Returns the process of a run, the latest one started with its log context.
+ */
+static int run_process(void* log_context) {
+    int oldest = s_run_count > TRACE_MAX_RUNS ? s_run_count - TRACE_MAX_RUNS : 0;
+    for (int n = s_run_count - 1; n >= oldest; n--) {
+        if (s_runs[n % TRACE_MAX_RUNS].log_context == log_context) return s_runs[n % TRACE_MAX_RUNS].pid;
+    }
+    return 1;
+}
+
+/**
+ * @brief Writes a printer's paper level to its counter track.
+ */
+static void paper_level_counter(int pid, int printer_id, unsigned long time_us, int level) {
+    char name[32];
+    snprintf(name, sizeof(name), "Paper (Printer %d)", printer_id);
+    trace_writer_counter(&s_writer, pid, name, time_us, level);
+}
+
+/**
+ * @brief Writes the spans, instants or counter values of one record.
+ *
+ * A job's spans are written whole when it leaves the system, from the
+ * timestamps its departure record carries.
+ */
+static void write_record(const trace_record_t* record) {
+    const log_event_t* event = &record->event;
+    int pid;
+    if (event->type == LOG_EVENT_SIMULATION_START || event->type == LOG_EVENT_SIMULATION_RESUMED) {
+        pid = start_run_process(record->log_context);
+    } else {
+        pid = run_process(record->log_context);
+    }
+    char name[32];
+    char args[160];
+    switch (event->type) {
+    case LOG_EVENT_SIMULATION_START:
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "simulation start", event->time_us, NULL);
+        break;
+    case LOG_EVENT_SIMULATION_RESUMED:
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "simulation resumed", event->time_us, NULL);
+        break;
+    case LOG_EVENT_SIMULATION_END:
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "simulation end", event->time_us, NULL);
+        trace_writer_flush(&s_writer); // the server never closes the trace
+        break;
+    case LOG_EVENT_SIMULATION_STOPPED:
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "simulation stopped", event->time_us, NULL);
+        trace_writer_flush(&s_writer);
+        break;
+    case LOG_EVENT_SIMULATION_CHECKPOINT:
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "checkpoint", event->time_us, NULL);
+        trace_writer_flush(&s_writer);
+        break;
+    case LOG_EVENT_DROPPED_JOB:
+        snprintf(args, sizeof(args), "\"job\":%d,\"papers\":%d", event->job_id, event->papers);
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "dropped", event->time_us, args);
+        break;
+    case LOG_EVENT_REMOVED_JOB:
+        snprintf(args, sizeof(args), "\"job\":%d", event->job_id);
+        trace_writer_instant(&s_writer, pid, TRACK_QUEUE, "removed", event->time_us, args);
+        break;
+    case LOG_EVENT_QUEUE_ARRIVAL:
+    case LOG_EVENT_QUEUE_DEPARTURE:
+        trace_writer_counter(&s_writer, pid, "Queue depth", event->time_us, event->queue_length);
+        break;
+    case LOG_EVENT_SYSTEM_DEPARTURE:
+        snprintf(name, sizeof(name), "Job %d", event->job_id);
+        snprintf(args, sizeof(args), "\"job\":%d,\"papers\":%d,\"printer\":%d,\"system_us\":%lu", event->job_id,
+            event->papers, event->printer_id, (unsigned long)(event->time_us - record->system_arrival_time_us));
+        trace_writer_async(&s_writer, pid, "Queue wait", event->job_id, record->queue_arrival_time_us,
+            record->queue_departure_time_us, args);
+        trace_writer_complete(&s_writer, pid, event->printer_id, name, record->service_arrival_time_us,
+            event->time_us - record->service_arrival_time_us, args);
+        paper_level_counter(pid, event->printer_id, event->time_us, record->paper_level);
+        break;
+    case LOG_EVENT_PAPER_EMPTY:
+        // The stall lasts until the refill ends; a run stopped meanwhile leaves it open
+        trace_writer_duration(&s_writer, TRUE, pid, event->printer_id, "Paper empty", event->time_us);
+        break;
+    case LOG_EVENT_PAPER_REFILL_END:
+        snprintf(name, sizeof(name), "Refill Printer %d", event->printer_id);
+        trace_writer_complete(&s_writer, pid, TRACK_REFILLER, name, event->time_us - event->duration_us,
+            event->duration_us, NULL);
+        trace_writer_duration(&s_writer, FALSE, pid, event->printer_id, "Paper empty", event->time_us);
+        paper_level_counter(pid, event->printer_id, event->time_us, record->paper_level);
+        break;
+    }
+}
+
+static void* trace_writer_thread_func(void* arg) {
+    for (;;) {
+        trace_record_t record;
+        int has_records = FALSE;
+        while (event_ring_pop(&s_ring, &record)) {
+            has_records = TRUE;
+            write_record(&record);
+        }
+        if (!has_records) {
+            // Producers have stopped before the stop flag is raised, so an empty ring is final
+            if (atomic_load(&s_stop_writer)) break;
+            usleep(TRACE_IDLE_SLEEP_US);
+        }
+    }
+    return NULL;
+}
+
+int trace_handler_open(const char* path, int overflow_policy) {
+    if (!trace_writer_open(&s_writer, path, get_time_in_us())) return FALSE;
+    if (!event_ring_init(&s_ring, TRACE_RING_CAPACITY, sizeof(trace_record_t), overflow_policy)) {
+        fprintf(stderr, "Error: Failed to allocate trace event ring\n");
+        trace_writer_close(&s_writer);
+        return FALSE;
+    }
+    snprintf(s_path, sizeof(s_path), "%s", path);
+    s_run_count = 0;
+    atomic_store(&s_stop_writer, 0);
+    s_is_open = TRUE;
+    pthread_create(&s_writer_thread, NULL, trace_writer_thread_func, NULL);
+    return TRUE;
+}
+
+void trace_handler_close(int is_quiet) {
+    if (!s_is_open) return;
+    s_is_open = FALSE;
+    atomic_store(&s_stop_writer, 1);
+    pthread_join(s_writer_thread, NULL);
+
+    unsigned long dropped = event_ring_dropped(&s_ring);
+    if (dropped > 0) fprintf(stderr, "Warning: %lu trace events dropped, trace file could not keep up\n", dropped);
+    event_ring_destroy(&s_ring);
+    size_t event_count = s_writer.event_count;
+    trace_writer_close(&s_writer);
+    if (!is_quiet) printf("Wrote %zu trace events to %s, open it in ui.perfetto.dev\n", event_count, s_path);
+}
+
+/**
+ * @brief Hands a record to the writer thread, tagged with the calling thread's run.
+ */
+static void submit(trace_record_t* record) {
+    if (!s_is_open) return;
+    record->log_context = log_router_thread_context();
+    event_ring_push(&s_ring, record);
+}
+
+// --- Event records ---
+/*
+ * The pipeline has already recorded the statistics; each event is captured
+ * with the values its trace events need. Arrivals at the system and the
+ * printers and refill starts write nothing: their spans are written whole
+ * when they end.
+ */
+static void trace_simulation_start(simulation_statistics_t* stats) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_SIMULATION_START, .time_us = stats->simulation_start_time_us}};
+    submit(&record);
+}
+
+static void trace_simulation_end(simulation_statistics_t* stats) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_SIMULATION_END,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us}};
+    submit(&record);
+}
+
+static void trace_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
+    simulation_statistics_t* stats)
+{
+    trace_record_t record = {.event = {.type = LOG_EVENT_DROPPED_JOB, .job_id = job->id,
+        .time_us = job->system_arrival_time_us, .papers = job->papers_required}};
+    submit(&record);
+}
+
+static void trace_removed_job(job_t* job) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_REMOVED_JOB, .job_id = job->id, .time_us = get_time_in_us()}};
+    submit(&record);
+}
+
+static void trace_queue_arrival(const job_t* job, simulation_statistics_t* stats,
+    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
+{
+    trace_record_t record = {.event = {.type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = job->id,
+        .time_us = job->queue_arrival_time_us, .queue_length = timed_queue_length(job_queue)}};
+    submit(&record);
+}
+
+static void trace_queue_departure(const job_t* job, simulation_statistics_t* stats,
+    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
+{
+    trace_record_t record = {.event = {.type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = job->id,
+        .time_us = job->queue_departure_time_us, .queue_length = timed_queue_length(job_queue)}};
+    submit(&record);
+}
+
+static void trace_system_departure(const job_t* job, const printer_t* printer,
+    simulation_statistics_t* stats)
+{
+    trace_record_t record = {
+        .event = {.type = LOG_EVENT_SYSTEM_DEPARTURE, .printer_id = printer->id, .job_id = job->id,
+            .time_us = job->service_departure_time_us, .papers = job->papers_required},
+        .paper_level = printer->current_paper_count,
+        .system_arrival_time_us = job->system_arrival_time_us,
+        .queue_arrival_time_us = job->queue_arrival_time_us,
+        .queue_departure_time_us = job->queue_departure_time_us,
+        .service_arrival_time_us = job->service_arrival_time_us
+    };
+    submit(&record);
+}
+
+static void trace_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_PAPER_EMPTY, .printer_id = printer->id, .job_id = job_id,
+        .time_us = current_time_us}};
+    submit(&record);
+}
+
+static void trace_paper_refill_end(printer_t* printer, int refill_duration_us,
+    unsigned long current_time_us)
+{
+    trace_record_t record = {
+        .event = {.type = LOG_EVENT_PAPER_REFILL_END, .printer_id = printer->id, .time_us = current_time_us,
+            .duration_us = refill_duration_us},
+        .paper_level = printer->capacity // refills fill the printer
+    };
+    submit(&record);
+}
+
+static void trace_simulation_stopped(simulation_statistics_t* stats) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_SIMULATION_STOPPED,
+        .time_us = stats->simulation_start_time_us + stats->simulation_duration_us}};
+    submit(&record);
+}
+
+static void trace_simulation_checkpoint(simulation_statistics_t* stats) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_SIMULATION_CHECKPOINT, .time_us = get_time_in_us()}};
+    submit(&record);
+}
+
+static void trace_simulation_resumed(simulation_statistics_t* stats) {
+    trace_record_t record = {.event = {.type = LOG_EVENT_SIMULATION_RESUMED, .time_us = get_time_in_us()}};
+    submit(&record);
+}
+
+void trace_handler_register(void) {
+    // Attached next to another sink, which presents the parameters and statistics
+    static const log_ops_t ops = {
+        .simulation_start = trace_simulation_start,
+        .simulation_end = trace_simulation_end,
+        .dropped_job = trace_dropped_job,
+        .removed_job = trace_removed_job,
+        .queue_arrival = trace_queue_arrival,
+        .queue_departure = trace_queue_departure,
+        .system_departure = trace_system_departure,
+        .paper_empty = trace_paper_empty,
+        .paper_refill_end = trace_paper_refill_end,
+        .simulation_stopped = trace_simulation_stopped,
+        .simulation_checkpoint = trace_simulation_checkpoint,
+        .simulation_resumed = trace_simulation_resumed,
+    };
+    log_router_register_trace_handler(&ops);
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "trace_writer.h"
+
+// Longest event the helpers format, name and args included
+#define TRACE_EVENT_MAX 512
+
+/**
+ * @brief Writes the buffered bytes to the file.
+ */
+static void flush_buffer(trace_writer_t* writer) {
+    if (writer->length > 0) fwrite(writer->buffer, 1, writer->length, writer->file);
+    writer->length = 0;
+}
+
+/**
+ * @brief Buffers bytes, writing the buffer out first if they do not fit.
+ */
+static void buffer_bytes(trace_writer_t* writer, const char* bytes, size_t length) {
+    if (writer->length + length > TRACE_WRITER_BUFFER_SIZE) flush_buffer(writer);
+    if (length > TRACE_WRITER_BUFFER_SIZE) {
+        fwrite(bytes, 1, length, writer->file);
+        return;
+    }
+    memcpy(writer->buffer + writer->length, bytes, length);
+    writer->length += length;
+}
+
+int trace_writer_open(trace_writer_t* writer, const char* path, unsigned long origin_us) {
+    writer->file = fopen(path, "w");
+    if (writer->file == NULL) {
+        fprintf(stderr, "Error: Failed to create trace file %s\n", path);
+        return FALSE;
+    }
+    writer->length = 0;
+    writer->event_count = 0;
+    writer->origin_us = origin_us;
+    static const char opening[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    buffer_bytes(writer, opening, sizeof(opening) - 1);
+    return TRUE;
+}
+
+void trace_writer_close(trace_writer_t* writer) {
+    static const char closing[] = "\n]}\n";
+    buffer_bytes(writer, closing, sizeof(closing) - 1);
+    flush_buffer(writer);
+    fclose(writer->file);
+    writer->file = NULL;
+}
+
+void trace_writer_flush(trace_writer_t* writer) {
+    flush_buffer(writer);
+    fflush(writer->file);
+}
+
+void trace_writer_append(trace_writer_t* writer, const char* event, size_t length) {
+    if (writer->event_count++ > 0) buffer_bytes(writer, ",\n", 2);
+    buffer_bytes(writer, event, length);
+}
+
+/**
+ * @brief Appends an event formatted by one of the helpers.
+ */
+static void append_event(trace_writer_t* writer, const char* event, int length) {
+    if (length <= 0 || length >= TRACE_EVENT_MAX) return; // cut short, so not valid JSON
+    trace_writer_append(writer, event, (size_t)length);
+}
+
+/**
+ * @brief Returns a timestamp relative to the writer's origin.
+ */
+static long relative_us(const trace_writer_t* writer, unsigned long time_us) {
+    return (long)(time_us - writer->origin_us);
+}
+
+void trace_writer_name(trace_writer_t* writer, int pid, int tid, const char* name) {
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event),
+        "{\"ph\":\"M\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+        tid == 0 ? "process_name" : "thread_name", pid, tid, name);
+    append_event(writer, event, length);
+}
+
+void trace_writer_complete(trace_writer_t* writer, int pid, int tid, const char* name,
+    unsigned long start_us, unsigned long duration_us, const char* args)
+{
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event),
+        "{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%ld,\"dur\":%lu,\"args\":{%s}}",
+        name, pid, tid, relative_us(writer, start_us), duration_us, args != NULL ? args : "");
+    append_event(writer, event, length);
+}
+
+void trace_writer_duration(trace_writer_t* writer, int is_begin, int pid, int tid, const char* name,
+    unsigned long time_us)
+{
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event), "{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%ld}",
+        is_begin ? "B" : "E", name, pid, tid, relative_us(writer, time_us));
+    append_event(writer, event, length);
+}
+
+void trace_writer_async(trace_writer_t* writer, int pid, const char* name, int id,
+    unsigned long start_us, unsigned long end_us, const char* args)
+{
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event),
+        "{\"ph\":\"b\",\"cat\":\"%s\",\"name\":\"%s\",\"id\":%d,\"pid\":%d,\"tid\":0,\"ts\":%ld,\"args\":{%s}}",
+        name, name, id, pid, relative_us(writer, start_us), args != NULL ? args : "");
+    append_event(writer, event, length);
+    length = snprintf(event, sizeof(event),
+        "{\"ph\":\"e\",\"cat\":\"%s\",\"name\":\"%s\",\"id\":%d,\"pid\":%d,\"tid\":0,\"ts\":%ld}",
+        name, name, id, pid, relative_us(writer, end_us));
+    append_event(writer, event, length);
+}
+
+void trace_writer_instant(trace_writer_t* writer, int pid, int tid, const char* name,
+    unsigned long time_us, const char* args)
+{
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event),
+        "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%ld,\"args\":{%s}}",
+        name, pid, tid, relative_us(writer, time_us), args != NULL ? args : "");
+    append_event(writer, event, length);
+}
+
+void trace_writer_counter(trace_writer_t* writer, int pid, const char* name, unsigned long time_us, long value) {
+    char event[TRACE_EVENT_MAX];
+    int length = snprintf(event, sizeof(event),
+        "{\"ph\":\"C\",\"name\":\"%s\",\"pid\":%d,\"ts\":%ld,\"args\":{\"value\":%ld}}",
+        name, pid, relative_us(writer, time_us), value);
+    append_event(writer, event, length);
+}
@@ -5,8 +5,13 @@
 #include "websocket_handler.h"
 #include "preprocessing.h"
 #include "timeutils.h"
+#include "text_buffer.h"
+#include "log_event.h"
 #include "mongoose.h"
+#include "host_usage.h"
+#include "lock_profile.h"
 #include "log_router.h"
+#include "metrics_ring.h"
 #include "simulation_stats.h"
 #include "ws_bridge.h"
 #include "job_receiver.h"
@@ -14,259 +19,438 @@
 #include "timed_queue.h"
 #include "printer.h"
 
-static unsigned long reference_time_us = 0;
-static unsigned long reference_end_time_us = 0;
+/**
+ * @brief Returns the stream of the run the calling thread belongs to. Every
+ * thread of a session run is bound to it before the first event is logged.
+ *
+ * @return The stream bound by the session.
+ */
+static ws_stream_t* current_stream(void) {
+    return (ws_stream_t*)log_router_thread_context();
+}
+
+// --- Event delivery ---
+/*
+ * Every event is captured into a log_event_t. Binary streams send the record
+ * as is; JSON streams format it with text_buffer.h instead of sprintf, either
+ * as a typed event with numeric fields or, with -ws-text-events, as the
+ * legacy sentence. The JSON envelopes are precomputed fragments, numbers are
+ * written by hand and the length is tracked, so sending needs no strlen.
+ */
+#define LOG_MESSAGE_CAPACITY 256
+
+static const char log_message_open[] = "{\"type\":\"log\", \"message\":\"";
+static const char log_message_close[] = "\"}";
 
 /**
- * @brief Writes to buffer the given time in milliseconds (ms) relative to the given reference
- * time.
- * 
- * @param time_us The time to log, in microseconds (us).
- * @param reference_time_us The reference time to log against, in microseconds (us).
- * @param buf The buffer to write the formatted time string into.
+ * @brief Appends the websocket wording of an event, e.g.
+ *        "job4 leaves queue, time in queue = 40.016ms, queue_length = 2".
+ */
+static void append_event_text(text_buffer_t* tb, const log_event_t* event) {
+    switch (event->type) {
+        case LOG_EVENT_SIMULATION_START:
+            text_append_literal(tb, "simulation begins");
+            break;
+        case LOG_EVENT_SIMULATION_END:
+            text_append_literal(tb, "simulation ends, duration = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_SYSTEM_ARRIVAL:
+        case LOG_EVENT_DROPPED_JOB:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " arrives, needs ");
+            text_append_int(tb, event->papers);
+            if (event->papers == 1) text_append_literal(tb, " paper, inter-arrival time = ");
+            else text_append_literal(tb, " papers, inter-arrival time = ");
+            text_append_ms(tb, event->duration_us);
+            if (event->type == LOG_EVENT_DROPPED_JOB) text_append_literal(tb, "ms, dropped");
+            else text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_REMOVED_JOB:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " removed from system");
+            break;
+        case LOG_EVENT_QUEUE_ARRIVAL:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " enters queue, queue length = ");
+            text_append_int(tb, event->queue_length);
+            break;
+        case LOG_EVENT_QUEUE_DEPARTURE:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " leaves queue, time in queue = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms, queue_length = ");
+            text_append_int(tb, event->queue_length);
+            break;
+        case LOG_EVENT_PRINTER_ARRIVAL:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " begins service at printer");
+            text_append_int(tb, event->printer_id);
+            text_append_literal(tb, ", printing ");
+            text_append_int(tb, event->papers);
+            text_append_literal(tb, " pages in about ");
+            text_append_uint(tb, event->duration_us / 1000);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_SYSTEM_DEPARTURE:
+            text_append_literal(tb, "job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " departs from printer");
+            text_append_int(tb, event->printer_id);
+            text_append_literal(tb, ", service time = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_PAPER_EMPTY:
+            text_append_literal(tb, "printer");
+            text_append_int(tb, event->printer_id);
+            text_append_literal(tb, " does not have enough paper for job");
+            text_append_int(tb, event->job_id);
+            text_append_literal(tb, " and is requesting refill");
+            break;
+        case LOG_EVENT_PAPER_REFILL_START:
+            text_append_literal(tb, "printer");
+            text_append_int(tb, event->printer_id);
+            text_append_literal(tb, " starts refilling ");
+            text_append_int(tb, event->papers);
+            text_append_literal(tb, " papers, estimated time = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_PAPER_REFILL_END:
+            text_append_literal(tb, "printer");
+            text_append_int(tb, event->printer_id);
+            text_append_literal(tb, " finishes refilling, actual time = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_SIMULATION_STOPPED:
+            text_append_literal(tb, "simulation stopped, duration = ");
+            text_append_ms(tb, event->duration_us);
+            text_append_literal(tb, "ms");
+            break;
+        case LOG_EVENT_SIMULATION_CHECKPOINT:
+            text_append_literal(tb, "simulation pausing for checkpoint, jobs in service will complete");
+            break;
+        case LOG_EVENT_SIMULATION_RESUMED:
+            text_append_literal(tb, "simulation resumes from checkpoint");
+            break;
+    }
+}
+
+// Appends ,"name":value for a numeric field of a typed event
+#define append_field(tb, name, value) \
+    do { text_append_literal((tb), ",\"" name "\":"); text_append_int((tb), (long)(value)); } while (0)
+
+/**
+ * @brief Appends an event as a typed JSON object, e.g.
+ *        {"type":"queue_departure", "t_us":40016, "job":4, "wait_us":40016, "qlen":2}
+ *        t_us is relative to the start of the run; durations are in microseconds.
+ */
+static void append_event_fields(text_buffer_t* tb, const log_event_t* event, uint64_t reference_time_us) {
+    text_append_literal(tb, "{\"type\":\"");
+    text_append_str(tb, log_event_type_name(event->type));
+    text_append_literal(tb, "\", \"t_us\":");
+    text_append_int(tb, (long)(event->time_us - reference_time_us));
+    switch (event->type) {
+        case LOG_EVENT_SIMULATION_END:
+        case LOG_EVENT_SIMULATION_STOPPED:
+            append_field(tb, "duration_us", event->duration_us);
+            break;
+        case LOG_EVENT_SYSTEM_ARRIVAL:
+        case LOG_EVENT_DROPPED_JOB:
+            append_field(tb, "job", event->job_id);
+            append_field(tb, "papers", event->papers);
+            append_field(tb, "interarrival_us", event->duration_us);
+            break;
+        case LOG_EVENT_REMOVED_JOB:
+            append_field(tb, "job", event->job_id);
+            break;
+        case LOG_EVENT_QUEUE_ARRIVAL:
+            append_field(tb, "job", event->job_id);
+            append_field(tb, "qlen", event->queue_length);
+            break;
+        case LOG_EVENT_QUEUE_DEPARTURE:
+            append_field(tb, "job", event->job_id);
+            append_field(tb, "wait_us", event->duration_us);
+            append_field(tb, "qlen", event->queue_length);
+            break;
+        case LOG_EVENT_PRINTER_ARRIVAL:
+            append_field(tb, "job", event->job_id);
+            append_field(tb, "printer", event->printer_id);
+            append_field(tb, "papers", event->papers);
+            append_field(tb, "service_us", event->duration_us);
+            break;
+        case LOG_EVENT_SYSTEM_DEPARTURE:
+            append_field(tb, "job", event->job_id);
+            append_field(tb, "printer", event->printer_id);
+            append_field(tb, "service_us", event->duration_us);
+            break;
+        case LOG_EVENT_PAPER_EMPTY:
+            append_field(tb, "printer", event->printer_id);
+            append_field(tb, "job", event->job_id);
+            break;
+        case LOG_EVENT_PAPER_REFILL_START:
+            append_field(tb, "printer", event->printer_id);
+            append_field(tb, "papers", event->papers);
+            append_field(tb, "refill_us", event->duration_us);
+            break;
+        case LOG_EVENT_PAPER_REFILL_END:
+            append_field(tb, "printer", event->printer_id);
+            append_field(tb, "refill_us", event->duration_us);
+            break;
+        case LOG_EVENT_SIMULATION_RESUMED:
+            append_field(tb, "elapsed_us", event->duration_us);
+            break;
+    }
+    text_append_literal(tb, "}");
+}
+
+/**
+ * @brief Sends an event to the stream in its protocol: a binary record, a
+ *        typed JSON event or, for text streams, e.g.
+ *        {"type":"log", "message":"00000251.457ms:  job4 enters queue, queue length = 2"}
+ *        Per-job events may be dropped by the stream's overflow policy.
  *
- * Sample output called 250ms (250,000us) after reference time is "00000251.457ms: "
+ * @param stream The stream to send to.
+ * @param event The event.
  */
-static void write_time_to_buffer(unsigned long time_us, unsigned long reference_time_us, char* buf) {
-    time_us -= reference_time_us;
+static void send_event(ws_stream_t* stream, const log_event_t* event) {
+    if (stream->protocol == WS_PROTOCOL_BINARY) {
+        ws_bridge_send_record_from_any_thread(stream, event->type, WS_RECORD_EVENT, event, sizeof(*event));
+        return;
+    }
 
-    int milliseconds = 0;
-    int microseconds = 0;
-    time_in_us_to_ms(time_us, &milliseconds, &microseconds);
-    sprintf(buf, time_format, milliseconds, microseconds);
+    char storage[LOG_MESSAGE_CAPACITY];
+    text_buffer_t tb;
+    text_buffer_init(&tb, storage, sizeof(storage));
+    if (!stream->is_text_events) {
+        append_event_fields(&tb, event, stream->reference_time_us);
+    } else {
+        text_append_literal(&tb, log_message_open);
+        text_append_time_prefix(&tb, event->time_us - stream->reference_time_us);
+        text_append_literal(&tb, " ");
+        append_event_text(&tb, event);
+        text_append_literal(&tb, log_message_close);
+    }
+    if (!tb.is_truncated) ws_bridge_send_event_from_any_thread(stream, event->type, tb.data, tb.length);
 }
 
 void publish_simulation_parameters(const simulation_parameters_t* params) {
+    ws_stream_t* stream = current_stream();
+    if (stream->protocol == WS_PROTOCOL_BINARY) {
+        // The values of the JSON params message, in the same order
+        double values[] = {
+            params->model.job_arrival_time_us / 1000.0, params->model.printing_rate, params->model.queue_capacity,
+            params->model.printer_paper_capacity, params->model.refill_rate, params->model.num_jobs,
+            params->model.papers_required_lower_bound, params->model.papers_required_upper_bound
+        };
+        ws_bridge_send_record_from_any_thread(stream, -1, WS_RECORD_PARAMS, values, sizeof(values));
+        return;
+    }
+
     char buf[1024];
     sprintf(buf, "{\"type\":\"params\", \"params\": {\"job_arrival_time\":%.6g,\
         \"printing_rate\":%.6g, \"queue_capacity\":%d,\
         \"printer_paper_capacity\":%d, \"refill_rate\":%.6g, \"num_jobs\":%d,\
         \"papers_required_lower_bound\":%d, \"papers_required_upper_bound\":%d}}",
-            params->job_arrival_time_us / 1000.0, params->printing_rate, params->queue_capacity,
-            params->printer_paper_capacity, params->refill_rate, params->num_jobs,
-            params->papers_required_lower_bound, params->papers_required_upper_bound);
+            params->model.job_arrival_time_us / 1000.0, params->model.printing_rate, params->model.queue_capacity,
+            params->model.printer_paper_capacity, params->model.refill_rate, params->model.num_jobs,
+            params->model.papers_required_lower_bound, params->model.papers_required_upper_bound);
     // sending via bridge on the Mongoose loop
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    ws_bridge_send_json_from_any_thread(stream, buf, strlen(buf));
 }
 
 void publish_simulation_start(simulation_statistics_t* stats) {
-    reference_time_us = get_time_in_us();
-    stats->simulation_start_time_us = reference_time_us;
-    char time_buf[64];
-    char buf[1024];
-
-    write_time_to_buffer(reference_time_us, reference_time_us, time_buf);
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s simulation begins\"}", time_buf);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    ws_stream_t* stream = current_stream();
+    stream->reference_time_us = stats->simulation_start_time_us;
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_START, .time_us = stats->simulation_start_time_us};
+    send_event(stream, &event);
 }
 
 void publish_simulation_end(simulation_statistics_t* stats)
 {
-    reference_end_time_us = get_time_in_us();
-    char time_buf[64];
-    char buf[1024];
-
-    write_time_to_buffer(reference_end_time_us, reference_time_us, time_buf);
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s simulation ends, duration = %lu.%03lums\"}",
-        time_buf, stats->simulation_duration_us / 1000, stats->simulation_duration_us % 1000);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    ws_stream_t* stream = current_stream();
+    stream->reference_end_time_us = stats->simulation_start_time_us + stats->simulation_duration_us;
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_END, .time_us = stream->reference_end_time_us,
+        .duration_us = stats->simulation_duration_us};
+    send_event(stream, &event);
 }
 
 
 /**
  * @brief Publishes an event when a new job is created in the system or when a job is dropped
  * 
- * @param job_id The id of the job that has been created or dropped.
- * @param papers_required The number of papers required by the job.
+ * @param job The job that has been created or dropped.
  * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds
- * @param current_job_arrival_time_us The current simulation time in microseconds.
  * @param is_dropped Whether the job was dropped (TRUE) or created (FALSE).
- * @param stats The simulation statistics to update.
  */
-static void job_arrival_helper(int job_id, int papers_required,
-    unsigned long previous_job_arrival_time_us, unsigned long current_job_arrival_time_us,
-    int is_dropped, simulation_statistics_t* stats)
+static void job_arrival_helper(const job_t* job, unsigned long previous_job_arrival_time_us,
+    int is_dropped)
 {
-    char time_buf[64];
-    char buf[1024];
-
-    write_time_to_buffer(current_job_arrival_time_us, reference_time_us, time_buf);
-
-    int inter_arrival_time_us = current_job_arrival_time_us - previous_job_arrival_time_us;
-    stats->total_inter_arrival_time_us += inter_arrival_time_us; // stats: avg job inter-arrival time
-    stats->total_jobs_arrived += 1; // stats: total jobs arrived
-    int time_in_ms = inter_arrival_time_us / 1000;
-    int time_in_us = inter_arrival_time_us % 1000;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d arrives, needs %d paper%s, inter-arrival time = %d.%03dms%s\"}",
-        time_buf, job_id, papers_required,
-        papers_required == 1 ? "" : "s", time_in_ms, time_in_us,
-        is_dropped ? ", dropped" : "");
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {
+        .type = is_dropped ? LOG_EVENT_DROPPED_JOB : LOG_EVENT_SYSTEM_ARRIVAL,
+        .job_id = job->id,
+        .time_us = job->system_arrival_time_us,
+        .duration_us = job->system_arrival_time_us - previous_job_arrival_time_us,
+        .papers = job->papers_required
+    };
+    send_event(current_stream(), &event);
 }
 
 void publish_system_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
     simulation_statistics_t* stats)
 {
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, FALSE,
-        stats);
+    job_arrival_helper(job, previous_job_arrival_time_us, FALSE);
 }
 
 void publish_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
     simulation_statistics_t* stats)
 {
-    stats->total_jobs_dropped += 1; // stats: total jobs dropped
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, TRUE,
-        stats);
+    job_arrival_helper(job, previous_job_arrival_time_us, TRUE);
 }
 
 void publish_removed_job(job_t* job) {
-    unsigned long current_time_us = get_time_in_us();
-    char time_buf[64];
-    char buf[1024];
-
-    write_time_to_buffer(current_time_us, reference_time_us, time_buf);
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d removed from system\"}",
-        time_buf, job->id);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_REMOVED_JOB, .job_id = job->id, .time_us = get_time_in_us()};
+    send_event(current_stream(), &event);
 }
 
 void publish_queue_arrival(const job_t* job, simulation_statistics_t* stats,
     timed_queue_t* job_queue, unsigned long last_interaction_time_us)
 {
-    stats->area_num_in_job_queue_us +=
-        (job->queue_arrival_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) - 1); // -1 for the job that just entered the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_arrival_time_us;
-
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(job->queue_arrival_time_us, reference_time_us, time_buf);
-
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d enters queue, queue length = %d\"}",
-        time_buf, job->id, timed_queue_length(job_queue));
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = job->id,
+        .time_us = job->queue_arrival_time_us, .queue_length = timed_queue_length(job_queue)};
+    send_event(current_stream(), &event);
 }
 
 void publish_queue_departure(const job_t* job, simulation_statistics_t* stats,
     timed_queue_t* job_queue, unsigned long last_interaction_time_us)
 {
-    stats->area_num_in_job_queue_us +=
-        (job->queue_departure_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) + 1); // +1 for the job that just left the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_departure_time_us;
-
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(job->queue_departure_time_us, reference_time_us, time_buf);
-
-    int queue_duration = job->queue_departure_time_us - job->queue_arrival_time_us;
-    int time_ms = queue_duration / 1000;
-    int time_us = queue_duration % 1000;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d leaves queue, time in queue = %d.%03dms, queue_length = %d\"}",
-        time_buf, job->id, time_ms, time_us, timed_queue_length(job_queue));
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = job->id,
+        .time_us = job->queue_departure_time_us,
+        .duration_us = job->queue_departure_time_us - job->queue_arrival_time_us,
+        .queue_length = timed_queue_length(job_queue)};
+    send_event(current_stream(), &event);
 }
 
 void publish_printer_arrival(const job_t* job, const printer_t* printer)
 {
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(job->service_arrival_time_us, reference_time_us, time_buf);
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d begins service at printer%d, printing %d pages in about %dms\"}",
-        time_buf, job->id, printer->id, job->papers_required, job->service_time_requested_ms);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_PRINTER_ARRIVAL, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_arrival_time_us,
+        .duration_us = (uint64_t)job->service_time_requested_ms * 1000, .papers = job->papers_required};
+    send_event(current_stream(), &event);
 }
 
 void publish_system_departure(const job_t* job, const printer_t* printer,
     simulation_statistics_t* stats)
 {
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(job->service_departure_time_us, reference_time_us, time_buf);
-
-    int system_time = job->service_departure_time_us - job->system_arrival_time_us;
-    stats->total_system_time_us += system_time; // stats: avg job system time
-    stats->sum_of_system_time_squared_us2 += system_time * system_time; // stats: stddev job system time
-    stats->total_jobs_served += 1; // stats: total jobs served
-
-    int service_duration = job->service_departure_time_us - job->service_arrival_time_us;
-    if (printer->id == 1) {
-        stats->total_service_time_p1_us += service_duration; // stats: avg job service time
-        stats->jobs_served_by_printer1 += 1; // stats: total jobs served by printer 1
-    } else if (printer->id == 2) {
-        stats->total_service_time_p2_us += service_duration; // stats: avg job service time
-        stats->jobs_served_by_printer2 += 1; // stats: total jobs served by printer 2
-    }
-    stats->total_queue_wait_time_us +=
-        (job->queue_departure_time_us - job->queue_arrival_time_us); // stats: avg job queue wait time
-
-    int time_ms = service_duration / 1000;
-    int time_us = service_duration % 1000;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s job%d departs from printer%d, service time = %d.%03dms\"}",
-        time_buf, job->id, printer->id, time_ms, time_us);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_SYSTEM_DEPARTURE, .printer_id = printer->id, .job_id = job->id,
+        .time_us = job->service_departure_time_us,
+        .duration_us = job->service_departure_time_us - job->service_arrival_time_us};
+    send_event(current_stream(), &event);
 }
 
 void publish_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us)
 {
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(current_time_us, reference_time_us, time_buf);
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s printer%d does not have enough paper for job%d and is requesting refill\"}",
-        time_buf, printer->id, job_id);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_PAPER_EMPTY, .printer_id = printer->id, .job_id = job_id,
+        .time_us = current_time_us};
+    send_event(current_stream(), &event);
 }
 
 void publish_paper_refill_start(printer_t* printer, int papers_needed,
     int time_to_refill_us, unsigned long current_time_us)
 {
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(current_time_us, reference_time_us, time_buf);
-    int time_ms = time_to_refill_us / 1000;
-    int time_us = time_to_refill_us % 1000;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s printer%d starts refilling %d papers, estimated time = %d.%03dms\"}",
-        time_buf, printer->id, papers_needed, time_ms, time_us);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_START, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = time_to_refill_us, .papers = papers_needed};
+    send_event(current_stream(), &event);
 }
 
 void publish_paper_refill_end(printer_t* printer, int refill_duration_us,
     unsigned long current_time_us)
 {
-    char time_buf[64];
-    char buf[1024];
-    write_time_to_buffer(current_time_us, reference_time_us, time_buf);
-    int time_ms = refill_duration_us / 1000;
-    int time_us = refill_duration_us % 1000;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s printer%d finishes refilling, actual time = %d.%03dms\"}",
-        time_buf, printer->id, time_ms, time_us);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    log_event_t event = {.type = LOG_EVENT_PAPER_REFILL_END, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = refill_duration_us};
+    send_event(current_stream(), &event);
 }
 
 void publish_simulation_stopped(simulation_statistics_t* stats) {
-    char time_buf[64];
-    char buf[1024];
-    reference_end_time_us = get_time_in_us();
+    ws_stream_t* stream = current_stream();
+    stream->reference_end_time_us = stats->simulation_start_time_us + stats->simulation_duration_us;
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_STOPPED, .time_us = stream->reference_end_time_us,
+        .duration_us = stats->simulation_duration_us};
+    send_event(stream, &event);
+}
 
-    write_time_to_buffer(reference_end_time_us, reference_time_us, time_buf);
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    sprintf(buf, "{\"type\":\"log\", \"message\":\"%s simulation stopped, duration = %lu.%03lums\"}",
-        time_buf, stats->simulation_duration_us / 1000, stats->simulation_duration_us % 1000);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+void publish_simulation_checkpoint(simulation_statistics_t* stats) {
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_CHECKPOINT, .time_us = get_time_in_us()};
+    send_event(current_stream(), &event);
+}
+
+void publish_simulation_resumed(simulation_statistics_t* stats) {
+    ws_stream_t* stream = current_stream();
+    stream->reference_time_us = stats->simulation_start_time_us;
+    // duration_us lets binary clients recover the shifted reference time, as in the binary event log
+    unsigned long current_time_us = get_time_in_us();
+    log_event_t event = {.type = LOG_EVENT_SIMULATION_RESUMED, .time_us = current_time_us,
+        .duration_us = current_time_us - stats->simulation_start_time_us};
+    send_event(stream, &event);
 }
 
 void publish_statistics(simulation_statistics_t* stats) {
+    ws_stream_t* stream = current_stream();
     if (stats == NULL) return;
 
     char buf[4096];
-    if (write_statistics_to_buffer(stats, buf, sizeof(buf)) > 0) {
-        ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    if (stream->protocol == WS_PROTOCOL_BINARY) {
+        double values[STATISTICS_VALUE_COUNT];
+        int count = write_statistics_values(stats, values, STATISTICS_VALUE_COUNT);
+        ws_bridge_send_record_from_any_thread(stream, -1, WS_RECORD_STATISTICS, values, count * sizeof(double));
+    } else if (write_statistics_to_buffer(stats, buf, sizeof(buf)) > 0) {
+        ws_bridge_send_json_from_any_thread(stream, buf, strlen(buf));
     }
+
+    // How the connection kept up with the run
+    ws_outbound_stats_t outbound;
+    ws_bridge_outbound_stats(stream, &outbound);
+    snprintf(buf, sizeof(buf), "{\"type\":\"outbound\", \"data\":{\"queued_bytes\":%zu,"
+        "\"peak_queued_bytes\":%zu,\"dropped_events\":%lu}}",
+        outbound.queued_bytes, outbound.peak_queued_bytes, outbound.dropped_events);
+    ws_bridge_send_json_from_any_thread(stream, buf, strlen(buf));
+}
+
+void publish_metrics_sample(const metrics_sample_t* sample, unsigned long number) {
+    ws_stream_t* stream = current_stream();
+    char buf[LOG_MESSAGE_CAPACITY];
+    text_buffer_t tb;
+    text_buffer_init(&tb, buf, sizeof(buf));
+    text_append_literal(&tb, "{\"type\":\"metrics\", \"seq\":");
+    text_append_uint(&tb, number);
+    text_append_literal(&tb, ", \"v\":");
+    metrics_sample_append_values(&tb, sample);
+    text_append_literal(&tb, "}");
+    ws_bridge_send_json_from_any_thread(stream, tb.data, tb.length);
+}
+
+void publish_host_usage(const host_usage_t* usage) {
+    char buf[2048];
+    int len = snprintf(buf, sizeof(buf), "{\"type\":\"host_usage\", \"data\":");
+    len += write_host_usage_to_buffer(usage, buf + len, sizeof(buf) - len);
+    if (len < (int)sizeof(buf)) len += snprintf(buf + len, sizeof(buf) - len, "}");
+    if (len < (int)sizeof(buf)) ws_bridge_send_json_from_any_thread(current_stream(), buf, len);
+}
+
+void publish_lock_statistics(const lock_profile_set_t* locks) {
+    char buf[4096];
+    int len = snprintf(buf, sizeof(buf), "{\"type\":\"locks\", \"data\":");
+    len += write_lock_profiles_to_buffer(locks, buf + len, sizeof(buf) - len);
+    if (len < (int)sizeof(buf)) len += snprintf(buf + len, sizeof(buf) - len, "}");
+    if (len < (int)sizeof(buf)) ws_bridge_send_json_from_any_thread(current_stream(), buf, len);
 }
 
 void websocket_handler_register(void) {
@@ -285,7 +469,12 @@ void websocket_handler_register(void) {
         .paper_refill_start = publish_paper_refill_start,
         .paper_refill_end = publish_paper_refill_end,
         .simulation_stopped = publish_simulation_stopped,
+        .simulation_checkpoint = publish_simulation_checkpoint,
+        .simulation_resumed = publish_simulation_resumed,
         .statistics = publish_statistics,
+        .metrics_sample = publish_metrics_sample,
+        .host_usage = publish_host_usage,
+        .lock_statistics = publish_lock_statistics,
     };
     log_router_register_websocket_handler(&ops);
 }
@@ -0,0 +1,557 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "log_filter.h"
+#include "mongoose.h"
+#include "ws_bridge.h"
+
+static struct mg_mgr* g_mgr = NULL; // used for mg_wakeup
+static int g_flush_interval_ms = 0; // 0 = one frame per event
+static size_t g_batch_bytes = 0;
+static size_t g_budget_bytes = 0;
+static int g_overflow_policy = WS_OVERFLOW_DROP_OLDEST;
+static size_t g_lag_cap_bytes = 0;
+
+// Events kept at summary verbosity are lifecycle events, which are never dropped
+static const log_filter_t s_lifecycle_only = {LOG_VERBOSITY_SUMMARY, 0, 1};
+
+// Unbatched frames up to this size are assembled on the stack before mg_wakeup
+#define UNBATCHED_STACK_FRAME 1024
+
+// A subscriber's queued frames are copied into Mongoose's send buffer while it holds less than this
+#define PUMP_SEND_BYTES 65536
+
+/**
+ * @brief A flushed frame, built once and shared by every subscriber's queue
+ *        until the last one has copied it into its send buffer.
+ */
+typedef struct ws_shared_frame {
+    int refs;              // subscribers still holding the frame; event loop only
+    unsigned char opcode;  // WEBSOCKET_OP_TEXT or WEBSOCKET_OP_BINARY
+    size_t length;
+    char data[];
+} ws_shared_frame_t;
+
+void ws_bridge_configure(struct mg_mgr* mgr, int flush_interval_ms, int batch_bytes, int budget_bytes,
+    int overflow_policy, int lag_cap_bytes)
+{
+    g_mgr = mgr;
+    g_flush_interval_ms = flush_interval_ms;
+    g_batch_bytes = (size_t)batch_bytes;
+    g_budget_bytes = (size_t)budget_bytes;
+    g_overflow_policy = overflow_policy;
+    g_lag_cap_bytes = (size_t)lag_cap_bytes;
+}
+
+int ws_bridge_flush_interval_ms(void) {
+    return g_flush_interval_ms;
+}
+
+int ws_protocol_from_name(const char* name) {
+    if (strcmp(name, "json") == 0) return WS_PROTOCOL_JSON;
+    if (strcmp(name, "binary") == 0) return WS_PROTOCOL_BINARY;
+    return -1;
+}
+
+void ws_bridge_init_stream(ws_stream_t* stream, unsigned long conn_id, int protocol) {
+    stream->conn_id = conn_id;
+    stream->protocol = protocol;
+    stream->is_text_events = 0;
+    pthread_mutex_init(&stream->mutex, NULL);
+    stream->batch = NULL;
+    stream->batch_length = 0;
+    stream->batch_capacity = 0;
+    stream->batch_count = 0;
+    stream->flush_requested = 0;
+    stream->last_flush_ms = 0;
+    stream->frames = NULL;
+    stream->frame_capacity = 0;
+    stream->send_backlog = 0;
+    stream->peak_queued_bytes = 0;
+    stream->dropped_events = 0;
+    stream->is_paused = 0;
+    memset(stream->suppressed, 0, sizeof(stream->suppressed));
+    stream->subscribers = NULL;
+    stream->subscriber_count = 0;
+    stream->subscriber_capacity = 0;
+    if (!ws_bridge_subscribe(stream, conn_id)) {
+        fprintf(stderr, "Error: Failed to subscribe connection %lu to its stream\n", conn_id);
+    }
+}
+
+static void release_queue(ws_subscriber_t* subscriber);
+
+void ws_bridge_destroy_stream(ws_stream_t* stream) {
+    for (int i = 0; i < stream->subscriber_count; i++) {
+        release_queue(&stream->subscribers[i]);
+        free(stream->subscribers[i].queue);
+    }
+    free(stream->subscribers);
+    free(stream->batch);
+    free(stream->frames);
+    stream->subscribers = NULL;
+    stream->subscriber_count = 0;
+    stream->batch = NULL;
+    stream->frames = NULL;
+    pthread_mutex_destroy(&stream->mutex);
+}
+
+// --- Batch management (stream mutex held) ---
+
+/**
+ * @brief Returns where the first frame of a batch starts: after the '[' of a
+ *        JSON array, at 0 for binary records.
+ */
+static size_t batch_origin(const ws_stream_t* stream) {
+    return stream->protocol == WS_PROTOCOL_JSON ? 1 : 0;
+}
+
+/**
+ * @brief Returns the bytes of pending frames, not counting the opening '[' of an empty JSON batch.
+ */
+static size_t pending_bytes(const ws_stream_t* stream) {
+    return stream->batch_count > 0 ? stream->batch_length : 0;
+}
+
+static void reset_batch(ws_stream_t* stream) {
+    stream->batch_count = 0;
+    stream->batch_length = stream->batch != NULL ? batch_origin(stream) : 0;
+    if (stream->batch != NULL && stream->protocol == WS_PROTOCOL_JSON) stream->batch[0] = '[';
+}
+
+/**
+ * @brief Writes a frame of the stream's protocol to out: the record header
+ *        first for binary streams, then the payload.
+ *
+ * @return The number of bytes written.
+ */
+static size_t write_frame(const ws_stream_t* stream, int kind, const void* payload, size_t len, char* out) {
+    size_t header = 0;
+    if (stream->protocol == WS_PROTOCOL_BINARY) {
+        out[0] = (char)kind;
+        out[1] = 0;
+        out[2] = (char)(len & 0xff);
+        out[3] = (char)(len >> 8);
+        header = WS_RECORD_HEADER_SIZE;
+    }
+    memcpy(out + header, payload, len);
+    return header + len;
+}
+
+static size_t frame_size(const ws_stream_t* stream, size_t len) {
+    return stream->protocol == WS_PROTOCOL_BINARY ? WS_RECORD_HEADER_SIZE + len : len;
+}
+
+/**
+ * @brief Appends a frame to the stream's batch.
+ *
+ * @return TRUE if the batch has reached the size threshold and the event loop
+ *         should be woken to flush it now.
+ */
+static int append_frame(ws_stream_t* stream, int kind, const void* payload, size_t len, int is_droppable) {
+    int is_json = stream->protocol == WS_PROTOCOL_JSON;
+    size_t length = frame_size(stream, len);
+    // JSON: ',' before the frame and room for the closing ']' added at flush
+    size_t needed = stream->batch_length + length + (is_json ? 2 : 0);
+    if (stream->batch == NULL) needed += batch_origin(stream);
+    if (needed > stream->batch_capacity) {
+        size_t capacity = stream->batch_capacity > 0 ? stream->batch_capacity : 4096;
+        while (capacity < needed) capacity *= 2;
+        char* batch = realloc(stream->batch, capacity);
+        if (batch == NULL) {
+            fprintf(stderr, "Error: Failed to grow websocket batch, frame dropped\n");
+            return FALSE;
+        }
+        int is_first = stream->batch == NULL;
+        stream->batch = batch;
+        stream->batch_capacity = capacity;
+        if (is_first) reset_batch(stream);
+    }
+    if (stream->batch_count == stream->frame_capacity) {
+        int capacity = stream->frame_capacity > 0 ? stream->frame_capacity * 2 : 64;
+        ws_frame_t* frames = realloc(stream->frames, capacity * sizeof(ws_frame_t));
+        if (frames == NULL) {
+            fprintf(stderr, "Error: Failed to grow websocket batch, frame dropped\n");
+            return FALSE;
+        }
+        stream->frames = frames;
+        stream->frame_capacity = capacity;
+    }
+    if (is_json && stream->batch_count > 0) stream->batch[stream->batch_length++] = ',';
+    ws_frame_t* frame = &stream->frames[stream->batch_count++];
+    frame->offset = stream->batch_length;
+    frame->length = length;
+    frame->is_droppable = is_droppable;
+    stream->batch_length += write_frame(stream, kind, payload, len, stream->batch + stream->batch_length);
+
+    size_t queued = stream->batch_length + stream->send_backlog;
+    if (queued > stream->peak_queued_bytes) stream->peak_queued_bytes = queued;
+    if (stream->flush_requested || stream->batch_length < g_batch_bytes) return FALSE;
+    stream->flush_requested = 1;
+    return TRUE;
+}
+
+static int append_json(ws_stream_t* stream, const char* json, size_t len) {
+    return append_frame(stream, WS_RECORD_JSON, json, len, FALSE);
+}
+
+/**
+ * @brief Cuts the oldest per-job frames out of the batch until it is no longer
+ *        than target_length. Lifecycle frames keep their place and order.
+ */
+static void drop_oldest_frames(ws_stream_t* stream, size_t target_length) {
+    if (stream->batch_count == 0) return;
+    size_t separator = stream->protocol == WS_PROTOCOL_JSON ? 1 : 0;
+    size_t excess = stream->batch_length > target_length ? stream->batch_length - target_length : 0;
+    size_t length = batch_origin(stream);
+    int count = 0;
+    for (int i = 0; i < stream->batch_count; i++) {
+        ws_frame_t frame = stream->frames[i];
+        if (frame.is_droppable && excess > 0) {
+            excess = excess > frame.length + separator ? excess - (frame.length + separator) : 0;
+            stream->dropped_events++;
+            continue;
+        }
+        if (count > 0 && separator) stream->batch[length++] = ',';
+        memmove(stream->batch + length, stream->batch + frame.offset, frame.length);
+        stream->frames[count].offset = length;
+        stream->frames[count].length = frame.length;
+        stream->frames[count].is_droppable = frame.is_droppable;
+        length += frame.length;
+        count++;
+    }
+    stream->batch_length = length;
+    stream->batch_count = count;
+}
+
+/**
+ * @brief Queues one frame counting, per event type, the events suppressed
+ *        since the last summary, e.g.
+ *        {"type":"summary", "suppressed":{"queue_arrival":120,"queue_departure":118}}
+ */
+static void append_summary(ws_stream_t* stream) {
+    char buf[1024];
+    int len = snprintf(buf, sizeof(buf), "{\"type\":\"summary\", \"suppressed\":{");
+    int count = 0;
+    for (int type = 0; type < LOG_EVENT_TYPE_COUNT; type++) {
+        if (stream->suppressed[type] == 0) continue;
+        len += snprintf(buf + len, sizeof(buf) - len, "%s\"%s\":%u", count++ > 0 ? "," : "",
+            log_event_type_name(type), stream->suppressed[type]);
+        stream->suppressed[type] = 0;
+    }
+    if (count == 0) return;
+    len += snprintf(buf + len, sizeof(buf) - len, "}}");
+    append_json(stream, buf, (size_t)len);
+}
+
+/**
+ * @brief Applies the overflow policy to a per-job frame that does not fit the budget.
+ *
+ * @return TRUE if room was made and the frame should still be queued.
+ */
+static int make_room(ws_stream_t* stream, int event_type, size_t length) {
+    switch (g_overflow_policy) {
+        case WS_OVERFLOW_DROP_OLDEST: {
+            // Cut down to three quarters of the budget so the next events do not each pay for a compaction
+            size_t target = g_budget_bytes / 4 * 3;
+            target = stream->send_backlog + length < target ? target - stream->send_backlog - length : 1;
+            drop_oldest_frames(stream, target);
+            if (stream->batch_length + stream->send_backlog + length < g_budget_bytes) return TRUE;
+            break;
+        }
+        case WS_OVERFLOW_SUMMARY:
+            stream->suppressed[event_type]++;
+            break;
+        case WS_OVERFLOW_PAUSE: {
+            static const char paused[] = "{\"type\":\"stream\", \"state\":\"paused\"}";
+            stream->is_paused = 1;
+            append_json(stream, paused, sizeof(paused) - 1);
+            break;
+        }
+    }
+    stream->dropped_events++;
+    return FALSE;
+}
+
+/**
+ * @brief Posts one frame to the event loop through the wakeup pipe. The first
+ *        byte carries the websocket opcode for ws_bridge_deliver.
+ */
+static void post_unbatched(ws_stream_t* stream, unsigned long id, int kind, const void* payload, size_t len) {
+    char stack_frame[UNBATCHED_STACK_FRAME];
+    size_t size = 1 + frame_size(stream, len);
+    char* frame = size <= sizeof(stack_frame) ? stack_frame : malloc(size);
+    if (frame == NULL) return;
+    frame[0] = stream->protocol == WS_PROTOCOL_BINARY ? WEBSOCKET_OP_BINARY : WEBSOCKET_OP_TEXT;
+    write_frame(stream, kind, payload, len, frame + 1);
+    mg_wakeup(g_mgr, id, frame, size);
+    if (frame != stack_frame) free(frame);
+}
+
+/**
+ * @brief Queues a frame for the stream's client, applying the overflow policy to per-job events.
+ */
+static void send_frame(ws_stream_t* stream, int event_type, int kind, const void* payload, size_t len) {
+    if (stream == NULL || payload == NULL || len == 0) return;
+    int is_droppable = event_type >= 0 && !log_filter_allows(&s_lifecycle_only, event_type, 0);
+    pthread_mutex_lock(&stream->mutex);
+    unsigned long id = stream->conn_id;
+    if (id == 0 || (kind != WS_RECORD_JSON && stream->protocol != WS_PROTOCOL_BINARY)) {
+        pthread_mutex_unlock(&stream->mutex);
+        return;
+    }
+
+    if (g_flush_interval_ms == 0) {
+        // Unbatched: Mongoose's send buffer is the only queue, so new per-job events are dropped while it is full
+        int is_over_budget = is_droppable && stream->send_backlog >= g_budget_bytes;
+        if (is_over_budget) stream->dropped_events++;
+        else post_unbatched(stream, id, kind, payload, len);
+        pthread_mutex_unlock(&stream->mutex);
+        return;
+    }
+
+    int wake = FALSE;
+    size_t length = frame_size(stream, len);
+    if (is_droppable && (stream->is_paused
+        || stream->batch_length + stream->send_backlog + length >= g_budget_bytes)) {
+        if (stream->is_paused) stream->dropped_events++;
+        else if (make_room(stream, event_type, length)) wake = append_frame(stream, kind, payload, len, TRUE);
+    } else {
+        wake = append_frame(stream, kind, payload, len, is_droppable);
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    // An empty wakeup asks the event loop to flush the batch now
+    if (wake) mg_wakeup(g_mgr, id, "", 0);
+}
+
+void ws_bridge_send_json_from_any_thread(ws_stream_t* stream, const char* json, size_t len) {
+    send_frame(stream, -1, WS_RECORD_JSON, json, len);
+}
+
+void ws_bridge_send_event_from_any_thread(ws_stream_t* stream, int event_type, const char* json, size_t len) {
+    send_frame(stream, event_type, WS_RECORD_JSON, json, len);
+}
+
+void ws_bridge_send_record_from_any_thread(ws_stream_t* stream, int event_type, int kind,
+    const void* payload, size_t len)
+{
+    if (len > UINT16_MAX) return;
+    send_frame(stream, event_type, kind, payload, len);
+}
+
+void ws_bridge_outbound_stats(ws_stream_t* stream, ws_outbound_stats_t* stats) {
+    pthread_mutex_lock(&stream->mutex);
+    stats->queued_bytes = pending_bytes(stream) + stream->send_backlog;
+    stats->peak_queued_bytes = stream->peak_queued_bytes;
+    stats->dropped_events = stream->dropped_events;
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+void ws_bridge_detach_stream(ws_stream_t* stream) {
+    pthread_mutex_lock(&stream->mutex);
+    stream->conn_id = 0;
+    reset_batch(stream);
+    stream->is_paused = 0;
+    memset(stream->suppressed, 0, sizeof(stream->suppressed));
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+// --- Fan-out (event loop only) ---
+
+static void release_frame(ws_shared_frame_t* frame) {
+    if (--frame->refs == 0) free(frame);
+}
+
+static void release_queue(ws_subscriber_t* subscriber) {
+    while (subscriber->count > 0) {
+        release_frame(subscriber->queue[subscriber->head]);
+        subscriber->head = (subscriber->head + 1) % subscriber->capacity;
+        subscriber->count--;
+    }
+    subscriber->head = 0;
+    subscriber->queued_bytes = 0;
+}
+
+static ws_subscriber_t* find_subscriber(ws_stream_t* stream, unsigned long conn_id) {
+    for (int i = 0; i < stream->subscriber_count; i++) {
+        if (stream->subscribers[i].conn_id == conn_id) return &stream->subscribers[i];
+    }
+    return NULL;
+}
+
+int ws_bridge_subscribe(ws_stream_t* stream, unsigned long conn_id) {
+    if (stream->subscriber_count == stream->subscriber_capacity) {
+        int capacity = stream->subscriber_capacity > 0 ? stream->subscriber_capacity * 2 : 4;
+        ws_subscriber_t* subscribers = realloc(stream->subscribers, capacity * sizeof(ws_subscriber_t));
+        if (subscribers == NULL) return FALSE;
+        stream->subscribers = subscribers;
+        stream->subscriber_capacity = capacity;
+    }
+    ws_subscriber_t* subscriber = &stream->subscribers[stream->subscriber_count++];
+    memset(subscriber, 0, sizeof(*subscriber));
+    subscriber->conn_id = conn_id;
+    return TRUE;
+}
+
+void ws_bridge_unsubscribe(ws_stream_t* stream, unsigned long conn_id) {
+    // The owner stays at index 0, so watchers are removed by shifting the rest down
+    for (int i = 1; i < stream->subscriber_count; i++) {
+        if (stream->subscribers[i].conn_id != conn_id) continue;
+        release_queue(&stream->subscribers[i]);
+        free(stream->subscribers[i].queue);
+        memmove(&stream->subscribers[i], &stream->subscribers[i + 1],
+            (stream->subscriber_count - i - 1) * sizeof(ws_subscriber_t));
+        stream->subscriber_count--;
+        return;
+    }
+}
+
+int ws_bridge_watcher_count(const ws_stream_t* stream) {
+    return stream->subscriber_count > 0 ? stream->subscriber_count - 1 : 0;
+}
+
+static int enqueue_frame(ws_subscriber_t* subscriber, ws_shared_frame_t* frame) {
+    if (subscriber->count == subscriber->capacity) {
+        int capacity = subscriber->capacity > 0 ? subscriber->capacity * 2 : 16;
+        ws_shared_frame_t** queue = malloc(capacity * sizeof(ws_shared_frame_t*));
+        if (queue == NULL) return FALSE;
+        for (int i = 0; i < subscriber->count; i++) {
+            queue[i] = subscriber->queue[(subscriber->head + i) % subscriber->capacity];
+        }
+        free(subscriber->queue);
+        subscriber->queue = queue;
+        subscriber->capacity = capacity;
+        subscriber->head = 0;
+    }
+    subscriber->queue[(subscriber->head + subscriber->count) % subscriber->capacity] = frame;
+    subscriber->count++;
+    subscriber->queued_bytes += frame->length;
+    frame->refs++;
+    return TRUE;
+}
+
+/**
+ * @brief Copies one frame into a shared buffer and queues it for every
+ *        subscriber. Watchers that would fall further behind than the lag cap
+ *        are flagged and their queue released instead.
+ */
+static void fan_out(ws_stream_t* stream, unsigned char opcode, const char* data, size_t length) {
+    if (stream->subscriber_count == 0) return;
+    ws_shared_frame_t* frame = malloc(sizeof(ws_shared_frame_t) + length);
+    if (frame == NULL) {
+        fprintf(stderr, "Error: Failed to allocate websocket frame, frame dropped\n");
+        return;
+    }
+    frame->refs = 1; // held by fan_out until every subscriber has queued it
+    frame->opcode = opcode;
+    frame->length = length;
+    memcpy(frame->data, data, length);
+
+    for (int i = 0; i < stream->subscriber_count; i++) {
+        ws_subscriber_t* subscriber = &stream->subscribers[i];
+        if (subscriber->is_lagging) continue;
+        if (i > 0 && subscriber->queued_bytes + length > g_lag_cap_bytes) {
+            subscriber->is_lagging = 1;
+            release_queue(subscriber);
+            continue;
+        }
+        if (!enqueue_frame(subscriber, frame)) subscriber->is_lagging = 1;
+    }
+    release_frame(frame);
+}
+
+/**
+ * @brief Copies queued frames into the connection's send buffer while it is
+ *        below PUMP_SEND_BYTES, so each subscriber holds only a bounded copy.
+ */
+static void pump_subscriber(struct mg_connection* c, ws_subscriber_t* subscriber) {
+    while (subscriber->count > 0 && c->send.len < PUMP_SEND_BYTES) {
+        ws_shared_frame_t* frame = subscriber->queue[subscriber->head];
+        mg_ws_send(c, frame->data, frame->length, frame->opcode);
+        subscriber->head = (subscriber->head + 1) % subscriber->capacity;
+        subscriber->count--;
+        subscriber->queued_bytes -= frame->length;
+        release_frame(frame);
+    }
+}
+
+int ws_bridge_pump(struct mg_connection* c, ws_stream_t* stream) {
+    ws_subscriber_t* subscriber = find_subscriber(stream, c->id);
+    if (subscriber == NULL || subscriber->is_lagging) return FALSE;
+    pump_subscriber(c, subscriber);
+    return TRUE;
+}
+
+/**
+ * @brief Refreshes the owner's backlog: its queued frames plus the bytes
+ *        Mongoose has yet to write. Called with the stream's mutex held.
+ */
+static void refresh_backlog(struct mg_connection* c, ws_stream_t* stream) {
+    size_t queued = stream->subscriber_count > 0 ? stream->subscribers[0].queued_bytes : 0;
+    stream->send_backlog = queued + c->send.len;
+}
+
+// --- Event loop side ---
+
+/**
+ * @brief Fans out the stream's pending frames as one frame, unless the owner
+ *        already has a full budget of unsent bytes and the flush is not
+ *        forced. Called with the stream's mutex held.
+ */
+static void flush_batch(struct mg_connection* c, ws_stream_t* stream, int force) {
+    stream->flush_requested = 0;
+    if (stream->batch_count == 0 || (!force && stream->send_backlog >= g_budget_bytes)) return;
+    if (stream->protocol == WS_PROTOCOL_JSON) {
+        stream->batch[stream->batch_length] = ']'; // room kept by append_frame
+        fan_out(stream, WEBSOCKET_OP_TEXT, stream->batch, stream->batch_length + 1);
+    } else {
+        fan_out(stream, WEBSOCKET_OP_BINARY, stream->batch, stream->batch_length);
+    }
+    reset_batch(stream);
+    if (stream->subscriber_count > 0) pump_subscriber(c, &stream->subscribers[0]);
+    refresh_backlog(c, stream);
+}
+
+void ws_bridge_service(struct mg_connection* c, ws_stream_t* stream, unsigned long now_ms) {
+    pthread_mutex_lock(&stream->mutex);
+    if (stream->subscriber_count > 0) pump_subscriber(c, &stream->subscribers[0]);
+    refresh_backlog(c, stream);
+    size_t queued = pending_bytes(stream) + stream->send_backlog;
+    if (queued > stream->peak_queued_bytes) stream->peak_queued_bytes = queued;
+
+    if (stream->is_paused && queued <= g_budget_bytes / 2) {
+        static const char resumed[] = "{\"type\":\"stream\", \"state\":\"resumed\"}";
+        stream->is_paused = 0;
+        append_json(stream, resumed, sizeof(resumed) - 1);
+    }
+    if (g_overflow_policy == WS_OVERFLOW_SUMMARY && queued < g_budget_bytes) append_summary(stream);
+
+    if (g_flush_interval_ms > 0
+        && (now_ms == 0 || now_ms - stream->last_flush_ms >= (unsigned long)g_flush_interval_ms)) {
+        flush_batch(c, stream, FALSE);
+        stream->last_flush_ms = now_ms;
+    }
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+void ws_bridge_deliver(struct mg_connection* c, ws_stream_t* stream, const void* data, size_t len) {
+    const char* frame = (const char*)data;
+    if (len <= 1) return;
+    pthread_mutex_lock(&stream->mutex);
+    fan_out(stream, (unsigned char)frame[0], frame + 1, len - 1);
+    if (stream->subscriber_count > 0) pump_subscriber(c, &stream->subscribers[0]);
+    refresh_backlog(c, stream);
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+void ws_bridge_set_protocol(struct mg_connection* c, ws_stream_t* stream, int protocol) {
+    pthread_mutex_lock(&stream->mutex);
+    flush_batch(c, stream, TRUE);
+    stream->protocol = protocol;
+    reset_batch(stream);
+    pthread_mutex_unlock(&stream->mutex);
+}
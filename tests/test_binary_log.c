@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "binary_log.h"
+#include "log_event.h"
+#include "test_utils.h"
+
+static const char log_path[] = "test_binary_log.bin";
+
+// More than the initial mapping holds, so the file has to grow
+#define RECORD_COUNT 200000
+
+int test_binary_log_round_trip() {
+    binary_log_writer_t writer;
+    if (!binary_log_open(&writer, log_path)) {
+        printf("Test failed: binary_log_open returned FALSE\n");
+        return 1;
+    }
+    for (int i = 0; i < RECORD_COUNT; i++) {
+        log_event_t event = {.type = LOG_EVENT_SYSTEM_ARRIVAL, .job_id = i, .time_us = 1000 + i,
+            .duration_us = 7, .papers = i % 20};
+        binary_log_append(&writer, &event);
+    }
+    binary_log_close(&writer);
+
+    binary_log_reader_t reader;
+    if (!binary_log_read(&reader, log_path)) {
+        printf("Test failed: binary_log_read rejected the file it wrote\n");
+        remove(log_path);
+        return 1;
+    }
+    int failed = 0;
+    if (reader.record_count != RECORD_COUNT) {
+        printf("Test failed: expected %d records, read %zu\n", RECORD_COUNT, reader.record_count);
+        failed = 1;
+    }
+    for (size_t i = 0; i < reader.record_count && !failed; i++) {
+        const log_event_t* event = &reader.records[i];
+        if (event->type != LOG_EVENT_SYSTEM_ARRIVAL || event->job_id != (int)i
+            || event->time_us != 1000 + i || event->papers != (int)(i % 20)) {
+            printf("Test failed: record %zu differs from the one written\n", i);
+            failed = 1;
+        }
+    }
+    binary_log_release(&reader);
+    remove(log_path);
+    if (!failed) printf("Test passed: %d records written through a growing mapping and read back\n", RECORD_COUNT);
+    return failed;
+}
+
+int test_binary_log_unclosed_file() {
+    // A run that crashed leaves a zero count and zeroed slots after its records
+    FILE* file = fopen(log_path, "wb");
+    binary_log_header_t header = {BINARY_LOG_MAGIC, BINARY_LOG_VERSION, sizeof(log_event_t), 0, 0};
+    fwrite(&header, sizeof(header), 1, file);
+    log_event_t events[5] = {0};
+    for (int i = 0; i < 3; i++) {
+        events[i].type = LOG_EVENT_QUEUE_ARRIVAL;
+        events[i].job_id = i + 1;
+    }
+    fwrite(events, sizeof(log_event_t), 5, file);
+    fclose(file);
+
+    binary_log_reader_t reader;
+    int failed = 0;
+    if (!binary_log_read(&reader, log_path)) {
+        printf("Test failed: binary_log_read rejected an unclosed log\n");
+        failed = 1;
+    } else {
+        if (reader.record_count != 3) {
+            printf("Test failed: expected 3 records in an unclosed log, read %zu\n", reader.record_count);
+            failed = 1;
+        }
+        binary_log_release(&reader);
+    }
+    remove(log_path);
+    if (!failed) printf("Test passed: unclosed log ends at the first zeroed record\n");
+    return failed;
+}
+
+int test_log_event_text_matches_console() {
+    log_event_t event = {.type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = 4, .time_us = 5240627,
+        .duration_us = 40016, .queue_length = 2};
+    char line[256];
+    log_event_format_text(&event, 5000000, line, sizeof(line));
+    const char* expected = "00000240.627ms: job4 leaves queue, time in queue = 40.016ms, queue_length = 2\n";
+    if (strcmp(line, expected) != 0) {
+        printf("Test failed: formatted \"%s\", expected \"%s\"\n", line, expected);
+        return 1;
+    }
+    printf("Test passed: decoded record formats as the console line\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "BINARY LOG";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_binary_log_round_trip();
+    failed_tests += test_binary_log_unclosed_file();
+    failed_tests += test_log_event_text_matches_console();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "checkpoint.h"
+#include "job_receiver.h"
+#include "preprocessing.h"
+#include "simulation_context.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "test_utils.h"
+
+static const char checkpoint_path[] = "test_checkpoint.ckpt";
+
+static void enqueue_job(simulation_context_t* ctx, int id, int papers_required, unsigned long arrival_time_us) {
+    job_t* job = malloc(sizeof(job_t));
+    init_job(job, id, 1000, papers_required);
+    job->system_arrival_time_us = arrival_time_us;
+    job->queue_arrival_time_us = arrival_time_us;
+    timed_queue_enqueue(&ctx->job_queue, job);
+}
+
+int test_checkpoint_round_trip() {
+    int failed = 0;
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.model.num_jobs = 42;
+    params.model.seed = 9;
+    params.ws_lag_cap_bytes = 1; // a run option of the saving process
+
+    // A quiesced run: two jobs waiting, printers part-way through their paper
+    simulation_context_t saved;
+    simulation_context_init(&saved, &params);
+    saved.stats.simulation_start_time_us = 1000000;
+    saved.stats.simulation_duration_us = 800000;
+    saved.stats.total_jobs_arrived = 7;
+    saved.stats.total_jobs_served = 5;
+    saved.stats.total_system_time_us = 123456;
+    saved.stats.area_num_in_job_queue_us = 98765;
+    latency_histogram_record(&saved.stats.system_time_histogram, 123456);
+    latency_histogram_record(&saved.stats.queue_wait_histogram, 42);
+    saved.rng_state = 12345;
+    saved.next_job_index = 7;
+    saved.previous_job_arrival_time_us = 1700000;
+    saved.printer1.current_paper_count = 61;
+    saved.printer2.total_papers_used = 77;
+    enqueue_job(&saved, 6, 11, 1600000);
+    enqueue_job(&saved, 7, 13, 1700000);
+
+    if (!checkpoint_save(&saved, checkpoint_path)) {
+        printf("Test failed: checkpoint_save returned FALSE\n");
+        simulation_context_destroy(&saved);
+        return 1;
+    }
+
+    simulation_parameters_t run_options = SIMULATION_DEFAULT_PARAMS;
+    snprintf(run_options.checkpoint_path, sizeof(run_options.checkpoint_path), "next.ckpt");
+    simulation_context_t restored;
+    if (!checkpoint_load(&restored, checkpoint_path, &run_options)) {
+        printf("Test failed: checkpoint_load returned FALSE\n");
+        simulation_context_destroy(&saved);
+        remove(checkpoint_path);
+        return 1;
+    }
+
+    // Statistics are identical apart from the start time, which moves by the paused interval
+    unsigned long offset_us = restored.stats.simulation_start_time_us - saved.stats.simulation_start_time_us;
+    char saved_json[4096];
+    char restored_json[4096];
+    write_statistics_to_buffer(&saved.stats, saved_json, sizeof(saved_json));
+    write_statistics_to_buffer(&restored.stats, restored_json, sizeof(restored_json));
+    simulation_statistics_t unshifted = restored.stats;
+    unshifted.simulation_start_time_us = saved.stats.simulation_start_time_us;
+    if (strcmp(saved_json, restored_json) != 0 || memcmp(&unshifted, &saved.stats, sizeof(unshifted)) != 0) {
+        printf("Test failed: restored statistics differ from the saved ones\n");
+        failed = 1;
+    }
+
+    if (restored.params.model.num_jobs != 42 || restored.params.model.seed != 9
+        || strcmp(restored.params.checkpoint_path, "next.ckpt") != 0
+        || restored.params.ws_lag_cap_bytes != run_options.ws_lag_cap_bytes) {
+        printf("Test failed: parameters not restored (num_jobs=%d, seed=%u, checkpoint_path=%s)\n",
+            restored.params.model.num_jobs, restored.params.model.seed, restored.params.checkpoint_path);
+        failed = 1;
+    }
+
+    if (restored.rng_state != 12345 || restored.next_job_index != 7
+        || restored.previous_job_arrival_time_us != 1700000 + offset_us
+        || restored.printer1.current_paper_count != 61 || restored.printer2.total_papers_used != 77) {
+        printf("Test failed: receiver or printer state not restored\n");
+        failed = 1;
+    }
+
+    list_node_t* first = timed_queue_first(&restored.job_queue);
+    job_t* job = first != NULL ? (job_t*)first->data : NULL;
+    if (timed_queue_length(&restored.job_queue) != 2 || job == NULL || job->id != 6
+        || job->papers_required != 11 || job->queue_arrival_time_us != 1600000 + offset_us
+        || job->service_arrival_time_us != 0) {
+        printf("Test failed: queued jobs not restored in order with rebased timestamps\n");
+        failed = 1;
+    }
+
+    if (!failed) {
+        printf("Test passed: checkpoint restored %d queued jobs, rebased by %lu us\n",
+            timed_queue_length(&restored.job_queue), offset_us);
+    }
+
+    simulation_context_destroy(&saved);
+    simulation_context_destroy(&restored);
+    remove(checkpoint_path);
+    return failed;
+}
+
+int test_checkpoint_is_compact() {
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    simulation_context_t ctx;
+    simulation_context_init(&ctx, &params);
+    latency_histogram_record(&ctx.stats.service_time_p1_histogram, 2500000);
+    int saved = checkpoint_save(&ctx, checkpoint_path);
+    simulation_context_destroy(&ctx);
+
+    FILE* file = fopen(checkpoint_path, "rb");
+    long size = -1;
+    if (file != NULL) {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fclose(file);
+    }
+    remove(checkpoint_path);
+    // Mostly empty histograms must not be written out bucket by bucket
+    if (!saved || size < 0 || size > (long)sizeof(simulation_statistics_t) / 10) {
+        printf("Test failed: checkpoint is %ld bytes for %zu bytes of statistics\n",
+            size, sizeof(simulation_statistics_t));
+        return 1;
+    }
+    printf("Test passed: checkpoint is %ld bytes for %zu bytes of statistics\n", size, sizeof(simulation_statistics_t));
+    return 0;
+}
+
+int test_checkpoint_rejects_foreign_file() {
+    FILE* file = fopen(checkpoint_path, "wb");
+    fputs("not a checkpoint", file);
+    fclose(file);
+
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    simulation_context_t ctx;
+    int loaded = checkpoint_load(&ctx, checkpoint_path, &params);
+    remove(checkpoint_path);
+    if (loaded) {
+        printf("Test failed: checkpoint_load accepted a foreign file\n");
+        simulation_context_destroy(&ctx);
+        return 1;
+    }
+    printf("Test passed: checkpoint_load rejected a foreign file\n");
+    return 0;
+}
+
+/**
+ * @brief Parameters of a short run with one job every 100 ms, short services
+ *        and enough paper that no refill happens.
+ */
+static simulation_parameters_t split_run_params(void) {
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.model.num_jobs = 8;
+    params.model.job_arrival_time_us = 100000;
+    params.model.printing_rate = 1000;
+    params.model.printer_paper_capacity = 100000;
+    params.model.seed = 3;
+    return params;
+}
+
+int test_checkpoint_split_run_matches_unsplit() {
+    int failed = 0;
+    simulation_parameters_t params = split_run_params();
+    const unsigned long interval_us = (unsigned long)params.model.job_arrival_time_us;
+
+    simulation_context_t unsplit;
+    simulation_context_init(&unsplit, &params);
+    simulation_context_run(&unsplit);
+
+    // Checkpoint late in an inter-arrival wait, pause, then resume
+    simulation_context_t first;
+    simulation_context_init(&first, &params);
+    simulation_context_start(&first);
+    usleep(4 * interval_us + interval_us * 9 / 10);
+    simulation_context_request_checkpoint(&first);
+    simulation_context_join(&first);
+    int is_saved = checkpoint_save(&first, checkpoint_path);
+    simulation_context_destroy(&first);
+    usleep(4 * interval_us);
+
+    simulation_context_t resumed;
+    if (!is_saved || !checkpoint_load(&resumed, checkpoint_path, &params)) {
+        printf("Test failed: the split run could not be checkpointed and restored\n");
+        simulation_context_destroy(&unsplit);
+        remove(checkpoint_path);
+        return 1;
+    }
+    simulation_context_resume(&resumed);
+    simulation_context_join(&resumed);
+    simulation_context_finish(&resumed);
+
+    // Neither the pause nor the drain nor a second wait for the pending job may show up in the timing
+    const simulation_statistics_t* a = &unsplit.stats;
+    const simulation_statistics_t* b = &resumed.stats;
+    long duration_difference_us = (long)b->simulation_duration_us - (long)a->simulation_duration_us;
+    long inter_arrival_difference_us = (long)b->total_inter_arrival_time_us - (long)a->total_inter_arrival_time_us;
+    if (b->total_jobs_arrived != a->total_jobs_arrived || b->total_jobs_served != a->total_jobs_served
+        || b->total_jobs_dropped != a->total_jobs_dropped
+        || b->printer1_paper_used + b->printer2_paper_used != a->printer1_paper_used + a->printer2_paper_used) {
+        printf("Test failed: split run served %g of %g jobs, unsplit %g of %g\n",
+            b->total_jobs_served, b->total_jobs_arrived, a->total_jobs_served, a->total_jobs_arrived);
+        failed = 1;
+    } else if (labs(duration_difference_us) > (long)interval_us / 2
+        || labs(inter_arrival_difference_us) > (long)interval_us / 2) {
+        printf("Test failed: split run is %ld us longer and its arrivals %ld us further apart than unsplit\n",
+            duration_difference_us, inter_arrival_difference_us);
+        failed = 1;
+    } else {
+        printf("Test passed: split run matches the unsplit one within %ld us (arrivals %ld us)\n",
+            duration_difference_us, inter_arrival_difference_us);
+    }
+
+    simulation_context_destroy(&unsplit);
+    simulation_context_destroy(&resumed);
+    remove(checkpoint_path);
+    return failed;
+}
+
+int main() {
+    char test_name[] = "CHECKPOINT";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_checkpoint_round_trip();
+    failed_tests += test_checkpoint_is_compact();
+    failed_tests += test_checkpoint_rejects_foreign_file();
+    failed_tests += test_checkpoint_split_run_matches_unsplit();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
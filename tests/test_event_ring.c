@@ -0,0 +1,129 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "event_ring.h"
+#include "log_event.h"
+#include "test_utils.h"
+
+#define PRODUCERS 4
+#define EVENTS_PER_PRODUCER 20000
+
+int test_event_ring_preserves_order() {
+    event_ring_t ring;
+    event_ring_init(&ring, 5, sizeof(log_event_t), EVENT_RING_OVERFLOW_BLOCK); // rounded up to 8
+
+    int failed = 0;
+    // Several laps around the ring
+    for (int round = 0; round < 3 && !failed; round++) {
+        for (int i = 0; i < 8; i++) {
+            log_event_t event = {.type = LOG_EVENT_SYSTEM_ARRIVAL, .job_id = round * 8 + i};
+            if (!event_ring_push(&ring, &event)) failed = 1;
+        }
+        for (int i = 0; i < 8; i++) {
+            log_event_t event;
+            if (!event_ring_pop(&ring, &event) || event.job_id != round * 8 + i) failed = 1;
+        }
+    }
+    log_event_t event;
+    if (event_ring_pop(&ring, &event)) failed = 1;
+
+    event_ring_destroy(&ring);
+    if (failed) {
+        printf("Test failed: records not popped in the order they were pushed\n");
+        return 1;
+    }
+    printf("Test passed: records popped in order across laps\n");
+    return 0;
+}
+
+int test_event_ring_drops_when_full() {
+    event_ring_t ring;
+    event_ring_init(&ring, 4, sizeof(log_event_t), EVENT_RING_OVERFLOW_DROP);
+
+    log_event_t event = {.type = LOG_EVENT_SYSTEM_ARRIVAL};
+    int pushed = 0;
+    for (int i = 0; i < 6; i++) {
+        event.job_id = i;
+        pushed += event_ring_push(&ring, &event);
+    }
+
+    int failed = 0;
+    if (pushed != 4 || event_ring_dropped(&ring) != 2) {
+        printf("Test failed: expected 4 pushed and 2 dropped, got %d and %lu\n",
+            pushed, event_ring_dropped(&ring));
+        failed = 1;
+    }
+    // The oldest records survive
+    if (!event_ring_pop(&ring, &event) || event.job_id != 0) {
+        printf("Test failed: oldest record was not kept\n");
+        failed = 1;
+    }
+
+    event_ring_destroy(&ring);
+    if (!failed) printf("Test passed: full ring drops and counts new records\n");
+    return failed;
+}
+
+typedef struct producer_args {
+    event_ring_t* ring;
+    int producer_id;
+} producer_args_t;
+
+static void* producer_thread_func(void* arg) {
+    producer_args_t* args = (producer_args_t*)arg;
+    for (int i = 0; i < EVENTS_PER_PRODUCER; i++) {
+        log_event_t event = {.type = LOG_EVENT_SYSTEM_ARRIVAL,
+            .printer_id = args->producer_id, .job_id = i};
+        event_ring_push(args->ring, &event);
+    }
+    return NULL;
+}
+
+int test_event_ring_multiple_producers() {
+    event_ring_t ring;
+    event_ring_init(&ring, 256, sizeof(log_event_t), EVENT_RING_OVERFLOW_BLOCK);
+
+    pthread_t threads[PRODUCERS];
+    producer_args_t args[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++) {
+        args[p] = (producer_args_t){&ring, p};
+        pthread_create(&threads[p], NULL, producer_thread_func, &args[p]);
+    }
+
+    // Every producer's records arrive complete and in that producer's order
+    int next_job_id[PRODUCERS] = {0};
+    int received = 0;
+    int failed = 0;
+    while (received < PRODUCERS * EVENTS_PER_PRODUCER) {
+        log_event_t event;
+        if (!event_ring_pop(&ring, &event)) continue;
+        if (event.printer_id >= PRODUCERS || event.job_id != next_job_id[event.printer_id]) failed = 1;
+        else next_job_id[event.printer_id]++;
+        received++;
+    }
+    for (int p = 0; p < PRODUCERS; p++) pthread_join(threads[p], NULL);
+
+    event_ring_destroy(&ring);
+    if (failed) {
+        printf("Test failed: records lost, duplicated or reordered across producers\n");
+        return 1;
+    }
+    printf("Test passed: %d producers delivered %d records in order\n", PRODUCERS, received);
+    return 0;
+}
+
+int main() {
+    char test_name[] = "EVENT RING";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_event_ring_preserves_order();
+    failed_tests += test_event_ring_drops_when_full();
+    failed_tests += test_event_ring_multiple_producers();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "host_usage.h"
+#include "test_utils.h"
+
+/**
+ * @brief Burns about 50 ms of CPU time, then sleeps so the thread blocks once.
+ */
+static void burn_cpu(void) {
+    volatile unsigned long sink = 0;
+    for (unsigned long i = 0; i < 100000000UL; i++) sink += i;
+    usleep(1000);
+}
+
+static void* pipeline_thread_func(void* arg) {
+    burn_cpu();
+    thread_usage_read_self((thread_usage_t*)arg);
+    return NULL;
+}
+
+static void* finishing_thread_func(void* arg) {
+    host_usage_finish((host_usage_t*)arg, 4);
+    return NULL;
+}
+
+int test_pipeline_and_event_loop_threads() {
+#ifndef __linux__
+    printf("Test skipped: per-thread usage needs Linux\n");
+    return 0;
+#endif
+    host_usage_t usage = {0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, pipeline_thread_func, &usage.threads[2]);
+    pthread_join(thread, NULL);
+
+    // This thread stands in for the event loop and is read by another one
+    host_usage_set_event_loop_thread();
+    burn_cpu();
+    pthread_create(&thread, NULL, finishing_thread_func, &usage);
+    pthread_join(thread, NULL);
+
+    const thread_usage_t* printer = &usage.threads[2]; // Printer 1
+    const thread_usage_t* event_loop = &usage.threads[HOST_USAGE_EVENT_LOOP];
+    if (!printer->is_recorded || printer->user_time_sec <= 0 || printer->voluntary_switches < 1
+        || !event_loop->is_recorded || event_loop->user_time_sec <= 0 || usage.threads[0].is_recorded
+        || usage.peak_rss_kb <= 0 || host_usage_cpu_per_job_us(&usage) <= 0) {
+        printf("Test failed: printer %d %.3f s, event loop %d %.3f s, peak RSS %ld KB\n", printer->is_recorded,
+            printer->user_time_sec, event_loop->is_recorded, event_loop->user_time_sec, usage.peak_rss_kb);
+        return 1;
+    }
+
+    char buf[1024];
+    int len = write_host_usage_to_buffer(&usage, buf, sizeof(buf));
+    if (len >= (int)sizeof(buf) || strstr(buf, "\"Job receiver\"") != NULL
+        || strstr(buf, "{\"name\":\"Printer 1\",\"user_sec\":") == NULL || strstr(buf, "\"Event loop\"") == NULL
+        || strcmp(buf + len - 2, "]}") != 0) {
+        printf("Test failed: unexpected JSON %s\n", buf);
+        return 1;
+    }
+    printf("Test passed: printer %.3f s, event loop %.3f s, %.0f us per job\n", printer->user_time_sec,
+        event_loop->user_time_sec, host_usage_cpu_per_job_us(&usage));
+    return 0;
+}
+
+int main() {
+    char test_name[] = "HOST USAGE";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_pipeline_and_event_loop_threads();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+
+#include "latency_histogram.h"
+#include "test_utils.h"
+
+int test_empty_and_exact_range() {
+    static latency_histogram_t histogram;
+    if (latency_histogram_percentile(&histogram, 50.0) != 0) {
+        printf("Test failed: empty histogram reported a nonzero percentile\n");
+        return 1;
+    }
+    for (unsigned long value_us = 1; value_us <= 100; value_us++) latency_histogram_record(&histogram, value_us);
+    unsigned long p50 = latency_histogram_percentile(&histogram, 50.0);
+    unsigned long p99 = latency_histogram_percentile(&histogram, 99.0);
+    unsigned long p100 = latency_histogram_percentile(&histogram, 100.0);
+    if (p50 != 50 || p99 != 99 || p100 != 100) {
+        printf("Test failed: small values not exact, p50 %lu p99 %lu p100 %lu\n", p50, p99, p100);
+        return 1;
+    }
+    printf("Test passed: empty histogram and exact small values\n");
+    return 0;
+}
+
+int test_relative_error_is_bounded() {
+    static latency_histogram_t histogram;
+    // One value per histogram, across every power of two up to the clamp
+    for (unsigned long value_us = 129; value_us < (1UL << LATENCY_HISTOGRAM_MAX_EXPONENT); value_us = value_us * 3 + 7) {
+        histogram = (latency_histogram_t){0};
+        latency_histogram_record(&histogram, value_us);
+        latency_histogram_record(&histogram, value_us * 2);
+        unsigned long reported = latency_histogram_percentile(&histogram, 50.0);
+        if (reported < value_us || reported - value_us > value_us / 64) {
+            printf("Test failed: %lu reported as %lu\n", value_us, reported);
+            return 1;
+        }
+    }
+    printf("Test passed: percentiles within 1/64 of the recorded value\n");
+    return 0;
+}
+
+int test_tail_percentiles_and_clamp() {
+    static latency_histogram_t histogram;
+    // 1000 fast jobs and 10 slow ones: the mean hides the tail, p99.9 must not
+    for (int i = 0; i < 1000; i++) latency_histogram_record(&histogram, 2000000);
+    for (int i = 0; i < 10; i++) latency_histogram_record(&histogram, 60000000);
+    unsigned long p90 = latency_histogram_percentile(&histogram, 90.0);
+    unsigned long p99_9 = latency_histogram_percentile(&histogram, 99.9);
+    if (p90 < 2000000 || p90 > 2000000 + 2000000 / 64 || p99_9 < 60000000) {
+        printf("Test failed: p90 %lu p99.9 %lu\n", p90, p99_9);
+        return 1;
+    }
+
+    // Values past the last bucket are counted there; the maximum stays exact
+    unsigned long huge_us = 1UL << (LATENCY_HISTOGRAM_MAX_EXPONENT + 4);
+    latency_histogram_record(&histogram, huge_us);
+    if (histogram.max_us != huge_us || latency_histogram_percentile(&histogram, 100.0) != huge_us
+        || histogram.total_count != 1011) {
+        printf("Test failed: out-of-range value not clamped\n");
+        return 1;
+    }
+    printf("Test passed: tail percentiles p90 %lu us, p99.9 %lu us, with a clamped outlier\n", p90, p99_9);
+    return 0;
+}
+
+int test_count_at_or_below() {
+    static latency_histogram_t histogram;
+    unsigned long values_us[] = {50, 127, 5000, 20000, 20000, 900000};
+    for (int i = 0; i < 6; i++) latency_histogram_record(&histogram, values_us[i]);
+    if (latency_histogram_count_at_or_below(&histogram, 50) != 1
+        || latency_histogram_count_at_or_below(&histogram, 127) != 2
+        || latency_histogram_count_at_or_below(&histogram, 10000) != 3
+        || latency_histogram_count_at_or_below(&histogram, 100000) != 5
+        || latency_histogram_count_at_or_below(&histogram, 900000) != 6) {
+        printf("Test failed: cumulative counts do not match the recorded values\n");
+        return 1;
+    }
+    printf("Test passed: counts at or below a bound\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "LATENCY HISTOGRAM";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_empty_and_exact_range();
+    failed_tests += test_relative_error_is_bounded();
+    failed_tests += test_tail_percentiles_and_clamp();
+    failed_tests += test_count_at_or_below();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
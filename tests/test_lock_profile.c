@@ -0,0 +1,118 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "lock_profile.h"
+#include "test_utils.h"
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static lock_profile_set_t s_locks;
+static int s_is_ready = FALSE;
+
+/**
+ * @brief Holds the mutex for 20 ms while the bound main thread waits for it.
+ */
+static void* holder_thread_func(void* arg) {
+    pthread_mutex_lock(&s_mutex);
+    s_is_ready = TRUE;
+    usleep(20000);
+    pthread_mutex_unlock(&s_mutex);
+    return NULL;
+}
+
+/**
+ * @brief Signals the condition variable after 10 ms.
+ */
+static void* signaller_thread_func(void* arg) {
+    usleep(10000);
+    pthread_mutex_lock(&s_mutex);
+    s_is_ready = TRUE;
+    pthread_cond_signal(&s_cond);
+    pthread_mutex_unlock(&s_mutex);
+    return NULL;
+}
+
+int test_uncontended_and_contended() {
+    memset(&s_locks, 0, sizeof(s_locks));
+    lock_profile_set_add(&s_locks, "test_mutex", &s_mutex, FALSE);
+    const lock_profile_t* profile = &s_locks.profiles[0];
+
+    // An unbound thread records nothing
+    profiled_mutex_lock(&s_mutex);
+    profiled_mutex_unlock(&s_mutex);
+
+    lock_profile_bind_thread(&s_locks);
+    profiled_mutex_lock(&s_mutex);
+    profiled_mutex_unlock(&s_mutex);
+
+    s_is_ready = FALSE;
+    pthread_t holder;
+    pthread_create(&holder, NULL, holder_thread_func, NULL);
+    while (!__atomic_load_n(&s_is_ready, __ATOMIC_ACQUIRE)) usleep(100);
+    profiled_mutex_lock(&s_mutex);
+    profiled_mutex_unlock(&s_mutex);
+    pthread_join(holder, NULL);
+    lock_profile_bind_thread(NULL);
+
+    if (profile->acquire_count != 2 || profile->contended_count != 1 || profile->hold_ns.total_count != 2
+        || profile->wait_ns.total_count != 1 || profile->wait_ns.max_us < 5000000) {
+        printf("Test failed: %lu acquired, %lu contended, %lu holds, longest wait %lu ns\n", profile->acquire_count,
+            profile->contended_count, profile->hold_ns.total_count, profile->wait_ns.max_us);
+        return 1;
+    }
+    printf("Test passed: 1 of 2 acquisitions contended, waited %.1f ms\n", profile->wait_ns.max_us / 1e6);
+    return 0;
+}
+
+int test_condition_wait() {
+    memset(&s_locks, 0, sizeof(s_locks));
+    lock_profile_set_add(&s_locks, "test_mutex", &s_mutex, FALSE);
+    lock_profile_set_add(&s_locks, "test_cv", &s_cond, TRUE);
+    const lock_profile_t* mutex_profile = &s_locks.profiles[0];
+    const lock_profile_t* cond_profile = &s_locks.profiles[1];
+
+    s_is_ready = FALSE;
+    lock_profile_bind_thread(&s_locks);
+    pthread_t signaller;
+    pthread_create(&signaller, NULL, signaller_thread_func, NULL);
+    profiled_mutex_lock(&s_mutex);
+    while (!s_is_ready) profiled_cond_wait(&s_cond, &s_mutex);
+    profiled_mutex_unlock(&s_mutex);
+    pthread_join(signaller, NULL);
+    lock_profile_bind_thread(NULL);
+
+    // The wait releases the mutex, so the hold before it and the one after it are separate
+    if (cond_profile->acquire_count < 1 || cond_profile->wait_ns.max_us < 5000000
+        || mutex_profile->acquire_count != 1 || mutex_profile->hold_ns.total_count != mutex_profile->acquire_count
+            + cond_profile->acquire_count || mutex_profile->hold_ns.max_us >= 5000000) {
+        printf("Test failed: %lu waits, longest %lu ns, %lu holds, longest %lu ns\n", cond_profile->acquire_count,
+            cond_profile->wait_ns.max_us, mutex_profile->hold_ns.total_count, mutex_profile->hold_ns.max_us);
+        return 1;
+    }
+
+    char buf[1024];
+    int len = write_lock_profiles_to_buffer(&s_locks, buf, sizeof(buf));
+    if (len >= (int)sizeof(buf) || buf[0] != '[' || buf[len - 1] != ']'
+        || strstr(buf, "{\"name\":\"test_cv\",\"kind\":\"condition\",\"acquired\":") == NULL) {
+        printf("Test failed: unexpected JSON %s\n", buf);
+        return 1;
+    }
+    printf("Test passed: condition wait of %.1f ms recorded apart from the mutex holds\n",
+        cond_profile->wait_ns.max_us / 1e6);
+    return 0;
+}
+
+int main() {
+    char test_name[] = "LOCK PROFILE";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_uncontended_and_contended();
+    failed_tests += test_condition_wait();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
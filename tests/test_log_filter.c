@@ -0,0 +1,111 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "log_event.h"
+#include "log_filter.h"
+#include "preprocessing.h"
+#include "test_utils.h"
+
+int test_summary_keeps_lifecycle_only() {
+    log_filter_t filter = {LOG_VERBOSITY_SUMMARY, 0, 1};
+    int failed = 0;
+    if (!log_filter_allows(&filter, LOG_EVENT_SIMULATION_START, 0)
+        || !log_filter_allows(&filter, LOG_EVENT_SIMULATION_STOPPED, 0)
+        || !log_filter_allows(&filter, LOG_EVENT_SIMULATION_RESUMED, 0)) {
+        printf("Test failed: summary level dropped a lifecycle event\n");
+        failed = 1;
+    }
+    if (log_filter_allows(&filter, LOG_EVENT_SYSTEM_ARRIVAL, 3)
+        || log_filter_allows(&filter, LOG_EVENT_PAPER_REFILL_END, 0)) {
+        printf("Test failed: summary level let a per-job or printer event through\n");
+        failed = 1;
+    }
+    if (!failed) printf("Test passed: summary level keeps lifecycle events only\n");
+    return failed;
+}
+
+int test_jobs_level_and_disable_mask() {
+    log_filter_t filter = {LOG_VERBOSITY_JOBS, 0, 1};
+    int failed = 0;
+    if (!log_filter_allows(&filter, LOG_EVENT_SYSTEM_DEPARTURE, 4)
+        || log_filter_allows(&filter, LOG_EVENT_QUEUE_ARRIVAL, 4)) {
+        printf("Test failed: jobs level does not separate system and queue events\n");
+        failed = 1;
+    }
+
+    filter.verbosity = LOG_VERBOSITY_ALL;
+    if (!log_event_mask_from_names("queue_arrival,queue_departure", &filter.disabled_events)) {
+        printf("Test failed: valid event names rejected\n");
+        return 1;
+    }
+    if (log_filter_allows(&filter, LOG_EVENT_QUEUE_DEPARTURE, 4)
+        || !log_filter_allows(&filter, LOG_EVENT_PRINTER_ARRIVAL, 4)) {
+        printf("Test failed: disable mask not applied to the named events only\n");
+        failed = 1;
+    }
+
+    unsigned int mask = 0;
+    if (log_event_mask_from_names("queue_arrival,bogus", &mask)
+        || log_event_mask_from_names("simulation_start", &mask)) {
+        printf("Test failed: unknown or lifecycle event name accepted\n");
+        failed = 1;
+    }
+    if (!failed) printf("Test passed: verbosity levels and disable mask\n");
+    return failed;
+}
+
+int test_sampling_is_deterministic_per_job() {
+    log_filter_t filter = {LOG_VERBOSITY_ALL, 0, 10};
+    int kept = 0;
+    int failed = 0;
+    for (int job_id = 1; job_id <= 100; job_id++) {
+        int arrival = log_filter_allows(&filter, LOG_EVENT_SYSTEM_ARRIVAL, job_id);
+        int departure = log_filter_allows(&filter, LOG_EVENT_SYSTEM_DEPARTURE, job_id);
+        if (arrival != departure) failed = 1; // a sampled job keeps all of its events
+        kept += arrival;
+    }
+    if (failed || kept != 10) {
+        printf("Test failed: 1-in-10 sampling kept %d of 100 jobs\n", kept);
+        return 1;
+    }
+    if (!log_filter_allows(&filter, LOG_EVENT_SIMULATION_END, 7)) {
+        printf("Test failed: sampling dropped a lifecycle event\n");
+        return 1;
+    }
+    printf("Test passed: 1-in-10 sampling kept %d of 100 jobs with all their events\n", kept);
+    return 0;
+}
+
+int test_log_args() {
+    char* argv[] = {"program_name", "-log-level", "jobs", "-log-off", "dropped_job", "-log-sample", "5"};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    if (!process_args(argc, argv, &params) || params.log_verbosity != LOG_VERBOSITY_JOBS
+        || params.log_disabled_events != (1u << LOG_EVENT_DROPPED_JOB) || params.log_sample_every != 5) {
+        printf("Test failed: log options not parsed\n");
+        return 1;
+    }
+
+    char* bad_argv[] = {"program_name", "-log-level", "verbose"};
+    params = (simulation_parameters_t)SIMULATION_DEFAULT_PARAMS;
+    if (process_args(3, bad_argv, &params)) {
+        printf("Test failed: unknown log level accepted\n");
+        return 1;
+    }
+    printf("Test passed: log options parsed from the command line\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "LOG FILTER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_summary_keeps_lifecycle_only();
+    failed_tests += test_jobs_level_and_disable_mask();
+    failed_tests += test_sampling_is_deterministic_per_job();
+    failed_tests += test_log_args();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "job_receiver.h"
+#include "log_event.h"
+#include "log_filter.h"
+#include "log_router.h"
+#include "simulation_stats.h"
+#include "test_utils.h"
+
+// Two counting sinks: removed_job is a per-job event, simulation_checkpoint a lifecycle one
+static int s_removed[2];
+static int s_checkpoints[2];
+
+static void removed_a(job_t* job) { s_removed[0]++; }
+static void removed_b(job_t* job) { s_removed[1]++; }
+static void checkpoint_a(simulation_statistics_t* stats) { s_checkpoints[0]++; }
+static void checkpoint_b(simulation_statistics_t* stats) { s_checkpoints[1]++; }
+
+static const log_ops_t s_sink_a = {.removed_job = removed_a, .simulation_checkpoint = checkpoint_a};
+static const log_ops_t s_sink_b = {.removed_job = removed_b, .simulation_checkpoint = checkpoint_b};
+
+static void reset_counts(void) {
+    s_removed[0] = s_removed[1] = 0;
+    s_checkpoints[0] = s_checkpoints[1] = 0;
+}
+
+int test_every_sink_sees_events_through_its_own_filter() {
+    log_filter_t all = LOG_FILTER_ALL;
+    log_filter_t summary = {LOG_VERBOSITY_SUMMARY, 0, 1};
+    job_t job = {.id = 3};
+    simulation_statistics_t stats = {0};
+    set_log_mode(LOG_MODE_QUIET);
+    reset_counts();
+    log_router_set_default_filter(&all);
+
+    if (!log_router_attach_sink(&s_sink_a, NULL) || !log_router_attach_sink(&s_sink_b, &summary)
+        || log_router_sink_count() != 2) {
+        printf("Test failed: sinks not attached\n");
+        return 1;
+    }
+    emit_removed_job(&job);
+    emit_simulation_checkpoint(&stats);
+    int failed = s_removed[0] != 1 || s_removed[1] != 0 || s_checkpoints[0] != 1 || s_checkpoints[1] != 1;
+
+    // A run's filter applies to sinks without one of their own only
+    log_router_bind_thread_filter(&summary);
+    emit_removed_job(&job);
+    log_router_bind_thread_filter(NULL);
+    if (s_removed[0] != 1) failed = 1;
+
+    log_router_detach_sink(&s_sink_a);
+    emit_simulation_checkpoint(&stats);
+    if (s_checkpoints[0] != 1 || s_checkpoints[1] != 2 || log_router_sink_count() != 1) failed = 1;
+    set_log_mode(LOG_MODE_QUIET);
+
+    if (failed) {
+        printf("Test failed: sink A saw %d removals and %d checkpoints, sink B %d and %d\n",
+            s_removed[0], s_checkpoints[0], s_removed[1], s_checkpoints[1]);
+        return 1;
+    }
+    printf("Test passed: each sink filters events on its own\n");
+    return 0;
+}
+
+int test_attach_rejects_duplicates_and_overflow() {
+    static log_ops_t sinks[LOG_ROUTER_MAX_SINKS + 1];
+    set_log_mode(LOG_MODE_QUIET);
+    int failed = 0;
+    for (int i = 0; i < LOG_ROUTER_MAX_SINKS; i++) {
+        if (!log_router_attach_sink(&sinks[i], NULL)) failed = 1;
+    }
+    if (log_router_attach_sink(&sinks[0], NULL)) {
+        printf("Test failed: a sink was attached twice\n");
+        failed = 1;
+    }
+    printf("Expecting an error for the sink past the limit:\n");
+    if (log_router_attach_sink(&sinks[LOG_ROUTER_MAX_SINKS], NULL)) {
+        printf("Test failed: more than %d sinks attached\n", LOG_ROUTER_MAX_SINKS);
+        failed = 1;
+    }
+    // A detached slot is reused
+    log_router_detach_sink(&sinks[2]);
+    if (!log_router_attach_sink(&sinks[LOG_ROUTER_MAX_SINKS], NULL)) failed = 1;
+    set_log_mode(LOG_MODE_QUIET);
+    if (log_router_sink_count() != 0) failed = 1;
+
+    if (!failed) printf("Test passed: duplicate and excess sinks rejected, freed slots reused\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "LOG ROUTER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_every_sink_sees_events_through_its_own_filter();
+    failed_tests += test_attach_rejects_duplicates_and_overflow();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics_ring.h"
+#include "test_utils.h"
+
+static metrics_ring_t ring;
+static metrics_sample_t samples[METRICS_RING_CAPACITY];
+
+int test_read_since() {
+    metrics_ring_init(&ring);
+    for (int i = 0; i < 10; i++) {
+        metrics_sample_t sample = {.time_us = (unsigned long)i * 1000, .queue_length = i};
+        if (metrics_ring_push(&ring, &sample) != (unsigned long)i) {
+            printf("Test failed: sample %d numbered out of order\n", i);
+            return 1;
+        }
+    }
+    unsigned long first = 0;
+    int count = metrics_ring_read(&ring, 7, samples, METRICS_RING_CAPACITY, &first);
+    if (count != 3 || first != 7 || samples[0].queue_length != 7 || samples[2].queue_length != 9) {
+        printf("Test failed: read from 7 returned %d samples starting at %lu\n", count, first);
+        return 1;
+    }
+    count = metrics_ring_read(&ring, 10, samples, METRICS_RING_CAPACITY, &first);
+    if (count != 0) {
+        printf("Test failed: read past the newest sample returned %d samples\n", count);
+        return 1;
+    }
+    metrics_ring_destroy(&ring);
+    printf("Test passed: samples read from a sample number on\n");
+    return 0;
+}
+
+int test_overwrites_oldest() {
+    metrics_ring_init(&ring);
+    int total = METRICS_RING_CAPACITY + 100;
+    for (int i = 0; i < total; i++) {
+        metrics_sample_t sample = {.queue_length = i};
+        metrics_ring_push(&ring, &sample);
+    }
+    unsigned long first = 0;
+    int count = metrics_ring_read(&ring, 0, samples, METRICS_RING_CAPACITY, &first);
+    if (count != METRICS_RING_CAPACITY || first != 100 || samples[0].queue_length != 100
+        || samples[count - 1].queue_length != total - 1) {
+        printf("Test failed: full ring returned %d samples starting at %lu\n", count, first);
+        return 1;
+    }
+    metrics_ring_destroy(&ring);
+    printf("Test passed: a full ring keeps the newest %d samples\n", METRICS_RING_CAPACITY);
+    return 0;
+}
+
+int test_append_values() {
+    metrics_sample_t sample = {.time_us = 2500123, .interval_us = 250004, .queue_length = 3,
+        .jobs_in_service = {1, 0}, .paper_level = {55, 80}, .jobs_arrived = 2, .jobs_served = 1, .jobs_dropped = 0};
+    char buf[128];
+    text_buffer_t tb;
+    text_buffer_init(&tb, buf, sizeof(buf));
+    metrics_sample_append_values(&tb, &sample);
+    const char* expected = "[2500123,250004,3,1,0,55,80,2,1,0]";
+    if (strcmp(buf, expected) != 0) {
+        printf("Test failed: sample written as %s, expected %s\n", buf, expected);
+        return 1;
+    }
+    printf("Test passed: sample written as %s\n", buf);
+    return 0;
+}
+
+int main() {
+    char test_name[] = "METRICS RING";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_read_since();
+    failed_tests += test_overwrites_oldest();
+    failed_tests += test_append_values();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
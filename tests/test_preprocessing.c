@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "preprocessing.h"
+#include "steady_state.h"
 #include "test_utils.h"
 
 int test_process_args() {
@@ -19,21 +20,21 @@ int test_process_args() {
         "-papers_upper", "10"
     };
     int argc = sizeof(argv) / sizeof(argv[0]);
-    simulation_parameters_t params;
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
 
     if (process_args(argc, argv, &params)) {
         printf("Test passed: num_jobs=%d, queue_capacity=%d,"
                " printer_paper_capacity=%d, arrival_time=%gus,"
                " service_rate=%gpapers/sec, refill_rate=%gpapers/sec,"
                " papers_required_lower_bound=%d, papers_required_upper_bound=%d\n",
-               params.num_jobs,
-               params.queue_capacity,
-               params.printer_paper_capacity,
-               params.job_arrival_time_us,
-               params.printing_rate,
-               params.refill_rate,
-               params.papers_required_lower_bound,
-               params.papers_required_upper_bound);
+               params.model.num_jobs,
+               params.model.queue_capacity,
+               params.model.printer_paper_capacity,
+               params.model.job_arrival_time_us,
+               params.model.printing_rate,
+               params.model.refill_rate,
+               params.model.papers_required_lower_bound,
+               params.model.papers_required_upper_bound);
     } else {
         printf("Test failed\n");
         failed = 1;
@@ -53,7 +54,7 @@ int test_bad_args() {
         "-ref", "0.3"
     };
     int argc = sizeof(argv) / sizeof(argv[0]);
-    simulation_parameters_t params;
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
 
     if (!process_args(argc, argv, &params)) {
         printf("Test passed: Detected invalid argument\n");
@@ -64,6 +65,43 @@ int test_bad_args() {
     return failed;
 }
 
+int test_precision_needs_replications() {
+    int failed = 0;
+    char *argv[] = {"program_name", "-precision", "0.05"};
+    char *argv_with_reps[] = {"program_name", "-precision", "0.05", "-reps", "4"};
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    simulation_parameters_t params_with_reps = SIMULATION_DEFAULT_PARAMS;
+
+    if (!process_args(3, argv, &params) && process_args(5, argv_with_reps, &params_with_reps)) {
+        printf("Test passed: -precision is rejected without -reps\n");
+    } else {
+        printf("Test failed: -precision without -reps was accepted, or with -reps rejected\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+int test_replications_reject_single_run_options() {
+    int failed = 0;
+    const char* options[][2] = {
+        {"-resume", "run.ckpt"}, {"-checkpoint", "run.ckpt"}, {"-trace", "run.json"}, {"-binlog", "run.bin"}, {"-quiet", NULL}
+    };
+    int count = (int)(sizeof(options) / sizeof(options[0]));
+    for (int i = 0; i < count; i++) {
+        char* argv[] = {"program_name", "-reps", "4", (char*)options[i][0], (char*)options[i][1]};
+        int argc = options[i][1] != NULL ? 5 : 4;
+        simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+        if (process_args(argc, argv, &params)) {
+            printf("Test failed: -reps was accepted with %s\n", options[i][0]);
+            failed = 1;
+        }
+    }
+    if (!failed) {
+        printf("Test passed: -reps rejects -resume, -checkpoint, -trace, -binlog and -quiet\n");
+    }
+    return failed;
+}
+
 int test_random_between() {
     int failed = 0;
     int lower = 10;
@@ -110,15 +148,79 @@ int test_swap_bounds_with_correct_values() {
     return failed;
 }
 
+int test_parse_start_params() {
+    int failed = 0;
+    const char* json = "{\"num_jobs\": 50, \"papers_required_lower_bound\": 30, \"papers_required_upper_bound\": 10,"
+        " \"printing_rate\": 2.5, \"seed\": 7, \"warmup\": \"30s\", \"metrics_interval_ms\": 0,"
+        " \"is_profiling_locks\": true}";
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.metrics_interval_ms = 100;
+    char bad_field[64];
+
+    if (parse_start_params(json, strlen(json), &params, bad_field, sizeof(bad_field))
+            && params.model.num_jobs == 50 && params.model.papers_required_lower_bound == 10
+            && params.model.papers_required_upper_bound == 30 && params.model.printing_rate == 2.5
+            && params.model.seed == 7 && params.model.warmup_method == WARMUP_TIME
+            && params.model.warmup_amount == 30 && params.metrics_interval_ms == 0 && params.is_profiling_locks
+            && params.model.queue_capacity == 15) {
+        printf("Test passed: start parameters set the given fields and keep the others\n");
+    } else {
+        printf("Test failed: start parameters were rejected or set wrongly (bad field \"%s\")\n", bad_field);
+        failed = 1;
+    }
+    return failed;
+}
+
+int test_parse_start_params_rejects() {
+    int failed = 0;
+    const struct {
+        const char* json;
+        const char* bad_field;
+    } cases[] = {
+        {"{\"num_jobs\": 5, \"bogus\": 1}", "bogus"},             // unknown field
+        {"{\"num_jobs\": 0}", "num_jobs"},                         // not positive
+        {"{\"num_jobs\": 2.5}", "num_jobs"},                       // not whole
+        {"{\"num_jobs\": 1e10}", "num_jobs"},                      // beyond int
+        {"{\"metrics_interval_ms\": -1e300}", "metrics_interval_ms"},
+        {"{\"printing_rate\": \"fast\"}", "printing_rate"},      // not a number
+        {"{\"is_profiling_locks\": 1}", "is_profiling_locks"},     // not a boolean
+        {"{\"warmup\": \"soon\"}", "warmup"},
+        {"{\"warmup\": \"2.5\"}", "warmup"},                      // a job count must be whole
+        {"{\"warmup\": \"-3s\"}", "warmup"},
+        {"{\"num_jobs\": 5", ""},                                  // malformed
+        {"[1, 2]", ""},
+    };
+    int count = (int)(sizeof(cases) / sizeof(cases[0]));
+    for (int i = 0; i < count; i++) {
+        simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+        simulation_parameters_t original;
+        memcpy(&original, &params, sizeof(params));
+        char bad_field[64];
+        if (parse_start_params(cases[i].json, strlen(cases[i].json), &params, bad_field, sizeof(bad_field))
+                || strcmp(bad_field, cases[i].bad_field) != 0 || memcmp(&params, &original, sizeof(params)) != 0) {
+            printf("Test failed: %s was accepted, changed the parameters or blamed \"%s\"\n", cases[i].json, bad_field);
+            failed = 1;
+        }
+    }
+    if (!failed) {
+        printf("Test passed: invalid start parameters are rejected and leave the parameters unchanged\n");
+    }
+    return failed;
+}
+
 int main() {
     char test_name[] = "PREPROCESSING";
     print_test_start(test_name);
     int failed_tests = 0;
     failed_tests += test_process_args();
     failed_tests += test_bad_args();
+    failed_tests += test_precision_needs_replications();
+    failed_tests += test_replications_reject_single_run_options();
     failed_tests += test_random_between();
     failed_tests += test_swap_bounds();
     failed_tests += test_swap_bounds_with_correct_values();
+    failed_tests += test_parse_start_params();
+    failed_tests += test_parse_start_params_rejects();
     print_test_end(test_name, failed_tests);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <math.h>
+
+#include "common.h"
+#include "preprocessing.h"
+#include "queueing_model.h"
+#include "test_utils.h"
+
+int test_erlang_c() {
+    int failed = 0;
+    // M/M/1: probability of waiting equals utilization
+    double p1 = erlang_c(1, 0.5);
+    // M/M/2 with a = 1 Erlang: C = 1/3
+    double p2 = erlang_c(2, 1.0);
+    if (fabs(p1 - 0.5) > 1e-9 || fabs(p2 - 1.0 / 3.0) > 1e-9) {
+        printf("Test failed: erlang_c(1, 0.5)=%f (expected 0.5), erlang_c(2, 1)=%f (expected 0.333)\n", p1, p2);
+        failed = 1;
+    } else {
+        printf("Test passed: erlang_c(1, 0.5)=%.3f, erlang_c(2, 1)=%.3f\n", p1, p2);
+    }
+    if (erlang_c(2, 2.5) != 1.0) {
+        printf("Test failed: unstable system should always wait\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+int test_mmck_blocking_probability() {
+    int failed = 0;
+    // M/M/1/K at a = 1: all K+1 states are equally likely
+    double p1 = mmck_blocking_probability(1, 4, 1.0);
+    // M/M/2/2 is Erlang B: a=1 -> (1/2) / (1 + 1 + 1/2) = 0.2
+    double p2 = mmck_blocking_probability(2, 2, 1.0);
+    // Very large capacity at high load must not overflow
+    double p3 = mmck_blocking_probability(2, 5000, 10.0);
+    if (fabs(p1 - 0.2) > 1e-9 || fabs(p2 - 0.2) > 1e-9 || !(p3 > 0.79 && p3 < 0.81)) {
+        printf("Test failed: blocking probabilities %f, %f, %f (expected 0.2, 0.2, 0.8)\n", p1, p2, p3);
+        failed = 1;
+    } else {
+        printf("Test passed: blocking probabilities %.3f, %.3f, %.3f\n", p1, p2, p3);
+    }
+    return failed;
+}
+
+int test_queueing_model_predict() {
+    int failed = 0;
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    queueing_model_t model;
+    queueing_model_predict(&params, &model);
+
+    // Defaults: lambda = 1/0.6 s, E[S] = 12.5 pages / 4 pages/s = 3.125 s -> overloaded
+    if (!model.is_valid || model.is_stable || fabs(model.utilization - 3.125 / 0.6 / 2) > 1e-9) {
+        printf("Test failed: default parameters should be valid and unstable, rho=%f\n", model.utilization);
+        failed = 1;
+    } else {
+        printf("Test passed: default parameters give rho=%.3f, drop probability=%.3f\n",
+            model.utilization, model.drop_probability_mmck);
+    }
+    // An overloaded finite system can carry at most one job per server
+    double carried = model.utilization * (1.0 - model.drop_probability_mmck);
+    if (fabs(model.carried_utilization - carried) > 1e-12 || model.carried_utilization > 1.0) {
+        printf("Test failed: carried utilization %f (expected %f, at most 1)\n", model.carried_utilization, carried);
+        failed = 1;
+    } else {
+        printf("Test passed: overloaded system carries utilization %.3f\n", model.carried_utilization);
+    }
+
+    params.model.job_arrival_time_us = 4000000; // 0.25 jobs/sec -> rho = 0.39
+    queueing_model_predict(&params, &model);
+    if (!model.is_stable || model.avg_queue_wait_mdc_sec >= model.avg_queue_wait_mmc_sec
+        || fabs(model.avg_system_time_mmc_sec - model.avg_queue_wait_mmc_sec - 3.125) > 1e-9) {
+        printf("Test failed: stable model predictions are inconsistent\n");
+        failed = 1;
+    } else {
+        printf("Test passed: Wq(M/M/c)=%.3fs, Wq(M/D/c)=%.3fs, Lq=%.3f\n",
+            model.avg_queue_wait_mmc_sec, model.avg_queue_wait_mdc_sec, model.avg_queue_length_mmc);
+    }
+
+    // Evenly spaced arrivals: pages uniform on 16 values -> cs^2 = (16^2 - 1) / 12 / 12.5^2
+    double service_scv = 255.0 / 12.0 / (12.5 * 12.5);
+    if (fabs(model.service_scv - service_scv) > 1e-9
+        || fabs(model.avg_queue_wait_dgc_sec - 0.5 * service_scv * model.avg_queue_wait_mmc_sec) > 1e-12
+        || model.avg_queue_wait_dgc_sec >= model.avg_queue_wait_mdc_sec) {
+        printf("Test failed: D/G/c wait %f with cs^2=%f is not the Allen-Cunneen value\n",
+            model.avg_queue_wait_dgc_sec, model.service_scv);
+        failed = 1;
+    } else {
+        printf("Test passed: Wq(D/G/c)=%.3fs with cs^2=%.3f\n", model.avg_queue_wait_dgc_sec, model.service_scv);
+    }
+
+    // Constant page count and evenly spaced arrivals: nobody waits
+    params.model.papers_required_lower_bound = params.model.papers_required_upper_bound = 10;
+    queueing_model_predict(&params, &model);
+    if (model.service_scv != 0.0 || model.avg_queue_wait_dgc_sec != 0.0) {
+        printf("Test failed: D/D/c should predict no wait, got %f\n", model.avg_queue_wait_dgc_sec);
+        failed = 1;
+    } else {
+        printf("Test passed: D/D/c predicts no wait\n");
+    }
+    return failed;
+}
+
+int main() {
+    char test_name[] = "QUEUEING MODEL";
+    print_test_start(test_name);
+    int failed_tests = 0;
+    failed_tests += test_erlang_c();
+    failed_tests += test_mmck_blocking_probability();
+    failed_tests += test_queueing_model_predict();
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
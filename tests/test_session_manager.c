@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "log_router.h"
+#include "preprocessing.h"
+#include "session_manager.h"
+#include "test_utils.h"
+
+/*
+ * The table is driven from this thread, as the server drives it from its
+ * event loop. Runs log nothing (LOG_MODE_QUIET), so the sessions' streams are
+ * never flushed and no Mongoose manager is needed.
+ */
+
+#define MAX_SESSIONS 2
+#define RUN_TIMEOUT_US 10000000
+
+static simulation_parameters_t session_params(void) {
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.max_sessions = MAX_SESSIONS;
+    params.model.job_arrival_time_us = 1000;
+    params.model.printing_rate = 100000;
+    params.model.printer_paper_capacity = 100000;
+    return params;
+}
+
+static int wait_until_stopped(session_t* session) {
+    for (int waited_us = 0; session_is_running(session); waited_us += 1000) {
+        if (waited_us > RUN_TIMEOUT_US) return FALSE;
+        usleep(1000);
+    }
+    return TRUE;
+}
+
+int test_open_up_to_cap() {
+    simulation_parameters_t params = session_params();
+    session_manager_init(&params);
+
+    session_t* first = session_manager_open(1, WS_PROTOCOL_JSON);
+    session_t* second = session_manager_open(2, WS_PROTOCOL_BINARY);
+    session_t* rejected = session_manager_open(3, WS_PROTOCOL_JSON);
+    int is_ok = first != NULL && second != NULL && first != second && rejected == NULL
+        && session_manager_count() == MAX_SESSIONS
+        && session_manager_find(1) == first && session_manager_find(2) == second
+        && session_manager_find(3) == NULL
+        && second->stream.protocol == WS_PROTOCOL_BINARY
+        && strcmp(session_checkpoint_path(first), session_checkpoint_path(second)) != 0;
+
+    session_manager_destroy();
+    if (!is_ok) {
+        printf("Test failed: opening %d sessions with a cap of %d\n", MAX_SESSIONS + 1, MAX_SESSIONS);
+        return 1;
+    }
+    printf("Test passed: %d sessions open, the next one is rejected\n", MAX_SESSIONS);
+    return 0;
+}
+
+int test_close_and_reap_free_the_slot() {
+    simulation_parameters_t params = session_params();
+    session_manager_init(&params);
+
+    session_manager_open(1, WS_PROTOCOL_JSON);
+    session_manager_open(2, WS_PROTOCOL_JSON);
+    session_manager_close(1);
+    // A closed session is no longer found but keeps its slot until reaped
+    int is_closed_ok = session_manager_find(1) == NULL && session_manager_count() == MAX_SESSIONS
+        && session_manager_open(3, WS_PROTOCOL_JSON) == NULL;
+    session_manager_reap();
+    int is_reaped_ok = session_manager_count() == MAX_SESSIONS - 1 && session_manager_find(2) != NULL;
+    session_t* reopened = session_manager_open(3, WS_PROTOCOL_JSON);
+    int is_reopened_ok = reopened != NULL && session_manager_find(3) == reopened;
+
+    session_manager_destroy();
+    if (!is_closed_ok || !is_reaped_ok || !is_reopened_ok) {
+        printf("Test failed: close %s, reap %s, reopen %s\n", is_closed_ok ? "ok" : "wrong",
+            is_reaped_ok ? "ok" : "wrong", is_reopened_ok ? "ok" : "wrong");
+        return 1;
+    }
+    printf("Test passed: a closed session is hidden, then reaped to free its slot\n");
+    return 0;
+}
+
+int test_sessions_run_in_separate_contexts() {
+    simulation_parameters_t params = session_params();
+    session_manager_init(&params);
+
+    session_t* first = session_manager_open(1, WS_PROTOCOL_JSON);
+    session_t* second = session_manager_open(2, WS_PROTOCOL_JSON);
+    first->params.model.num_jobs = 3;
+    second->params.model.num_jobs = 7;
+    int is_started = session_start(first) && session_start(second) && !session_start(first);
+    int is_finished = wait_until_stopped(first) && wait_until_stopped(second);
+
+    int is_ok = is_started && is_finished && &first->ctx != &second->ctx
+        && first->ctx.stats.total_jobs_arrived == 3 && second->ctx.stats.total_jobs_arrived == 7
+        && first->ctx.stats.total_jobs_served + first->ctx.stats.total_jobs_dropped == 3
+        && second->ctx.stats.total_jobs_served + second->ctx.stats.total_jobs_dropped == 7;
+    if (!is_ok) {
+        printf("Test failed: runs started %d, finished %d, arrived %g and %g (expected 3 and 7)\n",
+            is_started, is_finished, first->ctx.stats.total_jobs_arrived, second->ctx.stats.total_jobs_arrived);
+    } else {
+        printf("Test passed: concurrent sessions keep their own statistics (3 and 7 jobs)\n");
+    }
+
+    // Closing a session whose run has finished lets the next reap free it
+    session_manager_close(1);
+    session_manager_close(2);
+    session_manager_reap();
+    int is_reaped = session_manager_count() == 0;
+    if (!is_reaped) printf("Test failed: %d finished sessions left after reaping\n", session_manager_count());
+
+    session_manager_destroy();
+    return is_ok && is_reaped ? 0 : 1;
+}
+
+int main() {
+    char test_name[] = "SESSION MANAGER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+    set_log_mode(LOG_MODE_QUIET);
+
+    failed_tests += test_open_up_to_cap();
+    failed_tests += test_close_and_reap_free_the_slot();
+    failed_tests += test_sessions_run_in_separate_contexts();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
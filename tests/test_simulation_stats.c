@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 #include "test_utils.h"
 #include "simulation_stats.h"
@@ -16,7 +17,9 @@ int test_create_simulation_stats(simulation_statistics_t* stats) {
     stats->total_jobs_removed = 1;
     stats->total_inter_arrival_time_us = 900000; // total time between arrivals
     stats->total_system_time_us = 800000; // total time in system for served jobs
-    stats->sum_of_system_time_squared_us2 = 640000000000; // sum of squares
+    // system times of the 8 served jobs, 100000 us on average
+    unsigned long system_times_us[] = {60000, 80000, 90000, 100000, 100000, 110000, 120000, 140000};
+    for (int i = 0; i < 8; i++) streaming_moments_add(&stats->system_time_moments, system_times_us[i]);
     stats->total_queue_wait_time_us = 400000; // total wait time in queue
     stats->area_num_in_job_queue_us = 2000000; // integral of queue length over time
     stats->max_job_queue_length = 5;
@@ -39,7 +42,7 @@ int test_create_simulation_stats(simulation_statistics_t* stats) {
 int test_write_statistics_to_buffer(simulation_statistics_t* stats) {
     int failed = 0;
 
-    char buffer[1024];
+    char buffer[4096];
     int result;
     memset(buffer, 0, sizeof(buffer));
 
@@ -62,6 +65,32 @@ int test_log_statistics(simulation_statistics_t* stats) {
     return 0;
 }
 
+int test_confidence_interval() {
+    int failed = 0;
+    double samples[] = {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+    double mean, half_width;
+
+    // mean = 5, sample std dev = sqrt(32/7), t(7) = 2.365
+    calculate_confidence_interval_95(samples, 8, &mean, &half_width);
+    double expected_half_width = 2.365 * sqrt(32.0 / 7.0) / sqrt(8.0);
+    if (fabs(mean - 5.0) > 1e-9 || fabs(half_width - expected_half_width) > 1e-9) {
+        printf("Test failed: expected 5 +/- %.6f, got %.6f +/- %.6f\n",
+            expected_half_width, mean, half_width);
+        failed = 1;
+    } else {
+        printf("Test passed: confidence interval is %.3f +/- %.3f\n", mean, half_width);
+    }
+
+    calculate_confidence_interval_95(samples, 1, &mean, &half_width);
+    if (mean != 2.0 || half_width != 0.0) {
+        printf("Test failed: single sample should give zero half-width\n");
+        failed = 1;
+    } else {
+        printf("Test passed: single sample gives zero half-width\n");
+    }
+    return failed;
+}
+
 int main() {
     char test_name[] = "SIMULATION STATS";
     print_test_start(test_name);
@@ -71,6 +100,7 @@ int main() {
     failed_tests += test_create_simulation_stats(&stats);
     failed_tests += test_write_statistics_to_buffer(&stats);
     failed_tests += test_log_statistics(&stats);
+    failed_tests += test_confidence_interval();
 
     print_test_end(test_name, failed_tests);
     return 0;
@@ -0,0 +1,151 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "json_writer.h"
+#include "preprocessing.h"
+#include "simulation_stats.h"
+#include "stats_export.h"
+#include "test_utils.h"
+
+#define TEST_JSON_PATH "/tmp/test_stats_export.json"
+#define TEST_CSV_PATH "/tmp/test_stats_export.csv"
+
+/**
+ * @brief Reads a whole file into a new string.
+ */
+static char* read_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* contents = malloc(size + 1);
+    size_t read = fread(contents, 1, size, file);
+    contents[read] = '\0';
+    fclose(file);
+    return contents;
+}
+
+static int count_char(const char* str, char c) {
+    int count = 0;
+    for (; *str != '\0'; str++) count += *str == c;
+    return count;
+}
+
+/**
+ * @brief Fills the statistics of a short run of 4 jobs over 2 seconds.
+ */
+static void fill_stats(simulation_statistics_t* stats) {
+    *stats = (simulation_statistics_t){0};
+    stats->simulation_duration_us = 2000000;
+    stats->total_jobs_arrived = 4;
+    stats->total_jobs_served = 4;
+    stats->jobs_served_by_printer1 = 4;
+    stats->total_system_time_us = 1000000;
+    stats->total_service_time_p1_us = 800000;
+}
+
+int test_json_writer() {
+    FILE* file = fopen(TEST_JSON_PATH, "w");
+    if (file == NULL) return 1;
+    json_writer_t writer;
+    json_writer_init(&writer, file);
+    json_begin_object(&writer);
+    json_key(&writer, "name");
+    json_string(&writer, "say \"hi\"\n");
+    json_key(&writer, "values");
+    json_begin_array(&writer);
+    json_number(&writer, 0.1);
+    json_number(&writer, NAN);
+    json_begin_object(&writer);
+    json_end_object(&writer);
+    json_bool(&writer, TRUE);
+    json_end_array(&writer);
+    json_key(&writer, "third");
+    json_number(&writer, 1.0 / 3.0);
+    json_end_object(&writer);
+    fclose(file);
+
+    char* contents = read_file(TEST_JSON_PATH);
+    const char* expected =
+        "{\"name\":\"say \\\"hi\\\"\\n\",\"values\":[0.1,null,{},true],\"third\":0.33333333333333331}";
+    int is_ok = contents != NULL && strcmp(contents, expected) == 0;
+    if (!is_ok) printf("Test failed: unexpected JSON %s\n", contents != NULL ? contents : "(none)");
+    else printf("Test passed: nested JSON with escapes, null for NaN and exact numbers\n");
+    free(contents);
+    remove(TEST_JSON_PATH);
+    return is_ok ? 0 : 1;
+}
+
+int test_json_lines_append() {
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    simulation_statistics_t stats;
+    fill_stats(&stats);
+    remove(TEST_JSON_PATH);
+    int is_written = stats_export_append(TEST_JSON_PATH, &params, &stats, STATS_EXPORT_ENGINE_CLI);
+    params.model.seed = 2;
+    is_written = is_written && stats_export_append(TEST_JSON_PATH, &params, &stats, STATS_EXPORT_ENGINE_REPLICATION);
+
+    char* contents = read_file(TEST_JSON_PATH);
+    char* second = contents != NULL ? strchr(contents, '\n') + 1 : NULL;
+    int is_ok = is_written && contents != NULL && count_char(contents, '\n') == 2
+        && strncmp(contents, "{\"finished_at\":", 15) == 0
+        && strstr(contents, "\"engine\":\"cli\",\"build_id\":\"") != NULL
+        && strstr(second, "\"engine\":\"replication\"") != NULL && strstr(second, "\"seed\":2,") != NULL
+        && strstr(contents, "\"params\":{\"job_arrival_time_us\":600000,") != NULL
+        && strstr(contents, "\"raw\":{\"simulation_duration_us\":2000000,") != NULL
+        && strstr(contents, "\"avg_system_time_sec\":0.25,") != NULL
+        && strstr(contents, "\"utilization_p1\":0.4,") != NULL
+        && strstr(contents, "\"latency_system_time_sec_p99_9\":") != NULL
+        && strstr(contents, "\"warmup_cut_jobs_served\":0}}\n") != NULL;
+    if (!is_ok) printf("Test failed: unexpected JSON lines %s\n", contents != NULL ? contents : "(none)");
+    else printf("Test passed: one JSON object per run\n");
+    free(contents);
+    remove(TEST_JSON_PATH);
+    return is_ok ? 0 : 1;
+}
+
+int test_csv_append() {
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    simulation_statistics_t stats;
+    fill_stats(&stats);
+    remove(TEST_CSV_PATH);
+    int is_written = stats_export_append(TEST_CSV_PATH, &params, &stats, STATS_EXPORT_ENGINE_SERVER)
+        && stats_export_append(TEST_CSV_PATH, &params, &stats, STATS_EXPORT_ENGINE_SERVER);
+
+    char* contents = read_file(TEST_CSV_PATH);
+    int is_ok = is_written && contents != NULL && count_char(contents, '\n') == 3;
+    if (is_ok) {
+        // Every row has as many cells as the header
+        char* header_end = strchr(contents, '\n');
+        char* row_end = strchr(header_end + 1, '\n');
+        *header_end = '\0';
+        *row_end = '\0';
+        int header_cells = count_char(contents, ',');
+        is_ok = header_cells > STATISTICS_VALUE_COUNT && count_char(header_end + 1, ',') == header_cells
+            && strncmp(contents, "finished_at,engine,build_id,seed,params.job_arrival_time_us,", 60) == 0
+            && strstr(contents, ",statistics.avg_system_time_sec,") != NULL
+            && strstr(header_end + 1, ",\"server\",\"") != NULL && strstr(header_end + 1, ",0.25,") != NULL;
+    }
+    if (!is_ok) printf("Test failed: unexpected CSV %s\n", contents != NULL ? contents : "(none)");
+    else printf("Test passed: a header, then one row per run\n");
+    free(contents);
+    remove(TEST_CSV_PATH);
+    return is_ok ? 0 : 1;
+}
+
+int main() {
+    char test_name[] = "STATS EXPORT";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_json_writer();
+    failed_tests += test_json_lines_append();
+    failed_tests += test_csv_append();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "simulation_stats.h"
+#include "stats_snapshot.h"
+#include "test_utils.h"
+
+static simulation_statistics_t stats;
+
+int test_read_before_and_after_publish() {
+    stats_snapshot_t snapshot = {0};
+    stats_snapshot_data_t data = {0};
+    if (stats_snapshot_read(&snapshot, &data)) {
+        printf("Test failed: read succeeded before anything was published\n");
+        return 1;
+    }
+    data.jobs_served = 7;
+    data.queue_length = 3;
+    stats_snapshot_publish(&snapshot, &data);
+    data.jobs_served = 9;
+    stats_snapshot_publish(&snapshot, &data);
+
+    stats_snapshot_data_t read = {0};
+    if (!stats_snapshot_read(&snapshot, &read) || read.jobs_served != 9 || read.queue_length != 3) {
+        printf("Test failed: read %.0f served, queue %d after two publishes\n", read.jobs_served, read.queue_length);
+        return 1;
+    }
+    printf("Test passed: the latest published snapshot is read\n");
+    return 0;
+}
+
+int test_fill_cumulative_buckets() {
+    memset(&stats, 0, sizeof(stats));
+    // 20 ms, 200 ms, 3 s and 400 s
+    unsigned long system_times_us[] = {20000, 200000, 3000000, 400000000};
+    for (int i = 0; i < 4; i++) {
+        latency_histogram_record(&stats.system_time_histogram, system_times_us[i]);
+        stats.total_system_time_us += system_times_us[i];
+    }
+    stats.total_service_time_p1_us = 5000000;
+
+    stats_snapshot_data_t data = {0};
+    stats_snapshot_fill(&stats, 10000000, &data);
+    // Bounds 0.01, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300
+    unsigned long expected[STATS_SNAPSHOT_BUCKET_COUNT] = {0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3};
+    for (int i = 0; i < STATS_SNAPSHOT_BUCKET_COUNT; i++) {
+        if (data.system_time.buckets[i] != expected[i]) {
+            printf("Test failed: bucket %d holds %lu, expected %lu\n", i, data.system_time.buckets[i], expected[i]);
+            return 1;
+        }
+    }
+    if (data.system_time.count != 4 || data.system_time.sum_sec < 403.21 || data.system_time.sum_sec > 403.23
+        || data.utilization[0] != 0.5) {
+        printf("Test failed: count %lu, sum %g, utilization %g\n",
+            data.system_time.count, data.system_time.sum_sec, data.utilization[0]);
+        return 1;
+    }
+    printf("Test passed: latency histograms become cumulative buckets\n");
+    return 0;
+}
+
+int test_prometheus_exposition() {
+    stats_snapshot_data_t snapshots[2] = {0};
+    unsigned long session_ids[2] = {3, 8};
+    snapshots[0].is_running = TRUE;
+    snapshots[0].jobs_arrived = 40;
+    snapshots[0].paper_level[1] = 55;
+    snapshots[1].jobs_arrived = 12;
+    snapshots[1].queue_wait.count = 2;
+    snapshots[1].queue_wait.buckets[STATS_SNAPSHOT_BUCKET_COUNT - 1] = 2;
+
+    int size = write_prometheus_metrics(snapshots, session_ids, 2, NULL, 0) + 1;
+    char* buf = malloc(size);
+    int len = write_prometheus_metrics(snapshots, session_ids, 2, buf, size);
+    const char* expected[] = {
+        "# TYPE printsim_jobs_arrived_total counter\n",
+        "printsim_jobs_arrived_total{session=\"3\"} 40\n",
+        "printsim_jobs_arrived_total{session=\"8\"} 12\n",
+        "printsim_running{session=\"3\"} 1\n",
+        "printsim_printer_paper_level{session=\"3\",printer=\"2\"} 55\n",
+        "# TYPE printsim_queue_wait_seconds histogram\n",
+        "printsim_queue_wait_seconds_bucket{session=\"8\",le=\"300\"} 2\n",
+        "printsim_queue_wait_seconds_bucket{session=\"8\",le=\"+Inf\"} 2\n",
+        "printsim_queue_wait_seconds_count{session=\"8\"} 2\n",
+        "printsim_service_time_seconds_sum{session=\"3\",printer=\"1\"} 0\n",
+    };
+    int failed = len != size - 1;
+    for (int i = 0; i < (int)(sizeof(expected) / sizeof(expected[0])); i++) {
+        if (strstr(buf, expected[i]) == NULL) {
+            printf("Test failed: missing line %s", expected[i]);
+            failed = 1;
+        }
+    }
+    // Each family is described once, however many sessions it has samples for
+    int headers = 0;
+    for (const char* p = buf; (p = strstr(p, "# HELP printsim_jobs_arrived_total ")) != NULL; p++) headers++;
+    if (headers != 1) {
+        printf("Test failed: %d headers for printsim_jobs_arrived_total\n", headers);
+        failed = 1;
+    }
+    free(buf);
+    if (failed) {
+        printf("Test failed: exposition of two sessions\n");
+        return 1;
+    }
+    printf("Test passed: two sessions written in the Prometheus text format\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "STATS SNAPSHOT";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_read_before_and_after_publish();
+    failed_tests += test_fill_cumulative_buckets();
+    failed_tests += test_prometheus_exposition();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "steady_state.h"
+#include "test_utils.h"
+
+/**
+ * @brief Feeds a run with one departure per millisecond and a queue of
+ *        `transient_length` jobs until `transient_jobs` were served, 2 after.
+ */
+static void observe_run(steady_state_t* steady_state, int jobs, int transient_jobs, int transient_length) {
+    stats_mark_t mark = {0};
+    for (int served = 1; served <= jobs; served++) {
+        mark.time_us += 1000;
+        mark.jobs_arrived += 1;
+        mark.jobs_served += 1;
+        mark.system_time_us += 3000;
+        mark.area_num_in_job_queue_us += 1000 * (served <= transient_jobs ? transient_length : 2);
+        steady_state_observe(steady_state, &mark);
+    }
+}
+
+int test_mser_truncation_skips_transient() {
+    double batch_means[100];
+    for (int i = 0; i < 100; i++) {
+        batch_means[i] = i < 10 ? 20.0 - 2 * i : 2.0 + ((i * 7) % 5 - 2) * 0.05;
+    }
+    int d = mser_truncation(batch_means, 100);
+    int d_flat = mser_truncation(batch_means + 10, 90);
+    if (d < 9 || d > 10 || d_flat > 45 || mser_truncation(batch_means, 1) != 0) {
+        printf("Test failed: truncation %d, %d on the steady part only\n", d, d_flat);
+        return 1;
+    }
+    printf("Test passed: %d of 100 batches truncated\n", d);
+    return 0;
+}
+
+int test_mser5_cut_survives_compaction() {
+    steady_state_t steady_state = {0};
+    steady_state_configure(&steady_state, WARMUP_MSER5, 0);
+    observe_run(&steady_state, 2000, 300, 20);
+
+    stats_mark_t cut;
+    int is_truncated = steady_state_cut(&steady_state, &cut);
+    // 400 batches of 5 did not fit, so 200 of 10 are kept
+    if (!is_truncated || steady_state.batch_jobs != 10 || steady_state.batch_count != 200
+        || cut.jobs_served != 300 || cut.time_us != 300000) {
+        printf("Test failed: cut at %.0f jobs, %d batches of %u\n", cut.jobs_served, steady_state.batch_count,
+            steady_state.batch_jobs);
+        return 1;
+    }
+    printf("Test passed: MSER-5 cut at %.0f jobs, %d batches of %u\n", cut.jobs_served,
+        steady_state.batch_count, steady_state.batch_jobs);
+    return 0;
+}
+
+int test_fixed_cuts_and_window() {
+    steady_state_t by_jobs = {0}, by_time = {0}, unreached = {0}, none = {0};
+    steady_state_configure(&by_jobs, WARMUP_JOBS, 50);
+    steady_state_configure(&by_time, WARMUP_TIME, 0.1);
+    steady_state_configure(&unreached, WARMUP_JOBS, 5000);
+    observe_run(&by_jobs, 200, 50, 20);
+    observe_run(&by_time, 200, 50, 20);
+    observe_run(&unreached, 200, 50, 20);
+    observe_run(&none, 200, 50, 20);
+
+    stats_mark_t jobs_cut, time_cut, unused;
+    if (!steady_state_cut(&by_jobs, &jobs_cut) || !steady_state_cut(&by_time, &time_cut)
+        || steady_state_cut(&unreached, &unused) || steady_state_cut(&none, &unused)
+        || jobs_cut.jobs_served != 50 || time_cut.jobs_served != 100) {
+        printf("Test failed: cuts at %.0f and %.0f jobs\n", jobs_cut.jobs_served, time_cut.jobs_served);
+        return 1;
+    }
+
+    // The window after the transient sees only the steady queue
+    stats_mark_t end = {.time_us = 200000, .jobs_arrived = 200, .jobs_served = 200, .system_time_us = 600000,
+        .area_num_in_job_queue_us = 50 * 20000 + 150 * 2000};
+    stats_mark_t window;
+    stats_mark_window(&end, &jobs_cut, &window);
+    double avg_queue_length = (double)window.area_num_in_job_queue_us / window.time_us;
+    if (window.jobs_served != 150 || window.time_us != 150000 || avg_queue_length != 2.0) {
+        printf("Test failed: window of %.0f jobs, average queue %g\n", window.jobs_served, avg_queue_length);
+        return 1;
+    }
+    printf("Test passed: average queue %g after the cut\n", avg_queue_length);
+    return 0;
+}
+
+int test_warmup_arguments() {
+    int method;
+    double amount;
+    int ok = warmup_from_arg("auto", &method, &amount) && method == WARMUP_MSER5
+        && warmup_from_arg("200", &method, &amount) && method == WARMUP_JOBS && amount == 200
+        && warmup_from_arg("2.5s", &method, &amount) && method == WARMUP_TIME && amount == 2.5
+        && !warmup_from_arg("1.5", &method, &amount) && !warmup_from_arg("0", &method, &amount)
+        && !warmup_from_arg("-3s", &method, &amount) && !warmup_from_arg("10m", &method, &amount)
+        && !warmup_from_arg("fast", &method, &amount);
+    if (!ok) {
+        printf("Test failed: warm-up arguments misparsed\n");
+        return 1;
+    }
+    printf("Test passed: warm-up arguments parsed\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "STEADY STATE";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_mser_truncation_skips_transient();
+    failed_tests += test_mser5_cut_survives_compaction();
+    failed_tests += test_fixed_cuts_and_window();
+    failed_tests += test_warmup_arguments();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
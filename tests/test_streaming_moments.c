@@ -0,0 +1,73 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "streaming_moments.h"
+#include "test_utils.h"
+
+int test_known_values() {
+    streaming_moments_t moments = {0};
+    double values[] = {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+    for (int i = 0; i < 8; i++) streaming_moments_add(&moments, values[i]);
+
+    // mean 5, squared deviations 32, cubed deviations 42
+    double expected_skewness = sqrt(8.0) * 42.0 / pow(32.0, 1.5);
+    if (moments.count != 8 || fabs(moments.mean - 5.0) > 1e-12
+        || fabs(streaming_moments_variance(&moments) - 32.0 / 7.0) > 1e-12
+        || fabs(streaming_moments_skewness(&moments) - expected_skewness) > 1e-12
+        || moments.min != 2.0 || moments.max != 9.0) {
+        printf("Test failed: mean %g, variance %g, skewness %g, min %g, max %g\n", moments.mean,
+            streaming_moments_variance(&moments), streaming_moments_skewness(&moments), moments.min, moments.max);
+        return 1;
+    }
+    printf("Test passed: mean %g, std dev %.4f, skewness %.4f\n", moments.mean,
+        streaming_moments_std_dev(&moments), streaming_moments_skewness(&moments));
+    return 0;
+}
+
+int test_large_offset_keeps_precision() {
+    // A million values 1e9 +/- 1: sum of squares minus square of sums loses every digit here
+    streaming_moments_t moments = {0};
+    for (int i = 0; i < 1000000; i++) streaming_moments_add(&moments, 1e9 + (i % 2 ? 1.0 : -1.0));
+    double variance = streaming_moments_variance(&moments);
+    if (fabs(variance - 1000000.0 / 999999.0) > 1e-6 || fabs(streaming_moments_skewness(&moments)) > 1e-6) {
+        printf("Test failed: variance %.9g around a large offset\n", variance);
+        return 1;
+    }
+    printf("Test passed: variance %.9g around an offset of 1e9\n", variance);
+    return 0;
+}
+
+int test_merge_matches_single_stream() {
+    streaming_moments_t all = {0}, first = {0}, second = {0}, empty = {0};
+    for (int i = 0; i < 1000; i++) {
+        double value = (i * 7919) % 1000 + (i < 300 ? 5000.0 : 0.0); // two uneven parts
+        streaming_moments_add(&all, value);
+        streaming_moments_add(i < 300 ? &first : &second, value);
+    }
+    streaming_moments_merge(&first, &second);
+    streaming_moments_merge(&first, &empty);
+    streaming_moments_merge(&empty, &first);
+
+    if (empty.count != all.count || fabs(empty.mean - all.mean) > 1e-9
+        || fabs(streaming_moments_variance(&empty) / streaming_moments_variance(&all) - 1.0) > 1e-12
+        || fabs(streaming_moments_skewness(&empty) - streaming_moments_skewness(&all)) > 1e-9
+        || empty.min != all.min || empty.max != all.max) {
+        printf("Test failed: merged moments differ from the single stream\n");
+        return 1;
+    }
+    printf("Test passed: merged moments match the single stream\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "STREAMING MOMENTS";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_known_values();
+    failed_tests += test_large_offset_keeps_precision();
+    failed_tests += test_merge_matches_single_stream();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "text_buffer.h"
+#include "test_utils.h"
+
+int test_numbers_match_printf() {
+    unsigned long values[] = {0, 7, 10, 99, 100, 12345, 4294967295UL, 18446744073709551615UL};
+    char storage[64];
+    char expected[64];
+    text_buffer_t tb;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        text_buffer_init(&tb, storage, sizeof(storage));
+        text_append_uint(&tb, values[i]);
+        snprintf(expected, sizeof(expected), "%lu", values[i]);
+        if (strcmp(storage, expected) != 0 || tb.length != strlen(expected)) {
+            printf("Test failed: %lu written as \"%s\"\n", values[i], storage);
+            return 1;
+        }
+    }
+
+    text_buffer_init(&tb, storage, sizeof(storage));
+    text_append_int(&tb, -42);
+    text_append_literal(&tb, " ");
+    text_append_uint_padded(&tb, 7, 3);
+    text_append_literal(&tb, " ");
+    text_append_ms(&tb, 40016);
+    if (strcmp(storage, "-42 007 40.016") != 0) {
+        printf("Test failed: got \"%s\"\n", storage);
+        return 1;
+    }
+    printf("Test passed: integers match printf\n");
+    return 0;
+}
+
+int test_time_prefix() {
+    char storage[32];
+    text_buffer_t tb;
+    text_buffer_init(&tb, storage, sizeof(storage));
+    text_append_time_prefix(&tb, 240627);
+    if (strcmp(storage, "00000240.627ms: ") != 0) {
+        printf("Test failed: time prefix written as \"%s\"\n", storage);
+        return 1;
+    }
+    printf("Test passed: time prefix matches the log format\n");
+    return 0;
+}
+
+int test_truncation() {
+    char storage[8];
+    text_buffer_t tb;
+    text_buffer_init(&tb, storage, sizeof(storage));
+    text_append_literal(&tb, "job");
+    text_append_uint(&tb, 1234);
+    text_append_literal(&tb, "xyz");
+    if (!tb.is_truncated || tb.length != 7 || strcmp(storage, "job1234") != 0) {
+        printf("Test failed: overflow not flagged or buffer corrupted (\"%s\")\n", storage);
+        return 1;
+    }
+    printf("Test passed: overflow is flagged and the buffer stays terminated\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "TEXT BUFFER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_numbers_match_printf();
+    failed_tests += test_time_prefix();
+    failed_tests += test_truncation();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace_writer.h"
+#include "test_utils.h"
+
+#define TEST_TRACE_PATH "/tmp/test_trace_writer.json"
+
+/**
+ * @brief Reads the whole trace file into a new string.
+ */
+static char* read_trace(void) {
+    FILE* file = fopen(TEST_TRACE_PATH, "r");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* contents = malloc(size + 1);
+    size_t read = fread(contents, 1, size, file);
+    contents[read] = '\0';
+    fclose(file);
+    return contents;
+}
+
+int test_events_relative_to_origin() {
+    trace_writer_t writer;
+    if (!trace_writer_open(&writer, TEST_TRACE_PATH, 1000000)) return 1;
+    trace_writer_name(&writer, 1, 2, "Printer 2");
+    trace_writer_complete(&writer, 1, 2, "Job 7", 1000250, 40, "\"job\":7");
+    trace_writer_counter(&writer, 1, "Queue depth", 1000300, 3);
+    size_t event_count = writer.event_count;
+    trace_writer_close(&writer);
+
+    char* contents = read_trace();
+    int is_ok = contents != NULL && event_count == 3
+        && strncmp(contents, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", 40) == 0
+        && strstr(contents, "\"ph\":\"X\",\"name\":\"Job 7\",\"pid\":1,\"tid\":2,\"ts\":250,\"dur\":40") != NULL
+        && strstr(contents, "\"ts\":300,\"args\":{\"value\":3}") != NULL
+        && strcmp(contents + strlen(contents) - 4, "\n]}\n") == 0;
+    if (!is_ok) {
+        printf("Test failed: unexpected trace:\n%s\n", contents != NULL ? contents : "(missing)");
+        free(contents);
+        return 1;
+    }
+    free(contents);
+    printf("Test passed: %zu events with timestamps relative to the origin\n", event_count);
+    return 0;
+}
+
+int test_flush_and_overflow() {
+    trace_writer_t writer;
+    if (!trace_writer_open(&writer, TEST_TRACE_PATH, 0)) return 1;
+    trace_writer_instant(&writer, 1, 4, "simulation start", 0, NULL);
+    trace_writer_flush(&writer);
+
+    // Flushed events are in the file before it is closed
+    char* contents = read_trace();
+    int is_flushed = contents != NULL && strstr(contents, "simulation start") != NULL;
+    free(contents);
+
+    // More events than the buffer holds are written out as it fills
+    int event_total = 1;
+    while (event_total * 64 < 4 * TRACE_WRITER_BUFFER_SIZE) {
+        trace_writer_async(&writer, 1, "Queue wait", event_total, event_total, event_total + 10, NULL);
+        event_total += 2;
+    }
+    trace_writer_close(&writer);
+
+    contents = read_trace();
+    int separator_count = 0;
+    for (const char* c = contents; c != NULL && (c = strstr(c, "},\n{")) != NULL; c++) separator_count++;
+    int is_ok = is_flushed && contents != NULL && separator_count == event_total - 1
+        && strcmp(contents + strlen(contents) - 4, "\n]}\n") == 0;
+    free(contents);
+    remove(TEST_TRACE_PATH);
+    if (!is_ok) {
+        printf("Test failed: flushed %d, %d separators for %d events\n", is_flushed, separator_count, event_total);
+        return 1;
+    }
+    printf("Test passed: %d events written across several buffer flushes\n", event_total);
+    return 0;
+}
+
+int main() {
+    char test_name[] = "TRACE WRITER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_events_relative_to_origin();
+    failed_tests += test_flush_and_overflow();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "job_receiver.h"
+#include "log_router.h"
+#include "mongoose.h"
+#include "timed_queue.h"
+#include "websocket_handler.h"
+#include "ws_bridge.h"
+#include "test_utils.h"
+
+/*
+ * Events are published from this thread with the stream bound as its log
+ * context, as a session binds its run's threads, and flushed with
+ * ws_bridge_service(..., 0). A connection is a zeroed mg_connection whose
+ * send buffer collects the websocket frames.
+ */
+
+#define NO_THRESHOLD (1 << 30)
+#define REFERENCE_TIME_US 1000000UL
+
+/**
+ * @brief Publishes job 4 leaving a queue of length 2 after a 40.016 ms wait,
+ *        251.457 ms into the run, and returns the text frame it produced.
+ * @return TRUE if exactly one text frame was sent.
+ */
+static int publish_departure_frame(int is_text_events, char* text, size_t text_size) {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection c;
+    memset(&c, 0, sizeof(c));
+    c.id = 1;
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+    stream.reference_time_us = REFERENCE_TIME_US;
+    stream.is_text_events = is_text_events;
+    log_router_bind_thread_context(&stream);
+
+    timed_queue_t queue;
+    timed_queue_init(&queue);
+    job_t waiting[2] = {{.id = 5}, {.id = 6}};
+    timed_queue_enqueue(&queue, &waiting[0]);
+    timed_queue_enqueue(&queue, &waiting[1]);
+    job_t job = {.id = 4, .queue_arrival_time_us = REFERENCE_TIME_US + 211441,
+        .queue_departure_time_us = REFERENCE_TIME_US + 251457};
+    publish_queue_departure(&job, NULL, &queue, 0);
+    ws_bridge_service(&c, &stream, 0);
+
+    // A single small frame: FIN + text opcode, then a 7-bit payload length
+    int is_ok = c.send.len >= 2 && (c.send.buf[0] & 0x0f) == WEBSOCKET_OP_TEXT
+        && (c.send.buf[1] & 0x7f) < 126 && c.send.len == 2 + (size_t)(c.send.buf[1] & 0x7f)
+        && c.send.len - 2 < text_size;
+    text[0] = '\0';
+    if (is_ok) {
+        memcpy(text, c.send.buf + 2, c.send.len - 2);
+        text[c.send.len - 2] = '\0';
+    }
+
+    log_router_bind_thread_context(NULL);
+    timed_queue_clear(&queue);
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+    return is_ok;
+}
+
+int test_typed_queue_departure() {
+    char text[512];
+    const char* expected =
+        "[{\"type\":\"queue_departure\", \"t_us\":251457,\"job\":4,\"wait_us\":40016,\"qlen\":2}]";
+    if (!publish_departure_frame(FALSE, text, sizeof(text)) || strcmp(text, expected) != 0) {
+        printf("Test failed: typed event %s (expected %s)\n", text, expected);
+        return 1;
+    }
+    printf("Test passed: queue_departure is sent as %s\n", text);
+    return 0;
+}
+
+int test_text_queue_departure() {
+    char text[512];
+    const char* expected = "[{\"type\":\"log\", \"message\":\"00000251.457ms:  job4 leaves queue, "
+        "time in queue = 40.016ms, queue_length = 2\"}]";
+    if (!publish_departure_frame(TRUE, text, sizeof(text)) || strcmp(text, expected) != 0) {
+        printf("Test failed: text event %s (expected %s)\n", text, expected);
+        return 1;
+    }
+    printf("Test passed: is_text_events sends the legacy sentence\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "WEBSOCKET HANDLER";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_typed_queue_departure();
+    failed_tests += test_text_queue_departure();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}
@@ -0,0 +1,490 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "log_event.h"
+#include "mongoose.h"
+#include "ws_bridge.h"
+#include "test_utils.h"
+
+/*
+ * The bridge is driven from this thread alone: frames are queued with the
+ * ws_bridge_send_* calls and flushed with ws_bridge_service(..., 0), which
+ * flushes regardless of the interval. The batch threshold is never reached,
+ * so no wakeup is posted and no Mongoose manager is needed. A connection is
+ * a zeroed mg_connection whose send buffer collects the websocket frames.
+ */
+
+#define NO_THRESHOLD (1 << 30)
+#define PER_JOB_EVENTS 40
+
+static void init_connection(struct mg_connection* c, unsigned long id) {
+    memset(c, 0, sizeof(*c));
+    c->id = id;
+}
+
+/**
+ * @brief Decodes the server-to-client websocket frame at *pos of a send buffer.
+ * @return TRUE if a whole frame was there; *pos then points past it.
+ */
+static int next_frame(const struct mg_connection* c, size_t* pos, int* opcode,
+    const unsigned char** payload, size_t* length)
+{
+    const unsigned char* p = c->send.buf + *pos;
+    size_t available = c->send.len - *pos;
+    if (available < 2) return FALSE;
+    size_t header = 2;
+    size_t len = p[1] & 0x7f;
+    if (len == 126) {
+        header = 4;
+        len = (size_t)p[2] << 8 | p[3];
+    } else if (len == 127) {
+        header = 10;
+        len = 0;
+        for (int i = 0; i < 8; i++) len = len << 8 | p[2 + i];
+    }
+    if (available < header + len) return FALSE;
+    *opcode = p[0] & 0x0f;
+    *payload = p + header;
+    *length = len;
+    *pos += header + len;
+    return TRUE;
+}
+
+/**
+ * @brief Copies a text frame into a NUL-terminated buffer.
+ */
+static void copy_text(const unsigned char* payload, size_t length, char* out, size_t out_size) {
+    size_t n = length < out_size - 1 ? length : out_size - 1;
+    memcpy(out, payload, n);
+    out[n] = '\0';
+}
+
+/**
+ * @brief Checks that a batch is a JSON array of flat objects: '[', then
+ *        objects separated by single commas, then ']'.
+ */
+static int is_object_array(const char* text) {
+    const char* p = text;
+    if (*p++ != '[') return FALSE;
+    if (*p == ']') return p[1] == '\0';
+    while (TRUE) {
+        if (*p != '{') return FALSE;
+        const char* end = strchr(p, '}');
+        if (end == NULL || memchr(p + 1, '{', end - p - 1) != NULL) return FALSE;
+        p = end + 1;
+        if (*p == ']') return p[1] == '\0';
+        if (*p++ != ',') return FALSE;
+    }
+}
+
+static void send_job_event(ws_stream_t* stream, int event_type, int job_id) {
+    char json[160];
+    int len = snprintf(json, sizeof(json),
+        "{\"type\":\"%s\",\"job_id\":%d,\"padding\":\"%064d\"}", log_event_type_name(event_type), job_id, 0);
+    ws_bridge_send_event_from_any_thread(stream, event_type, json, (size_t)len);
+}
+
+static void send_lifecycle_event(ws_stream_t* stream, int event_type) {
+    char json[64];
+    int len = snprintf(json, sizeof(json), "{\"type\":\"%s\"}", log_event_type_name(event_type));
+    ws_bridge_send_event_from_any_thread(stream, event_type, json, (size_t)len);
+}
+
+int test_drop_oldest_keeps_lifecycle_frames() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, 2048, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection c;
+    init_connection(&c, 1);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+
+    send_lifecycle_event(&stream, LOG_EVENT_SIMULATION_START);
+    for (int i = 0; i < PER_JOB_EVENTS; i++) {
+        if (i == PER_JOB_EVENTS / 2) send_lifecycle_event(&stream, LOG_EVENT_SIMULATION_CHECKPOINT);
+        send_job_event(&stream, LOG_EVENT_QUEUE_ARRIVAL, i);
+    }
+    send_lifecycle_event(&stream, LOG_EVENT_SIMULATION_END);
+    ws_outbound_stats_t stats;
+    ws_bridge_outbound_stats(&stream, &stats);
+    ws_bridge_service(&c, &stream, 0);
+
+    static char text[8192];
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    int is_ok = next_frame(&c, &pos, &opcode, &payload, &length) && opcode == WEBSOCKET_OP_TEXT;
+    if (is_ok) copy_text(payload, length, text, sizeof(text));
+    int kept = 0;
+    for (const char* p = text; is_ok && (p = strstr(p, "\"job_id\"")) != NULL; p++) kept++;
+
+    const char* start = strstr(text, "simulation_start");
+    const char* checkpoint = strstr(text, "simulation_checkpoint");
+    const char* end = strstr(text, "simulation_end");
+    char newest[32];
+    snprintf(newest, sizeof(newest), "\"job_id\":%d,", PER_JOB_EVENTS - 1);
+    is_ok = is_ok && pos == c.send.len && is_object_array(text)
+        && start != NULL && checkpoint != NULL && end != NULL && start < checkpoint && checkpoint < end
+        && stats.dropped_events > 0 && kept + (int)stats.dropped_events == PER_JOB_EVENTS
+        && strstr(text, "\"job_id\":0,") == NULL && strstr(text, newest) != NULL;
+    if (!is_ok) printf("Test failed: drop-oldest batch %s (dropped %lu)\n", text, stats.dropped_events);
+    else printf("Test passed: drop-oldest kept %d of %d per-job events and every lifecycle frame\n",
+        kept, PER_JOB_EVENTS);
+
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+    return is_ok ? 0 : 1;
+}
+
+int test_summary_counts_per_event_type() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, 1024, WS_OVERFLOW_SUMMARY, NO_THRESHOLD);
+    struct mg_connection c;
+    init_connection(&c, 1);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+
+    // The arrivals overflow the budget, and the departures come while it is still full
+    for (int i = 0; i < 20; i++) send_job_event(&stream, LOG_EVENT_QUEUE_ARRIVAL, i);
+    for (int i = 0; i < 5; i++) send_job_event(&stream, LOG_EVENT_QUEUE_DEPARTURE, i);
+    ws_outbound_stats_t stats;
+    ws_bridge_outbound_stats(&stream, &stats);
+
+    // The flush sends the events that fit, followed by the summary of the rest
+    ws_bridge_service(&c, &stream, 0);
+
+    char text[4096] = "";
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    if (next_frame(&c, &pos, &opcode, &payload, &length)) copy_text(payload, length, text, sizeof(text));
+    unsigned int arrivals = 0, departures = 0;
+    const char* arrival_count = strstr(text, "\"queue_arrival\":");
+    const char* departure_count = strstr(text, "\"queue_departure\":");
+    if (arrival_count != NULL) sscanf(arrival_count, "\"queue_arrival\":%u", &arrivals);
+    if (departure_count != NULL) sscanf(departure_count, "\"queue_departure\":%u", &departures);
+
+    const char* summary = strstr(text, "{\"type\":\"summary\"");
+    int is_ok = text[0] == '[' && strstr(text, "\"job_id\":0,") != NULL && summary != NULL
+        && strcmp(summary + strcspn(summary, "}") + 1, "}]") == 0
+        && departures == 5 && arrivals > 0 && arrivals + departures == stats.dropped_events;
+    if (!is_ok) printf("Test failed: summary %s for %lu suppressed events\n", text, stats.dropped_events);
+    else printf("Test passed: summary counted %u queue_arrival and %u queue_departure events\n", arrivals, departures);
+
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+    return is_ok ? 0 : 1;
+}
+
+int test_pause_resumes_at_half_budget() {
+    const size_t budget = 1024;
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, (int)budget, WS_OVERFLOW_PAUSE, NO_THRESHOLD);
+    struct mg_connection c;
+    init_connection(&c, 1);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+
+    for (int i = 0; i < 20; i++) send_job_event(&stream, LOG_EVENT_QUEUE_ARRIVAL, i);
+    ws_bridge_service(&c, &stream, 0);
+    char text[4096] = "";
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    if (next_frame(&c, &pos, &opcode, &payload, &length)) copy_text(payload, length, text, sizeof(text));
+    int is_paused = strstr(text, "\"state\":\"paused\"") != NULL;
+
+    // Just over half the budget still unsent: the stream stays paused and per-job events are skipped
+    c.send.len = 0;
+    mg_iobuf_add(&c.send, 0, NULL, budget / 2 + 1);
+    ws_bridge_service(&c, &stream, 0);
+    ws_outbound_stats_t before;
+    ws_bridge_outbound_stats(&stream, &before);
+    send_job_event(&stream, LOG_EVENT_QUEUE_ARRIVAL, 100);
+    ws_outbound_stats_t during;
+    ws_bridge_outbound_stats(&stream, &during);
+    int stays_paused = c.send.len == budget / 2 + 1 && during.dropped_events == before.dropped_events + 1;
+
+    // Down to half: the stream resumes and the next per-job event is sent
+    c.send.len = budget / 2;
+    ws_bridge_service(&c, &stream, 0);
+    send_job_event(&stream, LOG_EVENT_QUEUE_ARRIVAL, 101);
+    ws_bridge_service(&c, &stream, 0);
+    char resumed[1024] = "";
+    char next[1024] = "";
+    pos = budget / 2;
+    if (next_frame(&c, &pos, &opcode, &payload, &length)) copy_text(payload, length, resumed, sizeof(resumed));
+    if (next_frame(&c, &pos, &opcode, &payload, &length)) copy_text(payload, length, next, sizeof(next));
+    ws_outbound_stats_t after;
+    ws_bridge_outbound_stats(&stream, &after);
+
+    int is_ok = is_paused && stays_paused && strstr(resumed, "\"state\":\"resumed\"") != NULL
+        && strstr(next, "\"job_id\":101,") != NULL && after.dropped_events == during.dropped_events;
+    if (!is_ok) printf("Test failed: pause/resume frames %s | %s | %s\n", text, resumed, next);
+    else printf("Test passed: paused over budget, resumed at half of it\n");
+
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+    return is_ok ? 0 : 1;
+}
+
+int test_batch_framing() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection c;
+    init_connection(&c, 1);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+
+    // JSON: everything pending goes out as one array frame
+    ws_bridge_send_json_from_any_thread(&stream, "{\"a\":1}", 7);
+    ws_bridge_send_event_from_any_thread(&stream, LOG_EVENT_QUEUE_ARRIVAL, "{\"b\":2}", 7);
+    ws_bridge_send_json_from_any_thread(&stream, "{\"c\":3}", 7);
+    ws_bridge_service(&c, &stream, 0);
+    size_t sent = c.send.len;
+    ws_bridge_service(&c, &stream, 0); // nothing pending, nothing sent
+    char text[256] = "";
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    int is_json_ok = next_frame(&c, &pos, &opcode, &payload, &length) && opcode == WEBSOCKET_OP_TEXT
+        && pos == sent && c.send.len == sent;
+    if (is_json_ok) copy_text(payload, length, text, sizeof(text));
+    is_json_ok = is_json_ok && strcmp(text, "[{\"a\":1},{\"b\":2},{\"c\":3}]") == 0;
+    ws_bridge_destroy_stream(&stream);
+
+    // Binary: the records are concatenated into one binary frame
+    c.send.len = 0;
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_BINARY);
+    log_event_t event = {.type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = 7};
+    ws_bridge_send_record_from_any_thread(&stream, LOG_EVENT_QUEUE_ARRIVAL, WS_RECORD_EVENT, &event, sizeof(event));
+    ws_bridge_send_json_from_any_thread(&stream, "{\"c\":3}", 7);
+    ws_bridge_service(&c, &stream, 0);
+    pos = 0;
+    int is_binary_ok = next_frame(&c, &pos, &opcode, &payload, &length) && opcode == WEBSOCKET_OP_BINARY
+        && pos == c.send.len && length == 2 * WS_RECORD_HEADER_SIZE + sizeof(event) + 7
+        && memcmp(payload + WS_RECORD_HEADER_SIZE, &event, sizeof(event)) == 0
+        && memcmp(payload + 2 * WS_RECORD_HEADER_SIZE + sizeof(event), "{\"c\":3}", 7) == 0;
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+
+    if (!is_json_ok || !is_binary_ok) {
+        printf("Test failed: batch framing (JSON %s, binary %s)\n", is_json_ok ? "ok" : text,
+            is_binary_ok ? "ok" : "wrong");
+        return 1;
+    }
+    printf("Test passed: a batch is one JSON array frame or one binary frame of records\n");
+    return 0;
+}
+
+int test_binary_record_headers() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection c;
+    init_connection(&c, 1);
+    ws_stream_t stream;
+
+    // A record sent to a JSON stream is ignored
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_JSON);
+    double value = 1.5;
+    ws_bridge_send_record_from_any_thread(&stream, -1, WS_RECORD_STATISTICS, &value, sizeof(value));
+    ws_bridge_service(&c, &stream, 0);
+    int is_json_ignored = c.send.len == 0;
+    ws_bridge_destroy_stream(&stream);
+
+    // The payload length is little-endian and may exceed 255 bytes; more than 65535 is refused
+    ws_bridge_init_stream(&stream, c.id, WS_PROTOCOL_BINARY);
+    static char big[70000];
+    memset(big, 'x', sizeof(big));
+    ws_bridge_send_record_from_any_thread(&stream, -1, WS_RECORD_JSON, big, sizeof(big));
+    ws_bridge_send_record_from_any_thread(&stream, -1, WS_RECORD_STATISTICS, &value, sizeof(value));
+    ws_bridge_send_record_from_any_thread(&stream, -1, WS_RECORD_JSON, big, 300);
+    ws_bridge_service(&c, &stream, 0);
+
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    const unsigned char statistics_header[] = {WS_RECORD_STATISTICS, 0, sizeof(value), 0};
+    const unsigned char json_header[] = {WS_RECORD_JSON, 0, 300 & 0xff, 300 >> 8};
+    int is_ok = is_json_ignored && next_frame(&c, &pos, &opcode, &payload, &length)
+        && length == 2 * WS_RECORD_HEADER_SIZE + sizeof(value) + 300
+        && memcmp(payload, statistics_header, WS_RECORD_HEADER_SIZE) == 0
+        && memcmp(payload + WS_RECORD_HEADER_SIZE, &value, sizeof(value)) == 0
+        && memcmp(payload + WS_RECORD_HEADER_SIZE + sizeof(value), json_header, WS_RECORD_HEADER_SIZE) == 0;
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&c.send);
+
+    if (!is_ok) {
+        printf("Test failed: binary record headers (JSON stream ignored the record: %d)\n", is_json_ignored);
+        return 1;
+    }
+    printf("Test passed: records carry kind, reserved byte and little-endian length\n");
+    return 0;
+}
+
+/**
+ * @brief Flushes one frame of about size bytes, "[{"seq":N,...}]", to every
+ *        subscriber, and drains the owner so only watchers fall behind.
+ */
+static void flush_sequenced_frame(struct mg_connection* owner, ws_stream_t* stream, int seq, size_t size) {
+    static char json[32768];
+    int len = snprintf(json, sizeof(json), "{\"seq\":%d,\"padding\":\"", seq);
+    while ((size_t)len < size - 2 && (size_t)len < sizeof(json) - 3) json[len++] = 'x';
+    json[len++] = '"';
+    json[len++] = '}';
+    ws_bridge_send_json_from_any_thread(stream, json, (size_t)len);
+    ws_bridge_service(owner, stream, 0);
+    owner->send.len = 0;
+}
+
+/**
+ * @brief Reads the sequence numbers of the frames in a watcher's send buffer
+ *        and empties it.
+ * @return The number of frames read.
+ */
+static int take_sequence(struct mg_connection* c, int* seqs, int max_seqs) {
+    size_t pos = 0;
+    int opcode = 0;
+    const unsigned char* payload;
+    size_t length;
+    int count = 0;
+    while (count < max_seqs && next_frame(c, &pos, &opcode, &payload, &length)) {
+        if (length < 10 || sscanf((const char*)payload, "[{\"seq\":%d,", &seqs[count]) != 1) seqs[count] = -1;
+        if (payload[length - 1] != ']') seqs[count] = -1;
+        count++;
+    }
+    c->send.len = 0;
+    return count;
+}
+
+int test_watcher_crossing_lag_cap() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, 4096);
+    struct mg_connection owner, watcher;
+    init_connection(&owner, 1);
+    init_connection(&watcher, 2);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, owner.id, WS_PROTOCOL_JSON);
+    ws_bridge_subscribe(&stream, watcher.id);
+
+    // Within the cap the watcher receives everything
+    for (int i = 0; i < 3; i++) flush_sequenced_frame(&owner, &stream, i, 1000);
+    int seqs[16];
+    int is_within_ok = ws_bridge_pump(&watcher, &stream) && take_sequence(&watcher, seqs, 16) == 3;
+
+    // Five more unpumped frames of 1000 bytes are more than 4096 behind
+    for (int i = 3; i < 8; i++) flush_sequenced_frame(&owner, &stream, i, 1000);
+    int is_cut_off = !ws_bridge_pump(&watcher, &stream) && watcher.send.len == 0;
+
+    // The owner is never cut off, and later frames still reach it
+    flush_sequenced_frame(&owner, &stream, 8, 1000);
+    ws_bridge_send_json_from_any_thread(&stream, "{\"seq\":9}", 10);
+    ws_bridge_service(&owner, &stream, 0);
+    int owner_seqs[4];
+    int is_owner_ok = take_sequence(&owner, owner_seqs, 4) == 1 && owner_seqs[0] == 9
+        && ws_bridge_watcher_count(&stream) == 1;
+
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&owner.send);
+    mg_iobuf_free(&watcher.send);
+    if (!is_within_ok || !is_cut_off || !is_owner_ok) {
+        printf("Test failed: lag cap (within %d, cut off %d, owner %d)\n", is_within_ok, is_cut_off, is_owner_ok);
+        return 1;
+    }
+    printf("Test passed: a watcher past the lag cap is cut off, the owner is not\n");
+    return 0;
+}
+
+int test_watcher_queue_grows_with_wrapped_head() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection owner, watcher;
+    init_connection(&owner, 1);
+    init_connection(&watcher, 2);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, owner.id, WS_PROTOCOL_JSON);
+    ws_bridge_subscribe(&stream, watcher.id);
+
+    // 20000-byte frames: one pump takes four of them before the send buffer is full
+    const int total = 22;
+    int seqs[32];
+    int received = 0;
+    for (int i = 0; i < 10; i++) flush_sequenced_frame(&owner, &stream, i, 20000);
+    ws_bridge_pump(&watcher, &stream);
+    received += take_sequence(&watcher, seqs + received, 32 - received);
+    int is_partial = received == 4;
+
+    // Ten more fill the initial 16 slots around the end of the ring; the rest force growth from a wrapped head
+    for (int i = 10; i < total; i++) flush_sequenced_frame(&owner, &stream, i, 20000);
+    for (int pumps = 0; pumps < total && received < total; pumps++) {
+        if (!ws_bridge_pump(&watcher, &stream)) break;
+        received += take_sequence(&watcher, seqs + received, 32 - received);
+    }
+
+    int is_in_order = received == total;
+    for (int i = 0; is_in_order && i < total; i++) is_in_order = seqs[i] == i;
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&owner.send);
+    mg_iobuf_free(&watcher.send);
+    if (!is_partial || !is_in_order) {
+        printf("Test failed: watcher received %d of %d frames (first pump %d), not in order\n",
+            received, total, is_partial);
+        return 1;
+    }
+    printf("Test passed: %d frames delivered in order across queue growth with a wrapped head\n", total);
+    return 0;
+}
+
+int test_unsubscribe_keeps_shared_frames() {
+    ws_bridge_configure(NULL, 20, NO_THRESHOLD, NO_THRESHOLD, WS_OVERFLOW_DROP_OLDEST, NO_THRESHOLD);
+    struct mg_connection owner, first, second;
+    init_connection(&owner, 1);
+    init_connection(&first, 2);
+    init_connection(&second, 3);
+    ws_stream_t stream;
+    ws_bridge_init_stream(&stream, owner.id, WS_PROTOCOL_JSON);
+    ws_bridge_subscribe(&stream, first.id);
+    ws_bridge_subscribe(&stream, second.id);
+
+    // Both watchers hold the same three frames; releasing the first must leave them intact for the second
+    for (int i = 0; i < 3; i++) flush_sequenced_frame(&owner, &stream, i, 3000);
+    ws_bridge_unsubscribe(&stream, first.id);
+    ws_bridge_unsubscribe(&stream, 99); // not subscribed: nothing happens
+    flush_sequenced_frame(&owner, &stream, 3, 3000);
+
+    int seqs[8];
+    int is_ok = ws_bridge_watcher_count(&stream) == 1 && !ws_bridge_pump(&first, &stream)
+        && ws_bridge_pump(&second, &stream) && take_sequence(&second, seqs, 8) == 4;
+    for (int i = 0; is_ok && i < 4; i++) is_ok = seqs[i] == i;
+
+    // The last holder releases them
+    ws_bridge_unsubscribe(&stream, second.id);
+    is_ok = is_ok && ws_bridge_watcher_count(&stream) == 0;
+    ws_bridge_destroy_stream(&stream);
+    mg_iobuf_free(&owner.send);
+    mg_iobuf_free(&first.send);
+    mg_iobuf_free(&second.send);
+    if (!is_ok) {
+        printf("Test failed: frames shared with an unsubscribed watcher were lost or reordered\n");
+        return 1;
+    }
+    printf("Test passed: unsubscribing a watcher leaves the frames it shared intact\n");
+    return 0;
+}
+
+int main() {
+    char test_name[] = "WS BRIDGE";
+    print_test_start(test_name);
+    int failed_tests = 0;
+
+    failed_tests += test_drop_oldest_keeps_lifecycle_frames();
+    failed_tests += test_summary_counts_per_event_type();
+    failed_tests += test_pause_resumes_at_half_budget();
+    failed_tests += test_batch_framing();
+    failed_tests += test_binary_record_headers();
+    failed_tests += test_watcher_crossing_lag_cap();
+    failed_tests += test_watcher_queue_grows_with_wrapped_head();
+    failed_tests += test_unsubscribe_keeps_shared_frames();
+
+    print_test_end(test_name, failed_tests);
+    return 0;
+}